@@ -0,0 +1,86 @@
+#include "index_format.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace IndexFormat
+{
+namespace
+{
+    PackedIndices pack32(std::span<const uint32_t> indices)
+    {
+        PackedIndices packed{.stride = sizeof(uint32_t)};
+        packed.data.resize(indices.size_bytes());
+        std::memcpy(packed.data.data(), indices.data(), indices.size_bytes());
+        packed.batches.push_back({
+            .firstIndex = 0,
+            .indexCount = (uint32_t)indices.size(),
+            .baseVertex = 0,
+        });
+        return packed;
+    }
+}
+
+PackedIndices pack(std::span<const uint32_t> indices, bool allow16Bit)
+{
+    if(!allow16Bit || indices.empty())
+        return pack32(indices);
+
+    // Greedily grow each batch one triangle at a time for as long as the range of referenced vertices
+    // stays 16-bit addressable
+    std::vector<Batch> batches;
+    uint32_t batchStart = 0;
+    uint32_t minIndex = std::numeric_limits<uint32_t>::max();
+    uint32_t maxIndex = 0;
+    for(uint32_t i = 0; i < indices.size(); i += 3)
+    {
+        auto [triangleMin, triangleMax] = std::minmax({indices[i + 0], indices[i + 1], indices[i + 2]});
+        uint32_t newMin = std::min(minIndex, triangleMin);
+        uint32_t newMax = std::max(maxIndex, triangleMax);
+
+        if(newMax - newMin < MAX_16_BIT_VERTICES)
+        {
+            minIndex = newMin;
+            maxIndex = newMax;
+            continue;
+        }
+
+        // Not even a single triangle fits, so the whole mesh has to use 32-bit indices
+        if(i == batchStart)
+            return pack32(indices);
+
+        batches.push_back({
+            .firstIndex = batchStart,
+            .indexCount = i - batchStart,
+            .baseVertex = (int32_t)minIndex,
+        });
+        batchStart = i;
+        minIndex = triangleMin;
+        maxIndex = triangleMax;
+        if(maxIndex - minIndex >= MAX_16_BIT_VERTICES)
+            return pack32(indices);
+    }
+    batches.push_back({
+        .firstIndex = batchStart,
+        .indexCount = (uint32_t)indices.size() - batchStart,
+        .baseVertex = (int32_t)minIndex,
+    });
+
+    // A single batch doesn't need a base vertex, and leaving it at 0 keeps the simple case simple
+    if(batches.size() == 1 && maxIndex < MAX_16_BIT_VERTICES)
+        batches[0].baseVertex = 0;
+
+    PackedIndices packed{.stride = sizeof(uint16_t)};
+    packed.data.resize(indices.size() * sizeof(uint16_t));
+    uint16_t* data = (uint16_t*)packed.data.data();
+    for(const Batch& batch : batches)
+    {
+        for(uint32_t i = batch.firstIndex; i < batch.firstIndex + batch.indexCount; ++i)
+            data[i] = (uint16_t)(indices[i] - batch.baseVertex);
+    }
+    packed.batches = std::move(batches);
+
+    return packed;
+}
+}
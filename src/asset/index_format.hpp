@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Picks the smallest index format a mesh can be drawn with. Meshes with too
+// many vertices for 16-bit indices are split into batches where each batch
+// only spans 2^16 vertices, drawn with a base vertex offset
+namespace IndexFormat
+{
+constexpr uint32_t MAX_16_BIT_VERTICES = 1 << 16;
+
+struct Batch
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t baseVertex;
+};
+
+struct PackedIndices
+{
+    // 2 or 4
+    uint32_t stride;
+    std::vector<char> data;
+    std::vector<Batch> batches;
+};
+
+// Works best if the vertices are ordered by first use, see MeshOptimize::optimizeVertexFetch.
+// Falls back to 32-bit indices if the mesh can't be split into 16-bit batches
+PackedIndices pack(std::span<const uint32_t> indices, bool allow16Bit = true);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <DirectXMath.h>
+
+// One stream per attribute, same as the vertex buffers the demos bind
+struct Mesh
+{
+    struct Lod
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        // See MeshSimplify::Result::error
+        float error;
+    };
+
+    std::vector<DirectX::XMFLOAT3> positions;
+    std::vector<DirectX::XMFLOAT2> uvs;
+    std::vector<DirectX::XMFLOAT3> normals;
+    std::vector<DirectX::XMFLOAT3> tangents;
+    std::vector<uint32_t> indices;
+    // Every level of detail is a range of `indices` and they all use the same vertices. Empty until
+    // MeshLod::build has run, after that lods[0] is the full detail mesh
+    std::vector<Lod> lods;
+
+    uint32_t vertexCount() const
+    {
+        return (uint32_t)positions.size();
+    }
+
+    uint32_t indexCount() const
+    {
+        return (uint32_t)indices.size();
+    }
+};
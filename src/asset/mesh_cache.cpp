@@ -0,0 +1,317 @@
+#include "mesh_cache.hpp"
+
+#include <asset/mesh_import.hpp>
+#include <asset/mesh_lod.hpp>
+#include <asset/mesh_optimize.hpp>
+#include <asset/vertex_quantize.hpp>
+#include <asset/vector_math.hpp>
+#include <asset/vertex_weld.hpp>
+#include <util/asset_registry.hpp>
+#include <util/file_util.hpp>
+#include <util/offset_counter.hpp>
+#include <util/path.hpp>
+#include <util/thread_pool.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace MeshCache
+{
+namespace
+{
+    // Only ever holds files that passed the checks in load()
+    AssetRegistry<MappedFile> cookedFiles;
+
+    // Centered on the bounding box, which is good enough for picking levels of detail
+    std::pair<DirectX::XMFLOAT3, float> getBoundingSphere(const Mesh& mesh)
+    {
+        if(mesh.positions.empty())
+            return {{0.0f, 0.0f, 0.0f}, 0.0f};
+
+        DirectX::XMFLOAT3 min = mesh.positions[0];
+        DirectX::XMFLOAT3 max = mesh.positions[0];
+        for(const DirectX::XMFLOAT3& position : mesh.positions)
+        {
+            min = {std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z)};
+            max = {std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z)};
+        }
+
+        DirectX::XMFLOAT3 center = VectorMath::scale(VectorMath::add(min, max), 0.5f);
+        float radius = 0.0f;
+        for(const DirectX::XMFLOAT3& position : mesh.positions)
+            radius = std::max(radius, VectorMath::length(VectorMath::sub(position, center)));
+        return {center, radius};
+    }
+
+    // Each level of each mesh is packed on its own so no batch straddles two of them, but they all have
+    // to share one index format
+    IndexFormat::PackedIndices packLods(
+        std::span<const Mesh> meshes,
+        std::vector<Lod>& cookedLods,
+        std::vector<Part>& parts)
+    {
+        std::vector<std::vector<Mesh::Lod>> meshLods;
+        for(const Mesh& mesh : meshes)
+        {
+            meshLods.push_back(mesh.lods);
+            if(mesh.lods.empty())
+                meshLods.back().push_back({.firstIndex = 0, .indexCount = mesh.indexCount(), .error = 0.0f});
+        }
+
+        std::vector<IndexFormat::PackedIndices> packedLods;
+        for(bool allow16Bit : {true, false})
+        {
+            packedLods.clear();
+            for(uint32_t i = 0; i < meshes.size(); ++i)
+            {
+                for(const Mesh::Lod& lod : meshLods[i])
+                {
+                    packedLods.push_back(IndexFormat::pack(
+                        std::span(meshes[i].indices).subspan(lod.firstIndex, lod.indexCount),
+                        allow16Bit));
+                }
+            }
+
+            bool sameStride = std::all_of(
+                packedLods.begin(),
+                packedLods.end(),
+                [&](const IndexFormat::PackedIndices& packed) { return packed.stride == packedLods[0].stride; });
+            if(sameStride)
+                break;
+        }
+
+        IndexFormat::PackedIndices result{.stride = packedLods[0].stride};
+        cookedLods.clear();
+        parts.clear();
+        uint32_t firstVertex = 0;
+        auto packedLod = packedLods.begin();
+        for(uint32_t i = 0; i < meshes.size(); ++i)
+        {
+            Part& part = parts.emplace_back(Part{
+                .firstLod = (uint32_t)cookedLods.size(),
+                .lodCount = (uint32_t)meshLods[i].size(),
+            });
+            std::tie(part.boundsCenter, part.boundsRadius) = getBoundingSphere(meshes[i]);
+
+            for(const Mesh::Lod& lod : meshLods[i])
+            {
+                cookedLods.push_back({
+                    .firstBatch = (uint32_t)result.batches.size(),
+                    .batchCount = (uint32_t)packedLod->batches.size(),
+                    .error = lod.error,
+                });
+
+                uint32_t firstIndex = (uint32_t)result.data.size() / result.stride;
+                for(IndexFormat::Batch batch : packedLod->batches)
+                {
+                    batch.firstIndex += firstIndex;
+                    batch.baseVertex += firstVertex;
+                    result.batches.push_back(batch);
+                }
+                result.data.insert(result.data.end(), packedLod->data.begin(), packedLod->data.end());
+                ++packedLod;
+            }
+
+            firstVertex += meshes[i].vertexCount();
+        }
+        return result;
+    }
+}
+
+std::filesystem::path getCookedPath(const std::filesystem::path& sourcePath, VertexFormat vertexFormat)
+{
+    const char* extension = vertexFormat == VertexFormat::QUANTIZED ? ".quantized.mesh" : ".mesh";
+    return Path::getCachePath(sourcePath.filename().concat(extension));
+}
+
+Layout getLayout(std::span<const Mesh> meshes, VertexFormat vertexFormat)
+{
+    Layout layout;
+    layout.indices = packLods(meshes, layout.lods, layout.parts);
+
+    // All meshes share one set of vertex buffers, the batches carry the offsets
+    uint32_t vertexCount = 0;
+    for(const Mesh& mesh : meshes)
+        vertexCount += mesh.vertexCount();
+
+    Header& header = layout.header;
+    header = {
+        .magic = MAGIC,
+        .version = VERSION,
+        .vertexFormat = vertexFormat,
+        .vertexCount = vertexCount,
+        .indexCount = (uint32_t)layout.indices.data.size() / layout.indices.stride,
+        .indexStride = layout.indices.stride,
+        .batchCount = (uint32_t)layout.indices.batches.size(),
+        .lodCount = (uint32_t)layout.lods.size(),
+        .partCount = (uint32_t)layout.parts.size(),
+    };
+    if(vertexFormat == VertexFormat::QUANTIZED)
+    {
+        VertexQuantize::PositionRange range = VertexQuantize::getPositionRange(meshes);
+        header.positionMin = range.min;
+        header.positionExtent = range.extent;
+    }
+    const VertexStrides strides = getVertexStrides(vertexFormat);
+
+    OffsetCounter counter;
+    // clang-format off
+    std::tie(header.positionOffset, header.positionSize) = counter.append(strides.position * header.vertexCount);
+    std::tie(header.uvOffset, header.uvSize)             = counter.append(strides.uv * header.vertexCount);
+    std::tie(header.normalOffset, header.normalSize)     = counter.append(strides.normal * header.vertexCount);
+    std::tie(header.tangentOffset, header.tangentSize)   = counter.append(strides.tangent * header.vertexCount);
+    std::tie(header.indexOffset, header.indexSize)       = counter.append((uint32_t)layout.indices.data.size());
+    std::tie(header.batchOffset, header.batchSize)       = counter.appendAligned<IndexFormat::Batch>(header.batchCount, 4);
+    std::tie(header.lodOffset, header.lodSize)           = counter.append<Lod>(header.lodCount);
+    std::tie(header.partOffset, header.partSize)         = counter.append<Part>(header.partCount);
+    std::tie(header.payloadSize, std::ignore)            = counter.append(0);
+    // clang-format on
+
+    return layout;
+}
+
+void writePayload(std::span<const Mesh> meshes, const Layout& layout, char* payload)
+{
+    const Header& header = layout.header;
+    const VertexStrides strides = getVertexStrides(header.vertexFormat);
+
+    std::vector<uint32_t> firstVertices;
+    uint32_t vertexCount = 0;
+    for(const Mesh& mesh : meshes)
+        firstVertices.push_back(std::exchange(vertexCount, vertexCount + mesh.vertexCount()));
+
+    // Every mesh owns a disjoint slice of each stream
+    ThreadPool::shared().parallelFor(
+        (uint32_t)meshes.size(),
+        1,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t i = begin; i < end; ++i)
+            {
+                const Mesh& mesh = meshes[i];
+                char* positions = payload + header.positionOffset + firstVertices[i] * strides.position;
+                char* uvs = payload + header.uvOffset + firstVertices[i] * strides.uv;
+                char* normals = payload + header.normalOffset + firstVertices[i] * strides.normal;
+                char* tangents = payload + header.tangentOffset + firstVertices[i] * strides.tangent;
+
+                if(header.vertexFormat == VertexFormat::QUANTIZED)
+                {
+                    VertexQuantize::PositionRange range{header.positionMin, header.positionExtent};
+                    VertexQuantize::encodePositions(mesh.positions, range, (std::array<uint16_t, 4>*)positions);
+                    VertexQuantize::encodeUvs(mesh.uvs, (std::array<uint16_t, 2>*)uvs);
+                    VertexQuantize::encodeDirections(mesh.normals, (std::array<int16_t, 2>*)normals);
+                    VertexQuantize::encodeDirections(mesh.tangents, (std::array<int16_t, 2>*)tangents);
+                }
+                else
+                {
+                    std::memcpy(positions, mesh.positions.data(), mesh.positions.size() * strides.position);
+                    std::memcpy(uvs, mesh.uvs.data(), mesh.uvs.size() * strides.uv);
+                    std::memcpy(normals, mesh.normals.data(), mesh.normals.size() * strides.normal);
+                    std::memcpy(tangents, mesh.tangents.data(), mesh.tangents.size() * strides.tangent);
+                }
+            }
+        });
+
+    std::memcpy(payload + header.indexOffset, layout.indices.data.data(), header.indexSize);
+    std::memcpy(payload + header.batchOffset, layout.indices.batches.data(), header.batchSize);
+    std::memcpy(payload + header.lodOffset, layout.lods.data(), header.lodSize);
+    std::memcpy(payload + header.partOffset, layout.parts.data(), header.partSize);
+}
+
+bool write(
+    std::span<const Mesh> meshes,
+    const std::filesystem::path& sourcePath,
+    const std::filesystem::path& cookedPath,
+    VertexFormat vertexFormat)
+{
+    Layout layout = getLayout(meshes, vertexFormat);
+    std::tie(layout.header.sourceSize, layout.header.sourceWriteTime) = FileUtil::getStamp(sourcePath);
+
+    // The file buffer is the only copy of the vertex data that gets made
+    std::vector<char> fileData(PAYLOAD_OFFSET + layout.header.payloadSize);
+    std::memcpy(fileData.data(), &layout.header, sizeof(Header));
+    writePayload(meshes, layout, fileData.data() + PAYLOAD_OFFSET);
+
+    std::error_code error;
+    std::filesystem::create_directories(cookedPath.parent_path(), error);
+
+    return FileUtil::replaceFile(cookedPath, fileData);
+}
+
+bool cook(
+    const std::filesystem::path& sourcePath,
+    const std::filesystem::path& cookedPath,
+    VertexFormat vertexFormat)
+{
+    std::optional<std::vector<Mesh>> meshes = MeshImport::import(sourcePath);
+    if(!meshes)
+        return false;
+
+    // One task per mesh. The passes split up large meshes further on their own
+    ThreadPool::shared().parallelFor(
+        (uint32_t)meshes->size(),
+        1,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t i = begin; i < end; ++i)
+            {
+                Mesh& mesh = meshes.value()[i];
+                VertexWeld::weld(mesh);
+                MeshOptimize::optimize(mesh);
+                MeshLod::build(mesh);
+            }
+        });
+
+    return write(meshes.value(), sourcePath, cookedPath, vertexFormat);
+}
+
+std::optional<CookedMesh> load(const std::filesystem::path& cookedPath)
+{
+    AssetRegistry<MappedFile>::Handle file = cookedFiles.load(
+        cookedPath,
+        [](MappedFile&& file) -> std::optional<MappedFile>
+        {
+            if(file.size() < PAYLOAD_OFFSET)
+                return std::nullopt;
+
+            const Header& header = *(const Header*)file.data();
+            if(header.magic != MAGIC || header.version != VERSION)
+                return std::nullopt;
+            if(file.size() < (size_t)PAYLOAD_OFFSET + header.payloadSize)
+                return std::nullopt;
+
+            return std::move(file);
+        });
+    if(!file)
+        return std::nullopt;
+
+    return CookedMesh(std::move(file));
+}
+
+bool isUpToDate(const CookedMesh& mesh, const std::filesystem::path& sourcePath)
+{
+    auto [size, writeTime] = FileUtil::getStamp(sourcePath);
+    return mesh.header().sourceSize == size && mesh.header().sourceWriteTime == writeTime;
+}
+
+std::optional<CookedMesh> loadOrCook(const std::filesystem::path& sourcePath, VertexFormat vertexFormat)
+{
+    std::filesystem::path cookedPath = getCookedPath(sourcePath, vertexFormat);
+
+    std::optional<CookedMesh> mesh = load(cookedPath);
+    if(mesh && mesh->header().vertexFormat == vertexFormat && isUpToDate(mesh.value(), sourcePath))
+        return mesh;
+
+    // The new file is renamed over the stale one, so every other CookedMesh of it keeps the old bytes. Windows
+    // won't replace a mapped file though, so drop ours first. Until the others are gone as well cooking fails there
+    mesh.reset();
+    if(!cook(sourcePath, cookedPath, vertexFormat))
+        return std::nullopt;
+
+    return load(cookedPath);
+}
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <asset/index_format.hpp>
+#include <asset/mesh.hpp>
+#include <util/mapped_file.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <DirectXMath.h>
+
+// Binary mesh format produced by the cook step. The payload is laid out in
+// the same order as the demos' upload buffers, so each stream can be copied
+// straight out of the mapped file without any conversion. Every mesh in the
+// source scene is packed into the same streams and drawn through its batches
+namespace MeshCache
+{
+constexpr uint32_t MAGIC = 0x4853454D; // "MESH"
+constexpr uint32_t VERSION = 7;
+constexpr uint32_t PAYLOAD_ALIGNMENT = 16;
+
+enum class VertexFormat : uint32_t
+{
+    FULL = 0,
+    // See VertexQuantize
+    QUANTIZED,
+};
+
+struct VertexStrides
+{
+    uint32_t position;
+    uint32_t uv;
+    uint32_t normal;
+    uint32_t tangent;
+};
+
+constexpr VertexStrides getVertexStrides(VertexFormat format)
+{
+    switch(format)
+    {
+        case VertexFormat::QUANTIZED: return {.position = 8, .uv = 4, .normal = 4, .tangent = 4};
+        case VertexFormat::FULL:
+        default: return {.position = 12, .uv = 8, .normal = 12, .tangent = 12};
+    }
+}
+
+struct Lod
+{
+    // Into the batch array, each level has its own batches
+    uint32_t firstBatch;
+    uint32_t batchCount;
+    // See MeshSimplify::Result::error
+    float error;
+};
+
+// One per mesh in the source scene, with the node transform already applied to its vertices
+struct Part
+{
+    // Into the LOD array, the first one is the full detail level
+    uint32_t firstLod;
+    uint32_t lodCount;
+    // Bounding sphere, for picking a level of detail
+    DirectX::XMFLOAT3 boundsCenter;
+    float boundsRadius;
+};
+
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+
+    // Used to detect when the source asset has changed since it was cooked
+    uint64_t sourceSize;
+    int64_t sourceWriteTime;
+
+    VertexFormat vertexFormat;
+    // Only used for VertexFormat::QUANTIZED, position = positionMin + unorm * positionExtent
+    DirectX::XMFLOAT3 positionMin;
+    DirectX::XMFLOAT3 positionExtent;
+
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    // 2 or 4 bytes, see IndexFormat
+    uint32_t indexStride;
+    uint32_t batchCount;
+    uint32_t lodCount;
+    uint32_t partCount;
+
+    // Relative to the start of the payload
+    uint32_t positionOffset;
+    uint32_t positionSize;
+    uint32_t uvOffset;
+    uint32_t uvSize;
+    uint32_t normalOffset;
+    uint32_t normalSize;
+    uint32_t tangentOffset;
+    uint32_t tangentSize;
+    uint32_t indexOffset;
+    uint32_t indexSize;
+    // Not GPU data, but it's small and this keeps everything in one file
+    uint32_t batchOffset;
+    uint32_t batchSize;
+    uint32_t lodOffset;
+    uint32_t lodSize;
+    uint32_t partOffset;
+    uint32_t partSize;
+    uint32_t payloadSize;
+};
+
+constexpr uint32_t PAYLOAD_OFFSET = (sizeof(Header) + PAYLOAD_ALIGNMENT - 1) / PAYLOAD_ALIGNMENT * PAYLOAD_ALIGNMENT;
+
+// A handle to the mapped file, copies share the mapping
+class CookedMesh
+{
+    std::shared_ptr<const MappedFile> file;
+
+  public:
+    explicit CookedMesh(std::shared_ptr<const MappedFile> file): file(std::move(file)) {}
+
+    const Header& header() const
+    {
+        return *(const Header*)file->data();
+    }
+
+    const char* payload() const
+    {
+        return file->data() + PAYLOAD_OFFSET;
+    }
+
+    std::span<const DirectX::XMFLOAT3> positions() const
+    {
+        assert(header().vertexFormat == VertexFormat::FULL);
+        return {(const DirectX::XMFLOAT3*)(payload() + header().positionOffset), header().vertexCount};
+    }
+
+    std::span<const DirectX::XMFLOAT2> uvs() const
+    {
+        assert(header().vertexFormat == VertexFormat::FULL);
+        return {(const DirectX::XMFLOAT2*)(payload() + header().uvOffset), header().vertexCount};
+    }
+
+    std::span<const DirectX::XMFLOAT3> normals() const
+    {
+        assert(header().vertexFormat == VertexFormat::FULL);
+        return {(const DirectX::XMFLOAT3*)(payload() + header().normalOffset), header().vertexCount};
+    }
+
+    std::span<const DirectX::XMFLOAT3> tangents() const
+    {
+        assert(header().vertexFormat == VertexFormat::FULL);
+        return {(const DirectX::XMFLOAT3*)(payload() + header().tangentOffset), header().vertexCount};
+    }
+
+    const char* indices() const
+    {
+        return payload() + header().indexOffset;
+    }
+
+    // Every level of detail
+    std::span<const IndexFormat::Batch> batches() const
+    {
+        return {(const IndexFormat::Batch*)(payload() + header().batchOffset), header().batchCount};
+    }
+
+    std::span<const Lod> lods() const
+    {
+        return {(const Lod*)(payload() + header().lodOffset), header().lodCount};
+    }
+
+    std::span<const IndexFormat::Batch> lodBatches(uint32_t lod) const
+    {
+        return batches().subspan(lods()[lod].firstBatch, lods()[lod].batchCount);
+    }
+
+    std::span<const Part> parts() const
+    {
+        return {(const Part*)(payload() + header().partOffset), header().partCount};
+    }
+
+    // For drawing the whole scene without picking levels of detail
+    std::vector<IndexFormat::Batch> fullDetailBatches() const
+    {
+        std::vector<IndexFormat::Batch> result;
+        for(const Part& part : parts())
+        {
+            std::span<const IndexFormat::Batch> partBatches = lodBatches(part.firstLod);
+            result.insert(result.end(), partBatches.begin(), partBatches.end());
+        }
+        return result;
+    }
+};
+
+// Everything about a cooked file except the vertex streams, which writePayload converts straight from the
+// meshes into place
+struct Layout
+{
+    // The source stamp is left empty, write fills it in
+    Header header;
+    IndexFormat::PackedIndices indices;
+    std::vector<Lod> lods;
+    std::vector<Part> parts;
+};
+
+Layout getLayout(std::span<const Mesh> meshes, VertexFormat vertexFormat = VertexFormat::FULL);
+
+// Converts every stream into its region of `payload`, which needs room for layout.header.payloadSize
+// bytes. Each mesh's vertices are read once and written once with no copy in between, so `payload` can
+// just as well be a mapped upload buffer. The meshes are converted in parallel
+void writePayload(std::span<const Mesh> meshes, const Layout& layout, char* payload);
+
+std::filesystem::path getCookedPath(
+    const std::filesystem::path& sourcePath,
+    VertexFormat vertexFormat = VertexFormat::FULL);
+
+bool write(
+    std::span<const Mesh> meshes,
+    const std::filesystem::path& sourcePath,
+    const std::filesystem::path& cookedPath,
+    VertexFormat vertexFormat = VertexFormat::FULL);
+bool cook(
+    const std::filesystem::path& sourcePath,
+    const std::filesystem::path& cookedPath,
+    VertexFormat vertexFormat = VertexFormat::FULL);
+
+// Returns std::nullopt if the file is missing, truncated, or from another version. Goes through an
+// AssetRegistry, so loads of the same cooked bytes share one mapping for as long as any of them is alive
+std::optional<CookedMesh> load(const std::filesystem::path& cookedPath);
+bool isUpToDate(const CookedMesh& mesh, const std::filesystem::path& sourcePath);
+
+// Maps the cooked version of `sourcePath`, cooking it first if it's missing or stale
+std::optional<CookedMesh> loadOrCook(
+    const std::filesystem::path& sourcePath,
+    VertexFormat vertexFormat = VertexFormat::FULL);
+}
@@ -0,0 +1,167 @@
+#include "mesh_import.hpp"
+
+#include <asset/tangent_generate.hpp>
+#include <asset/vector_math.hpp>
+#include <util/thread_pool.hpp>
+
+#include <cassert>
+#include <utility>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+namespace MeshImport
+{
+using namespace VectorMath;
+
+namespace
+{
+    struct Instance
+    {
+        uint32_t mesh;
+        aiMatrix4x4 transform;
+    };
+
+    void collectInstances(const aiNode* node, const aiMatrix4x4& parentTransform, std::vector<Instance>& instances)
+    {
+        aiMatrix4x4 transform = parentTransform * node->mTransformation;
+        for(uint32_t i = 0; i < node->mNumMeshes; ++i)
+            instances.push_back({node->mMeshes[i], transform});
+
+        for(uint32_t i = 0; i < node->mNumChildren; ++i)
+            collectInstances(node->mChildren[i], transform, instances);
+    }
+
+    Mesh convert(const aiMesh* mesh)
+    {
+        assert(mesh->HasNormals());
+        assert(mesh->HasTextureCoords(0));
+
+        Mesh outMesh;
+        outMesh.indices.reserve(mesh->mNumFaces * 3);
+        for(const aiFace* face = mesh->mFaces; face < mesh->mFaces + mesh->mNumFaces; ++face)
+        {
+            assert(face->mNumIndices == 3);
+            outMesh.indices.insert(outMesh.indices.end(), face->mIndices, face->mIndices + 3);
+        }
+
+        outMesh.positions.resize(mesh->mNumVertices);
+        outMesh.uvs.resize(mesh->mNumVertices);
+        outMesh.normals.resize(mesh->mNumVertices);
+        outMesh.tangents.resize(mesh->mNumVertices);
+        for(uint32_t i = 0; i < mesh->mNumVertices; ++i)
+        {
+            const aiVector3D& position = mesh->mVertices[i];
+            const aiVector3D& texCoords = mesh->mTextureCoords[0][i];
+            const aiVector3D& normal = mesh->mNormals[i];
+
+            outMesh.positions[i] = {position.x, position.y, position.z};
+            outMesh.uvs[i] = {texCoords.x, texCoords.y};
+            outMesh.normals[i] = {normal.x, normal.y, normal.z};
+        }
+
+        if(mesh->HasTangentsAndBitangents())
+        {
+            for(uint32_t i = 0; i < mesh->mNumVertices; ++i)
+                outMesh.tangents[i] = {mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z};
+        }
+        else
+        {
+            TangentGenerate::generate(outMesh);
+        }
+
+        return outMesh;
+    }
+
+    // What aiProcess_PreTransformVertices used to do, but per mesh so it can run in parallel
+    void applyTransform(Mesh& mesh, const aiMatrix4x4& transform)
+    {
+        DirectX::XMFLOAT3 row0{transform.a1, transform.a2, transform.a3};
+        DirectX::XMFLOAT3 row1{transform.b1, transform.b2, transform.b3};
+        DirectX::XMFLOAT3 row2{transform.c1, transform.c2, transform.c3};
+        DirectX::XMFLOAT3 translation{transform.a4, transform.b4, transform.c4};
+
+        // Normals need the inverse transpose. The cofactor matrix is that times the determinant, which
+        // only changes the length and, for mirroring transforms, the sign
+        DirectX::XMFLOAT3 cofactor0 = cross(row1, row2);
+        DirectX::XMFLOAT3 cofactor1 = cross(row2, row0);
+        DirectX::XMFLOAT3 cofactor2 = cross(row0, row1);
+        float determinant = dot(row0, cofactor0);
+        float normalSign = determinant < 0.0f ? -1.0f : 1.0f;
+
+        for(DirectX::XMFLOAT3& position : mesh.positions)
+            position = add({dot(row0, position), dot(row1, position), dot(row2, position)}, translation);
+        for(DirectX::XMFLOAT3& normal : mesh.normals)
+        {
+            DirectX::XMFLOAT3 transformed{dot(cofactor0, normal), dot(cofactor1, normal), dot(cofactor2, normal)};
+            normal = normalize(scale(transformed, normalSign));
+        }
+        for(DirectX::XMFLOAT3& tangent : mesh.tangents)
+            tangent = normalize({dot(row0, tangent), dot(row1, tangent), dot(row2, tangent)});
+
+        // Mirroring also flips the winding
+        if(determinant < 0.0f)
+        {
+            for(uint32_t i = 0; i + 2 < mesh.indexCount(); i += 3)
+                std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+        }
+    }
+}
+
+std::optional<std::vector<Mesh>> import(const std::filesystem::path& path)
+{
+    Assimp::Importer importer;
+    // Node transforms are applied below instead of with aiProcess_PreTransformVertices, which would walk
+    // every mesh on this thread
+    const aiScene* scene = importer.ReadFile(
+        path.string().c_str(), // This works with non-ANSII paths on Win11 22H2 ???
+        0);
+    if(!scene || scene->mNumMeshes == 0 || !scene->mRootNode)
+        return std::nullopt;
+
+    std::vector<Instance> instances;
+    collectInstances(scene->mRootNode, aiMatrix4x4(), instances);
+    if(instances.empty())
+        return std::nullopt;
+
+    std::vector<uint32_t> useCounts(scene->mNumMeshes, 0);
+    for(const Instance& instance : instances)
+        ++useCounts[instance.mesh];
+
+    // One task per mesh
+    ThreadPool& pool = ThreadPool::shared();
+    std::vector<Mesh> meshes(scene->mNumMeshes);
+    pool.parallelFor(
+        scene->mNumMeshes,
+        1,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t i = begin; i < end; ++i)
+            {
+                if(useCounts[i] > 0)
+                    meshes[i] = convert(scene->mMeshes[i]);
+            }
+        });
+
+    std::vector<Mesh> result(instances.size());
+    pool.parallelFor(
+        (uint32_t)instances.size(),
+        1,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t i = begin; i < end; ++i)
+            {
+                const Instance& instance = instances[i];
+                // Meshes that are only referenced once, which is most of them, can be moved
+                if(useCounts[instance.mesh] == 1)
+                    result[i] = std::move(meshes[instance.mesh]);
+                else
+                    result[i] = meshes[instance.mesh];
+                applyTransform(result[i], instance.transform);
+            }
+        });
+
+    return result;
+}
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <asset/mesh.hpp>
+
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace MeshImport
+{
+// Runs the file through Assimp. This is the slow path, prefer MeshCache::loadOrCook.
+// Returns one mesh per mesh reference in the node tree with the node's transform already applied, so
+// a mesh referenced by two nodes comes back twice. The meshes are converted in parallel
+std::optional<std::vector<Mesh>> import(const std::filesystem::path& path);
+}
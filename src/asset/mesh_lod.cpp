@@ -0,0 +1,80 @@
+#include "mesh_lod.hpp"
+
+#include <asset/mesh_optimize.hpp>
+#include <asset/mesh_simplify.hpp>
+#include <util/thread_pool.hpp>
+
+#include <chrono>
+#include <cmath>
+
+namespace MeshLod
+{
+std::vector<LevelStats> build(Mesh& mesh)
+{
+    uint32_t fullIndexCount = mesh.indexCount();
+    mesh.lods = {{.firstIndex = 0, .indexCount = fullIndexCount, .error = 0.0f}};
+    std::vector<LevelStats> stats{{.indexCount = fullIndexCount, .error = 0.0f, .buildTimeMS = 0.0f}};
+
+    // parallelFor rather than submit so this can run inside a pool task without waiting on the queue
+    std::array<MeshSimplify::Result, LOD_RATIOS.size()> levels;
+    std::array<float, LOD_RATIOS.size()> buildTimes;
+    ThreadPool::shared().parallelFor(
+        (uint32_t)LOD_RATIOS.size(),
+        1,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t level = begin; level < end; ++level)
+            {
+                auto start = std::chrono::high_resolution_clock::now();
+
+                uint32_t targetIndexCount = (uint32_t)(fullIndexCount / 3 * LOD_RATIOS[level]) * 3;
+                levels[level] =
+                    MeshSimplify::simplify(mesh, std::span(mesh.indices).first(fullIndexCount), targetIndexCount);
+                MeshOptimize::optimizeVertexCache(levels[level].indices, mesh.vertexCount());
+
+                std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+                buildTimes[level] = duration.count();
+            }
+        });
+
+    for(uint32_t level = 0; level < levels.size(); ++level)
+    {
+        const MeshSimplify::Result& result = levels[level];
+        if(result.indices.size() >= mesh.lods.back().indexCount)
+            continue;
+
+        mesh.lods.push_back({
+            .firstIndex = mesh.indexCount(),
+            .indexCount = (uint32_t)result.indices.size(),
+            .error = result.error,
+        });
+        mesh.indices.insert(mesh.indices.end(), result.indices.begin(), result.indices.end());
+        stats.push_back({
+            .indexCount = (uint32_t)result.indices.size(),
+            .error = result.error,
+            .buildTimeMS = buildTimes[level],
+        });
+    }
+
+    return stats;
+}
+
+float getProjectionScale(float verticalFov, uint32_t screenHeight)
+{
+    return screenHeight / (2.0f * std::tan(verticalFov * 0.5f));
+}
+
+uint32_t select(std::span<const MeshCache::Lod> lods, float distance, float projectionScale, float maxPixelError)
+{
+    if(distance <= 0.0f)
+        return 0;
+
+    uint32_t selected = 0;
+    for(uint32_t lod = 1; lod < lods.size(); ++lod)
+    {
+        if(lods[lod].error * projectionScale / distance <= maxPixelError)
+            selected = lod;
+    }
+    return selected;
+}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <asset/mesh.hpp>
+#include <asset/mesh_cache.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Builds the level of detail chain while cooking and picks a level at runtime
+namespace MeshLod
+{
+// Share of the full detail triangle count each simplified level aims for
+inline constexpr std::array LOD_RATIOS{0.5f, 0.25f, 0.125f};
+// How far off a level may look, in pixels, before a more detailed one is picked
+constexpr float MAX_PIXEL_ERROR = 1.0f;
+
+struct LevelStats
+{
+    uint32_t indexCount;
+    // See MeshSimplify::Result::error
+    float error;
+    float buildTimeMS;
+};
+
+// Simplifies the full detail mesh towards each of LOD_RATIOS in parallel, optimizes the results for the
+// vertex cache and appends them to mesh.indices. A level that doesn't end up smaller than the one before
+// it is left out. Returns one entry per level in mesh.lods
+std::vector<LevelStats> build(Mesh& mesh);
+
+// How many pixels one unit spans at a distance of one unit from the camera
+float getProjectionScale(float verticalFov, uint32_t screenHeight);
+
+// The coarsest level whose error covers at most `maxPixelError` pixels at `distance`
+uint32_t select(
+    std::span<const MeshCache::Lod> lods,
+    float distance,
+    float projectionScale,
+    float maxPixelError = MAX_PIXEL_ERROR);
+}
@@ -0,0 +1,398 @@
+#include "mesh_optimize.hpp"
+
+#include <asset/vector_math.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace MeshOptimize
+{
+using namespace VectorMath;
+
+namespace
+{
+    constexpr uint32_t INVALID_TRIANGLE = ~0u;
+    constexpr uint32_t INVALID_VERTEX = ~0u;
+    // The cache size used when scoring, not the one being simulated. Forsyth found 32 works well for
+    // pretty much any real cache size
+    constexpr uint32_t SCORING_CACHE_SIZE = 32;
+
+    float vertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+    {
+        if(remainingTriangles == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if(cachePosition >= 0)
+        {
+            // The last triangle's vertices get a fixed score so the next triangle doesn't just reuse the
+            // same edge, which would work against a strip-like order
+            if(cachePosition < 3)
+                score = 0.75f;
+            else
+                score = std::pow(1.0f - (cachePosition - 3) / (float)(SCORING_CACHE_SIZE - 3), 1.5f);
+        }
+
+        // Prefer vertices with few triangles left so they can be retired early
+        return score + 2.0f / std::sqrt((float)remainingTriangles);
+    }
+
+    struct FifoCache
+    {
+        std::vector<uint32_t> timestamps;
+        uint32_t timestamp;
+        uint32_t cacheSize;
+
+        FifoCache(uint32_t vertexCount, uint32_t cacheSize)
+            : timestamps(vertexCount, 0)
+            , timestamp(cacheSize + 1)
+            , cacheSize(cacheSize)
+        {
+        }
+
+        bool access(uint32_t vertex)
+        {
+            if(timestamp - timestamps[vertex] > cacheSize)
+            {
+                timestamps[vertex] = timestamp++;
+                return false;
+            }
+            return true;
+        }
+
+        uint32_t accessTriangle(const uint32_t* triangle)
+        {
+            return !access(triangle[0]) + !access(triangle[1]) + !access(triangle[2]);
+        }
+
+        void reset()
+        {
+            timestamp += cacheSize + 1;
+        }
+    };
+}
+
+CacheStats analyzeVertexCache(std::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    if(indices.empty())
+        return {0.0f, 0.0f};
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<bool> used(vertexCount, false);
+
+    uint32_t misses = 0;
+    uint32_t usedCount = 0;
+    for(uint32_t index : indices)
+    {
+        misses += !cache.access(index);
+        if(!used[index])
+        {
+            used[index] = true;
+            ++usedCount;
+        }
+    }
+
+    return {
+        .acmr = misses / (float)(indices.size() / 3),
+        .atvr = misses / (float)usedCount,
+    };
+}
+
+void optimizeVertexCache(std::span<uint32_t> indices, uint32_t vertexCount)
+{
+    const uint32_t triangleCount = (uint32_t)indices.size() / 3;
+    if(triangleCount == 0)
+        return;
+
+    // Vertex -> triangle adjacency. Emitted triangles are swapped to the back of each vertex's list so
+    // the first `remaining[v]` entries are always the live ones
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for(uint32_t index : indices)
+        ++remaining[index];
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    std::inclusive_scan(remaining.begin(), remaining.end(), adjacencyOffsets.begin() + 1);
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for(uint32_t i = 0; i < indices.size(); ++i)
+            adjacency[fill[indices[i]]++] = i / 3;
+    }
+
+    std::vector<float> vertexScores(vertexCount);
+    for(uint32_t i = 0; i < vertexCount; ++i)
+        vertexScores[i] = vertexScore(-1, remaining[i]);
+
+    std::vector<float> triangleScores(triangleCount);
+    for(uint32_t i = 0; i < triangleCount; ++i)
+    {
+        triangleScores[i] =
+            vertexScores[indices[i * 3 + 0]] + vertexScores[indices[i * 3 + 1]] + vertexScores[indices[i * 3 + 2]];
+    }
+
+    auto updateVertexScore = [&](uint32_t vertex, int32_t cachePosition) {
+        float score = vertexScore(cachePosition, remaining[vertex]);
+        float delta = score - vertexScores[vertex];
+        vertexScores[vertex] = score;
+
+        for(uint32_t i = 0; i < remaining[vertex]; ++i)
+            triangleScores[adjacency[adjacencyOffsets[vertex] + i]] += delta;
+    };
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    // +3 since the cache can temporarily hold the emitted triangle on top of a full cache
+    std::array<uint32_t, SCORING_CACHE_SIZE + 3> cache;
+    std::array<uint32_t, SCORING_CACHE_SIZE + 3> newCache;
+    uint32_t cacheCount = 0;
+
+    uint32_t bestTriangle = (uint32_t)std::distance(
+        triangleScores.begin(),
+        std::max_element(triangleScores.begin(), triangleScores.end()));
+    uint32_t cursor = 0;
+
+    while(output.size() < indices.size())
+    {
+        // Nothing adjacent to the cache left, fall back to the next triangle in the original order
+        if(bestTriangle == INVALID_TRIANGLE)
+        {
+            while(emitted[cursor])
+                ++cursor;
+            bestTriangle = cursor;
+        }
+
+        const uint32_t* triangle = &indices[bestTriangle * 3];
+        emitted[bestTriangle] = true;
+        output.insert(output.end(), triangle, triangle + 3);
+
+        for(uint32_t i = 0; i < 3; ++i)
+        {
+            uint32_t vertex = triangle[i];
+            auto begin = adjacency.begin() + adjacencyOffsets[vertex];
+            auto end = begin + remaining[vertex];
+            std::iter_swap(std::find(begin, end, bestTriangle), end - 1);
+            --remaining[vertex];
+        }
+
+        uint32_t newCacheCount = 0;
+        newCache[newCacheCount++] = triangle[0];
+        newCache[newCacheCount++] = triangle[1];
+        newCache[newCacheCount++] = triangle[2];
+        for(uint32_t i = 0; i < cacheCount; ++i)
+        {
+            uint32_t vertex = cache[i];
+            if(vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                newCache[newCacheCount++] = vertex;
+        }
+
+        for(uint32_t i = SCORING_CACHE_SIZE; i < newCacheCount; ++i)
+            updateVertexScore(newCache[i], -1);
+
+        cacheCount = std::min(newCacheCount, SCORING_CACHE_SIZE);
+        std::copy(newCache.begin(), newCache.begin() + cacheCount, cache.begin());
+
+        for(uint32_t i = 0; i < cacheCount; ++i)
+            updateVertexScore(cache[i], (int32_t)i);
+
+        // Only triangles touching the cache changed score, so that's all that needs to be searched
+        bestTriangle = INVALID_TRIANGLE;
+        float bestScore = -1.0f;
+        for(uint32_t i = 0; i < cacheCount; ++i)
+        {
+            uint32_t vertex = cache[i];
+            for(uint32_t j = 0; j < remaining[vertex]; ++j)
+            {
+                uint32_t candidate = adjacency[adjacencyOffsets[vertex] + j];
+                if(triangleScores[candidate] > bestScore)
+                {
+                    bestScore = triangleScores[candidate];
+                    bestTriangle = candidate;
+                }
+            }
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimizeOverdraw(std::span<uint32_t> indices, std::span<const DirectX::XMFLOAT3> positions, float threshold)
+{
+    const uint32_t triangleCount = (uint32_t)indices.size() / 3;
+    if(triangleCount == 0)
+        return;
+
+    FifoCache cache((uint32_t)positions.size(), SIMULATED_CACHE_SIZE);
+
+    // Hard boundaries are where every vertex of a triangle misses, i.e. the cache is cold regardless of
+    // what came before, so reordering there doesn't cost anything
+    std::vector<uint32_t> hardClusters{0};
+    cache.accessTriangle(&indices[0]);
+    for(uint32_t i = 1; i < triangleCount; ++i)
+    {
+        if(cache.accessTriangle(&indices[i * 3]) == 3)
+            hardClusters.push_back(i);
+    }
+    hardClusters.push_back(triangleCount);
+
+    // Soft boundaries split the hard clusters further as long as the cache efficiency of each part stays
+    // within `threshold` of the whole cluster
+    std::vector<uint32_t> clusters;
+    for(uint32_t cluster = 0; cluster + 1 < hardClusters.size(); ++cluster)
+    {
+        uint32_t start = hardClusters[cluster];
+        uint32_t end = hardClusters[cluster + 1];
+
+        cache.reset();
+        uint32_t clusterMisses = 0;
+        for(uint32_t i = start; i < end; ++i)
+            clusterMisses += cache.accessTriangle(&indices[i * 3]);
+        float clusterThreshold = threshold * clusterMisses / (float)(end - start);
+
+        cache.reset();
+        clusters.push_back(start);
+        uint32_t subStart = start;
+        uint32_t subMisses = 0;
+        for(uint32_t i = start; i < end; ++i)
+        {
+            subMisses += cache.accessTriangle(&indices[i * 3]);
+            if(i + 1 < end && subMisses / (float)(i + 1 - subStart) <= clusterThreshold)
+            {
+                clusters.push_back(i + 1);
+                subStart = i + 1;
+                subMisses = 0;
+                cache.reset();
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    // Area weighted mesh centroid
+    DirectX::XMFLOAT3 meshCentroid{0.0f, 0.0f, 0.0f};
+    float meshArea = 0.0f;
+    for(uint32_t i = 0; i < triangleCount; ++i)
+    {
+        const auto& a = positions[indices[i * 3 + 0]];
+        const auto& b = positions[indices[i * 3 + 1]];
+        const auto& c = positions[indices[i * 3 + 2]];
+
+        DirectX::XMFLOAT3 normal = cross(sub(b, a), sub(c, a));
+        float area = std::sqrt(dot(normal, normal));
+
+        meshCentroid.x += (a.x + b.x + c.x) * area;
+        meshCentroid.y += (a.y + b.y + c.y) * area;
+        meshCentroid.z += (a.z + b.z + c.z) * area;
+        meshArea += area * 3.0f;
+    }
+    if(meshArea > 0.0f)
+    {
+        meshCentroid.x /= meshArea;
+        meshCentroid.y /= meshArea;
+        meshCentroid.z /= meshArea;
+    }
+
+    // Clusters that face away from the center are more likely to occlude the rest, so draw them first
+    const uint32_t clusterCount = (uint32_t)clusters.size() - 1;
+    std::vector<float> sortKeys(clusterCount);
+    for(uint32_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        DirectX::XMFLOAT3 centroid{0.0f, 0.0f, 0.0f};
+        DirectX::XMFLOAT3 clusterNormal{0.0f, 0.0f, 0.0f};
+        float clusterArea = 0.0f;
+
+        for(uint32_t i = clusters[cluster]; i < clusters[cluster + 1]; ++i)
+        {
+            const auto& a = positions[indices[i * 3 + 0]];
+            const auto& b = positions[indices[i * 3 + 1]];
+            const auto& c = positions[indices[i * 3 + 2]];
+
+            // Length is twice the area, which is the weight we want anyway
+            DirectX::XMFLOAT3 normal = cross(sub(b, a), sub(c, a));
+            float area = std::sqrt(dot(normal, normal));
+
+            centroid.x += (a.x + b.x + c.x) * area;
+            centroid.y += (a.y + b.y + c.y) * area;
+            centroid.z += (a.z + b.z + c.z) * area;
+            clusterNormal.x += normal.x;
+            clusterNormal.y += normal.y;
+            clusterNormal.z += normal.z;
+            clusterArea += area * 3.0f;
+        }
+
+        float normalLength = std::sqrt(dot(clusterNormal, clusterNormal));
+        if(clusterArea == 0.0f || normalLength == 0.0f)
+        {
+            sortKeys[cluster] = 0.0f;
+            continue;
+        }
+
+        centroid.x /= clusterArea;
+        centroid.y /= clusterArea;
+        centroid.z /= clusterArea;
+        sortKeys[cluster] = dot(sub(centroid, meshCentroid), clusterNormal) / normalLength;
+    }
+
+    std::vector<uint32_t> clusterOrder(clusterCount);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t lhs, uint32_t rhs) {
+        return sortKeys[lhs] > sortKeys[rhs];
+    });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for(uint32_t cluster : clusterOrder)
+    {
+        output.insert(
+            output.end(),
+            indices.begin() + clusters[cluster] * 3,
+            indices.begin() + clusters[cluster + 1] * 3);
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimizeVertexFetch(Mesh& mesh)
+{
+    std::vector<uint32_t> remap(mesh.vertexCount(), INVALID_VERTEX);
+    uint32_t vertexCount = 0;
+    for(uint32_t& index : mesh.indices)
+    {
+        if(remap[index] == INVALID_VERTEX)
+            remap[index] = vertexCount++;
+        index = remap[index];
+    }
+
+    auto remapStream = [&](auto& stream) {
+        std::remove_reference_t<decltype(stream)> newStream(vertexCount);
+        for(uint32_t i = 0; i < stream.size(); ++i)
+        {
+            if(remap[i] != INVALID_VERTEX)
+                newStream[remap[i]] = stream[i];
+        }
+        stream = std::move(newStream);
+    };
+    remapStream(mesh.positions);
+    remapStream(mesh.uvs);
+    remapStream(mesh.normals);
+    remapStream(mesh.tangents);
+}
+
+Stats optimize(Mesh& mesh)
+{
+    Stats stats;
+    stats.before = analyzeVertexCache(mesh.indices, mesh.vertexCount());
+
+    optimizeVertexCache(mesh.indices, mesh.vertexCount());
+    optimizeOverdraw(mesh.indices, mesh.positions);
+    optimizeVertexFetch(mesh);
+
+    stats.after = analyzeVertexCache(mesh.indices, mesh.vertexCount());
+    return stats;
+}
+}
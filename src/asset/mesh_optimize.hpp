@@ -0,0 +1,56 @@
+#pragma once
+
+#include <asset/mesh.hpp>
+
+#include <cstdint>
+#include <span>
+
+#include <DirectXMath.h>
+
+// Reordering passes that run between import and upload. None of them change
+// what is drawn, only the order of the triangles and vertices
+namespace MeshOptimize
+{
+// Roughly what current hardware has after the input assembler
+constexpr uint32_t SIMULATED_CACHE_SIZE = 16;
+// How much worse the cache efficiency may get in exchange for less overdraw
+constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+struct CacheStats
+{
+    // Average cache miss ratio, vertex shader invocations per triangle. 0.5 is the ideal for big meshes
+    float acmr;
+    // Average transformed vertex ratio, vertex shader invocations per vertex. 1.0 is ideal
+    float atvr;
+};
+
+struct Stats
+{
+    CacheStats before;
+    CacheStats after;
+};
+
+// Simulates a FIFO post-transform cache of `cacheSize` entries
+CacheStats analyzeVertexCache(
+    std::span<const uint32_t> indices,
+    uint32_t vertexCount,
+    uint32_t cacheSize = SIMULATED_CACHE_SIZE);
+
+// Forsyth's "Linear-speed vertex cache optimisation"
+void optimizeVertexCache(std::span<uint32_t> indices, uint32_t vertexCount);
+
+// Splits the triangle list into clusters where the cache is cold anyway (similar to Tipsify) and sorts
+// the clusters so outwards facing ones are drawn first, which helps early-z reject the rest.
+// `indices` should already be optimized for the vertex cache
+void optimizeOverdraw(
+    std::span<uint32_t> indices,
+    std::span<const DirectX::XMFLOAT3> positions,
+    float threshold = OVERDRAW_THRESHOLD);
+
+// Renumbers the vertices in the order they're first referenced and drops unreferenced ones. This makes
+// vertex fetches more linear and keeps the vertex range of any run of triangles small
+void optimizeVertexFetch(Mesh& mesh);
+
+// Runs all passes in order
+Stats optimize(Mesh& mesh);
+}
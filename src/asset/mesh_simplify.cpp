@@ -0,0 +1,391 @@
+#include "mesh_simplify.hpp"
+
+#include <asset/vector_math.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+
+namespace MeshSimplify
+{
+using namespace VectorMath;
+
+namespace
+{
+    // Cosine of the largest rotation a triangle may go through in one collapse. Allowing anything up to
+    // 90 degrees lets slivers flip over in a few small steps
+    constexpr double MAX_NORMAL_CHANGE = 0.5;
+    // A triangle that shrinks below this share of its area is as good as collinear
+    constexpr double MIN_AREA_CHANGE = 1e-6;
+
+    struct DoubleNormal
+    {
+        double x, y, z;
+    };
+
+    // In double, so a collinear triangle comes out with no area whether or not the float math is fused
+    DoubleNormal getDoubleNormal(const std::array<DirectX::XMFLOAT3, 3>& corners)
+    {
+        auto edge = [&](uint32_t corner)
+        {
+            return DoubleNormal{
+                (double)corners[corner].x - corners[0].x,
+                (double)corners[corner].y - corners[0].y,
+                (double)corners[corner].z - corners[0].z,
+            };
+        };
+        DoubleNormal a = edge(1);
+        DoubleNormal b = edge(2);
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    struct Quadric
+    {
+        // Upper triangle of the symmetric 4x4 matrix
+        double xx = 0.0, xy = 0.0, xz = 0.0, xw = 0.0;
+        double yy = 0.0, yz = 0.0, yw = 0.0;
+        double zz = 0.0, zw = 0.0;
+        double ww = 0.0;
+        // Total area of the planes, so errors don't depend on how finely the surface is tessellated
+        double weight = 0.0;
+
+        static Quadric fromPlane(const DirectX::XMFLOAT3& normal, double distance, double weight)
+        {
+            double a = normal.x;
+            double b = normal.y;
+            double c = normal.z;
+            double d = distance;
+            // clang-format off
+            return {
+                a * a * weight, a * b * weight, a * c * weight, a * d * weight,
+                b * b * weight, b * c * weight, b * d * weight,
+                c * c * weight, c * d * weight,
+                d * d * weight,
+                weight,
+            };
+            // clang-format on
+        }
+
+        Quadric operator+(const Quadric& other) const
+        {
+            // clang-format off
+            return {
+                xx + other.xx, xy + other.xy, xz + other.xz, xw + other.xw,
+                yy + other.yy, yz + other.yz, yw + other.yw,
+                zz + other.zz, zw + other.zw,
+                ww + other.ww,
+                weight + other.weight,
+            };
+            // clang-format on
+        }
+
+        // Weighted mean of the squared distances from `point` to the planes
+        double evaluate(const DirectX::XMFLOAT3& point) const
+        {
+            if(weight == 0.0)
+                return 0.0;
+
+            double x = point.x;
+            double y = point.y;
+            double z = point.z;
+            double error = xx * x * x + 2.0 * xy * x * y + 2.0 * xz * x * z + 2.0 * xw * x
+                           + yy * y * y + 2.0 * yz * y * z + 2.0 * yw * y
+                           + zz * z * z + 2.0 * zw * z
+                           + ww;
+            return std::abs(error) / weight;
+        }
+    };
+
+    struct Collapse
+    {
+        double error;
+        // Vertex indices, not canonical ones. `to` is the exact vertex that replaces `from`
+        uint32_t from;
+        uint32_t to;
+
+        bool operator<(const Collapse& other) const
+        {
+            return std::tie(error, from, to) < std::tie(other.error, other.from, other.to);
+        }
+    };
+
+    std::array<uint32_t, 3> positionBits(const DirectX::XMFLOAT3& position)
+    {
+        auto bits = [](float value) { return value == 0.0f ? 0u : std::bit_cast<uint32_t>(value); };
+        return {bits(position.x), bits(position.y), bits(position.z)};
+    }
+
+    // Vertices that share a position are treated as one while simplifying. Each one maps to the lowest
+    // index with the same position
+    std::vector<uint32_t> findCanonicalVertices(const Mesh& mesh)
+    {
+        std::vector<uint32_t> order(mesh.vertexCount());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(
+            order.begin(),
+            order.end(),
+            [&](uint32_t a, uint32_t b)
+            {
+                return std::pair(positionBits(mesh.positions[a]), a) < std::pair(positionBits(mesh.positions[b]), b);
+            });
+
+        std::vector<uint32_t> canonical(mesh.vertexCount());
+        for(uint32_t i = 0; i < order.size(); ++i)
+        {
+            bool samePosition =
+                i > 0 && positionBits(mesh.positions[order[i]]) == positionBits(mesh.positions[order[i - 1]]);
+            canonical[order[i]] = samePosition ? canonical[order[i - 1]] : order[i];
+        }
+        return canonical;
+    }
+
+    // Seams are vertices sharing a position with another, borders are on an edge with only one
+    // triangle. Edges with more than two triangles are locked as well, there's no sane way to move them
+    std::vector<bool> findLockedVertices(const std::vector<uint32_t>& canonical, std::span<const uint32_t> indices)
+    {
+        std::vector<bool> locked(canonical.size(), false);
+        for(uint32_t vertex = 0; vertex < canonical.size(); ++vertex)
+        {
+            if(canonical[vertex] != vertex)
+            {
+                locked[vertex] = true;
+                locked[canonical[vertex]] = true;
+            }
+        }
+
+        std::vector<uint64_t> edges;
+        edges.reserve(indices.size());
+        for(uint32_t i = 0; i < indices.size(); i += 3)
+        {
+            for(uint32_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t a = canonical[indices[i + corner]];
+                uint32_t b = canonical[indices[i + (corner + 1) % 3]];
+                edges.push_back((uint64_t)std::min(a, b) << 32 | std::max(a, b));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        for(size_t begin = 0, end = 0; begin < edges.size(); begin = end)
+        {
+            while(end < edges.size() && edges[end] == edges[begin])
+                ++end;
+            if(end - begin != 2)
+            {
+                locked[edges[begin] >> 32] = true;
+                locked[edges[begin] & 0xFFFFFFFF] = true;
+            }
+        }
+
+        return locked;
+    }
+}
+
+Result simplify(const Mesh& mesh, std::span<const uint32_t> indices, uint32_t targetIndexCount, float maxError)
+{
+    std::vector<uint32_t> canonical = findCanonicalVertices(mesh);
+    auto position = [&](uint32_t vertex) -> const DirectX::XMFLOAT3& { return mesh.positions[vertex]; };
+
+    // Triangles with two corners in the same place have no area and would only get in the way
+    Result result{};
+    result.indices.reserve(indices.size());
+    for(uint32_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        uint32_t a = canonical[indices[i]];
+        uint32_t b = canonical[indices[i + 1]];
+        uint32_t c = canonical[indices[i + 2]];
+        if(a != b && b != c && c != a)
+            result.indices.insert(result.indices.end(), &indices[i], &indices[i + 3]);
+    }
+
+    std::vector<bool> locked = findLockedVertices(canonical, result.indices);
+
+    std::vector<Quadric> quadrics(mesh.vertexCount());
+    for(uint32_t i = 0; i < result.indices.size(); i += 3)
+    {
+        const DirectX::XMFLOAT3& a = position(result.indices[i]);
+        const DirectX::XMFLOAT3& b = position(result.indices[i + 1]);
+        const DirectX::XMFLOAT3& c = position(result.indices[i + 2]);
+        DirectX::XMFLOAT3 normal = cross(sub(b, a), sub(c, a));
+        float doubleArea = length(normal);
+        if(doubleArea == 0.0f)
+            continue;
+
+        normal = scale(normal, 1.0f / doubleArea);
+        Quadric quadric = Quadric::fromPlane(normal, -dot(normal, a), doubleArea * 0.5);
+        for(uint32_t corner = 0; corner < 3; ++corner)
+        {
+            Quadric& vertexQuadric = quadrics[canonical[result.indices[i + corner]]];
+            vertexQuadric = vertexQuadric + quadric;
+        }
+    }
+
+    double maxSquaredError = (double)maxError * maxError;
+    double maxCollapseError = 0.0;
+
+    std::vector<uint32_t> triangleOffsets;
+    std::vector<uint32_t> vertexTriangles;
+    std::vector<Collapse> collapses;
+    std::vector<bool> touched;
+    std::vector<uint32_t> remap(mesh.vertexCount());
+    std::vector<uint32_t> fromNeighbours;
+    std::vector<uint32_t> toNeighbours;
+
+    // Every pass collapses an independent set of edges, cheapest first, then rebuilds the adjacency
+    while(result.indices.size() > targetIndexCount)
+    {
+        uint32_t triangleCount = (uint32_t)result.indices.size() / 3;
+
+        triangleOffsets.assign(mesh.vertexCount() + 1, 0);
+        for(uint32_t index : result.indices)
+            ++triangleOffsets[canonical[index] + 1];
+        std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+        vertexTriangles.resize(result.indices.size());
+        {
+            std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for(uint32_t i = 0; i < result.indices.size(); ++i)
+                vertexTriangles[fill[canonical[result.indices[i]]]++] = i / 3;
+        }
+        auto trianglesAround = [&](uint32_t vertex)
+        {
+            return std::span(vertexTriangles).subspan(
+                triangleOffsets[vertex],
+                triangleOffsets[vertex + 1] - triangleOffsets[vertex]);
+        };
+        auto hasCorner = [&](uint32_t triangle, uint32_t vertex)
+        {
+            return canonical[result.indices[triangle * 3]] == vertex
+                   || canonical[result.indices[triangle * 3 + 1]] == vertex
+                   || canonical[result.indices[triangle * 3 + 2]] == vertex;
+        };
+        auto gatherNeighbours = [&](uint32_t vertex, std::vector<uint32_t>& neighbours)
+        {
+            neighbours.clear();
+            for(uint32_t triangle : trianglesAround(vertex))
+                for(uint32_t corner = 0; corner < 3; ++corner)
+                    if(uint32_t other = canonical[result.indices[triangle * 3 + corner]]; other != vertex)
+                        neighbours.push_back(other);
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        };
+
+        collapses.clear();
+        for(uint32_t i = 0; i < result.indices.size(); i += 3)
+        {
+            for(uint32_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t a = result.indices[i + corner];
+                uint32_t b = result.indices[i + (corner + 1) % 3];
+                for(auto [from, to] : {std::pair{a, b}, std::pair{b, a}})
+                {
+                    if(locked[canonical[from]])
+                        continue;
+                    Quadric combined = quadrics[canonical[from]] + quadrics[canonical[to]];
+                    collapses.push_back({combined.evaluate(position(to)), from, to});
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end());
+
+        touched.assign(mesh.vertexCount(), false);
+        std::iota(remap.begin(), remap.end(), 0);
+        uint32_t removableTriangles = triangleCount - targetIndexCount / 3;
+        uint32_t removedTriangles = 0;
+        uint32_t appliedCollapses = 0;
+        for(const Collapse& collapse : collapses)
+        {
+            if(removedTriangles >= removableTriangles || collapse.error > maxSquaredError)
+                break;
+
+            uint32_t from = canonical[collapse.from];
+            uint32_t to = canonical[collapse.to];
+            if(touched[from] || touched[to])
+                continue;
+
+            // The triangles on the collapsed edge disappear, the others must not flip over
+            uint32_t edgeTriangles = 0;
+            bool flips = false;
+            for(uint32_t triangle : trianglesAround(from))
+            {
+                if(hasCorner(triangle, to))
+                {
+                    ++edgeTriangles;
+                    continue;
+                }
+
+                std::array<DirectX::XMFLOAT3, 3> before;
+                std::array<DirectX::XMFLOAT3, 3> after;
+                for(uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    uint32_t vertex = result.indices[triangle * 3 + corner];
+                    before[corner] = position(vertex);
+                    after[corner] = canonical[vertex] == from ? position(collapse.to) : before[corner];
+                }
+                DoubleNormal normalBefore = getDoubleNormal(before);
+                DoubleNormal normalAfter = getDoubleNormal(after);
+                double lengthBefore = std::hypot(normalBefore.x, normalBefore.y, normalBefore.z);
+                double lengthAfter = std::hypot(normalAfter.x, normalAfter.y, normalAfter.z);
+                double dotBeforeAfter =
+                    normalBefore.x * normalAfter.x + normalBefore.y * normalAfter.y + normalBefore.z * normalAfter.z;
+                // Collapsing into a triangle with no area would leave a crack the flip test can't see, its
+                // normal is just rounding noise
+                if(lengthAfter <= MIN_AREA_CHANGE * lengthBefore
+                   || dotBeforeAfter <= MAX_NORMAL_CHANGE * lengthBefore * lengthAfter)
+                {
+                    flips = true;
+                    break;
+                }
+            }
+            if(flips || edgeTriangles == 0)
+                continue;
+
+            // Link condition: the only vertices both ends share are the tips of the edge's triangles.
+            // Anything else would pinch the surface into a non-manifold edge
+            gatherNeighbours(from, fromNeighbours);
+            gatherNeighbours(to, toNeighbours);
+            uint32_t sharedNeighbours = 0;
+            for(uint32_t neighbour : fromNeighbours)
+                sharedNeighbours += std::binary_search(toNeighbours.begin(), toNeighbours.end(), neighbour);
+            if(sharedNeighbours != edgeTriangles)
+                continue;
+
+            // `from` isn't on a seam, so it's the only vertex at its position and every triangle around
+            // it should pick up the same attributes for `to` as the collapsed edge has
+            remap[collapse.from] = collapse.to;
+            quadrics[to] = quadrics[to] + quadrics[from];
+            maxCollapseError = std::max(maxCollapseError, collapse.error);
+            removedTriangles += edgeTriangles;
+            ++appliedCollapses;
+
+            touched[from] = true;
+            touched[to] = true;
+            for(uint32_t neighbour : fromNeighbours)
+                touched[neighbour] = true;
+        }
+
+        if(appliedCollapses == 0)
+            break;
+
+        uint32_t keptCount = 0;
+        for(uint32_t i = 0; i < result.indices.size(); i += 3)
+        {
+            uint32_t a = remap[result.indices[i]];
+            uint32_t b = remap[result.indices[i + 1]];
+            uint32_t c = remap[result.indices[i + 2]];
+            if(canonical[a] == canonical[b] || canonical[b] == canonical[c] || canonical[c] == canonical[a])
+                continue;
+
+            result.indices[keptCount++] = a;
+            result.indices[keptCount++] = b;
+            result.indices[keptCount++] = c;
+        }
+        result.indices.resize(keptCount);
+    }
+
+    result.error = (float)std::sqrt(maxCollapseError);
+    return result;
+}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <asset/mesh.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+// Edge collapse simplification driven by quadric error metrics (Garland & Heckbert). Vertices only
+// ever collapse onto one of their neighbours, so the result indexes the same vertex streams as the
+// input and every level of detail can share one vertex buffer
+namespace MeshSimplify
+{
+struct Result
+{
+    std::vector<uint32_t> indices;
+    // Square root of the largest quadric error of any collapse, roughly how far the surface moved
+    // in mesh units
+    float error;
+};
+
+// Vertices on a UV/normal seam (same position, different attributes) or an open border are never
+// moved, which keeps seams intact at the cost of stopping short of the target on meshes that are
+// mostly seams. Collapses that would flip a triangle or make the mesh non-manifold are skipped
+Result simplify(
+    const Mesh& mesh,
+    std::span<const uint32_t> indices,
+    uint32_t targetIndexCount,
+    float maxError = std::numeric_limits<float>::max());
+}
@@ -0,0 +1,234 @@
+#include "meshlet_build.hpp"
+
+#include <asset/vector_math.hpp>
+#include <util/thread_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace MeshletBuild
+{
+using namespace VectorMath;
+
+namespace
+{
+    constexpr uint32_t NOT_IN_MESHLET = MAX_VERTICES;
+    constexpr uint32_t BOUNDS_GRAIN = 256;
+
+    void buildRange(const Mesh& mesh, uint32_t firstTriangle, uint32_t endTriangle, MeshletData& data)
+    {
+        Meshlet meshlet{0, 0, 0, 0};
+
+        // A linear search over at most 64 entries is cheaper than clearing a map for every meshlet
+        auto findLocal = [&](uint32_t vertex)
+        {
+            for(uint32_t i = 0; i < meshlet.vertexCount; ++i)
+                if(data.vertices[meshlet.vertexOffset + i] == vertex)
+                    return i;
+            return NOT_IN_MESHLET;
+        };
+
+        auto flush = [&]()
+        {
+            data.meshlets.push_back(meshlet);
+            meshlet = {(uint32_t)data.vertices.size(), (uint32_t)data.triangles.size(), 0, 0};
+        };
+
+        for(uint32_t triangle = firstTriangle; triangle < endTriangle; ++triangle)
+        {
+            const uint32_t* indices = &mesh.indices[triangle * 3];
+
+            std::array<uint32_t, 3> local;
+            uint32_t newVertexCount = 0;
+            for(uint32_t i = 0; i < 3; ++i)
+            {
+                local[i] = findLocal(indices[i]);
+                newVertexCount += local[i] == NOT_IN_MESHLET;
+            }
+
+            if(meshlet.vertexCount + newVertexCount > MAX_VERTICES || meshlet.triangleCount == MAX_TRIANGLES)
+            {
+                flush();
+                local = {NOT_IN_MESHLET, NOT_IN_MESHLET, NOT_IN_MESHLET};
+            }
+
+            for(uint32_t i = 0; i < 3; ++i)
+            {
+                // Searching again catches degenerate triangles which use the same new vertex twice
+                if(local[i] == NOT_IN_MESHLET)
+                    local[i] = findLocal(indices[i]);
+                if(local[i] == NOT_IN_MESHLET)
+                {
+                    data.vertices.push_back(indices[i]);
+                    local[i] = meshlet.vertexCount++;
+                }
+            }
+
+            data.triangles.push_back(local[0] | local[1] << 8 | local[2] << 16);
+            ++meshlet.triangleCount;
+        }
+
+        if(meshlet.triangleCount > 0)
+            flush();
+    }
+
+    Bounds computeBounds(const Mesh& mesh, const MeshletData& data, const Meshlet& meshlet)
+    {
+        auto position = [&](uint32_t local) -> const DirectX::XMFLOAT3&
+        { return mesh.positions[data.vertices[meshlet.vertexOffset + local]]; };
+
+        // Ritter's sphere: start from the widest pair of axis extremes and grow to cover the rest.
+        // Usually within a few percent of the optimal sphere
+        std::array<uint32_t, 3> minima{0, 0, 0};
+        std::array<uint32_t, 3> maxima{0, 0, 0};
+        for(uint32_t i = 1; i < meshlet.vertexCount; ++i)
+        {
+            for(uint32_t axis = 0; axis < 3; ++axis)
+            {
+                float value = (&position(i).x)[axis];
+                if(value < (&position(minima[axis]).x)[axis])
+                    minima[axis] = i;
+                if(value > (&position(maxima[axis]).x)[axis])
+                    maxima[axis] = i;
+            }
+        }
+
+        uint32_t widestAxis = 0;
+        float widestDistance = -1.0f;
+        for(uint32_t axis = 0; axis < 3; ++axis)
+        {
+            float distance = length(sub(position(maxima[axis]), position(minima[axis])));
+            if(distance > widestDistance)
+            {
+                widestAxis = axis;
+                widestDistance = distance;
+            }
+        }
+
+        Bounds bounds;
+        bounds.center = scale(add(position(minima[widestAxis]), position(maxima[widestAxis])), 0.5f);
+        bounds.radius = widestDistance * 0.5f;
+        for(uint32_t i = 0; i < meshlet.vertexCount; ++i)
+        {
+            DirectX::XMFLOAT3 offset = sub(position(i), bounds.center);
+            float distance = length(offset);
+            if(distance > bounds.radius)
+            {
+                float radius = (bounds.radius + distance) * 0.5f;
+                bounds.center = add(bounds.center, scale(offset, (radius - bounds.radius) / distance));
+                bounds.radius = radius;
+            }
+        }
+
+        std::array<DirectX::XMFLOAT3, MAX_TRIANGLES> normals;
+        uint32_t normalCount = 0;
+        DirectX::XMFLOAT3 axis{0.0f, 0.0f, 0.0f};
+        for(uint32_t triangle = 0; triangle < meshlet.triangleCount; ++triangle)
+        {
+            uint32_t packed = data.triangles[meshlet.triangleOffset + triangle];
+            const DirectX::XMFLOAT3& a = position(packed & 0xFF);
+            const DirectX::XMFLOAT3& b = position((packed >> 8) & 0xFF);
+            const DirectX::XMFLOAT3& c = position((packed >> 16) & 0xFF);
+
+            DirectX::XMFLOAT3 normal = cross(sub(b, a), sub(c, a));
+            float area = length(normal);
+            // Degenerate triangles are never visible, so they don't constrain the cone
+            if(area == 0.0f)
+                continue;
+
+            normals[normalCount] = scale(normal, 1.0f / area);
+            axis = add(axis, normals[normalCount]);
+            ++normalCount;
+        }
+
+        float axisLength = length(axis);
+        bounds.coneAxis = axisLength > 0.0f ? scale(axis, 1.0f / axisLength) : axis;
+        bounds.coneCutoff = 1.0f;
+        if(axisLength > 0.0f)
+        {
+            float minDot = 1.0f;
+            for(uint32_t i = 0; i < normalCount; ++i)
+                minDot = std::min(minDot, dot(normals[i], bounds.coneAxis));
+
+            // A cone wider than a hemisphere can't be rejected from anywhere
+            if(minDot > 0.0f)
+                bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+
+        return bounds;
+    }
+}
+
+MeshletData build(const Mesh& mesh, ThreadPool& pool)
+{
+    uint32_t triangleCount = mesh.indexCount() / 3;
+    uint32_t taskCount = (triangleCount + TRIANGLES_PER_TASK - 1) / TRIANGLES_PER_TASK;
+
+    std::vector<MeshletData> taskData(taskCount);
+    pool.parallelFor(
+        triangleCount,
+        TRIANGLES_PER_TASK,
+        [&](uint32_t begin, uint32_t end) { buildRange(mesh, begin, end, taskData[begin / TRIANGLES_PER_TASK]); });
+
+    MeshletData data;
+    size_t meshletCount = 0;
+    size_t vertexCount = 0;
+    for(const MeshletData& task : taskData)
+    {
+        meshletCount += task.meshlets.size();
+        vertexCount += task.vertices.size();
+    }
+    data.meshlets.reserve(meshletCount);
+    data.vertices.reserve(vertexCount);
+    data.triangles.reserve(triangleCount);
+
+    // Stitching the runs together in order is what makes the result independent of scheduling
+    for(const MeshletData& task : taskData)
+    {
+        uint32_t vertexBase = (uint32_t)data.vertices.size();
+        uint32_t triangleBase = (uint32_t)data.triangles.size();
+        for(Meshlet meshlet : task.meshlets)
+        {
+            meshlet.vertexOffset += vertexBase;
+            meshlet.triangleOffset += triangleBase;
+            data.meshlets.push_back(meshlet);
+        }
+        data.vertices.insert(data.vertices.end(), task.vertices.begin(), task.vertices.end());
+        data.triangles.insert(data.triangles.end(), task.triangles.begin(), task.triangles.end());
+    }
+
+    data.bounds.resize(data.meshlets.size());
+    pool.parallelFor(
+        (uint32_t)data.meshlets.size(),
+        BOUNDS_GRAIN,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t i = begin; i < end; ++i)
+                data.bounds[i] = computeBounds(mesh, data, data.meshlets[i]);
+        });
+
+    return data;
+}
+
+Stats analyze(const MeshletData& data)
+{
+    if(data.meshlets.empty())
+        return {0, 0.0f, 0.0f};
+
+    uint64_t vertexCount = 0;
+    uint64_t triangleCount = 0;
+    for(const Meshlet& meshlet : data.meshlets)
+    {
+        vertexCount += meshlet.vertexCount;
+        triangleCount += meshlet.triangleCount;
+    }
+
+    uint32_t meshletCount = (uint32_t)data.meshlets.size();
+    return {
+        meshletCount,
+        vertexCount / (float)(meshletCount * MAX_VERTICES),
+        triangleCount / (float)(meshletCount * MAX_TRIANGLES),
+    };
+}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <asset/mesh.hpp>
+#include <util/thread_pool.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <DirectXMath.h>
+
+// Splits a mesh into small clusters with culling data, laid out so every array can be uploaded as is
+// and read as a StructuredBuffer by a mesh or compute shader
+namespace MeshletBuild
+{
+// The limits recommended for mesh shaders on most current hardware
+constexpr uint32_t MAX_VERTICES = 64;
+constexpr uint32_t MAX_TRIANGLES = 124;
+// Triangles are split into independent runs of this many before building. Fixed so the output doesn't
+// depend on the number of threads, large so the partial meshlet at the end of every run doesn't matter
+constexpr uint32_t TRIANGLES_PER_TASK = 1 << 12;
+
+struct Meshlet
+{
+    // Into MeshletData::vertices
+    uint32_t vertexOffset;
+    // Into MeshletData::triangles
+    uint32_t triangleOffset;
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+};
+static_assert(sizeof(Meshlet) == 16);
+
+struct Bounds
+{
+    // Bounding sphere
+    DirectX::XMFLOAT3 center;
+    float radius;
+    // Normal cone. The whole meshlet faces away from the camera if
+    // dot(center - cameraPosition, coneAxis) >= coneCutoff * length(center - cameraPosition) + radius.
+    // Meshlets whose normals are spread too far have a cutoff of 1 and are never rejected
+    DirectX::XMFLOAT3 coneAxis;
+    float coneCutoff;
+};
+static_assert(sizeof(Bounds) == 32);
+
+struct MeshletData
+{
+    std::vector<Meshlet> meshlets;
+    // One per meshlet
+    std::vector<Bounds> bounds;
+    // Indices into the mesh's vertex streams
+    std::vector<uint32_t> vertices;
+    // One per triangle, three 8-bit meshlet local vertex indices packed as a | b << 8 | c << 16
+    std::vector<uint32_t> triangles;
+};
+
+struct Stats
+{
+    uint32_t meshletCount;
+    // Average share of MAX_VERTICES and MAX_TRIANGLES that is actually used
+    float vertexFill;
+    float triangleFill;
+};
+
+// Greedily fills meshlets in index order, so the indices should already be optimized for the vertex
+// cache. Multithreaded, but the result is the same for any number of threads
+MeshletData build(const Mesh& mesh, ThreadPool& pool = ThreadPool::shared());
+
+Stats analyze(const MeshletData& data);
+}
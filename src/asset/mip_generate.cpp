@@ -0,0 +1,363 @@
+#include "mip_generate.hpp"
+
+#include <util/align.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace MipGenerate
+{
+namespace
+{
+    // In texels of the level being written, the window covers twice that
+    constexpr float KAISER_RADIUS = 2.0f;
+    constexpr float KAISER_ALPHA = 4.0f;
+    // Fine enough that the darkest sRGB steps, where the curve is steepest, still land on the right code
+    constexpr uint32_t SRGB_ENCODE_TABLE_SIZE = 16384;
+
+    enum class Encoding
+    {
+        SRGB,
+        UNORM,
+        // [0, 255] to [-1, 1]
+        SNORM,
+    };
+
+    struct Tables
+    {
+        std::array<float, 256> srgbDecode;
+        std::array<float, 256> unormDecode;
+        std::array<float, 256> snormDecode;
+        std::array<uint8_t, SRGB_ENCODE_TABLE_SIZE> srgbEncode;
+    };
+
+    const Tables& getTables()
+    {
+        static const Tables tables = []()
+        {
+            Tables tables;
+            for(uint32_t i = 0; i < 256; ++i)
+            {
+                float value = i / 255.0f;
+                tables.srgbDecode[i] =
+                    value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+                tables.unormDecode[i] = value;
+                tables.snormDecode[i] = value * 2.0f - 1.0f;
+            }
+            for(uint32_t i = 0; i < SRGB_ENCODE_TABLE_SIZE; ++i)
+            {
+                float value = i / float(SRGB_ENCODE_TABLE_SIZE - 1);
+                float encoded =
+                    value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+                tables.srgbEncode[i] = (uint8_t)(encoded * 255.0f + 0.5f);
+            }
+            return tables;
+        }();
+        return tables;
+    }
+
+    Encoding getEncoding(Content content, uint32_t channel)
+    {
+        if(channel >= 3 || content == Content::LINEAR)
+            return Encoding::UNORM;
+
+        return content == Content::COLOR ? Encoding::SRGB : Encoding::SNORM;
+    }
+
+    // Source texels and weights for every texel of the level being written, along one axis. Every texel
+    // gets the same number of taps so the loops over them don't branch, the spare ones have zero weight
+    struct Taps
+    {
+        uint32_t count;
+        std::vector<uint32_t> indices;
+        std::vector<float> weights;
+    };
+
+    float besselI0(float x)
+    {
+        // Power series, converges quickly for the small arguments a Kaiser window needs
+        float sum = 1.0f;
+        float term = 1.0f;
+        for(uint32_t k = 1; k < 16; ++k)
+        {
+            term *= (x * 0.5f / k) * (x * 0.5f / k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    float kaiser(float x)
+    {
+        if(std::abs(x) >= KAISER_RADIUS)
+            return 0.0f;
+
+        float sinc = x == 0.0f ? 1.0f : std::sin(std::numbers::pi_v<float> * x) / (std::numbers::pi_v<float> * x);
+        float window = x / KAISER_RADIUS;
+        return sinc * besselI0(KAISER_ALPHA * std::sqrt(1.0f - window * window)) / besselI0(KAISER_ALPHA);
+    }
+
+    Taps getTaps(uint32_t sourceSize, uint32_t size, Filter filter)
+    {
+        // Texel i covers [i, i + 1), in source texels
+        const float scale = sourceSize / float(size);
+        const float radius = filter == Filter::BOX ? scale * 0.5f : KAISER_RADIUS * scale;
+
+        struct Tap
+        {
+            int32_t index;
+            float weight;
+        };
+        std::vector<std::vector<Tap>> texels(size);
+        uint32_t count = 0;
+        for(uint32_t x = 0; x < size; ++x)
+        {
+            float center = (x + 0.5f) * scale;
+            int32_t first = (int32_t)std::floor(center - radius);
+            int32_t last = (int32_t)std::ceil(center + radius);
+            float sum = 0.0f;
+            for(int32_t i = first; i < last; ++i)
+            {
+                float weight = filter == Filter::BOX
+                                   ? std::min(i + 1.0f, center + radius) - std::max(float(i), center - radius)
+                                   : kaiser((i + 0.5f - center) / scale);
+                if(std::abs(weight) < 1e-6f)
+                    continue;
+
+                // Clamp to edge, mirrored taps would pull in texels from the opposite side of the seam
+                texels[x].push_back({std::clamp(i, 0, (int32_t)sourceSize - 1), weight});
+                sum += weight;
+            }
+            for(Tap& tap : texels[x])
+                tap.weight /= sum;
+
+            count = std::max(count, (uint32_t)texels[x].size());
+        }
+
+        Taps taps = {.count = count, .indices = std::vector<uint32_t>(size * count), .weights = {}};
+        taps.weights.resize(size * count, 0.0f);
+        for(uint32_t x = 0; x < size; ++x)
+        {
+            for(uint32_t t = 0; t < count; ++t)
+            {
+                const Tap& tap = t < texels[x].size() ? texels[x][t] : Tap{texels[x].back().index, 0.0f};
+                taps.indices[x * count + t] = tap.index;
+                taps.weights[x * count + t] = tap.weight;
+            }
+        }
+        return taps;
+    }
+
+    uint8_t encode(float value, Encoding encoding, const Tables& tables)
+    {
+        if(encoding == Encoding::SNORM)
+            value = value * 0.5f + 0.5f;
+        value = std::clamp(value, 0.0f, 1.0f);
+
+        if(encoding == Encoding::SRGB)
+            return tables.srgbEncode[(uint32_t)(value * (SRGB_ENCODE_TABLE_SIZE - 1) + 0.5f)];
+
+        return (uint8_t)(value * 255.0f + 0.5f);
+    }
+
+    // Horizontal pass over one vertically filtered row, `row` is the source width and `output` the
+    // destination width
+    void filterRow(const float* row, const Taps& taps, uint32_t width, uint32_t channels, float* output)
+    {
+#if defined(__SSE2__) || defined(_M_X64)
+        // A texel fits a register, so each tap is one multiply add regardless of the filter
+        if(channels == 4)
+        {
+            for(uint32_t x = 0; x < width; ++x)
+            {
+                __m128 sum = _mm_setzero_ps();
+                for(uint32_t t = 0; t < taps.count; ++t)
+                {
+                    __m128 texel = _mm_loadu_ps(row + taps.indices[x * taps.count + t] * 4);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(texel, _mm_set1_ps(taps.weights[x * taps.count + t])));
+                }
+                _mm_storeu_ps(output + x * 4, sum);
+            }
+            return;
+        }
+#endif
+        for(uint32_t x = 0; x < width; ++x)
+        {
+            for(uint32_t c = 0; c < channels; ++c)
+            {
+                float sum = 0.0f;
+                for(uint32_t t = 0; t < taps.count; ++t)
+                    sum += row[taps.indices[x * taps.count + t] * channels + c] * taps.weights[x * taps.count + t];
+                output[x * channels + c] = sum;
+            }
+        }
+    }
+}
+
+uint32_t getLevelCount(uint32_t width, uint32_t height)
+{
+    return (uint32_t)std::bit_width(std::max(width, height));
+}
+
+Layout getLayout(uint32_t width, uint32_t height, uint32_t channels, uint32_t levelCount)
+{
+    assert(channels >= 1 && channels <= 4);
+    if(levelCount == 0)
+        levelCount = getLevelCount(width, height);
+
+    Layout layout = {.channels = channels, .levels = {}, .size = 0};
+    layout.levels.reserve(levelCount);
+    for(uint32_t level = 0; level < levelCount; ++level)
+    {
+        Level& current = layout.levels.emplace_back();
+        current.width = std::max(width >> level, 1u);
+        current.height = std::max(height >> level, 1u);
+        current.offset = AlignTo(layout.size, PLACEMENT_ALIGNMENT);
+        current.rowPitch = AlignTo(current.width * channels, ROW_PITCH_ALIGNMENT);
+        // The last row doesn't need its padding
+        layout.size = current.offset + current.rowPitch * (current.height - 1) + current.width * channels;
+    }
+    return layout;
+}
+
+void generate(
+    const uint8_t* source,
+    const Layout& layout,
+    Content content,
+    Filter filter,
+    char* destination,
+    ThreadPool& pool)
+{
+    const Tables& tables = getTables();
+    const uint32_t channels = layout.channels;
+
+    std::array<Encoding, 4> encodings;
+    std::array<const float*, 4> decodeTables;
+    for(uint32_t c = 0; c < 4; ++c)
+    {
+        encodings[c] = getEncoding(content, c);
+        decodeTables[c] = encodings[c] == Encoding::SRGB    ? tables.srgbDecode.data()
+                          : encodings[c] == Encoding::SNORM ? tables.snormDecode.data()
+                                                            : tables.unormDecode.data();
+    }
+
+    const Level& first = layout.levels[0];
+    pool.parallelFor(
+        first.height,
+        ROWS_PER_TASK,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t y = begin; y < end; ++y)
+            {
+                std::memcpy(
+                    destination + first.offset + y * first.rowPitch,
+                    source + y * first.width * channels,
+                    first.width * channels);
+            }
+        });
+
+    // Linear values of the level above, the first level is decoded on the fly instead
+    std::vector<float> previous;
+    std::vector<float> current;
+    for(uint32_t level = 1; level < layout.levels.size(); ++level)
+    {
+        const Level& above = layout.levels[level - 1];
+        const Level& target = layout.levels[level];
+        const Taps horizontal = getTaps(above.width, target.width, filter);
+        const Taps vertical = getTaps(above.height, target.height, filter);
+        const uint32_t sourceRowSize = above.width * channels;
+
+        current.resize(target.width * target.height * channels);
+        pool.parallelFor(
+            target.height,
+            ROWS_PER_TASK,
+            [&](uint32_t begin, uint32_t end)
+            {
+                // The first level is stored as 8 bit, decode the rows this chunk reads once up front instead
+                // of once per tap. Neighbouring chunks share a few of them with wider filters
+                uint32_t firstSourceY = 0;
+                std::vector<float> decoded;
+                const float* above = previous.data();
+                if(level == 1)
+                {
+                    firstSourceY = vertical.indices[begin * vertical.count];
+                    uint32_t lastSourceY = firstSourceY;
+                    for(uint32_t i = begin * vertical.count; i < end * vertical.count; ++i)
+                    {
+                        firstSourceY = std::min(firstSourceY, vertical.indices[i]);
+                        lastSourceY = std::max(lastSourceY, vertical.indices[i]);
+                    }
+
+                    decoded.resize((lastSourceY - firstSourceY + 1) * sourceRowSize);
+                    const uint8_t* input = source + firstSourceY * sourceRowSize;
+                    for(uint32_t i = 0; i < decoded.size(); i += channels)
+                    {
+                        for(uint32_t c = 0; c < channels; ++c)
+                            decoded[i + c] = decodeTables[c][input[i + c]];
+                    }
+                    above = decoded.data();
+                }
+
+                std::vector<float> row(sourceRowSize);
+                for(uint32_t y = begin; y < end; ++y)
+                {
+                    // Vertical pass first, it walks whole rows so the inner loop is contiguous
+                    std::fill(row.begin(), row.end(), 0.0f);
+                    for(uint32_t t = 0; t < vertical.count; ++t)
+                    {
+                        const float weight = vertical.weights[y * vertical.count + t];
+                        if(weight == 0.0f)
+                            continue;
+
+                        const float* input =
+                            above + (vertical.indices[y * vertical.count + t] - firstSourceY) * sourceRowSize;
+                        for(uint32_t i = 0; i < sourceRowSize; ++i)
+                            row[i] += input[i] * weight;
+                    }
+
+                    float* output = current.data() + y * target.width * channels;
+                    filterRow(row.data(), horizontal, target.width, channels, output);
+
+                    if(content == Content::NORMAL && channels >= 3)
+                    {
+                        for(uint32_t x = 0; x < target.width * channels; x += channels)
+                        {
+                            float length = std::sqrt(
+                                output[x] * output[x] + output[x + 1] * output[x + 1] + output[x + 2] * output[x + 2]);
+                            if(length > 0.0f)
+                            {
+                                output[x] /= length;
+                                output[x + 1] /= length;
+                                output[x + 2] /= length;
+                            }
+                            else
+                            {
+                                // Opposing normals cancelled out, flat is the least surprising answer
+                                output[x] = 0.0f;
+                                output[x + 1] = 0.0f;
+                                output[x + 2] = 1.0f;
+                            }
+                        }
+                    }
+
+                    uint8_t* encoded = (uint8_t*)destination + target.offset + y * target.rowPitch;
+                    for(uint32_t x = 0; x < target.width * channels; x += channels)
+                    {
+                        for(uint32_t c = 0; c < channels; ++c)
+                            encoded[x + c] = encode(output[x + c], encodings[c], tables);
+                    }
+                }
+            });
+
+        std::swap(previous, current);
+    }
+}
+}
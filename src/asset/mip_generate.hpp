@@ -0,0 +1,68 @@
+#pragma once
+
+#include <util/thread_pool.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Mip chains for 8 bit per channel textures, built on the CPU at load time. Every level is filtered from
+// the one above it in linear space on floats, and only rounded back to 8 bits on the way out
+namespace MipGenerate
+{
+// D3D12_TEXTURE_DATA_PITCH_ALIGNMENT and D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, without pulling in d3d12.h
+constexpr uint32_t ROW_PITCH_ALIGNMENT = 256;
+constexpr uint32_t PLACEMENT_ALIGNMENT = 512;
+constexpr uint32_t ROWS_PER_TASK = 16;
+
+enum class Filter
+{
+    // Average of the 2x2 texels under each texel of the next level
+    BOX,
+    // Kaiser windowed sinc over 4x4 texels of the next level. Sharper, at the cost of slight ringing
+    KAISER,
+};
+
+enum class Content
+{
+    // sRGB encoded color with linear alpha
+    COLOR,
+    // Already linear, like AO
+    LINEAR,
+    // Tangent space normals stored as xyz * 0.5 + 0.5, renormalized on every level. Alpha is linear
+    NORMAL,
+};
+
+struct Level
+{
+    uint32_t width;
+    uint32_t height;
+    // Relative to the start of the chain
+    uint32_t offset;
+    uint32_t rowPitch;
+};
+
+struct Layout
+{
+    uint32_t channels;
+    std::vector<Level> levels;
+    // Of the whole chain
+    uint32_t size;
+};
+
+uint32_t getLevelCount(uint32_t width, uint32_t height);
+
+// Every level down to 1x1 unless `levelCount` says otherwise. Offsets and pitches come out the same as
+// GetCopyableFootprints would give for an 8 bit per channel format, so each level can be used as the
+// placed footprint of its subresource
+Layout getLayout(uint32_t width, uint32_t height, uint32_t channels, uint32_t levelCount = 0);
+
+// Fills in every level of `layout`, the first one is a copy of `source` (tightly packed). `destination`
+// is only ever written to, so it can be a mapped upload buffer
+void generate(
+    const uint8_t* source,
+    const Layout& layout,
+    Content content,
+    Filter filter,
+    char* destination,
+    ThreadPool& pool = ThreadPool::shared());
+}
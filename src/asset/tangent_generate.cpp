@@ -0,0 +1,316 @@
+#include "tangent_generate.hpp"
+
+#include <asset/vector_math.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace TangentGenerate
+{
+using namespace VectorMath;
+
+namespace
+{
+    constexpr uint32_t VERTICES_PER_TASK = 16384;
+    // Same threshold as MikkTSpace's NotZero
+    constexpr float TINY = std::numeric_limits<float>::min();
+
+    // Just enough of a vector type to write the triangle code once for every lane count. The struct
+    // wrappers are there because operators can't be overloaded on the intrinsic types with every compiler
+    namespace Simd
+    {
+#if defined(__AVX2__)
+        constexpr uint32_t LANE_COUNT = 8;
+
+        struct Float
+        {
+            __m256 v;
+        };
+
+        // clang-format off
+        inline Float splat(float a) { return {_mm256_set1_ps(a)}; }
+        inline Float load(const float* a) { return {_mm256_load_ps(a)}; }
+        inline void store(float* a, Float b) { _mm256_store_ps(a, b.v); }
+        inline Float operator+(Float a, Float b) { return {_mm256_add_ps(a.v, b.v)}; }
+        inline Float operator-(Float a, Float b) { return {_mm256_sub_ps(a.v, b.v)}; }
+        inline Float operator*(Float a, Float b) { return {_mm256_mul_ps(a.v, b.v)}; }
+        inline Float operator/(Float a, Float b) { return {_mm256_div_ps(a.v, b.v)}; }
+        inline Float operator&(Float a, Float b) { return {_mm256_and_ps(a.v, b.v)}; }
+        inline Float sqrt(Float a) { return {_mm256_sqrt_ps(a.v)}; }
+        inline Float abs(Float a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+        inline Float min(Float a, Float b) { return {_mm256_min_ps(a.v, b.v)}; }
+        inline Float max(Float a, Float b) { return {_mm256_max_ps(a.v, b.v)}; }
+        inline Float greater(Float a, Float b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+        inline Float select(Float mask, Float a, Float b) { return {_mm256_blendv_ps(b.v, a.v, mask.v)}; }
+        // clang-format on
+#elif defined(__SSE2__) || defined(_M_X64)
+        constexpr uint32_t LANE_COUNT = 4;
+
+        struct Float
+        {
+            __m128 v;
+        };
+
+        // clang-format off
+        inline Float splat(float a) { return {_mm_set1_ps(a)}; }
+        inline Float load(const float* a) { return {_mm_load_ps(a)}; }
+        inline void store(float* a, Float b) { _mm_store_ps(a, b.v); }
+        inline Float operator+(Float a, Float b) { return {_mm_add_ps(a.v, b.v)}; }
+        inline Float operator-(Float a, Float b) { return {_mm_sub_ps(a.v, b.v)}; }
+        inline Float operator*(Float a, Float b) { return {_mm_mul_ps(a.v, b.v)}; }
+        inline Float operator/(Float a, Float b) { return {_mm_div_ps(a.v, b.v)}; }
+        inline Float operator&(Float a, Float b) { return {_mm_and_ps(a.v, b.v)}; }
+        inline Float sqrt(Float a) { return {_mm_sqrt_ps(a.v)}; }
+        inline Float abs(Float a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+        inline Float min(Float a, Float b) { return {_mm_min_ps(a.v, b.v)}; }
+        inline Float max(Float a, Float b) { return {_mm_max_ps(a.v, b.v)}; }
+        inline Float greater(Float a, Float b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+        // clang-format on
+        // No blendv before SSE4.1
+        inline Float select(Float mask, Float a, Float b)
+        {
+            return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+        }
+#else
+        constexpr uint32_t LANE_COUNT = 1;
+
+        struct Float
+        {
+            float v;
+        };
+
+        // clang-format off
+        inline Float splat(float a) { return {a}; }
+        inline Float load(const float* a) { return {*a}; }
+        inline void store(float* a, Float b) { *a = b.v; }
+        inline Float operator+(Float a, Float b) { return {a.v + b.v}; }
+        inline Float operator-(Float a, Float b) { return {a.v - b.v}; }
+        inline Float operator*(Float a, Float b) { return {a.v * b.v}; }
+        inline Float operator/(Float a, Float b) { return {a.v / b.v}; }
+        inline Float operator&(Float a, Float b) { return {a.v != 0.0f && b.v != 0.0f ? 1.0f : 0.0f}; }
+        inline Float sqrt(Float a) { return {std::sqrt(a.v)}; }
+        inline Float abs(Float a) { return {std::abs(a.v)}; }
+        inline Float min(Float a, Float b) { return {std::min(a.v, b.v)}; }
+        inline Float max(Float a, Float b) { return {std::max(a.v, b.v)}; }
+        inline Float greater(Float a, Float b) { return {a.v > b.v ? 1.0f : 0.0f}; }
+        inline Float select(Float mask, Float a, Float b) { return mask.v != 0.0f ? a : b; }
+        // clang-format on
+#endif
+
+        struct Float3
+        {
+            Float x;
+            Float y;
+            Float z;
+        };
+
+        // clang-format off
+        inline Float3 operator+(const Float3& a, const Float3& b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+        inline Float3 operator-(const Float3& a, const Float3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+        inline Float3 operator*(const Float3& a, Float b) { return {a.x * b, a.y * b, a.z * b}; }
+        inline Float dot(const Float3& a, const Float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+        // clang-format on
+
+        // Removes the part of `a` along the unit vector `normal`
+        inline Float3 project(const Float3& a, const Float3& normal)
+        {
+            return a - normal * dot(normal, a);
+        }
+
+        // Zero vectors stay zero
+        inline Float3 normalize(const Float3& a)
+        {
+            Float lengthSquared = dot(a, a);
+            return a * select(greater(lengthSquared, splat(TINY)), splat(1.0f) / sqrt(lengthSquared), splat(0.0f));
+        }
+
+        // Abramowitz and Stegun 4.4.46, within 2e-8 radians of the real thing before float rounding
+        inline Float acos(Float a)
+        {
+            Float x = min(abs(a), splat(1.0f));
+            Float polynomial = splat(-0.0012624911f);
+            polynomial = polynomial * x + splat(0.0066700901f);
+            polynomial = polynomial * x + splat(-0.0170881256f);
+            polynomial = polynomial * x + splat(0.0308918810f);
+            polynomial = polynomial * x + splat(-0.0501743046f);
+            polynomial = polynomial * x + splat(0.0889789874f);
+            polynomial = polynomial * x + splat(-0.2145988016f);
+            polynomial = polynomial * x + splat(1.5707963050f);
+            Float result = sqrt(splat(1.0f) - x) * polynomial;
+            return select(greater(splat(0.0f), a), splat(3.14159265f) - result, result);
+        }
+    }
+
+    // Writes the weighted tangent of every corner of up to LANE_COUNT triangles, one triangle per lane
+    void processTriangles(
+        const Mesh& mesh,
+        uint32_t firstTriangle,
+        uint32_t triangleCount,
+        DirectX::XMFLOAT3* cornerTangents)
+    {
+        using namespace Simd;
+
+        // Gathering into SoA first makes the rest straight line code. Lanes past the end repeat the last
+        // triangle so they don't produce NaNs, and are never written back
+        alignas(32) float positions[3][3][LANE_COUNT];
+        alignas(32) float uvs[3][2][LANE_COUNT];
+        alignas(32) float normals[3][3][LANE_COUNT];
+        for(uint32_t lane = 0; lane < LANE_COUNT; ++lane)
+        {
+            const uint32_t* indices = &mesh.indices[(firstTriangle + std::min(lane, triangleCount - 1)) * 3];
+            for(uint32_t corner = 0; corner < 3; ++corner)
+            {
+                const DirectX::XMFLOAT3& position = mesh.positions[indices[corner]];
+                const DirectX::XMFLOAT2& uv = mesh.uvs[indices[corner]];
+                const DirectX::XMFLOAT3& normal = mesh.normals[indices[corner]];
+                positions[corner][0][lane] = position.x;
+                positions[corner][1][lane] = position.y;
+                positions[corner][2][lane] = position.z;
+                uvs[corner][0][lane] = uv.x;
+                uvs[corner][1][lane] = uv.y;
+                normals[corner][0][lane] = normal.x;
+                normals[corner][1][lane] = normal.y;
+                normals[corner][2][lane] = normal.z;
+            }
+        }
+
+        Float3 p[3];
+        Float3 n[3];
+        Float u[3];
+        Float v[3];
+        for(uint32_t corner = 0; corner < 3; ++corner)
+        {
+            p[corner] = {load(positions[corner][0]), load(positions[corner][1]), load(positions[corner][2])};
+            n[corner] = {load(normals[corner][0]), load(normals[corner][1]), load(normals[corner][2])};
+            u[corner] = load(uvs[corner][0]);
+            v[corner] = load(uvs[corner][1]);
+        }
+
+        // The direction in which u grows across the triangle
+        Float3 edge1 = p[1] - p[0];
+        Float3 edge2 = p[2] - p[0];
+        Float u1 = u[1] - u[0];
+        Float v1 = v[1] - v[0];
+        Float u2 = u[2] - u[0];
+        Float v2 = v[2] - v[0];
+        Float signedArea = u1 * v2 - v1 * u2;
+        Float3 tangent = edge1 * v2 - edge2 * v1;
+        Float tangentLengthSquared = dot(tangent, tangent);
+
+        // Mirrored UVs flip the sign, which keeps the tangent pointing along +u. Triangles that are
+        // degenerate in UV or in space don't contribute
+        Float valid = greater(abs(signedArea), splat(TINY)) & greater(tangentLengthSquared, splat(TINY));
+        Float sign = select(greater(signedArea, splat(0.0f)), splat(1.0f), splat(-1.0f));
+        tangent = tangent * select(valid, sign / sqrt(tangentLengthSquared), splat(0.0f));
+
+        alignas(32) float weighted[3][3][LANE_COUNT];
+        for(uint32_t corner = 0; corner < 3; ++corner)
+        {
+            const Float3& normal = n[corner];
+            Float3 previous = normalize(project(p[(corner + 2) % 3] - p[corner], normal));
+            Float3 next = normalize(project(p[(corner + 1) % 3] - p[corner], normal));
+            Float angle = acos(max(min(dot(previous, next), splat(1.0f)), splat(-1.0f)));
+
+            Float3 cornerTangent = normalize(project(tangent, normal)) * angle;
+            store(weighted[corner][0], cornerTangent.x);
+            store(weighted[corner][1], cornerTangent.y);
+            store(weighted[corner][2], cornerTangent.z);
+        }
+
+        for(uint32_t lane = 0; lane < triangleCount; ++lane)
+        {
+            for(uint32_t corner = 0; corner < 3; ++corner)
+            {
+                cornerTangents[(firstTriangle + lane) * 3 + corner] = {
+                    weighted[corner][0][lane],
+                    weighted[corner][1][lane],
+                    weighted[corner][2][lane],
+                };
+            }
+        }
+    }
+
+    DirectX::XMFLOAT3 getPerpendicular(const DirectX::XMFLOAT3& normal)
+    {
+        // Cross with whichever axis is further from the normal
+        DirectX::XMFLOAT3 axis = std::abs(normal.x) < 0.9f ? DirectX::XMFLOAT3{1.0f, 0.0f, 0.0f}
+                                                           : DirectX::XMFLOAT3{0.0f, 1.0f, 0.0f};
+        return normalize(cross(normal, axis));
+    }
+}
+
+void generate(Mesh& mesh, ThreadPool& pool)
+{
+    uint32_t triangleCount = mesh.indexCount() / 3;
+    uint32_t vertexCount = mesh.vertexCount();
+
+    static_assert(TRIANGLES_PER_TASK % Simd::LANE_COUNT == 0);
+    std::vector<DirectX::XMFLOAT3> cornerTangents(triangleCount * 3);
+    pool.parallelFor(
+        triangleCount,
+        TRIANGLES_PER_TASK,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t triangle = begin; triangle < end; triangle += Simd::LANE_COUNT)
+                processTriangles(mesh, triangle, std::min(Simd::LANE_COUNT, end - triangle), cornerTangents.data());
+        });
+
+    // Corners grouped by vertex. They're in index order within a vertex so the sums below come out the
+    // same no matter how the work was split
+    std::vector<uint32_t> cornerOffsets(vertexCount + 1, 0);
+    for(uint32_t i = 0; i < triangleCount * 3; ++i)
+        ++cornerOffsets[mesh.indices[i] + 1];
+    for(uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        cornerOffsets[vertex + 1] += cornerOffsets[vertex];
+
+    std::vector<uint32_t> vertexCorners(triangleCount * 3);
+    std::vector<uint32_t> cursors(cornerOffsets.begin(), cornerOffsets.end() - 1);
+    for(uint32_t i = 0; i < triangleCount * 3; ++i)
+        vertexCorners[cursors[mesh.indices[i]]++] = i;
+
+    mesh.tangents.resize(vertexCount);
+    pool.parallelFor(
+        vertexCount,
+        VERTICES_PER_TASK,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t vertex = begin; vertex < end; ++vertex)
+            {
+                DirectX::XMFLOAT3 sum{0.0f, 0.0f, 0.0f};
+                for(uint32_t i = cornerOffsets[vertex]; i < cornerOffsets[vertex + 1]; ++i)
+                    sum = add(sum, cornerTangents[vertexCorners[i]]);
+
+                float sumLength = length(sum);
+                mesh.tangents[vertex] =
+                    sumLength > TINY ? scale(sum, 1.0f / sumLength) : getPerpendicular(mesh.normals[vertex]);
+            }
+        });
+}
+
+Error measureError(std::span<const DirectX::XMFLOAT3> tangents, std::span<const DirectX::XMFLOAT3> reference)
+{
+    Error error{0.0f, 0.0f};
+    if(tangents.empty())
+        return error;
+
+    double sum = 0.0;
+    for(size_t i = 0; i < tangents.size(); ++i)
+    {
+        // More precise than acos of the dot product for the tiny angles this is usually about
+        DirectX::XMFLOAT3 a = normalize(tangents[i]);
+        DirectX::XMFLOAT3 b = normalize(reference[i]);
+        float angle = std::atan2(length(cross(a, b)), dot(a, b));
+        error.max = std::max(error.max, angle);
+        sum += angle;
+    }
+    error.mean = (float)(sum / tangents.size());
+
+    return error;
+}
+}
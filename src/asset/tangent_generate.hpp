@@ -0,0 +1,32 @@
+#pragma once
+
+#include <asset/mesh.hpp>
+#include <util/thread_pool.hpp>
+
+#include <cstdint>
+#include <span>
+
+#include <DirectXMath.h>
+
+// Tangent generation for sources that don't come with tangents. Follows the MikkTSpace math: every
+// triangle's tangent is projected into the tangent plane of each of its vertices and weighted by the
+// angle of the triangle at that vertex. Vertices are never split, the index buffer already shares a
+// vertex only between triangles that agree on position, normal and UV
+namespace TangentGenerate
+{
+constexpr uint32_t TRIANGLES_PER_TASK = 16384;
+
+struct Error
+{
+    // Angle between the generated tangents and the reference, in radians
+    float max;
+    float mean;
+};
+
+// Fills mesh.tangents from the positions, normals and UVs. The bitangent sign isn't kept, the shaders
+// rebuild the bitangent as cross(normal, tangent). Vertices without a usable triangle get an arbitrary
+// tangent perpendicular to their normal
+void generate(Mesh& mesh, ThreadPool& pool = ThreadPool::shared());
+
+Error measureError(std::span<const DirectX::XMFLOAT3> tangents, std::span<const DirectX::XMFLOAT3> reference);
+}
@@ -0,0 +1,233 @@
+#include "texture_atlas.hpp"
+
+#include <util/align.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace TextureAtlas
+{
+namespace
+{
+    // Every free rectangle starts on an aligned texel, which keeps every placement aligned as long as the
+    // padded sizes are rounded up as well
+    bool tryPack(
+        std::span<const Rect> padded,
+        std::span<const uint32_t> order,
+        uint32_t width,
+        uint32_t height,
+        std::vector<Rect>& placements)
+    {
+        std::vector<Rect> free = {{0, 0, width, height}};
+        for(uint32_t index : order)
+        {
+            const Rect& rect = padded[index];
+            uint32_t best = UINT32_MAX;
+            uint32_t bestShortSide = UINT32_MAX;
+            uint32_t bestLongSide = UINT32_MAX;
+            for(uint32_t i = 0; i < free.size(); ++i)
+            {
+                if(rect.width > free[i].width || rect.height > free[i].height)
+                    continue;
+
+                uint32_t leftoverWidth = free[i].width - rect.width;
+                uint32_t leftoverHeight = free[i].height - rect.height;
+                uint32_t shortSide = std::min(leftoverWidth, leftoverHeight);
+                uint32_t longSide = std::max(leftoverWidth, leftoverHeight);
+                if(shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+                {
+                    best = i;
+                    bestShortSide = shortSide;
+                    bestLongSide = longSide;
+                }
+            }
+            if(best == UINT32_MAX)
+                return false;
+
+            const Rect target = free[best];
+            free[best] = free.back();
+            free.pop_back();
+            placements[index] = {target.x, target.y, rect.width, rect.height};
+
+            // Split along the shorter leftover axis, so the bigger of the two pieces stays as large as it can
+            const uint32_t leftoverWidth = target.width - rect.width;
+            const uint32_t leftoverHeight = target.height - rect.height;
+            Rect right;
+            Rect bottom;
+            if(leftoverWidth < leftoverHeight)
+            {
+                right = {target.x + rect.width, target.y, leftoverWidth, rect.height};
+                bottom = {target.x, target.y + rect.height, target.width, leftoverHeight};
+            }
+            else
+            {
+                right = {target.x + rect.width, target.y, leftoverWidth, target.height};
+                bottom = {target.x, target.y + rect.height, rect.width, leftoverHeight};
+            }
+            if(right.width > 0 && right.height > 0)
+                free.push_back(right);
+            if(bottom.width > 0 && bottom.height > 0)
+                free.push_back(bottom);
+        }
+
+        return true;
+    }
+}
+
+std::optional<Packing> pack(
+    std::span<const TextureLoad::Size> sizes,
+    uint32_t maxSize,
+    uint32_t padding,
+    uint32_t alignment)
+{
+    // Keeps the images themselves aligned, not only their padded rectangles
+    padding = AlignTo(padding, alignment);
+    std::vector<Rect> padded(sizes.size());
+    uint64_t paddedArea = 0;
+    uint32_t largestSide = 1;
+    for(uint32_t i = 0; i < sizes.size(); ++i)
+    {
+        padded[i] = {
+            0,
+            0,
+            AlignTo(sizes[i].width, alignment) + padding * 2,
+            AlignTo(sizes[i].height, alignment) + padding * 2,
+        };
+        paddedArea += (uint64_t)padded[i].width * padded[i].height;
+        largestSide = std::max({largestSide, padded[i].width, padded[i].height});
+    }
+
+    std::vector<uint32_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(),
+        order.end(),
+        [&](uint32_t a, uint32_t b)
+        {
+            uint32_t sideA = std::max(padded[a].width, padded[a].height);
+            uint32_t sideB = std::max(padded[b].width, padded[b].height);
+            if(sideA != sideB)
+                return sideA > sideB;
+            return padded[a].width * padded[a].height > padded[b].width * padded[b].height;
+        });
+
+    // Grows a square from the smallest one that could hold everything in steps of 1/16th, then shrinks the
+    // height as far as it still fits. Packing is cheap next to wasting memory on a power of two
+    // The atlas itself stays a whole number of BC blocks
+    const uint32_t sizeAlignment = std::max(alignment, 4u);
+    auto fits = [&](uint32_t width, uint32_t height, std::vector<Rect>& placements)
+    { return tryPack(padded, order, width, height, placements); };
+    std::vector<Rect> placements(sizes.size());
+    uint32_t width = AlignTo(std::max(largestSide, (uint32_t)std::ceil(std::sqrt((double)paddedArea))), sizeAlignment);
+    while(width <= maxSize && !fits(width, width, placements))
+        width = AlignTo(width + width / 16, sizeAlignment);
+    if(width > maxSize)
+        return std::nullopt;
+
+    uint32_t height = width;
+    std::vector<Rect> candidate(sizes.size());
+    for(uint32_t step = std::bit_floor(width / 2); step >= sizeAlignment; step /= 2)
+    {
+        if(height > step && fits(width, height - step, candidate))
+        {
+            height -= step;
+            placements.swap(candidate);
+        }
+    }
+
+    Packing packing = {.width = width, .height = height, .padding = padding};
+    packing.rects.resize(sizes.size());
+    for(uint32_t i = 0; i < sizes.size(); ++i)
+        packing.rects[i] = {placements[i].x + padding, placements[i].y + padding, sizes[i].width, sizes[i].height};
+
+    return packing;
+}
+
+float getEfficiency(const Packing& packing)
+{
+    uint64_t used = 0;
+    for(const Rect& rect : packing.rects)
+        used += (uint64_t)rect.width * rect.height;
+    return (float)((double)used / ((double)packing.width * packing.height));
+}
+
+UvTransform getUvTransform(const Packing& packing, uint32_t index)
+{
+    const Rect& rect = packing.rects[index];
+    return {
+        .scaleU = rect.width / (float)packing.width,
+        .scaleV = rect.height / (float)packing.height,
+        .offsetU = rect.x / (float)packing.width,
+        .offsetV = rect.y / (float)packing.height,
+    };
+}
+
+void build(
+    const Packing& packing,
+    std::span<const Blit::Image> images,
+    const Blit::MutableImage& destination,
+    ThreadPool& pool)
+{
+    assert(images.size() == packing.rects.size());
+    const uint32_t pixelSize = Blit::getPixelSize(destination.format);
+    const uint32_t padding = packing.padding;
+    pool.parallelFor(
+        (uint32_t)images.size(),
+        1,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t i = begin; i < end; ++i)
+            {
+                const Rect& rect = packing.rects[i];
+                char* origin = (char*)destination.data + (size_t)rect.y * destination.rowPitch + rect.x * pixelSize;
+                Blit::blit(
+                    images[i],
+                    {origin, destination.rowPitch, destination.format},
+                    rect.width,
+                    rect.height);
+                if(padding == 0)
+                    continue;
+
+                // Edge texels out to the sides first, then whole padded rows up and down, which fills the
+                // corners too
+                for(uint32_t y = 0; y < rect.height; ++y)
+                {
+                    char* row = origin + (size_t)y * destination.rowPitch;
+                    char* last = row + (rect.width - 1) * pixelSize;
+                    for(uint32_t x = 1; x <= padding; ++x)
+                    {
+                        std::memcpy(row - x * pixelSize, row, pixelSize);
+                        std::memcpy(last + x * pixelSize, last, pixelSize);
+                    }
+                }
+                const size_t paddedRowSize = (size_t)(rect.width + padding * 2) * pixelSize;
+                char* firstRow = origin - padding * pixelSize;
+                char* lastRow = firstRow + (size_t)(rect.height - 1) * destination.rowPitch;
+                for(uint32_t y = 1; y <= padding; ++y)
+                {
+                    std::memcpy(firstRow - (size_t)y * destination.rowPitch, firstRow, paddedRowSize);
+                    std::memcpy(lastRow + (size_t)y * destination.rowPitch, lastRow, paddedRowSize);
+                }
+            }
+        });
+}
+
+ArrayLayout getArrayLayout(uint32_t width, uint32_t height, uint32_t channels, uint32_t sliceCount)
+{
+    ArrayLayout layout = {.channels = channels};
+    const uint32_t rowPitch = AlignTo(width * channels, MipGenerate::ROW_PITCH_ALIGNMENT);
+    uint32_t offset = 0;
+    for(uint32_t i = 0; i < sliceCount; ++i)
+    {
+        layout.slices.push_back({width, height, offset, rowPitch});
+        offset = AlignTo(offset + rowPitch * height, MipGenerate::PLACEMENT_ALIGNMENT);
+    }
+    layout.size = offset;
+
+    return layout;
+}
+}
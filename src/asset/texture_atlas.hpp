@@ -0,0 +1,80 @@
+#pragma once
+
+#include <asset/mip_generate.hpp>
+#include <asset/texture_load.hpp>
+#include <util/blit.hpp>
+#include <util/thread_pool.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Puts a set of images into one texture so objects with different images can share a descriptor table and
+// be drawn instanced. Images of the same size go into the slices of a Texture2DArray, mixed sizes get packed
+// into a single atlas and sampled through a UV transform
+namespace TextureAtlas
+{
+struct Rect
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Maps an image's own UVs into the atlas as uv * scale + offset, a float4 in the shader
+struct UvTransform
+{
+    float scaleU;
+    float scaleV;
+    float offsetU;
+    float offsetV;
+};
+
+struct Packing
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t padding;
+    // In the order the sizes were given, without the padding
+    std::vector<Rect> rects;
+};
+
+struct ArrayLayout
+{
+    uint32_t channels;
+    // One per slice, which are also the array's subresources when it has a single mip
+    std::vector<MipGenerate::Level> slices;
+    // Of the whole array
+    uint32_t size;
+};
+
+// Guillotine packing, biggest images first into the free rectangle that leaves the shortest side, in the
+// smallest atlas it finds up to `maxSize` on a side. Every image gets `padding` texels of border around it,
+// rounded up to a multiple of `alignment`, and starts at a multiple of `alignment`. For an atlas with N mips
+// an alignment of 1 << (N - 1) keeps every image on whole texels of every level, and bilinear filtering
+// stays inside an image down to the level where the padding shrinks below a texel. Returns std::nullopt if
+// the images don't fit
+std::optional<Packing> pack(
+    std::span<const TextureLoad::Size> sizes,
+    uint32_t maxSize,
+    uint32_t padding,
+    uint32_t alignment = 1);
+
+// Image texels over atlas texels
+float getEfficiency(const Packing& packing);
+
+UvTransform getUvTransform(const Packing& packing, uint32_t index);
+
+// Copies every image into its rectangle, converting to `destination`'s format, and extends its edges into
+// the padding. Texels outside of every padded rectangle are left as they are
+void build(
+    const Packing& packing,
+    std::span<const Blit::Image> images,
+    const Blit::MutableImage& destination,
+    ThreadPool& pool = ThreadPool::shared());
+
+// Slices laid out one after the other at the pitch and placement CopyTextureRegion wants
+ArrayLayout getArrayLayout(uint32_t width, uint32_t height, uint32_t channels, uint32_t sliceCount);
+}
@@ -0,0 +1,169 @@
+#include "texture_cache.hpp"
+
+#include <asset/texture_load.hpp>
+#include <util/asset_registry.hpp>
+#include <util/file_util.hpp>
+#include <util/path.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+namespace TextureCache
+{
+namespace
+{
+    // Only ever holds files that passed the checks in load()
+    AssetRegistry<MappedFile> cookedFiles;
+
+    const char* getFormatName(const Settings& settings)
+    {
+        if(settings.compression)
+        {
+            switch(settings.compression.value())
+            {
+            case TextureCompress::Format::BC1: return "bc1";
+            case TextureCompress::Format::BC4: return "bc4";
+            case TextureCompress::Format::BC5: return "bc5";
+            case TextureCompress::Format::BC7: return "bc7";
+            }
+        }
+
+        constexpr const char* names[] = {"r8", "rg8", "rgb8", "rgba8"};
+        return names[std::clamp(settings.channels, 1u, 4u) - 1];
+    }
+
+    bool matches(const Header& header, const Settings& settings)
+    {
+        return header.channels == settings.channels && header.content == settings.content &&
+               header.filter == settings.filter && (header.compressed != 0) == settings.compression.has_value() &&
+               (!settings.compression || header.compressionFormat == settings.compression.value()) &&
+               (header.packedAlpha != 0) == settings.alphaSource.has_value();
+    }
+}
+
+std::filesystem::path getCookedPath(const std::filesystem::path& sourcePath, const Settings& settings)
+{
+    // The same image can be cooked into more than one format, e.g. a mask as both BC4 and R8, and packed
+    // with more than one alpha
+    std::filesystem::path name = sourcePath.filename();
+    if(settings.alphaSource)
+    {
+        name += "+";
+        name += settings.alphaSource->filename();
+    }
+    std::string extension = std::string(".") + getFormatName(settings) + ".texture";
+    return Path::getCachePath(name.concat(extension));
+}
+
+bool cook(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath, const Settings& settings)
+{
+    std::optional<TextureLoad::Size> size = TextureLoad::getSize(sourcePath);
+    if(!size)
+        return false;
+
+    const MipGenerate::Layout mips = MipGenerate::getLayout(size->width, size->height, settings.channels);
+    if(mips.levels.size() > MAX_LEVEL_COUNT)
+        return false;
+
+    std::optional<TextureCompress::Layout> compressed;
+    if(settings.compression)
+        compressed = TextureCompress::getLayout(size->width, size->height, settings.compression.value());
+    std::span<const MipGenerate::Level> levels = compressed ? compressed->levels : mips.levels;
+
+    Header header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    std::tie(header.sourceSize, header.sourceWriteTime) = FileUtil::getStamp(sourcePath);
+    header.channels = settings.channels;
+    header.content = settings.content;
+    header.filter = settings.filter;
+    header.compressed = settings.compression.has_value();
+    header.compressionFormat = settings.compression.value_or(TextureCompress::Format::BC1);
+    header.packedAlpha = settings.alphaSource.has_value();
+    if(settings.alphaSource)
+        std::tie(header.alphaSourceSize, header.alphaSourceWriteTime) = FileUtil::getStamp(*settings.alphaSource);
+    header.width = size->width;
+    header.height = size->height;
+    header.levelCount = (uint32_t)levels.size();
+    std::copy(levels.begin(), levels.end(), header.levels);
+    header.payloadSize = compressed ? compressed->size : mips.size;
+
+    // Decoded, filtered and compressed straight into the file buffer
+    std::vector<char> fileData(PAYLOAD_OFFSET + header.payloadSize);
+    std::memcpy(fileData.data(), &header, sizeof(Header));
+    bool decoded = TextureLoad::decode({
+        .path = sourcePath,
+        .channels = settings.channels,
+        .width = size->width,
+        .height = size->height,
+        .destination = fileData.data() + PAYLOAD_OFFSET,
+        .rowPitch = mips.levels[0].rowPitch,
+        .mips = TextureLoad::Mips{.layout = mips, .content = settings.content, .filter = settings.filter},
+        .compression = compressed,
+        .alphaPath = settings.alphaSource,
+    });
+    if(!decoded)
+        return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(cookedPath.parent_path(), error);
+
+    return FileUtil::replaceFile(cookedPath, fileData);
+}
+
+std::optional<CookedTexture> load(const std::filesystem::path& cookedPath)
+{
+    AssetRegistry<MappedFile>::Handle file = cookedFiles.load(
+        cookedPath,
+        [](MappedFile&& file) -> std::optional<MappedFile>
+        {
+            if(file.size() < PAYLOAD_OFFSET)
+                return std::nullopt;
+
+            const Header& header = *(const Header*)file.data();
+            if(header.magic != MAGIC || header.version != VERSION || header.levelCount > MAX_LEVEL_COUNT)
+                return std::nullopt;
+            if(file.size() < (size_t)PAYLOAD_OFFSET + header.payloadSize)
+                return std::nullopt;
+
+            return std::move(file);
+        });
+    if(!file)
+        return std::nullopt;
+
+    return CookedTexture(std::move(file));
+}
+
+bool isUpToDate(const CookedTexture& texture, const std::filesystem::path& sourcePath, const Settings& settings)
+{
+    const Header& header = texture.header();
+    auto [size, writeTime] = FileUtil::getStamp(sourcePath);
+    if(header.sourceSize != size || header.sourceWriteTime != writeTime || !matches(header, settings))
+        return false;
+    if(!settings.alphaSource)
+        return true;
+
+    auto [alphaSize, alphaWriteTime] = FileUtil::getStamp(settings.alphaSource.value());
+    return header.alphaSourceSize == alphaSize && header.alphaSourceWriteTime == alphaWriteTime;
+}
+
+std::optional<CookedTexture> loadOrCook(const std::filesystem::path& sourcePath, const Settings& settings)
+{
+    std::filesystem::path cookedPath = getCookedPath(sourcePath, settings);
+
+    std::optional<CookedTexture> texture = load(cookedPath);
+    if(texture && isUpToDate(texture.value(), sourcePath, settings))
+        return texture;
+
+    // The new file is renamed over the stale one, so every other CookedTexture of it keeps the old bytes. Windows
+    // won't replace a mapped file though, so drop ours first. Until the others are gone as well cooking fails there
+    texture.reset();
+    if(!cook(sourcePath, cookedPath, settings))
+        return std::nullopt;
+
+    return load(cookedPath);
+}
+}
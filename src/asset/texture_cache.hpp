@@ -0,0 +1,106 @@
+#pragma once
+
+#include <asset/mip_generate.hpp>
+#include <asset/texture_compress.hpp>
+#include <util/mapped_file.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+
+// Binary texture format produced by the cook step, the texture counterpart of MeshCache. The payload is the
+// whole mip chain exactly as it goes into an upload buffer, every level already at its placement and row
+// pitch, so loading is one copy of the mapped file with no decode or re-pitching. The payload itself
+// starts at a placement boundary in the file as well, for when it's read straight to the GPU
+namespace TextureCache
+{
+constexpr uint32_t MAGIC = 0x52545854; // "TXTR"
+constexpr uint32_t VERSION = 2;
+// A 16384 texture, the D3D12 maximum, has 15 levels
+constexpr uint32_t MAX_LEVEL_COUNT = 16;
+constexpr uint32_t PAYLOAD_OFFSET = MipGenerate::PLACEMENT_ALIGNMENT;
+
+// What to cook the source image into
+struct Settings
+{
+    // Components per pixel taken from the source, 1 to 4 like stbi_load's `desired_channels`
+    uint32_t channels;
+    MipGenerate::Content content;
+    MipGenerate::Filter filter;
+    // Levels stay 8 bits per channel without one
+    std::optional<TextureCompress::Format> compression;
+    // Image whose first channel goes into alpha, like TextureLoad::Request::alphaPath. Needs 4 channels
+    std::optional<std::filesystem::path> alphaSource;
+};
+
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+
+    // Used to detect when the source image has changed since it was cooked
+    uint64_t sourceSize;
+    int64_t sourceWriteTime;
+
+    // Settings flattened, so a file cooked with different ones gets cooked again
+    uint32_t channels;
+    MipGenerate::Content content;
+    MipGenerate::Filter filter;
+    uint32_t compressed;
+    TextureCompress::Format compressionFormat;
+    uint32_t packedAlpha;
+
+    // Zero without a packed alpha
+    uint64_t alphaSourceSize;
+    int64_t alphaSourceWriteTime;
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    // Relative to the start of the payload. Compressed levels are padded to whole blocks
+    MipGenerate::Level levels[MAX_LEVEL_COUNT];
+    uint32_t payloadSize;
+};
+
+static_assert(sizeof(Header) <= PAYLOAD_OFFSET);
+
+// A handle to the mapped file, copies share the mapping
+class CookedTexture
+{
+    std::shared_ptr<const MappedFile> file;
+
+  public:
+    explicit CookedTexture(std::shared_ptr<const MappedFile> file): file(std::move(file)) {}
+
+    const Header& header() const
+    {
+        return *(const Header*)file->data();
+    }
+
+    // Copied as a whole to a placement aligned offset of an upload buffer, the levels are then where
+    // levels() says relative to that offset
+    const char* payload() const
+    {
+        return file->data() + PAYLOAD_OFFSET;
+    }
+
+    std::span<const MipGenerate::Level> levels() const
+    {
+        return {header().levels, header().levelCount};
+    }
+};
+
+std::filesystem::path getCookedPath(const std::filesystem::path& sourcePath, const Settings& settings);
+
+bool cook(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath, const Settings& settings);
+
+// Returns std::nullopt if the file is missing, truncated, or from another version. Loads of the same cooked
+// bytes share one mapping, like MeshCache::load
+std::optional<CookedTexture> load(const std::filesystem::path& cookedPath);
+bool isUpToDate(const CookedTexture& texture, const std::filesystem::path& sourcePath, const Settings& settings);
+
+// Maps the cooked version of `sourcePath`, cooking it first if it's missing, stale or cooked differently
+std::optional<CookedTexture> loadOrCook(const std::filesystem::path& sourcePath, const Settings& settings);
+}
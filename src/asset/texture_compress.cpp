@@ -0,0 +1,674 @@
+#include "texture_compress.hpp"
+
+#include <util/align.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace TextureCompress
+{
+namespace
+{
+    constexpr uint32_t REFINE_ITERATION_COUNT = 2;
+    constexpr uint32_t POWER_ITERATION_COUNT = 8;
+    // BC7 interpolation weights for 4 bit indices, out of 64
+    constexpr std::array<uint32_t, 16> BC7_WEIGHTS = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    // Where each BC1 index sits between color0 and color1 in the four color mode
+    constexpr std::array<float, 4> BC1_WEIGHTS = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+    using Texel = std::array<float, 4>;
+    using Block = std::array<Texel, 16>;
+    using Indices = std::array<uint32_t, 16>;
+
+    // Texels past the edge of levels that aren't a multiple of 4 repeat the last row and column
+    Block loadBlock(
+        const uint8_t* level,
+        const MipGenerate::Level& source,
+        uint32_t channels,
+        uint32_t blockX,
+        uint32_t blockY)
+    {
+        Block block;
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t x = std::min(blockX * 4 + i % 4, source.width - 1);
+            uint32_t y = std::min(blockY * 4 + i / 4, source.height - 1);
+            const uint8_t* texel = level + y * source.rowPitch + x * channels;
+            block[i] = {0.0f, 0.0f, 0.0f, 255.0f};
+            for(uint32_t c = 0; c < channels; ++c)
+                block[i][c] = texel[c];
+        }
+        return block;
+    }
+
+    float getDistance(const Texel& a, const Texel& b, uint32_t channelCount)
+    {
+        float distance = 0.0f;
+        for(uint32_t c = 0; c < channelCount; ++c)
+            distance += (a[c] - b[c]) * (a[c] - b[c]);
+        return distance;
+    }
+
+    // Picks the closest palette entry for every texel and returns the summed squared error. The channel
+    // count is a template parameter so the distance loop unrolls, this is where most of the time goes
+    template<uint32_t CHANNEL_COUNT, size_t N>
+    float assignIndices(const Block& block, const std::array<Texel, N>& palette, uint32_t paletteSize, Indices& indices)
+    {
+        float error = 0.0f;
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            float best = std::numeric_limits<float>::max();
+            uint32_t index = 0;
+            for(uint32_t p = 0; p < paletteSize; ++p)
+            {
+                float distance = 0.0f;
+                for(uint32_t c = 0; c < CHANNEL_COUNT; ++c)
+                    distance += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+                // Kept branch free, noisy blocks would mispredict half of the comparisons
+                index = distance < best ? p : index;
+                best = std::min(best, distance);
+            }
+            indices[i] = index;
+            error += best;
+        }
+        return error;
+    }
+
+    // Line through the block along the principal axis of its texels, cut off at the outermost ones
+    void fitEndpoints(const Block& block, uint32_t channelCount, Texel& first, Texel& second)
+    {
+        Texel mean = {};
+        for(const Texel& texel : block)
+        {
+            for(uint32_t c = 0; c < channelCount; ++c)
+                mean[c] += texel[c] / 16.0f;
+        }
+
+        std::array<Texel, 4> covariance = {};
+        for(const Texel& texel : block)
+        {
+            for(uint32_t a = 0; a < channelCount; ++a)
+            {
+                for(uint32_t b = 0; b < channelCount; ++b)
+                    covariance[a][b] += (texel[a] - mean[a]) * (texel[b] - mean[b]);
+            }
+        }
+
+        // Power iteration, starting from the row of the channel that varies the most so the start is never
+        // perpendicular to the answer
+        uint32_t widest = 0;
+        for(uint32_t c = 1; c < channelCount; ++c)
+            widest = covariance[c][c] > covariance[widest][widest] ? c : widest;
+        Texel axis = covariance[widest];
+        for(uint32_t iteration = 0; iteration < POWER_ITERATION_COUNT; ++iteration)
+        {
+            Texel next = {};
+            float largest = 0.0f;
+            for(uint32_t a = 0; a < channelCount; ++a)
+            {
+                for(uint32_t b = 0; b < channelCount; ++b)
+                    next[a] += covariance[a][b] * axis[b];
+                largest = std::max(largest, std::abs(next[a]));
+            }
+            if(largest == 0.0f)
+                break;
+
+            for(uint32_t c = 0; c < channelCount; ++c)
+                axis[c] = next[c] / largest;
+        }
+
+        float length = std::sqrt(getDistance(axis, {}, channelCount));
+        float low = 0.0f;
+        float high = 0.0f;
+        if(length > 0.0f)
+        {
+            for(uint32_t c = 0; c < channelCount; ++c)
+                axis[c] /= length;
+            for(const Texel& texel : block)
+            {
+                float t = 0.0f;
+                for(uint32_t c = 0; c < channelCount; ++c)
+                    t += (texel[c] - mean[c]) * axis[c];
+                low = std::min(low, t);
+                high = std::max(high, t);
+            }
+        }
+
+        first = mean;
+        second = mean;
+        for(uint32_t c = 0; c < channelCount; ++c)
+        {
+            first[c] = std::clamp(mean[c] + axis[c] * low, 0.0f, 255.0f);
+            second[c] = std::clamp(mean[c] + axis[c] * high, 0.0f, 255.0f);
+        }
+    }
+
+    // Least squares endpoints for texels at fixed positions `weights` between them. False if the weights
+    // don't pin both endpoints down, like when every texel picked the same one
+    bool refitEndpoints(
+        const Block& block,
+        const std::array<float, 16>& weights,
+        uint32_t channelCount,
+        Texel& first,
+        Texel& second)
+    {
+        float firstFirst = 0.0f;
+        float firstSecond = 0.0f;
+        float secondSecond = 0.0f;
+        Texel firstTexel = {};
+        Texel secondTexel = {};
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            float a = 1.0f - weights[i];
+            float b = weights[i];
+            firstFirst += a * a;
+            firstSecond += a * b;
+            secondSecond += b * b;
+            for(uint32_t c = 0; c < channelCount; ++c)
+            {
+                firstTexel[c] += a * block[i][c];
+                secondTexel[c] += b * block[i][c];
+            }
+        }
+
+        float determinant = firstFirst * secondSecond - firstSecond * firstSecond;
+        if(std::abs(determinant) < 1e-6f)
+            return false;
+
+        for(uint32_t c = 0; c < channelCount; ++c)
+        {
+            first[c] = (secondSecond * firstTexel[c] - firstSecond * secondTexel[c]) / determinant;
+            second[c] = (firstFirst * secondTexel[c] - firstSecond * firstTexel[c]) / determinant;
+            first[c] = std::clamp(first[c], 0.0f, 255.0f);
+            second[c] = std::clamp(second[c], 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    // BC1
+
+    uint16_t packRgb565(const Texel& color)
+    {
+        uint32_t r = (uint32_t)(color[0] * 31.0f / 255.0f + 0.5f);
+        uint32_t g = (uint32_t)(color[1] * 63.0f / 255.0f + 0.5f);
+        uint32_t b = (uint32_t)(color[2] * 31.0f / 255.0f + 0.5f);
+        return (uint16_t)(r << 11 | g << 5 | b);
+    }
+
+    Texel unpackRgb565(uint16_t color)
+    {
+        uint32_t r = color >> 11;
+        uint32_t g = (color >> 5) & 63;
+        uint32_t b = color & 31;
+        return {float(r << 3 | r >> 2), float(g << 2 | g >> 4), float(b << 3 | b >> 2), 255.0f};
+    }
+
+    std::array<Texel, 4> getBc1Palette(uint16_t color0, uint16_t color1)
+    {
+        std::array<Texel, 4> palette = {unpackRgb565(color0), unpackRgb565(color1)};
+        for(uint32_t c = 0; c < 3; ++c)
+        {
+            if(color0 > color1)
+            {
+                palette[2][c] = std::round((2.0f * palette[0][c] + palette[1][c]) / 3.0f);
+                palette[3][c] = std::round((palette[0][c] + 2.0f * palette[1][c]) / 3.0f);
+            }
+            else
+            {
+                palette[2][c] = std::round((palette[0][c] + palette[1][c]) / 2.0f);
+                palette[3][c] = 0.0f;
+            }
+        }
+        palette[2][3] = 255.0f;
+        palette[3][3] = color0 > color1 ? 255.0f : 0.0f;
+        return palette;
+    }
+
+    uint64_t encodeBc1(const Block& block)
+    {
+        Texel first;
+        Texel second;
+        fitEndpoints(block, 3, first, second);
+
+        uint64_t encoded = 0;
+        float bestError = std::numeric_limits<float>::max();
+        for(uint32_t iteration = 0; iteration <= REFINE_ITERATION_COUNT; ++iteration)
+        {
+            uint16_t color0 = packRgb565(first);
+            uint16_t color1 = packRgb565(second);
+            // The four color mode needs color0 above color1. Equal colors fall into the three color mode,
+            // where index 0 is still color0
+            if(color0 < color1)
+            {
+                std::swap(color0, color1);
+                std::swap(first, second);
+            }
+
+            Indices indices;
+            float error =
+                assignIndices<3>(block, getBc1Palette(color0, color1), color0 == color1 ? 1 : 4, indices);
+            if(error < bestError)
+            {
+                bestError = error;
+                encoded = uint64_t(color0) | uint64_t(color1) << 16;
+                for(uint32_t i = 0; i < 16; ++i)
+                    encoded |= uint64_t(indices[i]) << (32 + i * 2);
+            }
+
+            std::array<float, 16> weights;
+            for(uint32_t i = 0; i < 16; ++i)
+                weights[i] = BC1_WEIGHTS[indices[i]];
+            if(color0 == color1 || !refitEndpoints(block, weights, 3, first, second))
+                break;
+        }
+        return encoded;
+    }
+
+    // BC4, also both halves of BC5
+
+    std::array<Texel, 8> getBc4Palette(uint32_t value0, uint32_t value1)
+    {
+        std::array<Texel, 8> palette = {};
+        palette[0][0] = float(value0);
+        palette[1][0] = float(value1);
+        if(value0 > value1)
+        {
+            for(uint32_t i = 2; i < 8; ++i)
+                palette[i][0] = ((8 - i) * value0 + (i - 1) * value1) / 7.0f;
+        }
+        else
+        {
+            for(uint32_t i = 2; i < 6; ++i)
+                palette[i][0] = ((6 - i) * value0 + (i - 1) * value1) / 5.0f;
+            palette[6][0] = 0.0f;
+            palette[7][0] = 255.0f;
+        }
+        return palette;
+    }
+
+    uint64_t encodeBc4(const Block& block, uint32_t channel)
+    {
+        // Moved to the first channel so the shared helpers can be used
+        Block values = {};
+        float low = 255.0f;
+        float high = 0.0f;
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            values[i][0] = block[i][channel];
+            low = std::min(low, values[i][0]);
+            high = std::max(high, values[i][0]);
+        }
+
+        uint32_t value0 = (uint32_t)(high + 0.5f);
+        uint32_t value1 = (uint32_t)(low + 0.5f);
+        if(value0 == value1)
+            return uint64_t(value0) | uint64_t(value1) << 8;
+
+        uint64_t encoded = 0;
+        float bestError = std::numeric_limits<float>::max();
+        for(uint32_t iteration = 0; iteration <= REFINE_ITERATION_COUNT; ++iteration)
+        {
+            Indices indices;
+            float error = assignIndices<1>(values, getBc4Palette(value0, value1), 8, indices);
+            if(error < bestError)
+            {
+                bestError = error;
+                encoded = uint64_t(value0) | uint64_t(value1) << 8;
+                for(uint32_t i = 0; i < 16; ++i)
+                    encoded |= uint64_t(indices[i]) << (16 + i * 3);
+            }
+
+            std::array<float, 16> weights;
+            for(uint32_t i = 0; i < 16; ++i)
+                weights[i] = indices[i] <= 1 ? float(indices[i]) : (indices[i] - 1) / 7.0f;
+            Texel first;
+            Texel second;
+            if(!refitEndpoints(values, weights, 1, first, second))
+                break;
+
+            value0 = (uint32_t)(first[0] + 0.5f);
+            value1 = (uint32_t)(second[0] + 0.5f);
+            // Only the eight value mode is encoded, it needs value0 above value1
+            if(value0 < value1)
+                std::swap(value0, value1);
+            if(value0 == value1)
+                break;
+        }
+        return encoded;
+    }
+
+    // BC7 mode 6
+
+    struct BitWriter
+    {
+        std::array<uint64_t, 2> words = {};
+        uint32_t position = 0;
+
+        void write(uint64_t value, uint32_t bitCount)
+        {
+            for(uint32_t i = 0; i < bitCount; ++i, ++position)
+                words[position / 64] |= ((value >> i) & 1) << (position % 64);
+        }
+    };
+
+    struct BitReader
+    {
+        std::array<uint64_t, 2> words;
+        uint32_t position = 0;
+
+        uint32_t read(uint32_t bitCount)
+        {
+            uint32_t value = 0;
+            for(uint32_t i = 0; i < bitCount; ++i, ++position)
+                value |= uint32_t((words[position / 64] >> (position % 64)) & 1) << i;
+            return value;
+        }
+    };
+
+    // 7 bits per channel plus a P bit shared by the whole endpoint, picked for the smaller error
+    struct Bc7Endpoint
+    {
+        std::array<uint32_t, 4> values;
+        uint32_t pBit;
+
+        Texel expand() const
+        {
+            Texel texel;
+            for(uint32_t c = 0; c < 4; ++c)
+                texel[c] = float(values[c] << 1 | pBit);
+            return texel;
+        }
+    };
+
+    Bc7Endpoint quantizeBc7(const Texel& endpoint)
+    {
+        Bc7Endpoint best = {};
+        float bestError = std::numeric_limits<float>::max();
+        for(uint32_t pBit = 0; pBit < 2; ++pBit)
+        {
+            Bc7Endpoint quantized = {.values = {}, .pBit = pBit};
+            for(uint32_t c = 0; c < 4; ++c)
+                quantized.values[c] = (uint32_t)std::clamp(std::round((endpoint[c] - pBit) / 2.0f), 0.0f, 127.0f);
+
+            float error = getDistance(quantized.expand(), endpoint, 4);
+            if(error < bestError)
+            {
+                bestError = error;
+                best = quantized;
+            }
+        }
+        return best;
+    }
+
+    std::array<Texel, 16> getBc7Palette(const Bc7Endpoint& endpoint0, const Bc7Endpoint& endpoint1)
+    {
+        Texel expanded0 = endpoint0.expand();
+        Texel expanded1 = endpoint1.expand();
+        std::array<Texel, 16> palette;
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            for(uint32_t c = 0; c < 4; ++c)
+            {
+                uint32_t value = ((64 - BC7_WEIGHTS[i]) * (uint32_t)expanded0[c] +
+                                  BC7_WEIGHTS[i] * (uint32_t)expanded1[c] + 32) >> 6;
+                palette[i][c] = float(value);
+            }
+        }
+        return palette;
+    }
+
+    std::array<uint64_t, 2> encodeBc7(const Block& block)
+    {
+        Texel first;
+        Texel second;
+        fitEndpoints(block, 4, first, second);
+
+        Bc7Endpoint bestEndpoints[2];
+        Indices bestIndices;
+        float bestError = std::numeric_limits<float>::max();
+        for(uint32_t iteration = 0; iteration <= REFINE_ITERATION_COUNT; ++iteration)
+        {
+            Bc7Endpoint endpoint0 = quantizeBc7(first);
+            Bc7Endpoint endpoint1 = quantizeBc7(second);
+            Indices indices;
+            float error = assignIndices<4>(block, getBc7Palette(endpoint0, endpoint1), 16, indices);
+            if(error < bestError)
+            {
+                bestError = error;
+                bestEndpoints[0] = endpoint0;
+                bestEndpoints[1] = endpoint1;
+                bestIndices = indices;
+            }
+
+            std::array<float, 16> weights;
+            for(uint32_t i = 0; i < 16; ++i)
+                weights[i] = BC7_WEIGHTS[indices[i]] / 64.0f;
+            if(!refitEndpoints(block, weights, 4, first, second))
+                break;
+        }
+
+        // The first texel's index has its top bit implied to be 0, flip the endpoints around if it isn't
+        if(bestIndices[0] >= 8)
+        {
+            std::swap(bestEndpoints[0], bestEndpoints[1]);
+            for(uint32_t& index : bestIndices)
+                index = 15 - index;
+        }
+
+        BitWriter writer;
+        writer.write(1 << 6, 7);
+        for(uint32_t c = 0; c < 4; ++c)
+        {
+            writer.write(bestEndpoints[0].values[c], 7);
+            writer.write(bestEndpoints[1].values[c], 7);
+        }
+        writer.write(bestEndpoints[0].pBit, 1);
+        writer.write(bestEndpoints[1].pBit, 1);
+        for(uint32_t i = 0; i < 16; ++i)
+            writer.write(bestIndices[i], i == 0 ? 3 : 4);
+        assert(writer.position == 128);
+        return writer.words;
+    }
+
+    // Decoders, only used to measure the error. They cover what the encoders write rather than the whole
+    // of every format
+
+    void decodeBc4(const char* data, uint32_t channel, Block& block)
+    {
+        uint64_t encoded;
+        std::memcpy(&encoded, data, sizeof(encoded));
+        std::array<Texel, 8> palette = getBc4Palette(encoded & 0xFF, (encoded >> 8) & 0xFF);
+        for(uint32_t i = 0; i < 16; ++i)
+            block[i][channel] = palette[(encoded >> (16 + i * 3)) & 7][0];
+    }
+
+    Block decodeBlock(const char* data, Format format)
+    {
+        Block block = {};
+        switch(format)
+        {
+        case Format::BC1:
+        {
+            uint64_t encoded;
+            std::memcpy(&encoded, data, sizeof(encoded));
+            std::array<Texel, 4> palette = getBc1Palette(encoded & 0xFFFF, (encoded >> 16) & 0xFFFF);
+            for(uint32_t i = 0; i < 16; ++i)
+                block[i] = palette[(encoded >> (32 + i * 2)) & 3];
+            break;
+        }
+        case Format::BC4: decodeBc4(data, 0, block); break;
+        case Format::BC5:
+            decodeBc4(data, 0, block);
+            decodeBc4(data + 8, 1, block);
+            break;
+        case Format::BC7:
+        {
+            BitReader reader;
+            std::memcpy(reader.words.data(), data, sizeof(reader.words));
+            [[maybe_unused]] uint32_t mode = reader.read(7);
+            assert(mode == 1 << 6);
+
+            Bc7Endpoint endpoints[2];
+            for(uint32_t c = 0; c < 4; ++c)
+            {
+                endpoints[0].values[c] = reader.read(7);
+                endpoints[1].values[c] = reader.read(7);
+            }
+            endpoints[0].pBit = reader.read(1);
+            endpoints[1].pBit = reader.read(1);
+
+            std::array<Texel, 16> palette = getBc7Palette(endpoints[0], endpoints[1]);
+            for(uint32_t i = 0; i < 16; ++i)
+                block[i] = palette[reader.read(i == 0 ? 3 : 4)];
+            break;
+        }
+        }
+        return block;
+    }
+
+    uint32_t getKeptChannelCount(Format format, uint32_t channels)
+    {
+        switch(format)
+        {
+        case Format::BC1: return std::min(channels, 3u);
+        case Format::BC4: return 1;
+        case Format::BC5: return std::min(channels, 2u);
+        case Format::BC7: return channels;
+        }
+        return 0;
+    }
+}
+
+uint32_t getBlockSize(Format format)
+{
+    return format == Format::BC1 || format == Format::BC4 ? 8 : 16;
+}
+
+Layout getLayout(uint32_t width, uint32_t height, Format format, uint32_t levelCount)
+{
+    if(levelCount == 0)
+        levelCount = MipGenerate::getLevelCount(width, height);
+
+    const uint32_t blockSize = getBlockSize(format);
+    Layout layout = {.format = format, .levels = {}, .size = 0};
+    layout.levels.reserve(levelCount);
+    for(uint32_t level = 0; level < levelCount; ++level)
+    {
+        const uint32_t blocksWide = (std::max(width >> level, 1u) + 3) / 4;
+        const uint32_t blocksHigh = (std::max(height >> level, 1u) + 3) / 4;
+
+        MipGenerate::Level& current = layout.levels.emplace_back();
+        current.width = blocksWide * 4;
+        current.height = blocksHigh * 4;
+        current.offset = AlignTo(layout.size, MipGenerate::PLACEMENT_ALIGNMENT);
+        current.rowPitch = AlignTo(blocksWide * blockSize, MipGenerate::ROW_PITCH_ALIGNMENT);
+        layout.size = current.offset + current.rowPitch * (blocksHigh - 1) + blocksWide * blockSize;
+    }
+    return layout;
+}
+
+void compress(
+    const char* source,
+    const MipGenerate::Layout& sourceLayout,
+    const Layout& layout,
+    char* destination,
+    ThreadPool& pool)
+{
+    assert(sourceLayout.levels.size() == layout.levels.size());
+    assert(layout.format != Format::BC5 || sourceLayout.channels >= 2);
+
+    const uint32_t blockSize = getBlockSize(layout.format);
+    for(uint32_t level = 0; level < layout.levels.size(); ++level)
+    {
+        const MipGenerate::Level& from = sourceLayout.levels[level];
+        const MipGenerate::Level& to = layout.levels[level];
+        const uint8_t* input = (const uint8_t*)source + from.offset;
+        pool.parallelFor(
+            to.height / 4,
+            BLOCK_ROWS_PER_TASK,
+            [&](uint32_t begin, uint32_t end)
+            {
+                for(uint32_t blockY = begin; blockY < end; ++blockY)
+                {
+                    char* output = destination + to.offset + blockY * to.rowPitch;
+                    for(uint32_t blockX = 0; blockX < to.width / 4; ++blockX, output += blockSize)
+                    {
+                        Block block = loadBlock(input, from, sourceLayout.channels, blockX, blockY);
+                        switch(layout.format)
+                        {
+                        case Format::BC1:
+                        {
+                            uint64_t encoded = encodeBc1(block);
+                            std::memcpy(output, &encoded, sizeof(encoded));
+                            break;
+                        }
+                        case Format::BC4:
+                        {
+                            uint64_t encoded = encodeBc4(block, 0);
+                            std::memcpy(output, &encoded, sizeof(encoded));
+                            break;
+                        }
+                        case Format::BC5:
+                        {
+                            std::array<uint64_t, 2> encoded = {encodeBc4(block, 0), encodeBc4(block, 1)};
+                            std::memcpy(output, encoded.data(), sizeof(encoded));
+                            break;
+                        }
+                        case Format::BC7:
+                        {
+                            std::array<uint64_t, 2> encoded = encodeBc7(block);
+                            std::memcpy(output, encoded.data(), sizeof(encoded));
+                            break;
+                        }
+                        }
+                    }
+                }
+            });
+    }
+}
+
+float measurePsnr(
+    const char* source,
+    const MipGenerate::Layout& sourceLayout,
+    const Layout& layout,
+    const char* compressed)
+{
+    const uint32_t blockSize = getBlockSize(layout.format);
+    const uint32_t channelCount = getKeptChannelCount(layout.format, sourceLayout.channels);
+    double squaredError = 0.0;
+    uint64_t sampleCount = 0;
+    for(uint32_t level = 0; level < layout.levels.size(); ++level)
+    {
+        const MipGenerate::Level& from = sourceLayout.levels[level];
+        const MipGenerate::Level& to = layout.levels[level];
+        const uint8_t* input = (const uint8_t*)source + from.offset;
+        for(uint32_t blockY = 0; blockY < to.height / 4; ++blockY)
+        {
+            for(uint32_t blockX = 0; blockX < to.width / 4; ++blockX)
+            {
+                Block original = loadBlock(input, from, sourceLayout.channels, blockX, blockY);
+                Block decoded =
+                    decodeBlock(compressed + to.offset + blockY * to.rowPitch + blockX * blockSize, layout.format);
+                for(uint32_t i = 0; i < 16; ++i)
+                {
+                    // Texels past the edge are only there to fill the block
+                    if(blockX * 4 + i % 4 >= from.width || blockY * 4 + i / 4 >= from.height)
+                        continue;
+
+                    squaredError += getDistance(original[i], decoded[i], channelCount);
+                    sampleCount += channelCount;
+                }
+            }
+        }
+    }
+
+    if(squaredError == 0.0)
+        return std::numeric_limits<float>::infinity();
+
+    return float(10.0 * std::log10(255.0 * 255.0 / (squaredError / sampleCount)));
+}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <asset/mip_generate.hpp>
+#include <util/thread_pool.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Block compression of uncompressed mip chains into the BC formats the GPU samples directly. Every 4x4 block
+// is encoded on its own from a principal axis fit of its texels, refined with a least squares pass over the
+// chosen indices
+namespace TextureCompress
+{
+constexpr uint32_t BLOCK_ROWS_PER_TASK = 4;
+
+enum class Format
+{
+    // RGB at 4 bits per texel, alpha is dropped
+    BC1,
+    // One channel at 4 bits per texel
+    BC4,
+    // Two channels at 8 bits per texel, for normals with Z rebuilt in the shader
+    BC5,
+    // RGBA at 8 bits per texel. Only mode 6 is used, a single subset with 4 bit indices
+    BC7,
+};
+
+struct Layout
+{
+    Format format;
+    // Widths and heights are rounded up to whole blocks, which is what the copy footprints want. The row
+    // pitch is per row of blocks
+    std::vector<MipGenerate::Level> levels;
+    // Of the whole chain
+    uint32_t size;
+};
+
+uint32_t getBlockSize(Format format);
+
+// Same placement and pitch alignment as MipGenerate::getLayout
+Layout getLayout(uint32_t width, uint32_t height, Format format, uint32_t levelCount = 0);
+
+// Compresses every level of `source`, laid out by `sourceLayout` which needs the same level count as
+// `layout`. BC4 takes the first channel, BC5 the first two and BC1 and BC7 all of them, with alpha at 255
+// when there are less than four
+void compress(
+    const char* source,
+    const MipGenerate::Layout& sourceLayout,
+    const Layout& layout,
+    char* destination,
+    ThreadPool& pool = ThreadPool::shared());
+
+// Peak signal to noise ratio in dB over every level, only counting the channels the format keeps
+float measurePsnr(
+    const char* source,
+    const MipGenerate::Layout& sourceLayout,
+    const Layout& layout,
+    const char* compressed);
+}
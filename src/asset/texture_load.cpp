@@ -0,0 +1,132 @@
+#include "texture_load.hpp"
+
+#include <util/blit.hpp>
+#include <util/mapped_file.hpp>
+#include <util/stbi.hpp>
+#include <util/thread_pool.hpp>
+
+#include <cassert>
+#include <vector>
+
+namespace TextureLoad
+{
+namespace
+{
+    AssetRegistry<Image> sharedImages;
+
+    bool packAlpha(const std::filesystem::path& path, uint8_t* destination, uint32_t width, uint32_t height)
+    {
+        std::optional<Image> alpha = load(path, 1);
+        if(!alpha || alpha->width != width || alpha->height != height)
+            return false;
+
+        const size_t pixelCount = (size_t)width * height;
+        for(size_t i = 0; i < pixelCount; ++i)
+            destination[i * 4 + 3] = alpha->pixels.get()[i];
+        return true;
+    }
+}
+
+std::optional<Size> getSize(const std::filesystem::path& path)
+{
+    std::optional<MappedFile> file = MappedFile::open(path);
+    if(!file)
+        return std::nullopt;
+
+    return getSizeFromMemory({file->data(), file->size()});
+}
+
+std::optional<Size> getSizeFromMemory(std::span<const char> encoded)
+{
+    int width;
+    int height;
+    int channels;
+    if(!stbi_info_from_memory((const stbi_uc*)encoded.data(), (int)encoded.size(), &width, &height, &channels))
+        return std::nullopt;
+
+    return Size{(uint32_t)width, (uint32_t)height};
+}
+
+std::optional<Image> load(const std::filesystem::path& path, uint32_t channels)
+{
+    std::optional<MappedFile> file = MappedFile::open(path);
+    if(!file)
+        return std::nullopt;
+
+    return loadFromMemory({file->data(), file->size()}, channels);
+}
+
+std::optional<Image> loadFromMemory(std::span<const char> encoded, uint32_t channels)
+{
+    int width;
+    int height;
+    int sourceChannels;
+    uint8_t* pixels = stbi_load_from_memory(
+        (const stbi_uc*)encoded.data(), (int)encoded.size(), &width, &height, &sourceChannels, (int)channels);
+    if(!pixels)
+        return std::nullopt;
+
+    return Image{{pixels, stbi_image_free}, (uint32_t)width, (uint32_t)height, channels};
+}
+
+SharedImage loadShared(const std::filesystem::path& path, uint32_t channels)
+{
+    return sharedImages.load(
+        path, [&](MappedFile&& file) { return loadFromMemory({file.data(), file.size()}, channels); }, channels);
+}
+
+bool decode(const Request& request)
+{
+    std::optional<Image> image = load(request.path, request.channels);
+    if(!image || image->width != request.width || image->height != request.height)
+        return false;
+    uint8_t* data = image->pixels.get();
+
+    if(request.alphaPath)
+    {
+        assert(request.channels == 4);
+        if(!packAlpha(request.alphaPath.value(), data, request.width, request.height))
+            return false;
+    }
+
+    if(request.mips)
+    {
+        const MipGenerate::Level& first = request.mips->layout.levels[0];
+        assert(first.width == request.width && first.height == request.height && first.offset == 0);
+        assert(request.mips->layout.channels == request.channels);
+        if(!request.compression)
+        {
+            assert(first.rowPitch == request.rowPitch);
+            MipGenerate::generate(
+                data, request.mips->layout, request.mips->content, request.mips->filter, request.destination);
+            return true;
+        }
+
+        std::vector<char> chain(request.mips->layout.size);
+        MipGenerate::generate(data, request.mips->layout, request.mips->content, request.mips->filter, chain.data());
+        TextureCompress::compress(chain.data(), request.mips->layout, *request.compression, request.destination);
+        return true;
+    }
+    assert(!request.compression);
+
+    constexpr Blit::Format FORMATS[] = {Blit::Format::R8, Blit::Format::RG8, Blit::Format::RGB8, Blit::Format::RGBA8};
+    const Blit::Format format = FORMATS[request.channels - 1];
+    Blit::blit(
+        {data, request.width * request.channels, format},
+        {request.destination, request.rowPitch, format},
+        request.width,
+        request.height);
+
+    return true;
+}
+
+std::vector<std::future<bool>> decodeAsync(std::span<const Request> requests)
+{
+    std::vector<std::future<bool>> futures;
+    futures.reserve(requests.size());
+    for(const Request& request : requests)
+        futures.push_back(ThreadPool::shared().submit([request]() { return decode(request); }));
+
+    return futures;
+}
+}
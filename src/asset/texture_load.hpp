@@ -0,0 +1,86 @@
+#pragma once
+
+#include <asset/mip_generate.hpp>
+#include <asset/texture_compress.hpp>
+#include <util/asset_registry.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Image decoding for the demos' textures. Rows are written straight into their pitched place, usually a
+// mapped upload buffer, so there's no intermediate copy to line them up for CopyTextureRegion
+namespace TextureLoad
+{
+struct Mips
+{
+    // Has to start with the image itself, at the request's size, channels and row pitch
+    MipGenerate::Layout layout;
+    MipGenerate::Content content;
+    MipGenerate::Filter filter;
+};
+
+struct Request
+{
+    std::filesystem::path path;
+    // Components per pixel to convert to, 1 to 4 like stbi_load's `desired_channels`
+    uint32_t channels;
+    // The image has to be exactly this size
+    uint32_t width;
+    uint32_t height;
+    // Row `y` goes to destination + y * rowPitch, unless the texture is compressed
+    char* destination;
+    uint32_t rowPitch;
+    // Fills in the rest of the chain below `destination` as well
+    std::optional<Mips> mips;
+    // Block compresses the whole chain into `destination`, the uncompressed one is only kept on the side.
+    // Needs `mips`
+    std::optional<TextureCompress::Layout> compression;
+    // Image of the same size whose first channel replaces alpha, e.g. AO packed into the albedo so a
+    // material samples one texture less. Needs 4 channels
+    std::optional<std::filesystem::path> alphaPath;
+};
+
+struct Size
+{
+    uint32_t width;
+    uint32_t height;
+};
+
+// Tightly packed pixels
+struct Image
+{
+    std::unique_ptr<uint8_t, void (*)(void*)> pixels;
+    uint32_t width;
+    uint32_t height;
+    // As asked for, not what the file has
+    uint32_t channels;
+};
+
+// Only reads the image's header, so only its first pages are faulted in
+std::optional<Size> getSize(const std::filesystem::path& path);
+std::optional<Size> getSizeFromMemory(std::span<const char> encoded);
+
+// Maps the file and decodes it straight from the view, there's no stdio buffering or extra copy of the
+// encoded file, and no path conversion on Windows. `channels` is 1 to 4 like stbi_load's `desired_channels`
+std::optional<Image> load(const std::filesystem::path& path, uint32_t channels);
+// For images that are already in memory, e.g. embedded in another file
+std::optional<Image> loadFromMemory(std::span<const char> encoded, uint32_t channels);
+
+using SharedImage = AssetRegistry<Image>::Handle;
+
+// Same as load() but decodes every file contents only once per channel count, for as long as a handle to it
+// is held. Null if the file can't be decoded
+SharedImage loadShared(const std::filesystem::path& path, uint32_t channels);
+
+// Returns false if the file can't be decoded or isn't the expected size
+bool decode(const Request& request);
+
+// One task per request on the shared pool, so all textures of a material decode next to each other.
+// The destinations have to stay valid until every future is ready
+std::vector<std::future<bool>> decodeAsync(std::span<const Request> requests);
+}
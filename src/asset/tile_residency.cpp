@@ -0,0 +1,421 @@
+#include "tile_residency.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <tuple>
+
+namespace TileResidency
+{
+namespace
+{
+    bool operator==(const TileKey& a, const TileKey& b)
+    {
+        return a.texture == b.texture && a.level == b.level && a.x == b.x && a.y == b.y;
+    }
+
+    uint32_t getTileIndex(float coordinate, uint32_t size, uint32_t tileSize, uint32_t tileCount)
+    {
+        float texel = std::clamp(coordinate, 0.0f, 1.0f) * size;
+        return std::min((uint32_t)texel / tileSize, tileCount - 1);
+    }
+}
+
+TileShape getTileShape(uint32_t texelSize, bool blockCompressed)
+{
+    // In elements, a texel or a 4x4 block
+    TileShape shape;
+    switch(texelSize)
+    {
+    case 1: shape = {256, 256}; break;
+    case 2: shape = {256, 128}; break;
+    case 4: shape = {128, 128}; break;
+    case 8: shape = {128, 64}; break;
+    case 16: shape = {64, 64}; break;
+    default: assert(false && "Not a size D3D12 has a standard tile shape for"); shape = {64, 64}; break;
+    }
+
+    if(blockCompressed)
+        return {shape.width * 4, shape.height * 4};
+    return shape;
+}
+
+Residency::Residency(uint32_t slotCount, uint32_t maxLoadsPerUpdate): maxLoadsPerUpdate(maxLoadsPerUpdate)
+{
+    slots.resize(slotCount, {{}, 0, INVALID_SLOT, INVALID_SLOT, SlotState::FREE});
+    // Popped from the back, so the slots are handed out in order
+    for(uint32_t i = slotCount; i > 0; --i)
+        freeSlots.push_back(i - 1);
+}
+
+Residency::PageTableEntry& Residency::getEntry(const TileKey& key)
+{
+    const Level& level = textures[key.texture].levels[key.level];
+    return pageTable[level.firstEntry + key.y * level.tileCountX + key.x];
+}
+
+const Residency::PageTableEntry& Residency::getEntry(const TileKey& key) const
+{
+    const Level& level = textures[key.texture].levels[key.level];
+    return pageTable[level.firstEntry + key.y * level.tileCountX + key.x];
+}
+
+void Residency::unlink(uint32_t slot)
+{
+    Slot& unlinked = slots[slot];
+    if(unlinked.previous != INVALID_SLOT)
+        slots[unlinked.previous].next = unlinked.next;
+    else
+        head = unlinked.next;
+    if(unlinked.next != INVALID_SLOT)
+        slots[unlinked.next].previous = unlinked.previous;
+    else
+        tail = unlinked.previous;
+
+    unlinked.previous = INVALID_SLOT;
+    unlinked.next = INVALID_SLOT;
+}
+
+void Residency::pushFront(uint32_t slot)
+{
+    slots[slot].previous = INVALID_SLOT;
+    slots[slot].next = head;
+    if(head != INVALID_SLOT)
+        slots[head].previous = slot;
+    else
+        tail = slot;
+    head = slot;
+}
+
+uint32_t Residency::takeSlot(std::vector<Eviction>& evictions)
+{
+    if(!freeSlots.empty())
+    {
+        uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+
+    // Everything in the list was requested this frame, evicting any of it would just load it again next frame
+    if(tail == INVALID_SLOT || slots[tail].lastUsedFrame == frame)
+        return INVALID_SLOT;
+
+    uint32_t slot = tail;
+    unlink(slot);
+    getEntry(slots[slot].key).slot = INVALID_SLOT;
+    slots[slot].state = SlotState::FREE;
+    evictions.push_back({slots[slot].key, slot});
+    return slot;
+}
+
+uint32_t Residency::addTexture(uint32_t width, uint32_t height, uint32_t levelCount, TileShape shape)
+{
+    const uint32_t textureIndex = (uint32_t)textures.size();
+    Texture& texture = textures.emplace_back();
+    texture.shape = shape;
+    texture.tailLevel = levelCount;
+    for(uint32_t i = 0; i < levelCount; ++i)
+    {
+        uint32_t levelWidth = std::max(width >> i, 1u);
+        uint32_t levelHeight = std::max(height >> i, 1u);
+        if(levelWidth < shape.width || levelHeight < shape.height)
+        {
+            // The tail is a single entry
+            texture.tailLevel = i;
+            texture.levels.push_back({levelWidth, levelHeight, 1, 1, (uint32_t)pageTable.size()});
+            pageTable.push_back({INVALID_SLOT, 0});
+            break;
+        }
+
+        Level level = {
+            levelWidth,
+            levelHeight,
+            (levelWidth + shape.width - 1) / shape.width,
+            (levelHeight + shape.height - 1) / shape.height,
+            (uint32_t)pageTable.size(),
+        };
+        texture.levels.push_back(level);
+        pageTable.resize(pageTable.size() + level.tileCountX * level.tileCountY, {INVALID_SLOT, 0});
+    }
+    assert(texture.tailLevel < levelCount);
+
+    const TileKey key = {textureIndex, texture.tailLevel, 0, 0};
+    uint32_t slot = takeSlot(tailEvictions);
+    assert(slot != INVALID_SLOT && "Every slot is in use, there's no room for another tail");
+    slots[slot].key = key;
+    slots[slot].lastUsedFrame = frame;
+    slots[slot].state = SlotState::PENDING;
+    getEntry(key).slot = slot;
+    tailLoads.push_back({key, slot});
+
+    return textureIndex;
+}
+
+uint32_t Residency::getTailLevel(uint32_t texture) const
+{
+    return textures[texture].tailLevel;
+}
+
+uint32_t Residency::getTileCountX(uint32_t texture, uint32_t level) const
+{
+    return textures[texture].levels[std::min(level, textures[texture].tailLevel)].tileCountX;
+}
+
+uint32_t Residency::getTileCountY(uint32_t texture, uint32_t level) const
+{
+    return textures[texture].levels[std::min(level, textures[texture].tailLevel)].tileCountY;
+}
+
+void Residency::request(TileKey key)
+{
+    const Texture& texture = textures[key.texture];
+    if(key.level >= texture.tailLevel)
+        key = {key.texture, texture.tailLevel, 0, 0};
+
+    // Walks up until it meets a tile that was already requested this frame, which has had its parents
+    // requested too
+    while(true)
+    {
+        const Level& level = texture.levels[key.level];
+        key.x = std::min(key.x, level.tileCountX - 1);
+        key.y = std::min(key.y, level.tileCountY - 1);
+        PageTableEntry& entry = getEntry(key);
+        if(entry.requestedFrame == frame)
+            return;
+
+        entry.requestedFrame = frame;
+        ++frameStats.requestedTiles;
+        if(entry.slot == INVALID_SLOT)
+        {
+            ++frameStats.missingTiles;
+            missing.push_back(key);
+        }
+        else if(slots[entry.slot].state == SlotState::RESIDENT)
+        {
+            slots[entry.slot].lastUsedFrame = frame;
+            unlink(entry.slot);
+            pushFront(entry.slot);
+        }
+
+        if(key.level == texture.tailLevel)
+            return;
+        key = {key.texture, key.level + 1, key.x / 2, key.y / 2};
+    }
+}
+
+void Residency::request(uint32_t texture, uint32_t level, float uMin, float vMin, float uMax, float vMax)
+{
+    const Texture& requested = textures[texture];
+    level = std::min(level, requested.tailLevel);
+    const Level& info = requested.levels[level];
+    const uint32_t firstX = getTileIndex(uMin, info.width, requested.shape.width, info.tileCountX);
+    const uint32_t lastX = getTileIndex(uMax, info.width, requested.shape.width, info.tileCountX);
+    const uint32_t firstY = getTileIndex(vMin, info.height, requested.shape.height, info.tileCountY);
+    const uint32_t lastY = getTileIndex(vMax, info.height, requested.shape.height, info.tileCountY);
+    for(uint32_t y = firstY; y <= lastY; ++y)
+    {
+        for(uint32_t x = firstX; x <= lastX; ++x)
+            request({texture, level, x, y});
+    }
+}
+
+Update Residency::update()
+{
+    Update result;
+    result.loads = std::move(tailLoads);
+    result.evictions = std::move(tailEvictions);
+    tailLoads.clear();
+    tailEvictions.clear();
+
+    // Coarse to fine, and in a fixed order within a level so runs are repeatable
+    std::sort(
+        missing.begin(),
+        missing.end(),
+        [](const TileKey& a, const TileKey& b)
+        {
+            if(a.level != b.level)
+                return a.level > b.level;
+            return std::tie(a.texture, a.y, a.x) < std::tie(b.texture, b.y, b.x);
+        });
+
+    uint32_t loadCount = 0;
+    for(const TileKey& key : missing)
+    {
+        // Left for a later frame, they'll be requested again if they're still needed
+        if(loadCount == maxLoadsPerUpdate)
+            break;
+
+        uint32_t slot = takeSlot(result.evictions);
+        if(slot == INVALID_SLOT)
+        {
+            frameStats.starvedLoads = (uint32_t)missing.size() - loadCount;
+            break;
+        }
+
+        slots[slot].key = key;
+        slots[slot].lastUsedFrame = frame;
+        slots[slot].state = SlotState::PENDING;
+        getEntry(key).slot = slot;
+        result.loads.push_back({key, slot});
+        ++loadCount;
+    }
+    missing.clear();
+
+    frameStats.loads = (uint32_t)result.loads.size();
+    frameStats.evictions = (uint32_t)result.evictions.size();
+    frameStats.residentTiles = 0;
+    frameStats.pendingTiles = 0;
+    for(const Slot& slot : slots)
+    {
+        frameStats.residentTiles += slot.state == SlotState::RESIDENT || slot.state == SlotState::PINNED;
+        frameStats.pendingTiles += slot.state == SlotState::PENDING;
+    }
+    lastStats = frameStats;
+    frameStats = {};
+    ++frame;
+
+    return result;
+}
+
+void Residency::complete(const Load& load)
+{
+    Slot& slot = slots[load.slot];
+    assert(slot.state == SlotState::PENDING && slot.key == load.key);
+    if(load.key.level == textures[load.key.texture].tailLevel)
+    {
+        slot.state = SlotState::PINNED;
+        return;
+    }
+
+    slot.state = SlotState::RESIDENT;
+    slot.lastUsedFrame = frame;
+    pushFront(load.slot);
+}
+
+uint32_t Residency::getSlot(TileKey key) const
+{
+    const Texture& texture = textures[key.texture];
+    if(key.level >= texture.tailLevel)
+        key = {key.texture, texture.tailLevel, 0, 0};
+
+    uint32_t slot = getEntry(key).slot;
+    if(slot == INVALID_SLOT || slots[slot].state == SlotState::PENDING)
+        return INVALID_SLOT;
+    return slot;
+}
+
+uint32_t Residency::getResidentLevel(uint32_t texture, uint32_t level, float u, float v) const
+{
+    const Texture& sampled = textures[texture];
+    for(uint32_t i = level; i < sampled.tailLevel; ++i)
+    {
+        const Level& info = sampled.levels[i];
+        TileKey key = {
+            texture,
+            i,
+            getTileIndex(u, info.width, sampled.shape.width, info.tileCountX),
+            getTileIndex(v, info.height, sampled.shape.height, info.tileCountY),
+        };
+        if(getSlot(key) != INVALID_SLOT)
+            return i;
+    }
+
+    return std::max(level, sampled.tailLevel);
+}
+
+void Residency::getResidentLevels(uint32_t texture, std::span<uint8_t> levels) const
+{
+    const Texture& sampled = textures[texture];
+    const Level& first = sampled.levels[0];
+    assert(levels.size() >= first.tileCountX * first.tileCountY);
+    for(uint32_t y = 0; y < first.tileCountY; ++y)
+    {
+        for(uint32_t x = 0; x < first.tileCountX; ++x)
+        {
+            uint32_t resident = sampled.tailLevel;
+            // Tile shapes are powers of two, so a tile's parent is always at half its index
+            for(uint32_t i = 0; i < sampled.tailLevel; ++i)
+            {
+                const Level& info = sampled.levels[i];
+                TileKey key = {
+                    texture, i, std::min(x >> i, info.tileCountX - 1), std::min(y >> i, info.tileCountY - 1)};
+                if(getSlot(key) != INVALID_SLOT)
+                {
+                    resident = i;
+                    break;
+                }
+            }
+            levels[y * first.tileCountX + x] = (uint8_t)resident;
+        }
+    }
+}
+
+bool Residency::validate() const
+{
+    std::vector<bool> seen(slots.size(), false);
+    for(uint32_t slot : freeSlots)
+    {
+        if(slot >= slots.size() || seen[slot] || slots[slot].state != SlotState::FREE)
+            return false;
+        seen[slot] = true;
+    }
+
+    // Every slot in use is in the page table under its own key, and the other way around
+    uint32_t usedEntries = 0;
+    for(uint32_t i = 0; i < textures.size(); ++i)
+    {
+        const Texture& texture = textures[i];
+        for(uint32_t level = 0; level <= texture.tailLevel; ++level)
+        {
+            const Level& info = texture.levels[level];
+            for(uint32_t y = 0; y < info.tileCountY; ++y)
+            {
+                for(uint32_t x = 0; x < info.tileCountX; ++x)
+                {
+                    const TileKey key = {i, level, x, y};
+                    uint32_t slot = getEntry(key).slot;
+                    if(slot == INVALID_SLOT)
+                        continue;
+                    if(slot >= slots.size() || slots[slot].state == SlotState::FREE || !(slots[slot].key == key))
+                        return false;
+                    ++usedEntries;
+                }
+            }
+        }
+    }
+
+    uint32_t usedSlots = 0;
+    uint32_t residentSlots = 0;
+    for(uint32_t i = 0; i < slots.size(); ++i)
+    {
+        if(slots[i].state == SlotState::FREE)
+        {
+            if(!seen[i])
+                return false;
+            continue;
+        }
+        if(seen[i])
+            return false;
+        ++usedSlots;
+        residentSlots += slots[i].state == SlotState::RESIDENT;
+    }
+    if(usedSlots != usedEntries)
+        return false;
+
+    // The LRU list holds exactly the resident slots, most recently used first
+    uint32_t listed = 0;
+    uint32_t previous = INVALID_SLOT;
+    for(uint32_t slot = head; slot != INVALID_SLOT; slot = slots[slot].next)
+    {
+        if(slots[slot].state != SlotState::RESIDENT || slots[slot].previous != previous)
+            return false;
+        if(previous != INVALID_SLOT && slots[previous].lastUsedFrame < slots[slot].lastUsedFrame)
+            return false;
+        if(++listed > residentSlots)
+            return false;
+        previous = slot;
+    }
+
+    return listed == residentSlots && tail == previous;
+}
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Bookkeeping for textures streamed in 64KB tiles, the size D3D12 maps reserved resources in. Tiles that get
+// requested are given a slot of a fixed size pool, the least recently requested ones are evicted to make room,
+// and the page table says where every resident tile lives. Nothing in here touches the GPU or the disk, the
+// caller does the loads and the tile mappings from what update() hands out
+namespace TileResidency
+{
+// D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES
+constexpr uint32_t TILE_SIZE = 64 * 1024;
+constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+// Texels covered by one tile, the standard swizzle shapes
+struct TileShape
+{
+    uint32_t width;
+    uint32_t height;
+};
+
+// `texelSize` bytes per texel, or per 4x4 block for block compressed formats
+TileShape getTileShape(uint32_t texelSize, bool blockCompressed);
+
+struct TileKey
+{
+    uint32_t texture;
+    uint32_t level;
+    uint32_t x;
+    uint32_t y;
+};
+
+// Fill pool slot `slot` with the tile, then call complete()
+struct Load
+{
+    TileKey key;
+    uint32_t slot;
+};
+
+// The tile is gone from the page table already, its slot is about to be reused by one of the loads
+struct Eviction
+{
+    TileKey key;
+    uint32_t slot;
+};
+
+struct Update
+{
+    // Coarsest levels first, so there's always something to fall back to
+    std::vector<Load> loads;
+    std::vector<Eviction> evictions;
+};
+
+struct Stats
+{
+    // Of the last update, every tile counts once no matter how often it was requested
+    uint32_t requestedTiles;
+    uint32_t missingTiles;
+    uint32_t loads;
+    uint32_t evictions;
+    // Loads that couldn't start because every slot was in use this frame or waiting on a load
+    uint32_t starvedLoads;
+
+    uint32_t residentTiles;
+    uint32_t pendingTiles;
+};
+
+class Residency
+{
+    enum class SlotState : uint8_t
+    {
+        FREE,
+        PENDING,
+        RESIDENT,
+        // Packed mip tails, never evicted
+        PINNED,
+    };
+
+    struct Slot
+    {
+        TileKey key;
+        uint32_t lastUsedFrame;
+        // LRU list of the resident slots, most recently used at the head
+        uint32_t previous;
+        uint32_t next;
+        SlotState state;
+    };
+
+    struct PageTableEntry
+    {
+        uint32_t slot;
+        uint32_t requestedFrame;
+    };
+
+    struct Level
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t tileCountX;
+        uint32_t tileCountY;
+        uint32_t firstEntry;
+    };
+
+    struct Texture
+    {
+        TileShape shape;
+        // Levels from this one down are smaller than a tile and packed into a single one, like D3D12's packed
+        // mips. The tail is loaded as level `tailLevel`, tile 0 0
+        uint32_t tailLevel;
+        std::vector<Level> levels;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<Texture> textures;
+    std::vector<PageTableEntry> pageTable;
+    std::vector<TileKey> missing;
+    // From addTexture, handed out with the next update
+    std::vector<Load> tailLoads;
+    std::vector<Eviction> tailEvictions;
+    uint32_t head = INVALID_SLOT;
+    uint32_t tail = INVALID_SLOT;
+    uint32_t frame = 1;
+    uint32_t maxLoadsPerUpdate;
+    Stats frameStats = {};
+    Stats lastStats = {};
+
+    PageTableEntry& getEntry(const TileKey& key);
+    const PageTableEntry& getEntry(const TileKey& key) const;
+    void unlink(uint32_t slot);
+    void pushFront(uint32_t slot);
+    uint32_t takeSlot(std::vector<Eviction>& evictions);
+
+  public:
+    Residency(uint32_t slotCount, uint32_t maxLoadsPerUpdate);
+
+    // Takes a pinned slot for the mip tail right away, its load comes out of the next update. `levelCount`
+    // has to go down to a level smaller than a tile
+    uint32_t addTexture(uint32_t width, uint32_t height, uint32_t levelCount, TileShape shape);
+
+    uint32_t getTailLevel(uint32_t texture) const;
+    uint32_t getTileCountX(uint32_t texture, uint32_t level) const;
+    uint32_t getTileCountY(uint32_t texture, uint32_t level) const;
+
+    // Marks the tile and every coarser one under it as needed this frame. Levels in the tail map to the tail
+    void request(TileKey key);
+    // Every tile of `level` the UV rectangle touches, in [0, 1] and clamped to it
+    void request(uint32_t texture, uint32_t level, float uMin, float vMin, float uMax, float vMax);
+
+    // Ends the frame. Loads what was requested and isn't resident yet, evicting what went unrequested the
+    // longest if there are no free slots
+    Update update();
+    // The load's data is in its slot and can be sampled
+    void complete(const Load& load);
+
+    // INVALID_SLOT unless the tile is resident
+    uint32_t getSlot(TileKey key) const;
+    // Finest level at or above `level` that has the tile under (u, v) resident. That's the level to clamp
+    // sampling to. The tail is the last resort, nothing should sample the texture before it's loaded
+    uint32_t getResidentLevel(uint32_t texture, uint32_t level, float u, float v) const;
+    // getResidentLevel for every tile of level 0, row by row, for a min LOD clamp texture
+    void getResidentLevels(uint32_t texture, std::span<uint8_t> levels) const;
+
+    const Stats& stats() const
+    {
+        return lastStats;
+    }
+
+    // Walks the page table, the slots and the LRU list and checks they agree. For tools and tests, it's slow
+    bool validate() const;
+};
+}
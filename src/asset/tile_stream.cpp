@@ -0,0 +1,152 @@
+#include "tile_stream.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace TileStream
+{
+namespace
+{
+    // Bytes per texel, or per 4x4 block, and texels per element on a side
+    struct Element
+    {
+        uint32_t size;
+        uint32_t texels;
+    };
+
+    Element getElement(const TextureCache::Header& header)
+    {
+        if(header.compressed)
+            return {TextureCompress::getBlockSize(header.compressionFormat), 4};
+        return {header.channels, 1};
+    }
+}
+
+TileResidency::TileShape getTileShape(const TextureCache::Header& header)
+{
+    assert(header.compressed || header.channels != 3);
+    return TileResidency::getTileShape(getElement(header).size, header.compressed);
+}
+
+uint32_t getTailSize(const TextureCache::Header& header, uint32_t tailLevel)
+{
+    assert(tailLevel < header.levelCount);
+    return header.payloadSize - header.levels[tailLevel].offset;
+}
+
+void readTile(
+    const TextureCache::CookedTexture& texture,
+    TileResidency::TileShape shape,
+    uint32_t level,
+    uint32_t x,
+    uint32_t y,
+    char* destination)
+{
+    const Element element = getElement(texture.header());
+    const MipGenerate::Level& source = texture.levels()[level];
+    const uint32_t tileColumns = shape.width / element.texels;
+    const uint32_t tileRows = shape.height / element.texels;
+    const uint32_t tileRowSize = tileColumns * element.size;
+    assert(tileRowSize * tileRows == TileResidency::TILE_SIZE);
+
+    // Cooked compressed levels are already whole blocks
+    const uint32_t firstColumn = x * tileColumns;
+    const uint32_t firstRow = y * tileRows;
+    const uint32_t levelColumns = (source.width + element.texels - 1) / element.texels;
+    const uint32_t levelRows = (source.height + element.texels - 1) / element.texels;
+    assert(firstColumn < levelColumns && firstRow < levelRows);
+    const uint32_t columns = std::min(tileColumns, levelColumns - firstColumn);
+    const uint32_t rows = std::min(tileRows, levelRows - firstRow);
+
+    const char* origin = texture.payload() + source.offset + (size_t)firstRow * source.rowPitch +
+                         (size_t)firstColumn * element.size;
+    const uint32_t rowSize = columns * element.size;
+    for(uint32_t row = 0; row < rows; ++row)
+    {
+        char* target = destination + (size_t)row * tileRowSize;
+        std::memcpy(target, origin + (size_t)row * source.rowPitch, rowSize);
+        std::memset(target + rowSize, 0, tileRowSize - rowSize);
+    }
+    std::memset(destination + (size_t)rows * tileRowSize, 0, (size_t)(tileRows - rows) * tileRowSize);
+}
+
+void readTail(const TextureCache::CookedTexture& texture, uint32_t tailLevel, char* destination)
+{
+    const uint32_t size = getTailSize(texture.header(), tailLevel);
+    assert(size <= TileResidency::TILE_SIZE && "The mip tail doesn't fit a tile");
+    std::memcpy(destination, texture.payload() + texture.levels()[tailLevel].offset, size);
+    std::memset(destination + size, 0, TileResidency::TILE_SIZE - size);
+}
+
+Streamer::Streamer(TileResidency::Residency& residency, std::span<char> slotMemory, ThreadPool& pool):
+    residency(residency), slotMemory(slotMemory), pool(pool)
+{
+}
+
+Streamer::~Streamer()
+{
+    wait();
+}
+
+uint32_t Streamer::addTexture(const TextureCache::CookedTexture& texture)
+{
+    const TextureCache::Header& header = texture.header();
+    uint32_t index = residency.addTexture(header.width, header.height, header.levelCount, getTileShape(header));
+    assert(index == textures.size());
+    textures.push_back(&texture);
+    return index;
+}
+
+TileResidency::Update Streamer::update()
+{
+    std::erase_if(
+        pending,
+        [](const std::future<void>& future)
+        { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+
+    TileResidency::Update update = residency.update();
+    for(const TileResidency::Load& load : update.loads)
+    {
+        assert(((size_t)load.slot + 1) * TileResidency::TILE_SIZE <= slotMemory.size());
+        // Nothing that belongs to the residency is touched off this thread
+        const TextureCache::CookedTexture& texture = *textures[load.key.texture];
+        const bool tail = load.key.level == residency.getTailLevel(load.key.texture);
+        pending.push_back(pool.submit(
+            [this, load, &texture, tail]()
+            {
+                char* destination = slotMemory.data() + (size_t)load.slot * TileResidency::TILE_SIZE;
+                if(tail)
+                    readTail(texture, load.key.level, destination);
+                else
+                    readTile(
+                        texture,
+                        getTileShape(texture.header()),
+                        load.key.level,
+                        load.key.x,
+                        load.key.y,
+                        destination);
+
+                std::lock_guard lock(mutex);
+                finished.push_back(load);
+            }));
+    }
+
+    return update;
+}
+
+std::vector<TileResidency::Load> Streamer::collect()
+{
+    std::lock_guard lock(mutex);
+    return std::exchange(finished, {});
+}
+
+void Streamer::wait()
+{
+    for(std::future<void>& future : pending)
+        future.wait();
+    pending.clear();
+}
+}
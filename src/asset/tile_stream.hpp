@@ -0,0 +1,69 @@
+#pragma once
+
+#include <asset/texture_cache.hpp>
+#include <asset/tile_residency.hpp>
+#include <util/thread_pool.hpp>
+
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <span>
+#include <vector>
+
+// Reads the tiles TileResidency asks for out of cooked textures, on the thread pool. Each load lands in its
+// slot of a staging area with one TILE_SIZE slot per pool tile, laid out for CopyTiles with
+// D3D12_TILE_COPY_FLAG_LINEAR_BUFFER_TO_SWIZZLED_TILED_RESOURCE. Only the pages of the mapped file a tile
+// covers are ever touched, so textures that are never looked at closely never have their top levels read
+namespace TileStream
+{
+// Standard tile shape of the cooked format. Three channel textures have no tiled D3D12 format
+TileResidency::TileShape getTileShape(const TextureCache::Header& header);
+
+// The levels from `tailLevel` down are copied as they are in the cooked payload, so level i sits at
+// levels[i].offset - levels[tailLevel].offset in the slot, already at a valid footprint for CopyTextureRegion
+uint32_t getTailSize(const TextureCache::Header& header, uint32_t tailLevel);
+
+// Tile (x, y) of `level` as block rows one after the other, parts past the edge of the level are zeroed.
+// `destination` is TILE_SIZE bytes
+void readTile(
+    const TextureCache::CookedTexture& texture,
+    TileResidency::TileShape shape,
+    uint32_t level,
+    uint32_t x,
+    uint32_t y,
+    char* destination);
+
+void readTail(const TextureCache::CookedTexture& texture, uint32_t tailLevel, char* destination);
+
+class Streamer
+{
+    TileResidency::Residency& residency;
+    std::span<char> slotMemory;
+    ThreadPool& pool;
+    std::vector<const TextureCache::CookedTexture*> textures;
+    std::vector<std::future<void>> pending;
+    std::mutex mutex;
+    std::vector<TileResidency::Load> finished;
+
+  public:
+    // `slotMemory` holds TILE_SIZE bytes for every slot of `residency`, usually a mapped upload buffer
+    Streamer(TileResidency::Residency& residency, std::span<char> slotMemory, ThreadPool& pool = ThreadPool::shared());
+    Streamer(const Streamer&) = delete;
+    Streamer& operator=(const Streamer&) = delete;
+    ~Streamer();
+
+    // Adds it to the residency as well, under the index it returns. `texture` has to outlive the streamer
+    uint32_t addTexture(const TextureCache::CookedTexture& texture);
+
+    // residency.update(), with its loads started in the background. The evictions are handed back for the
+    // caller to unmap, the loads to map once their data has been copied out of the staging slots
+    TileResidency::Update update();
+
+    // Loads whose data is in their staging slot since the last call. They're still pending in the
+    // residency, the caller completes them once the GPU copy they feed has finished
+    std::vector<TileResidency::Load> collect();
+
+    // Until every load started so far is in its slot
+    void wait();
+};
+}
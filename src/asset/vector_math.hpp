@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cmath>
+
+#include <DirectXMath.h>
+
+// Scalar helpers for the offline mesh code, which works on the XMFLOAT storage types directly
+namespace VectorMath
+{
+inline DirectX::XMFLOAT3 add(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+{
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+inline DirectX::XMFLOAT3 sub(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+{
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+inline DirectX::XMFLOAT3 scale(const DirectX::XMFLOAT3& a, float factor)
+{
+    return {a.x * factor, a.y * factor, a.z * factor};
+}
+
+inline DirectX::XMFLOAT3 cross(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline float dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline float length(const DirectX::XMFLOAT3& a)
+{
+    return std::sqrt(dot(a, a));
+}
+
+// Zero length vectors are returned as is
+inline DirectX::XMFLOAT3 normalize(const DirectX::XMFLOAT3& a)
+{
+    float aLength = length(a);
+    return aLength > 0.0f ? scale(a, 1.0f / aLength) : a;
+}
+}
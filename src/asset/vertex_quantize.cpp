@@ -0,0 +1,270 @@
+#include "vertex_quantize.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace VertexQuantize
+{
+namespace
+{
+    float length(const DirectX::XMFLOAT3& v)
+    {
+        return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    }
+
+    DirectX::XMFLOAT3 normalize(const DirectX::XMFLOAT3& v)
+    {
+        float len = length(v);
+        if(len == 0.0f)
+            return {0.0f, 0.0f, 1.0f};
+        return {v.x / len, v.y / len, v.z / len};
+    }
+
+    float angleBetween(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        // acos of the dot product can't resolve anything below ~3e-4 radians in float, which is more than the
+        // whole error of the octahedral encoding
+        DirectX::XMFLOAT3 cross{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+        return std::atan2(length(cross), a.x * b.x + a.y * b.y + a.z * b.z);
+    }
+
+    float signNotZero(float value)
+    {
+        return value >= 0.0f ? 1.0f : -1.0f;
+    }
+}
+
+uint16_t encodeUnorm16(float value)
+{
+    return (uint16_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+float decodeUnorm16(uint16_t value)
+{
+    return value / 65535.0f;
+}
+
+int16_t encodeSnorm16(float value)
+{
+    return (int16_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+float decodeSnorm16(int16_t value)
+{
+    // -32768 and -32767 both map to -1, same as the GPU
+    return std::max(value / 32767.0f, -1.0f);
+}
+
+uint16_t encodeHalf(float value)
+{
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    uint32_t exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    // NaN and infinity
+    if(exponent == 0xFF)
+        return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+
+    int32_t halfExponent = (int32_t)exponent - 127 + 15;
+    if(halfExponent >= 0x1F)
+        return sign | 0x7C00;
+
+    if(halfExponent <= 0)
+    {
+        // Too small even for a denormal
+        if(halfExponent < -10)
+            return sign;
+
+        // Denormal, shift in the implicit bit and round to nearest even
+        mantissa |= 0x800000;
+        uint32_t shift = 14 - halfExponent;
+        uint32_t halfMantissa = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if(remainder > halfway || (remainder == halfway && (halfMantissa & 1)))
+            ++halfMantissa;
+        return sign | (uint16_t)halfMantissa;
+    }
+
+    uint32_t half = ((uint32_t)halfExponent << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFF;
+    // Round to nearest even, a carry into the exponent is still correct
+    if(remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        ++half;
+    return sign | (uint16_t)half;
+}
+
+float decodeHalf(uint16_t value)
+{
+    uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+
+    if(exponent == 0)
+    {
+        // Zero or denormal, 2^-24 is the smallest denormal
+        float magnitude = mantissa * (1.0f / 16777216.0f);
+        return sign ? -magnitude : magnitude;
+    }
+    if(exponent == 0x1F)
+        return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+
+    return std::bit_cast<float>(sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+}
+
+std::array<int16_t, 2> encodeOctahedral(const DirectX::XMFLOAT3& normal)
+{
+    float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    float x = normal.x / sum;
+    float y = normal.y / sum;
+
+    // Fold the lower hemisphere over the diagonals
+    if(normal.z < 0.0f)
+    {
+        float foldedX = (1.0f - std::abs(y)) * signNotZero(x);
+        float foldedY = (1.0f - std::abs(x)) * signNotZero(y);
+        x = foldedX;
+        y = foldedY;
+    }
+
+    return {encodeSnorm16(x), encodeSnorm16(y)};
+}
+
+DirectX::XMFLOAT3 decodeOctahedral(const std::array<int16_t, 2>& encoded)
+{
+    // Same as octahedralDecode in vs/normal_mapping_quantized.hlsl
+    float x = decodeSnorm16(encoded[0]);
+    float y = decodeSnorm16(encoded[1]);
+    float z = 1.0f - std::abs(x) - std::abs(y);
+
+    float t = std::clamp(-z, 0.0f, 1.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    return normalize({x, y, z});
+}
+
+PositionRange getPositionRange(std::span<const Mesh> meshes)
+{
+    DirectX::XMFLOAT3 min{0.0f, 0.0f, 0.0f};
+    DirectX::XMFLOAT3 max{0.0f, 0.0f, 0.0f};
+    bool first = true;
+    for(const Mesh& mesh : meshes)
+    {
+        for(const DirectX::XMFLOAT3& position : mesh.positions)
+        {
+            if(std::exchange(first, false))
+                min = max = position;
+            min = {std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z)};
+            max = {std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z)};
+        }
+    }
+
+    return {min, {max.x - min.x, max.y - min.y, max.z - min.z}};
+}
+
+void encodePositions(
+    std::span<const DirectX::XMFLOAT3> positions,
+    const PositionRange& range,
+    std::array<uint16_t, 4>* destination)
+{
+    // Flat axes would divide by zero, any scale works since every position is at min anyway
+    auto inverseExtent = [](float extent) { return extent > 0.0f ? 1.0f / extent : 0.0f; };
+    DirectX::XMFLOAT3 scale{
+        inverseExtent(range.extent.x),
+        inverseExtent(range.extent.y),
+        inverseExtent(range.extent.z),
+    };
+
+    for(const DirectX::XMFLOAT3& position : positions)
+    {
+        *destination++ = {
+            encodeUnorm16((position.x - range.min.x) * scale.x),
+            encodeUnorm16((position.y - range.min.y) * scale.y),
+            encodeUnorm16((position.z - range.min.z) * scale.z),
+            65535,
+        };
+    }
+}
+
+void encodeUvs(std::span<const DirectX::XMFLOAT2> uvs, std::array<uint16_t, 2>* destination)
+{
+    for(const DirectX::XMFLOAT2& uv : uvs)
+        *destination++ = {encodeHalf(uv.x), encodeHalf(uv.y)};
+}
+
+void encodeDirections(std::span<const DirectX::XMFLOAT3> directions, std::array<int16_t, 2>* destination)
+{
+    for(const DirectX::XMFLOAT3& direction : directions)
+        *destination++ = encodeOctahedral(normalize(direction));
+}
+
+QuantizedStreams quantize(const Mesh& mesh)
+{
+    QuantizedStreams streams;
+
+    PositionRange range = getPositionRange(std::span(&mesh, 1));
+    streams.positionMin = range.min;
+    streams.positionExtent = range.extent;
+
+    const uint32_t vertexCount = mesh.vertexCount();
+    streams.positions.resize(vertexCount);
+    streams.uvs.resize(vertexCount);
+    streams.normals.resize(vertexCount);
+    streams.tangents.resize(vertexCount);
+    encodePositions(mesh.positions, range, streams.positions.data());
+    encodeUvs(mesh.uvs, streams.uvs.data());
+    encodeDirections(mesh.normals, streams.normals.data());
+    encodeDirections(mesh.tangents, streams.tangents.data());
+
+    return streams;
+}
+
+Mesh dequantize(const QuantizedStreams& streams)
+{
+    Mesh mesh;
+
+    const uint32_t vertexCount = (uint32_t)streams.positions.size();
+    mesh.positions.resize(vertexCount);
+    mesh.uvs.resize(vertexCount);
+    mesh.normals.resize(vertexCount);
+    mesh.tangents.resize(vertexCount);
+    for(uint32_t i = 0; i < vertexCount; ++i)
+    {
+        const auto& position = streams.positions[i];
+        mesh.positions[i] = {
+            streams.positionMin.x + decodeUnorm16(position[0]) * streams.positionExtent.x,
+            streams.positionMin.y + decodeUnorm16(position[1]) * streams.positionExtent.y,
+            streams.positionMin.z + decodeUnorm16(position[2]) * streams.positionExtent.z,
+        };
+        mesh.uvs[i] = {decodeHalf(streams.uvs[i][0]), decodeHalf(streams.uvs[i][1])};
+        mesh.normals[i] = decodeOctahedral(streams.normals[i]);
+        mesh.tangents[i] = decodeOctahedral(streams.tangents[i]);
+    }
+
+    return mesh;
+}
+
+Error measureError(const Mesh& mesh, const QuantizedStreams& streams)
+{
+    Mesh decoded = dequantize(streams);
+
+    Error error{0.0f, 0.0f, 0.0f, 0.0f};
+    for(uint32_t i = 0; i < mesh.vertexCount(); ++i)
+    {
+        const auto& a = mesh.positions[i];
+        const auto& b = decoded.positions[i];
+        error.position = std::max({error.position, std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z)});
+        error.uv = std::max(
+            {error.uv, std::abs(mesh.uvs[i].x - decoded.uvs[i].x), std::abs(mesh.uvs[i].y - decoded.uvs[i].y)});
+        error.normal = std::max(error.normal, angleBetween(mesh.normals[i], decoded.normals[i]));
+        error.tangent = std::max(error.tangent, angleBetween(mesh.tangents[i], decoded.tangents[i]));
+    }
+
+    return error;
+}
+}
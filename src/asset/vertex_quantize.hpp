@@ -0,0 +1,80 @@
+#pragma once
+
+#include <asset/mesh.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <DirectXMath.h>
+
+// Compact vertex encoding, 20 bytes per vertex instead of 44:
+// - Positions as R16G16B16A16_UNORM relative to the mesh AABB (the 4th component is padding)
+// - UVs as R16G16_FLOAT
+// - Normals and tangents octahedral encoded as R16G16_SNORM
+// Decoding is off by at most half a unorm step of the AABB per position axis, half a half-float ulp per UV
+// component, which is 2^-11 of its magnitude, and MAX_DIRECTION_ERROR for normals and tangents
+namespace VertexQuantize
+{
+// In radians, the largest seen over 20M random directions was 6.5e-5
+constexpr float MAX_DIRECTION_ERROR = 1e-4f;
+
+struct QuantizedStreams
+{
+    // position = positionMin + unorm * positionExtent
+    DirectX::XMFLOAT3 positionMin;
+    DirectX::XMFLOAT3 positionExtent;
+
+    std::vector<std::array<uint16_t, 4>> positions;
+    std::vector<std::array<uint16_t, 2>> uvs;
+    std::vector<std::array<int16_t, 2>> normals;
+    std::vector<std::array<int16_t, 2>> tangents;
+};
+
+// position = min + unorm * extent
+struct PositionRange
+{
+    DirectX::XMFLOAT3 min;
+    DirectX::XMFLOAT3 extent;
+};
+
+// Largest difference between the source mesh and a decoded quantized mesh
+struct Error
+{
+    float position;
+    float uv;
+    // In radians
+    float normal;
+    float tangent;
+};
+
+uint16_t encodeUnorm16(float value);
+float decodeUnorm16(uint16_t value);
+int16_t encodeSnorm16(float value);
+float decodeSnorm16(int16_t value);
+
+uint16_t encodeHalf(float value);
+float decodeHalf(uint16_t value);
+
+// `normal` must be normalized
+std::array<int16_t, 2> encodeOctahedral(const DirectX::XMFLOAT3& normal);
+DirectX::XMFLOAT3 decodeOctahedral(const std::array<int16_t, 2>& encoded);
+
+// Bounds of the positions of every mesh, so they can share one range
+PositionRange getPositionRange(std::span<const Mesh> meshes);
+
+// One stream at a time, straight into wherever it ends up. `destination` needs room for the whole stream.
+// Normals and tangents are normalized before encoding
+void encodePositions(
+    std::span<const DirectX::XMFLOAT3> positions,
+    const PositionRange& range,
+    std::array<uint16_t, 4>* destination);
+void encodeUvs(std::span<const DirectX::XMFLOAT2> uvs, std::array<uint16_t, 2>* destination);
+void encodeDirections(std::span<const DirectX::XMFLOAT3> directions, std::array<int16_t, 2>* destination);
+
+QuantizedStreams quantize(const Mesh& mesh);
+Mesh dequantize(const QuantizedStreams& streams);
+
+Error measureError(const Mesh& mesh, const QuantizedStreams& streams);
+}
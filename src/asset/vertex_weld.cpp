@@ -0,0 +1,234 @@
+#include "vertex_weld.hpp"
+
+#include <util/thread_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <vector>
+
+namespace VertexWeld
+{
+namespace
+{
+    constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+    constexpr uint32_t GRAIN = 1 << 14;
+
+    // position, uv, normal, tangent
+    using Key = std::array<int64_t, 3 + 2 + 3 + 3>;
+
+    // Keys are rebuilt from the streams whenever they're needed instead of being stored, which
+    // would take 88 bytes per vertex
+    struct KeyBuilder
+    {
+        const Mesh& mesh;
+        // 0 means exact comparison
+        float inverseEpsilon;
+
+        int64_t component(float value) const
+        {
+            if(inverseEpsilon == 0.0f)
+                return value == 0.0f ? 0 : std::bit_cast<uint32_t>(value);
+
+            return std::llround((double)value * inverseEpsilon);
+        }
+
+        Key operator()(uint32_t vertex) const
+        {
+            const DirectX::XMFLOAT3& position = mesh.positions[vertex];
+            const DirectX::XMFLOAT2& uv = mesh.uvs[vertex];
+            const DirectX::XMFLOAT3& normal = mesh.normals[vertex];
+            const DirectX::XMFLOAT3& tangent = mesh.tangents[vertex];
+            return {
+                component(position.x),
+                component(position.y),
+                component(position.z),
+                component(uv.x),
+                component(uv.y),
+                component(normal.x),
+                component(normal.y),
+                component(normal.z),
+                component(tangent.x),
+                component(tangent.y),
+                component(tangent.z),
+            };
+        }
+    };
+
+    uint64_t hashKey(const Key& key)
+    {
+        uint64_t hash = 0;
+        for(int64_t component : key)
+        {
+            hash ^= (uint64_t)component;
+            hash *= 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+
+    template<typename T>
+    std::vector<T> gather(ThreadPool& pool, const std::vector<T>& source, const std::vector<uint32_t>& vertices)
+    {
+        std::vector<T> result(vertices.size());
+        pool.parallelFor(
+            (uint32_t)vertices.size(),
+            GRAIN,
+            [&](uint32_t begin, uint32_t end)
+            {
+                for(uint32_t i = begin; i < end; ++i)
+                    result[i] = source[vertices[i]];
+            });
+        return result;
+    }
+}
+
+Stats weld(Mesh& mesh, float epsilon, ThreadPool& pool)
+{
+    uint32_t vertexCount = mesh.vertexCount();
+    if(vertexCount == 0)
+        return {0, 0};
+
+    KeyBuilder keyOf{mesh, epsilon > 0.0f ? 1.0f / epsilon : 0.0f};
+
+    std::vector<uint64_t> hashes(vertexCount);
+    pool.parallelFor(
+        vertexCount,
+        GRAIN,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t vertex = begin; vertex < end; ++vertex)
+                hashes[vertex] = hashKey(keyOf(vertex));
+        });
+
+    // Open addressing with linear probing. At least half of the slots stay empty so the probe
+    // sequences are short even for millions of vertices
+    size_t slotCount = std::bit_ceil((size_t)vertexCount * 2);
+    size_t slotMask = slotCount - 1;
+    std::vector<std::atomic<uint32_t>> slots(slotCount);
+    pool.parallelFor(
+        (uint32_t)std::min<size_t>(slotCount, UINT32_MAX),
+        GRAIN,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t slot = begin; slot < end; ++slot)
+                slots[slot].store(EMPTY_SLOT, std::memory_order_relaxed);
+        });
+
+    auto isSame = [&](uint32_t a, uint32_t b, const Key& keyB)
+    { return hashes[a] == hashes[b] && keyOf(a) == keyB; };
+
+    // Each group of equal vertices ends up owning one slot which holds the lowest index of the group.
+    // Taking the lowest instead of the first to arrive is what keeps the result deterministic.
+    // Returns false if the slot belongs to a different group
+    auto claim = [&](std::atomic<uint32_t>& slot, uint32_t vertex, const Key& key)
+    {
+        uint32_t occupant = slot.load();
+        // A failed exchange reloads the occupant, so every iteration looks at the latest one
+        while(true)
+        {
+            if(occupant == EMPTY_SLOT)
+            {
+                if(slot.compare_exchange_weak(occupant, vertex))
+                    return true;
+                continue;
+            }
+
+            if(!isSame(occupant, vertex, key))
+                return false;
+            if(occupant < vertex || slot.compare_exchange_weak(occupant, vertex))
+                return true;
+        }
+    };
+
+    pool.parallelFor(
+        vertexCount,
+        GRAIN,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t vertex = begin; vertex < end; ++vertex)
+            {
+                Key key = keyOf(vertex);
+                size_t slot = hashes[vertex] & slotMask;
+                while(!claim(slots[slot], vertex, key))
+                    slot = (slot + 1) & slotMask;
+            }
+        });
+
+    std::vector<uint32_t> remap(vertexCount);
+    pool.parallelFor(
+        vertexCount,
+        GRAIN,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t vertex = begin; vertex < end; ++vertex)
+            {
+                Key key = keyOf(vertex);
+                for(size_t slot = hashes[vertex] & slotMask;; slot = (slot + 1) & slotMask)
+                {
+                    uint32_t occupant = slots[slot].load(std::memory_order_relaxed);
+                    if(isSame(occupant, vertex, key))
+                    {
+                        remap[vertex] = occupant;
+                        break;
+                    }
+                }
+            }
+        });
+
+    // The lowest index of a group always comes first, so its new index is known by the time the rest
+    // of the group is reached
+    std::vector<uint32_t> uniqueVertices;
+    for(uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        if(remap[vertex] == vertex)
+        {
+            remap[vertex] = (uint32_t)uniqueVertices.size();
+            uniqueVertices.push_back(vertex);
+        }
+        else
+            remap[vertex] = remap[remap[vertex]];
+    }
+
+    uint32_t uniqueCount = (uint32_t)uniqueVertices.size();
+    if(uniqueCount == vertexCount)
+        return {vertexCount, vertexCount};
+
+    mesh.positions = gather(pool, mesh.positions, uniqueVertices);
+    mesh.uvs = gather(pool, mesh.uvs, uniqueVertices);
+    mesh.normals = gather(pool, mesh.normals, uniqueVertices);
+    mesh.tangents = gather(pool, mesh.tangents, uniqueVertices);
+
+    pool.parallelFor(
+        mesh.indexCount(),
+        GRAIN,
+        [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t i = begin; i < end; ++i)
+                mesh.indices[i] = remap[mesh.indices[i]];
+        });
+
+    // Exact welding only merges identical vertices, so it can't create new degenerate triangles
+    if(epsilon > 0.0f)
+    {
+        uint32_t keptCount = 0;
+        for(uint32_t i = 0; i + 2 < mesh.indexCount(); i += 3)
+        {
+            uint32_t a = mesh.indices[i];
+            uint32_t b = mesh.indices[i + 1];
+            uint32_t c = mesh.indices[i + 2];
+            if(a == b || b == c || c == a)
+                continue;
+
+            mesh.indices[keptCount++] = a;
+            mesh.indices[keptCount++] = b;
+            mesh.indices[keptCount++] = c;
+        }
+        mesh.indices.resize(keptCount);
+    }
+
+    return {vertexCount, uniqueCount};
+}
+}
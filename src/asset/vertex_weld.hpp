@@ -0,0 +1,23 @@
+#pragma once
+
+#include <asset/mesh.hpp>
+#include <util/thread_pool.hpp>
+
+#include <cstdint>
+
+// Merges vertices whose whole tuple (position, uv, normal, tangent) is the same and remaps the
+// indices. Exporters tend to split vertices per face, so this usually shrinks every vertex stream
+namespace VertexWeld
+{
+struct Stats
+{
+    uint32_t verticesBefore;
+    uint32_t verticesAfter;
+};
+
+// With `epsilon` 0 the components have to be bitwise equal (apart from -0 and 0). Otherwise every
+// component is snapped to a grid of `epsilon`, so close vertices in neighbouring cells are still
+// kept apart. Triangles that collapse because of the snapping are dropped.
+// Which vertex of a group survives doesn't depend on the number of threads
+Stats weld(Mesh& mesh, float epsilon = 0.0f, ThreadPool& pool = ThreadPool::shared());
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <graphics/dx12/versioning.hpp>
+#include <util/copy_batch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <d3d12.h>
+
+// Collects the copies of a load instead of recording each one as it comes, along with the state every destination
+// has to end up in. flush() merges buffer copies that continue one another into a single CopyBufferRegion, orders
+// texture copies by texture and subresource, and finishes with one ResourceBarrier call that has a single barrier
+// per resource, however many times it was asked to transition
+class CopyBatcher
+{
+  public:
+    struct Stats
+    {
+        uint32_t requestedCopyCount;
+        uint32_t copyCount;
+        // One per transition() call, what recording every request as it came would have issued
+        uint32_t requestedBarrierCount;
+        uint32_t barrierCount;
+    };
+
+  private:
+    struct TextureCopy
+    {
+        ID3D12Resource* destination;
+        uint32_t subresource;
+        ID3D12Resource* source;
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+    };
+
+    std::vector<CopyBatch::BufferCopy<ID3D12Resource*>> bufferCopies;
+    std::vector<TextureCopy> textureCopies;
+    std::vector<CopyBatch::Transition<ID3D12Resource*, D3D12_RESOURCE_STATES>> transitions;
+
+  public:
+    void copyBuffer(
+        ID3D12Resource* destination,
+        uint64_t destinationOffset,
+        ID3D12Resource* source,
+        uint64_t sourceOffset,
+        uint64_t size)
+    {
+        bufferCopies.push_back({destination, destinationOffset, source, sourceOffset, size});
+    }
+
+    // The whole subresource, from a placed footprint in `source`
+    void copyTexture(
+        ID3D12Resource* destination,
+        uint32_t subresource,
+        ID3D12Resource* source,
+        const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint)
+    {
+        textureCopies.push_back({destination, subresource, source, footprint});
+    }
+
+    // Once everything is copied, every subresource of `resource` goes from COPY_DEST to `after`. There's no barrier
+    // before the copies, the first one promotes the resource from COMMON to COPY_DEST
+    void transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES after)
+    {
+        transitions.push_back({resource, after});
+    }
+
+    // Records everything collected since the last flush
+    Stats flush(ID3D12GraphicsCommandList* commandList)
+    {
+        Stats stats = {};
+        stats.requestedCopyCount = (uint32_t)(bufferCopies.size() + textureCopies.size());
+        stats.requestedBarrierCount = (uint32_t)transitions.size();
+        CopyBatch::dedupe(transitions);
+
+        CopyBatch::coalesce(bufferCopies);
+        for(const auto& copy : bufferCopies)
+        {
+            commandList->CopyBufferRegion(
+                copy.destination, copy.destinationOffset, copy.source, copy.sourceOffset, copy.size);
+        }
+
+        // Keeps the copies into one texture together, the order between them doesn't matter
+        std::stable_sort(
+            textureCopies.begin(),
+            textureCopies.end(),
+            [](const TextureCopy& a, const TextureCopy& b)
+            {
+                if(a.destination != b.destination)
+                    return std::less<ID3D12Resource*>{}(a.destination, b.destination);
+                return a.subresource < b.subresource;
+            });
+        for(const TextureCopy& copy : textureCopies)
+        {
+            commandList->CopyTextureRegion(
+                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
+                    .pResource = copy.destination,
+                    .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+                    .SubresourceIndex = copy.subresource,
+                }),
+                0,
+                0,
+                0,
+                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
+                    .pResource = copy.source,
+                    .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+                    .PlacedFootprint = copy.footprint,
+                }),
+                nullptr);
+        }
+        stats.copyCount = (uint32_t)(bufferCopies.size() + textureCopies.size());
+
+        std::vector<D3D12_RESOURCE_BARRIER> barriers;
+        for(const auto& transition : transitions)
+        {
+            barriers.push_back({
+                .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+                .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+                .Transition =
+                    {
+                        .pResource = transition.resource,
+                        .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                        .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
+                        .StateAfter = transition.after,
+                    },
+            });
+        }
+        if(!barriers.empty())
+            commandList->ResourceBarrier((UINT)barriers.size(), barriers.data());
+        stats.barrierCount = (uint32_t)barriers.size();
+
+        bufferCopies.clear();
+        textureCopies.clear();
+        transitions.clear();
+        return stats;
+    }
+};
@@ -3,10 +3,12 @@
 #include <array>
 #include <cstdint>
 #include <numeric>
+#include <vector>
 
+#include <asset/index_format.hpp>
 #include <graphics/dx12/versioning.hpp>
 #include <util/align.hpp>
-#include <util/offset_counter.hpp>
+#include <util/upload_layout.hpp>
 
 #include <DirectXMath.h>
 #include <SimpleMath.h>
@@ -28,13 +30,32 @@ namespace DEMO_NAME
 
     constexpr DirectX::SimpleMath::Vector3 CAMERA_POSITION{0.0f, 0.0f, -3.0f};
 
-    struct Vertex
+    // Everything with a size that's known up front, laid out at compile time at the start of the upload buffer
+    struct StaticUpload
     {
-        DirectX::SimpleMath::Vector3 position;
-        DirectX::SimpleMath::Vector2 uv;
-        DirectX::SimpleMath::Vector3 normal;
-        DirectX::SimpleMath::Vector3 tangent;
+        UploadRegion<DirectX::XMFLOAT4X4> cbvTransform0;
+        UploadRegion<DirectX::XMFLOAT4X4> cbvTransform1;
+        UploadRegion<DirectX::XMFLOAT4X4> cbvViewProjection;
+        UploadRegion<char> textureAlbedo;
+        UploadRegion<char> textureAmbient;
+        UploadRegion<char> textureNormal;
+        uint32_t size;
     };
+    constexpr StaticUpload STATIC_UPLOAD = []
+    {
+        UploadLayout layout;
+        // clang-format off
+        return StaticUpload{
+            .cbvTransform0 = layout.add<DirectX::XMFLOAT4X4>(1, 256),
+            .cbvTransform1 = layout.add<DirectX::XMFLOAT4X4>(1, 256),
+            .cbvViewProjection = layout.add<DirectX::XMFLOAT4X4>(1, 256),
+            .textureAlbedo = layout.add<char>(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT),
+            .textureAmbient = layout.add<char>(AlignTo(TEXTURE_WIDTH, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT),
+            .textureNormal = layout.add<char>(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT),
+            .size = layout.getSize(),
+        };
+        // clang-format on
+    }();
 
     struct State
     {
@@ -97,35 +118,19 @@ namespace DEMO_NAME
             ID3DBlobS pixelBlob;
         } shaders;
 
+        // After STATIC_UPLOAD
         struct
         {
-            uint32_t VERTEX_POSITION_OFFSET = -1;
-            uint32_t VERTEX_POSITION_SIZE = -1;
-            uint32_t VERTEX_UV_OFFSET = -1;
-            uint32_t VERTEX_UV_SIZE = -1;
-            uint32_t VERTEX_NORMAL_OFFSET = -1;
-            uint32_t VERTEX_NORMAL_SIZE = -1;
-            uint32_t VERTEX_TANGENT_OFFSET = -1;
-            uint32_t VERTEX_TANGENT_SIZE = -1;
-            uint32_t INDEX_OFFSET = -1;
-            uint32_t INDEX_SIZE = -1;
-            uint32_t CBV_TRANSFORM_0_OFFSET = -1;
-            uint32_t CBV_TRANSFORM_0_SIZE = -1;
-            uint32_t CBV_TRANSFORM_1_OFFSET = -1;
-            uint32_t CBV_TRANSFORM_1_SIZE = -1;
-            uint32_t CBV_VIEWPROJ_OFFSET = -1;
-            uint32_t CBV_VIEWPROJ_SIZE = -1;
-            uint32_t TEXTURE_ALBEDO_OFFSET = -1;
-            uint32_t TEXTURE_ALBEDO_SIZE = -1;
-            uint32_t TEXTURE_AMBIENT_OFFSET = -1;
-            uint32_t TEXTURE_AMBIENT_SIZE = -1;
-            uint32_t TEXTURE_NORMAL_OFFSET = -1;
-            uint32_t TEXTURE_NORMAL_SIZE = -1;
-            uint32_t UPLOAD_BUFFER_SIZE = -1;
-        } constants;
-
-        std::vector<uint32_t> indexData;
-        std::vector<Vertex> vertexData;
+            UploadRegion<DirectX::XMFLOAT3> vertexPosition;
+            UploadRegion<DirectX::XMFLOAT2> vertexUv;
+            UploadRegion<DirectX::XMFLOAT3> vertexNormal;
+            UploadRegion<DirectX::XMFLOAT3> vertexTangent;
+            UploadRegion<char> index;
+            uint32_t size;
+        } upload;
+
+        DXGI_FORMAT indexFormat;
+        std::vector<IndexFormat::Batch> indexBatches;
     };
 
     void init(HWND hWnd, uint32_t windowWidth, uint32_t windowHeight);
@@ -6,7 +6,9 @@
 #include <array>
 #include <cstring>
 #include <dxgiformat.h>
+#include <future>
 #include <iostream>
+#include <vector>
 
 #include <SimpleMath.h>
 #include <comdef.h>
@@ -23,7 +25,9 @@
 
 #include <util/file_util.hpp>
 #include <util/path.hpp>
-#include <util/stbi.hpp>
+
+#include <asset/texture_atlas.hpp>
+#include <asset/texture_load.hpp>
 
 static dx12_demo::DEMO_NAME::State state;
 
@@ -155,47 +159,11 @@ namespace DEMO_NAME
                 Out(state.commandList)));
         }
 
-        uint32_t textureRowPitch;
-        std::vector<char> textureData;
-        {
-            auto catPath = Path::getRandomCat();
-
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), catPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_rgb_alpha), // everything will break if this is
-                                                                                    // changed from STBI_rgb_alpha :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                return stbiData;
-            }();
-
-            textureRowPitch = AlignTo(TEXTURE_WIDTH * 4, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
-
-            textureData.resize(textureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureData.data() + textureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 4 * i,
-                    TEXTURE_WIDTH * 4);
-        }
+        // Every cat goes into its own slice of one array, so all of them are drawn with a single SRV
+        const TextureAtlas::ArrayLayout textureLayout =
+            TextureAtlas::getArrayLayout(TEXTURE_WIDTH, TEXTURE_HEIGHT, TEXTURE_CHANNELS, TEXTURE_SLICE_COUNT);
+        assert(
+            state.constants.UPLOAD_TEXTURE_OFFSET + textureLayout.size <= state.constants.UPLOAD_CBV_VIEWPROJ_OFFSET);
 
         {
             device->CreateCommittedResource(
@@ -229,6 +197,24 @@ namespace DEMO_NAME
                 Out(state.resources.uploadBuffer));
         }
 
+        // The cats decode on the worker pool straight into their slices while the rest is created
+        void* uploadBufferDataPointer;
+        state.resources.uploadBuffer->Map(0, nullptr, &uploadBufferDataPointer);
+        std::vector<TextureLoad::Request> textureRequests;
+        for(uint32_t slice = 0; slice < TEXTURE_SLICE_COUNT; ++slice)
+        {
+            textureRequests.push_back({
+                .path = Path::getCat(slice),
+                .channels = TEXTURE_CHANNELS,
+                .width = TEXTURE_WIDTH,
+                .height = TEXTURE_HEIGHT,
+                .destination = (char*)uploadBufferDataPointer + state.constants.UPLOAD_TEXTURE_OFFSET
+                               + textureLayout.slices[slice].offset,
+                .rowPitch = textureLayout.slices[slice].rowPitch,
+            });
+        }
+        std::vector<std::future<bool>> textureDecodes = TextureLoad::decodeAsync(textureRequests);
+
         {
             device->CreateCommittedResource(
                 as_lvalue(D3D12_HEAP_PROPERTIES{
@@ -334,7 +320,7 @@ namespace DEMO_NAME
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
                     .Width = TEXTURE_WIDTH,
                     .Height = TEXTURE_HEIGHT,
-                    .DepthOrArraySize = 1, // Mandatory
+                    .DepthOrArraySize = TEXTURE_SLICE_COUNT,
                     .MipLevels = 1,
                     .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
                     .SampleDesc =
@@ -351,6 +337,7 @@ namespace DEMO_NAME
         }
 
         {
+            // The default view of an array is a Texture2DArray over every slice
             device->CreateShaderResourceView(
                 state.resources.texture.Get(),
                 nullptr,
@@ -358,9 +345,6 @@ namespace DEMO_NAME
         }
 
         {
-            void* uploadBufferDataPointer;
-            state.resources.uploadBuffer->Map(0, nullptr, &uploadBufferDataPointer);
-
             uint32_t i = 0;
             for(const auto [position, uv] : vertices)
             {
@@ -400,10 +384,12 @@ namespace DEMO_NAME
                 &viewProjectionMatrix,
                 sizeof(viewProjectionMatrix));
 
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.UPLOAD_TEXTURE_OFFSET,
-                textureData.data(),
-                textureData.size());
+            // Last chance before the copies are recorded
+            for(std::future<bool>& decode : textureDecodes)
+            {
+                [[maybe_unused]] bool decoded = decode.get();
+                assert(decoded);
+            }
             state.resources.uploadBuffer->Unmap(0, nullptr);
 
             // TODO: Implicit transition?
@@ -439,31 +425,36 @@ namespace DEMO_NAME
                 state.resources.uploadBuffer.Get(),
                 state.constants.UPLOAD_INDEX_OFFSET,
                 sizeof(indexData));
-            state.commandList->CopyTextureRegion(
-                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
-                    .pResource = state.resources.texture.Get(),
-                    .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
-                    .SubresourceIndex = 0,
-                }),
-                0,
-                0,
-                0,
-                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
-                    .pResource = state.resources.uploadBuffer.Get(),
-                    .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
-                    .PlacedFootprint =
-                        D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
-                            .Offset = state.constants.UPLOAD_TEXTURE_OFFSET,
-                            .Footprint =
-                                D3D12_SUBRESOURCE_FOOTPRINT{
-                                    .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
-                                    .Width = TEXTURE_WIDTH,
-                                    .Height = TEXTURE_HEIGHT,
-                                    .Depth = 1,
-                                    .RowPitch = textureRowPitch,
-                                },
-                        }}),
-                nullptr);
+            // With a single mip every slice is its own subresource
+            for(uint32_t slice = 0; slice < TEXTURE_SLICE_COUNT; ++slice)
+            {
+                const MipGenerate::Level& footprint = textureLayout.slices[slice];
+                state.commandList->CopyTextureRegion(
+                    as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
+                        .pResource = state.resources.texture.Get(),
+                        .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+                        .SubresourceIndex = slice,
+                    }),
+                    0,
+                    0,
+                    0,
+                    as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
+                        .pResource = state.resources.uploadBuffer.Get(),
+                        .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+                        .PlacedFootprint =
+                            D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
+                                .Offset = state.constants.UPLOAD_TEXTURE_OFFSET + footprint.offset,
+                                .Footprint =
+                                    D3D12_SUBRESOURCE_FOOTPRINT{
+                                        .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+                                        .Width = footprint.width,
+                                        .Height = footprint.height,
+                                        .Depth = 1,
+                                        .RowPitch = footprint.rowPitch,
+                                    },
+                            }}),
+                    nullptr);
+            }
 
             // Note: resource has been promoted into COPY_DEST
             state.commandList->ResourceBarrier(
@@ -474,7 +465,7 @@ namespace DEMO_NAME
                     .Transition =
                         {
                             .pResource = state.resources.texture.Get(),
-                            .Subresource = 0,
+                            .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
                             .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
                             .StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
                         },
@@ -559,13 +550,14 @@ namespace DEMO_NAME
         }
 
         {
-            std::vector vertexShaderCode = FileUtil::readFile(Path::getShaderPath("vs/cubed_cat.bin")).value();
+            std::vector vertexShaderCode =
+                FileUtil::readFile(Path::getShaderPath("vs/cubed_cat_instanced.bin")).value();
             Die(D3DCreateBlob(vertexShaderCode.size(), state.shaders.vertexBlob.GetAddressOf()));
             std::memcpy(state.shaders.vertexBlob->GetBufferPointer(), vertexShaderCode.data(), vertexShaderCode.size());
         }
 
         {
-            std::vector pixelShaderCode = FileUtil::readFile(Path::getShaderPath("ps/spinning_cat.bin")).value();
+            std::vector pixelShaderCode = FileUtil::readFile(Path::getShaderPath("ps/cubed_cat.bin")).value();
             Die(D3DCreateBlob(pixelShaderCode.size(), state.shaders.pixelBlob.GetAddressOf()));
             std::memcpy(state.shaders.pixelBlob->GetBufferPointer(), pixelShaderCode.data(), pixelShaderCode.size());
         }
@@ -744,7 +736,8 @@ namespace DEMO_NAME
 
         state.commandList->SetDescriptorHeaps(1, state.heaps.srv.GetAddressOf());
         state.commandList->SetGraphicsRootDescriptorTable(2, state.heaps.srv->GetGPUDescriptorHandleForHeapStart());
-        state.commandList->DrawIndexedInstanced(indexData.size(), 1, 0, 0, 0);
+        // One cube per cat, the vertex shader picks the slice and the place from the instance ID
+        state.commandList->DrawIndexedInstanced(indexData.size(), TEXTURE_SLICE_COUNT, 0, 0, 0);
 
         state.commandList->ResourceBarrier(
             1,
@@ -5,6 +5,7 @@
 
 #include <graphics/dx12/versioning.hpp>
 #include <util/align.hpp>
+#include <util/path.hpp>
 
 #include <DirectXMath.h>
 #include <SimpleMath.h>
@@ -22,6 +23,7 @@ namespace DEMO_NAME
     constexpr uint32_t TEXTURE_WIDTH = 512;
     constexpr uint32_t TEXTURE_HEIGHT = 512;
     constexpr uint32_t TEXTURE_CHANNELS = 4;
+    constexpr uint32_t TEXTURE_SLICE_COUNT = Path::CAT_COUNT;
 
     constexpr DirectX::SimpleMath::Vector3 CAMERA_POSITION{0.0f, 0.0f, -5.0f};
 
@@ -136,7 +138,7 @@ namespace DEMO_NAME
             uint32_t UPLOAD_INDEX_OFFSET =          AlignTo256(UPLOAD_VERTEX_UV_OFFSET       + sizeof(DirectX::XMFLOAT2) * vertices.size());
             uint32_t UPLOAD_CBV_TRANSFORM_OFFSET =  AlignTo256(UPLOAD_INDEX_OFFSET           + sizeof(indexData));
             uint32_t UPLOAD_TEXTURE_OFFSET =        AlignTo(   UPLOAD_CBV_TRANSFORM_OFFSET   + sizeof(DirectX::XMFLOAT4X4), D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
-            uint32_t UPLOAD_CBV_VIEWPROJ_OFFSET =   AlignTo256(UPLOAD_TEXTURE_OFFSET         + AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT);
+            uint32_t UPLOAD_CBV_VIEWPROJ_OFFSET =   AlignTo256(UPLOAD_TEXTURE_OFFSET         + AlignTo(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) * TEXTURE_SLICE_COUNT);
             uint32_t UPLOAD_BUFFER_SIZE =           AlignTo256(UPLOAD_CBV_VIEWPROJ_OFFSET    + sizeof(DirectX::XMFLOAT4X4));
             // clang-format on
         } constants;
@@ -0,0 +1,1144 @@
+#define XSTR(x) #x
+#define STR(x) XSTR(x)
+#include STR(DEMO_NAME.hpp)
+
+#include <array>
+#include <cstring>
+#include <dxgiformat.h>
+#include <iostream>
+#include <tuple>
+
+#include <DirectXMath.h>
+#include <SimpleMath.h>
+#include <comdef.h>
+#include <d3d12.h>
+#include <d3dcommon.h>
+#include <d3dcompiler.h>
+#include <dxgi.h>
+#include <dxgi1_2.h>
+
+#include <graphics/dx12/blend_state.hpp>
+#include <graphics/dx12/depth_stencil_state.hpp>
+#include <graphics/dx12/rasterizer_state.hpp>
+#include <graphics/dx12/versioning.hpp>
+
+#include <util/blit.hpp>
+#include <util/file_util.hpp>
+#include <util/path.hpp>
+
+#include <asset/texture_load.hpp>
+
+#include <asset/mesh_cache.hpp>
+
+static dx12_demo::DEMO_NAME::State state;
+
+namespace SimpleMath = DirectX::SimpleMath;
+
+namespace dx12_demo
+{
+namespace DEMO_NAME
+{
+    void init(HWND hWnd, uint32_t windowWidth, uint32_t windowHeight)
+    {
+        State state{};
+
+        // Cooks cube.glb on the first run, after that it's just a mapped file
+        MeshCache::CookedMesh mesh = MeshCache::loadOrCook(Path::getAssetPath("cube.glb")).value();
+        {
+            const MeshCache::Header& meshHeader = mesh.header();
+            state.indexFormat = meshHeader.indexStride == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+            state.indexBatches = mesh.fullDetailBatches();
+
+            UploadLayout layout{STATIC_UPLOAD.size};
+            // clang-format off
+            state.upload = {
+                .vertexPosition = layout.add<DirectX::XMFLOAT3>(meshHeader.vertexCount),
+                .vertexUv = layout.add<DirectX::XMFLOAT2>(meshHeader.vertexCount),
+                .vertexNormal = layout.add<DirectX::XMFLOAT3>(meshHeader.vertexCount),
+                .vertexTangent = layout.add<DirectX::XMFLOAT3>(meshHeader.vertexCount),
+                .index = layout.add<char>(meshHeader.indexSize),
+                .size = layout.getSize(),
+            };
+            // clang-format on
+        }
+
+        IDXGIFactoryS dxgiFactory;
+
+        UINT factoryFlags = 0;
+#ifdef DEBUG
+        factoryFlags |= DXGI_CREATE_FACTORY_DEBUG;
+#endif
+        Die(CreateDXGIFactory2(factoryFlags, Out(dxgiFactory)));
+
+#ifdef DEBUG
+        ID3D12DebugS debug;
+        Die(D3D12GetDebugInterface(Out(debug)));
+        debug->EnableDebugLayer();
+        debug->SetEnableGPUBasedValidation(true);
+#endif
+
+        IDXGIAdapterS adapter;
+        Die(dxgiFactory->EnumAdapterByGpuPreference(0, DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE, Out(adapter)));
+        Die(D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_12_2, Out(state.device)));
+
+        auto& device = state.device;
+
+        {
+            state.sync.fenceCounter = 0;
+            Die(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, Out(state.sync.flushFence)));
+            state.sync.fenceEventHandle = CreateEvent(nullptr, false, false, nullptr);
+            if(!state.sync.fenceEventHandle)
+                Die(HRESULT_FROM_WIN32(GetLastError()));
+        }
+
+        state.descriptorSizes = {
+            .rtv = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV),
+            .dsv = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV),
+            .cbvSrvUav = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV),
+        };
+
+        {
+            Die(device->CreateCommandQueue(
+                as_lvalue(D3D12_COMMAND_QUEUE_DESC{
+                    .Type = D3D12_COMMAND_LIST_TYPE_DIRECT,
+                    .Priority = 0,
+                    .Flags = D3D12_COMMAND_QUEUE_FLAG_NONE,
+                    .NodeMask = 0,
+
+                }),
+                Out(state.commandQueue)));
+        }
+        auto& commandQueue = state.commandQueue;
+
+        {
+            DXGI_SWAP_CHAIN_DESC1 desc;
+            ComPtr<IDXGISwapChain1> swapChain1;
+
+            Die(dxgiFactory->CreateSwapChainForHwnd(
+                commandQueue.Get(),
+                hWnd,
+                as_lvalue(DXGI_SWAP_CHAIN_DESC1{
+                    .Width = windowWidth,
+                    .Height = windowHeight,
+                    .Format = BACKBUFFER_FORMAT,
+                    .Stereo = FALSE,
+                    .SampleDesc = {.Count = MSAA_COUNT, .Quality = MSAA_QUALITY},
+                    .BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT,
+                    .BufferCount = BACKBUFFER_COUNT,
+                    .Scaling = DXGI_SCALING_STRETCH,
+                    .SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD,
+                    .AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED,
+                    .Flags = 0,
+
+                }),
+                nullptr,
+                nullptr,
+                swapChain1.GetAddressOf()));
+
+            swapChain1.As(&state.swapChain);
+        }
+        auto& swapChain = state.swapChain;
+
+        {
+            Die(device->CreateDescriptorHeap(
+                as_lvalue(D3D12_DESCRIPTOR_HEAP_DESC{
+                    .Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV,
+                    .NumDescriptors = BACKBUFFER_COUNT,
+                    .Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE,
+                    .NodeMask = 0,
+                }),
+                Out(state.heaps.rtv)));
+
+            Die(device->CreateDescriptorHeap(
+                as_lvalue(D3D12_DESCRIPTOR_HEAP_DESC{
+                    .Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+                    .NumDescriptors = 3,
+                    .Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
+                    .NodeMask = 0,
+                }),
+                Out(state.heaps.srv)));
+
+            Die(device->CreateDescriptorHeap(
+                as_lvalue(D3D12_DESCRIPTOR_HEAP_DESC{
+                    .Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV,
+                    .NumDescriptors = 1,
+                    .Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE,
+                    .NodeMask = 0,
+                }),
+                Out(state.heaps.dsv)));
+        }
+
+        auto& descriptorHeapRTV = state.heaps.rtv;
+        {
+            auto heapHandle = descriptorHeapRTV->GetCPUDescriptorHandleForHeapStart();
+            for(uint32_t i{0}; i < BACKBUFFER_COUNT; ++i)
+            {
+                Die(swapChain->GetBuffer(i, Out(state.resources.swapChainBuffers[i])));
+                device->CreateRenderTargetView(state.resources.swapChainBuffers[i].Get(), nullptr, heapHandle);
+                heapHandle.ptr += state.descriptorSizes.rtv;
+            }
+        }
+
+        {
+            Die(device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_DEFAULT,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = windowWidth,
+                    .Height = windowHeight,
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1,
+                    .Format = DEPTH_STENCIL_FORMAT,
+                    .SampleDesc =
+                        {
+                            .Count = MSAA_COUNT,
+                            .Quality = MSAA_QUALITY,
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL,
+                }),
+                D3D12_RESOURCE_STATE_DEPTH_WRITE,
+                as_lvalue(D3D12_CLEAR_VALUE{
+                    .Format = DEPTH_STENCIL_FORMAT,
+                    .DepthStencil =
+                        D3D12_DEPTH_STENCIL_VALUE{
+                            .Depth = 1.0f,
+                            .Stencil = 0,
+                        },
+                }),
+                Out(state.resources.depthStencilBuffer)));
+
+            device->CreateDepthStencilView(
+                state.resources.depthStencilBuffer.Get(),
+                as_lvalue(D3D12_DEPTH_STENCIL_VIEW_DESC{
+                    .Format = DEPTH_STENCIL_FORMAT,
+                    .ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D,
+                    .Flags = D3D12_DSV_FLAG_NONE,
+                    .Texture2D = D3D12_TEX2D_DSV{.MipSlice = 0},
+                }),
+                state.heaps.dsv->GetCPUDescriptorHandleForHeapStart());
+        }
+
+        {
+            // A command allocator can only be reset once the GPU is done with its frame
+            for(ID3D12CommandAllocatorS& commandAllocator : state.commandAllocators)
+                Die(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, Out(commandAllocator)));
+            Die(device->CreateCommandList(
+                0,
+                D3D12_COMMAND_LIST_TYPE_DIRECT,
+                state.commandAllocators[0].Get(),
+                nullptr,
+                Out(state.commandList)));
+        }
+
+        uint32_t textureRowPitch;
+        std::vector<char> textureAlbedoData;
+        {
+            auto albedoPath = Path::getAssetPath() / "texture" / "jagged-cliff1-albedo_low.png";
+
+            const TextureLoad::Image image = TextureLoad::load(albedoPath, 4).value();
+            assert(image.width == TEXTURE_WIDTH);
+            assert(image.height == TEXTURE_HEIGHT);
+
+            textureRowPitch = AlignTo(TEXTURE_WIDTH * 4, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+
+            textureAlbedoData.resize(textureRowPitch * TEXTURE_HEIGHT);
+            Blit::blit(
+                {image.pixels.get(), TEXTURE_WIDTH * 4, Blit::Format::RGBA8},
+                {textureAlbedoData.data(), textureRowPitch, Blit::Format::RGBA8},
+                TEXTURE_WIDTH,
+                TEXTURE_HEIGHT);
+        }
+
+        uint32_t ambientTextureRowPitch;
+        std::vector<char> textureAmbientData;
+        {
+            auto normalPath = Path::getAssetPath() / "texture" / "jagged-cliff1-ao_low.png";
+
+            const TextureLoad::Image image = TextureLoad::load(normalPath, 1).value();
+            assert(image.width == TEXTURE_WIDTH);
+            assert(image.height == TEXTURE_HEIGHT);
+
+            ambientTextureRowPitch = AlignTo(TEXTURE_WIDTH * 1, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+
+            textureAmbientData.resize(ambientTextureRowPitch * TEXTURE_HEIGHT);
+            Blit::blit(
+                {image.pixels.get(), TEXTURE_WIDTH * 1, Blit::Format::R8},
+                {textureAmbientData.data(), ambientTextureRowPitch, Blit::Format::R8},
+                TEXTURE_WIDTH,
+                TEXTURE_HEIGHT);
+        }
+
+        std::vector<char> textureNormalData;
+        {
+            auto normalPath = Path::getAssetPath() / "texture" / "jagged-cliff1-normal-ogl_low.png";
+
+            const TextureLoad::Image image = TextureLoad::load(normalPath, 4).value();
+            assert(image.width == TEXTURE_WIDTH);
+            assert(image.height == TEXTURE_HEIGHT);
+
+            textureNormalData.resize(textureRowPitch * TEXTURE_HEIGHT);
+            Blit::blit(
+                {image.pixels.get(), TEXTURE_WIDTH * 4, Blit::Format::RGBA8},
+                {textureNormalData.data(), textureRowPitch, Blit::Format::RGBA8},
+                TEXTURE_WIDTH,
+                TEXTURE_HEIGHT);
+        }
+
+        {
+            device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_UPLOAD,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = state.upload.size,
+                    .Height = 1, // Mandatory
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1, // Mandatory
+                    .Format = DXGI_FORMAT_UNKNOWN, // Mandatory
+                    .SampleDesc =
+                        {
+                            .Count = 1, // Mandatory
+                            .Quality = 0, // Mandatory
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_NONE,
+                }),
+                D3D12_RESOURCE_STATE_COPY_SOURCE,
+                nullptr,
+                Out(state.resources.uploadBuffer));
+        }
+
+        {
+            // Only holds constant buffers, which the shaders read straight from the upload heap. It stays mapped
+            // for as long as it lives, write-combined memory is fine for that as long as it's never read back
+            Die(device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_UPLOAD,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = UPLOAD_RING_SIZE,
+                    .Height = 1, // Mandatory
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1, // Mandatory
+                    .Format = DXGI_FORMAT_UNKNOWN, // Mandatory
+                    .SampleDesc =
+                        {
+                            .Count = 1, // Mandatory
+                            .Quality = 0, // Mandatory
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_NONE,
+                }),
+                D3D12_RESOURCE_STATE_GENERIC_READ, // Mandatory for upload heaps
+                nullptr,
+                Out(state.resources.uploadRingBuffer)));
+
+            void* uploadRingDataPointer;
+            Die(state.resources.uploadRingBuffer->Map(
+                0, as_lvalue(D3D12_RANGE{.Begin = 0, .End = 0}), &uploadRingDataPointer));
+            state.uploadRing = UploadRing(
+                (char*)uploadRingDataPointer,
+                state.resources.uploadRingBuffer->GetGPUVirtualAddress(),
+                UPLOAD_RING_SIZE,
+                FRAMES_IN_FLIGHT);
+        }
+
+        {
+            device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_DEFAULT,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = state.upload.vertexPosition.size(),
+                    .Height = 1, // Mandatory
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1, // Mandatory
+                    .Format = DXGI_FORMAT_UNKNOWN, // Mandatory
+                    .SampleDesc =
+                        {
+                            .Count = 1, // Mandatory
+                            .Quality = 0, // Mandatory
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_NONE,
+                }),
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                Out(state.resources.vertexPositionBuffer));
+            device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_DEFAULT,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = state.upload.vertexNormal.size(),
+                    .Height = 1, // Mandatory
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1, // Mandatory
+                    .Format = DXGI_FORMAT_UNKNOWN, // Mandatory
+                    .SampleDesc =
+                        {
+                            .Count = 1, // Mandatory
+                            .Quality = 0, // Mandatory
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_NONE,
+                }),
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                Out(state.resources.vertexNormalBuffer));
+            device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_DEFAULT,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = state.upload.vertexTangent.size(),
+                    .Height = 1, // Mandatory
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1, // Mandatory
+                    .Format = DXGI_FORMAT_UNKNOWN, // Mandatory
+                    .SampleDesc =
+                        {
+                            .Count = 1, // Mandatory
+                            .Quality = 0, // Mandatory
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_NONE,
+                }),
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                Out(state.resources.vertexTangentBuffer));
+            device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_DEFAULT,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = state.upload.vertexUv.size(),
+                    .Height = 1, // Mandatory
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1, // Mandatory
+                    .Format = DXGI_FORMAT_UNKNOWN, // Mandatory
+                    .SampleDesc =
+                        {
+                            .Count = 1, // Mandatory
+                            .Quality = 0, // Mandatory
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_NONE,
+                }),
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                Out(state.resources.vertexUvBuffer));
+
+            device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_DEFAULT,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = state.upload.index.size(),
+                    .Height = 1, // Mandatory
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1, // Mandatory
+                    .Format = DXGI_FORMAT_UNKNOWN, // Mandatory
+                    .SampleDesc =
+                        {
+                            .Count = 1, // Mandatory
+                            .Quality = 0, // Mandatory
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_NONE,
+                }),
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                Out(state.resources.indexBuffer));
+
+            device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_DEFAULT,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = TEXTURE_WIDTH,
+                    .Height = TEXTURE_HEIGHT,
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1,
+                    .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+                    .SampleDesc =
+                        {
+                            .Count = 1, // Mandatory
+                            .Quality = 0, // Mandatory
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_NONE,
+                }),
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                Out(state.resources.textureAlbedo));
+            device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_DEFAULT,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = TEXTURE_WIDTH,
+                    .Height = TEXTURE_HEIGHT,
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1,
+                    .Format = DXGI_FORMAT_R8_UNORM,
+                    .SampleDesc =
+                        {
+                            .Count = 1, // Mandatory
+                            .Quality = 0, // Mandatory
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_NONE,
+                }),
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                Out(state.resources.textureAmbient));
+            device->CreateCommittedResource(
+                as_lvalue(D3D12_HEAP_PROPERTIES{
+                    .Type = D3D12_HEAP_TYPE_DEFAULT,
+                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
+                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
+                    .CreationNodeMask = 0,
+                    .VisibleNodeMask = 0,
+                }),
+                D3D12_HEAP_FLAG_NONE,
+                as_lvalue(D3D12_RESOURCE_DESC{
+                    .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+                    .Alignment =
+                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
+                    .Width = TEXTURE_WIDTH,
+                    .Height = TEXTURE_HEIGHT,
+                    .DepthOrArraySize = 1, // Mandatory
+                    .MipLevels = 1,
+                    .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+                    .SampleDesc =
+                        {
+                            .Count = 1, // Mandatory
+                            .Quality = 0, // Mandatory
+                        },
+                    .Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN, // Mandatory
+                    .Flags = D3D12_RESOURCE_FLAG_NONE,
+                }),
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                Out(state.resources.textureNormal));
+        }
+
+        {
+            auto handle = state.heaps.srv->GetCPUDescriptorHandleForHeapStart();
+            device->CreateShaderResourceView(state.resources.textureAlbedo.Get(), nullptr, handle);
+
+            handle.ptr += state.descriptorSizes.srv;
+            device->CreateShaderResourceView(state.resources.textureAmbient.Get(), nullptr, handle);
+
+            handle.ptr += state.descriptorSizes.srv;
+            device->CreateShaderResourceView(state.resources.textureNormal.Get(), nullptr, handle);
+        }
+
+        {
+            void* uploadBufferDataPointer;
+            state.resources.uploadBuffer->Map(0, nullptr, &uploadBufferDataPointer);
+            std::span uploadData{(char*)uploadBufferDataPointer, state.upload.size};
+
+            // The cooked streams are already in their final format, so each one is a single copy
+            const MeshCache::Header& meshHeader = mesh.header();
+            state.upload.vertexPosition.write(uploadData, mesh.positions());
+            state.upload.vertexUv.write(uploadData, mesh.uvs());
+            state.upload.vertexNormal.write(uploadData, mesh.normals());
+            state.upload.vertexTangent.write(uploadData, mesh.tangents());
+            std::memcpy(state.upload.index.data(uploadData), mesh.indices(), state.upload.index.size());
+
+            STATIC_UPLOAD.textureAlbedo.write(uploadData, textureAlbedoData);
+            STATIC_UPLOAD.textureAmbient.write(uploadData, textureAmbientData);
+            STATIC_UPLOAD.textureNormal.write(uploadData, textureNormalData);
+            state.resources.uploadBuffer->Unmap(0, nullptr);
+
+            state.commandList->CopyBufferRegion(
+                state.resources.vertexPositionBuffer.Get(),
+                0,
+                state.resources.uploadBuffer.Get(),
+                state.upload.vertexPosition.offset,
+                state.upload.vertexPosition.size());
+            state.commandList->CopyBufferRegion(
+                state.resources.vertexNormalBuffer.Get(),
+                0,
+                state.resources.uploadBuffer.Get(),
+                state.upload.vertexNormal.offset,
+                state.upload.vertexNormal.size());
+            state.commandList->CopyBufferRegion(
+                state.resources.vertexTangentBuffer.Get(),
+                0,
+                state.resources.uploadBuffer.Get(),
+                state.upload.vertexTangent.offset,
+                state.upload.vertexTangent.size());
+            state.commandList->CopyBufferRegion(
+                state.resources.vertexUvBuffer.Get(),
+                0,
+                state.resources.uploadBuffer.Get(),
+                state.upload.vertexUv.offset,
+                state.upload.vertexUv.size());
+            state.commandList->CopyBufferRegion(
+                state.resources.indexBuffer.Get(),
+                0,
+                state.resources.uploadBuffer.Get(),
+                state.upload.index.offset,
+                state.upload.index.size());
+            state.commandList->CopyTextureRegion(
+                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
+                    .pResource = state.resources.textureAlbedo.Get(),
+                    .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+                    .SubresourceIndex = 0,
+                }),
+                0,
+                0,
+                0,
+                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
+                    .pResource = state.resources.uploadBuffer.Get(),
+                    .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+                    .PlacedFootprint =
+                        D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
+                            .Offset = STATIC_UPLOAD.textureAlbedo.offset,
+                            .Footprint =
+                                D3D12_SUBRESOURCE_FOOTPRINT{
+                                    .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+                                    .Width = TEXTURE_WIDTH,
+                                    .Height = TEXTURE_HEIGHT,
+                                    .Depth = 1,
+                                    .RowPitch = textureRowPitch,
+                                },
+                        }}),
+                nullptr);
+            state.commandList->CopyTextureRegion(
+                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
+                    .pResource = state.resources.textureAmbient.Get(),
+                    .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+                    .SubresourceIndex = 0,
+                }),
+                0,
+                0,
+                0,
+                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
+                    .pResource = state.resources.uploadBuffer.Get(),
+                    .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+                    .PlacedFootprint =
+                        D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
+                            .Offset = STATIC_UPLOAD.textureAmbient.offset,
+                            .Footprint =
+                                D3D12_SUBRESOURCE_FOOTPRINT{
+                                    .Format = DXGI_FORMAT_R8_UNORM,
+                                    .Width = TEXTURE_WIDTH,
+                                    .Height = TEXTURE_HEIGHT,
+                                    .Depth = 1,
+                                    .RowPitch = ambientTextureRowPitch,
+                                },
+                        }}),
+                nullptr);
+            state.commandList->CopyTextureRegion(
+                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
+                    .pResource = state.resources.textureNormal.Get(),
+                    .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+                    .SubresourceIndex = 0,
+                }),
+                0,
+                0,
+                0,
+                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
+                    .pResource = state.resources.uploadBuffer.Get(),
+                    .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+                    .PlacedFootprint =
+                        D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
+                            .Offset = STATIC_UPLOAD.textureNormal.offset,
+                            .Footprint =
+                                D3D12_SUBRESOURCE_FOOTPRINT{
+                                    .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+                                    .Width = TEXTURE_WIDTH,
+                                    .Height = TEXTURE_HEIGHT,
+                                    .Depth = 1,
+                                    .RowPitch = textureRowPitch,
+                                },
+                        }}),
+                nullptr);
+
+            // Note: resource has been promoted into COPY_DEST
+            auto barriers = std::to_array({
+                D3D12_RESOURCE_BARRIER{
+                    .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+                    .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+                    .Transition =
+                        {
+                            .pResource = state.resources.textureAlbedo.Get(),
+                            .Subresource = 0,
+                            .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
+                            .StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                        },
+                },
+                D3D12_RESOURCE_BARRIER{
+                    .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+                    .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+                    .Transition =
+                        {
+                            .pResource = state.resources.textureAmbient.Get(),
+                            .Subresource = 0,
+                            .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
+                            .StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                        },
+                },
+                D3D12_RESOURCE_BARRIER{
+                    .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+                    .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+                    .Transition =
+                        {
+                            .pResource = state.resources.textureNormal.Get(),
+                            .Subresource = 0,
+                            .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
+                            .StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                        },
+                },
+            });
+            state.commandList->ResourceBarrier(barriers.size(), barriers.data());
+        }
+
+        {
+            std::array descriptorTableRanges = std::to_array({D3D12_DESCRIPTOR_RANGE{
+                .RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
+                .NumDescriptors = 3,
+                .BaseShaderRegister = 0,
+                .RegisterSpace = 0,
+                .OffsetInDescriptorsFromTableStart = 0,
+            }});
+            std::array rootParameters = std::to_array({
+                D3D12_ROOT_PARAMETER{
+                    .ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV,
+                    .Descriptor =
+                        D3D12_ROOT_DESCRIPTOR{
+                            .ShaderRegister = 0,
+                            .RegisterSpace = 0,
+                        },
+                    .ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX,
+                },
+                D3D12_ROOT_PARAMETER{
+                    .ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV,
+                    .Descriptor =
+                        D3D12_ROOT_DESCRIPTOR{
+                            .ShaderRegister = 1,
+                            .RegisterSpace = 0,
+                        },
+                    .ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX,
+                },
+                D3D12_ROOT_PARAMETER{
+                    .ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE,
+                    .DescriptorTable =
+                        D3D12_ROOT_DESCRIPTOR_TABLE{
+                            .NumDescriptorRanges = descriptorTableRanges.size(),
+                            .pDescriptorRanges = descriptorTableRanges.data(),
+                        },
+                    .ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL,
+                },
+            });
+
+            std::array samplers = std::to_array({D3D12_STATIC_SAMPLER_DESC{
+                .Filter = D3D12_FILTER_ANISOTROPIC,
+                .AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP,
+                .AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP,
+                .AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP,
+                .MipLODBias = 0.0f,
+                .MaxAnisotropy = 16,
+                .ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER,
+                .BorderColor = D3D12_STATIC_BORDER_COLOR_OPAQUE_BLACK,
+                .MinLOD = 0.0f,
+                .MaxLOD = 0.0,
+                .ShaderRegister = 0,
+                .RegisterSpace = 0,
+                .ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL,
+            }});
+            ID3DBlobS serialized;
+            ID3DBlobS error;
+            Die(D3D12SerializeVersionedRootSignature(
+                as_lvalue(D3D12_VERSIONED_ROOT_SIGNATURE_DESC{
+                    .Version = D3D_ROOT_SIGNATURE_VERSION_1,
+                    .Desc_1_0 =
+                        D3D12_ROOT_SIGNATURE_DESC{
+                            .NumParameters = rootParameters.size(),
+                            .pParameters = rootParameters.data(),
+                            .NumStaticSamplers = samplers.size(),
+                            .pStaticSamplers = samplers.data(),
+                            .Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT,
+                        },
+                }),
+                serialized.GetAddressOf(),
+                error.GetAddressOf()));
+
+            Die(device->CreateRootSignature(
+                0,
+                serialized->GetBufferPointer(),
+                serialized->GetBufferSize(),
+                Out(state.rootSignature)));
+        }
+
+        {
+            std::vector vertexShaderCode =
+                FileUtil::readFile(Path::getShaderPath("vs/normal_mapping_tangent.bin")).value();
+            Die(D3DCreateBlob(vertexShaderCode.size(), state.shaders.vertexBlob.GetAddressOf()));
+            std::memcpy(state.shaders.vertexBlob->GetBufferPointer(), vertexShaderCode.data(), vertexShaderCode.size());
+        }
+
+        {
+            std::vector pixelShaderCode =
+                FileUtil::readFile(Path::getShaderPath("ps/normal_mapping_tangent.bin")).value();
+            Die(D3DCreateBlob(pixelShaderCode.size(), state.shaders.pixelBlob.GetAddressOf()));
+            std::memcpy(state.shaders.pixelBlob->GetBufferPointer(), pixelShaderCode.data(), pixelShaderCode.size());
+        }
+
+        {
+            std::array inputLayout = std::to_array({
+                D3D12_INPUT_ELEMENT_DESC{
+                    .SemanticName = "POSITION",
+                    .SemanticIndex = 0,
+                    .Format = DXGI_FORMAT_R32G32B32_FLOAT,
+                    .InputSlot = 0,
+                    .AlignedByteOffset = 0,
+                    .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                    .InstanceDataStepRate = 0, // Mandatory
+                },
+                D3D12_INPUT_ELEMENT_DESC{
+                    .SemanticName = "UV",
+                    .SemanticIndex = 0,
+                    .Format = DXGI_FORMAT_R32G32_FLOAT,
+                    .InputSlot = 1,
+                    .AlignedByteOffset = 0,
+                    .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                    .InstanceDataStepRate = 0, // Mandatory
+                },
+                D3D12_INPUT_ELEMENT_DESC{
+                    .SemanticName = "NORMAL",
+                    .SemanticIndex = 0,
+                    .Format = DXGI_FORMAT_R32G32B32_FLOAT,
+                    .InputSlot = 2,
+                    .AlignedByteOffset = 0,
+                    .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                    .InstanceDataStepRate = 0, // Mandatory
+                },
+                D3D12_INPUT_ELEMENT_DESC{
+                    .SemanticName = "TANGENT",
+                    .SemanticIndex = 0,
+                    .Format = DXGI_FORMAT_R32G32B32_FLOAT,
+                    .InputSlot = 3,
+                    .AlignedByteOffset = 0,
+                    .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                    .InstanceDataStepRate = 0, // Mandatory
+                },
+            });
+
+            Die(device->CreateGraphicsPipelineState(
+                as_lvalue(D3D12_GRAPHICS_PIPELINE_STATE_DESC{
+                    .pRootSignature = state.rootSignature.Get(),
+                    .VS =
+                        {
+                            .pShaderBytecode = state.shaders.vertexBlob->GetBufferPointer(),
+                            .BytecodeLength = state.shaders.vertexBlob->GetBufferSize(),
+                        },
+                    .PS =
+                        {
+                            .pShaderBytecode = state.shaders.pixelBlob->GetBufferPointer(),
+                            .BytecodeLength = state.shaders.pixelBlob->GetBufferSize(),
+                        },
+                    .DS = {},
+                    .HS = {},
+                    .GS = {},
+                    .StreamOutput = {},
+                    .BlendState = BlendState::Disabled,
+                    .SampleMask = UINT_MAX,
+                    .RasterizerState = RasterizerState::Normal,
+                    .DepthStencilState = DepthStencilState::Enabled,
+                    .InputLayout =
+                        {
+                            .pInputElementDescs = inputLayout.data(),
+                            .NumElements = inputLayout.size(),
+                        },
+                    .IBStripCutValue = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED,
+                    .PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE,
+                    .NumRenderTargets = 1,
+                    .RTVFormats = {BACKBUFFER_FORMAT},
+                    .DSVFormat = DEPTH_STENCIL_FORMAT,
+                    .SampleDesc =
+                        {
+                            .Count = MSAA_COUNT,
+                            .Quality = MSAA_QUALITY,
+                        },
+                    .NodeMask = 0,
+                    .CachedPSO = {},
+                    .Flags = D3D12_PIPELINE_STATE_FLAG_NONE,
+                }),
+                Out(state.pipelineState)));
+        }
+
+        state.commandList->Close();
+
+        ID3D12CommandList* commandList = state.commandList.Get();
+        state.commandQueue->ExecuteCommandLists(1, &commandList);
+
+        const UINT64 fence = ++state.sync.fenceCounter;
+        state.commandQueue->Signal(state.sync.flushFence.Get(), fence);
+
+        if(state.sync.flushFence->GetCompletedValue() < fence)
+        {
+            state.sync.flushFence->SetEventOnCompletion(fence, state.sync.fenceEventHandle);
+            WaitForSingleObject(state.sync.fenceEventHandle, INFINITE);
+        }
+
+        ::state = std::move(state);
+    }
+
+    float time = 0.0f;
+
+    void render(uint32_t windowWidth, uint32_t windowHeight)
+    {
+        auto& device = state.device;
+
+        uint32_t currentFrame = state.swapChain->GetCurrentBackBufferIndex();
+
+        // Only waits for the frame FRAMES_IN_FLIGHT frames back, whose constant buffers and command allocator
+        // this frame is about to reuse, instead of the one that was just submitted
+        const UINT64 reuseFence = state.uploadRing.getReuseFence();
+        if(state.sync.flushFence->GetCompletedValue() < reuseFence)
+        {
+            state.sync.flushFence->SetEventOnCompletion(reuseFence, state.sync.fenceEventHandle);
+            WaitForSingleObject(state.sync.fenceEventHandle, INFINITE);
+        }
+        state.uploadRing.beginFrame(state.sync.flushFence->GetCompletedValue());
+
+        ID3D12CommandAllocator* commandAllocator = state.commandAllocators[state.uploadRing.getFrameIndex()].Get();
+        commandAllocator->Reset();
+        state.commandList->Reset(commandAllocator, state.pipelineState.Get());
+
+        state.commandList->SetGraphicsRootSignature(state.rootSignature.Get());
+        state.commandList->RSSetViewports(
+            1,
+            as_lvalue(D3D12_VIEWPORT{
+                .TopLeftX = 0.0f,
+                .TopLeftY = 0.0f,
+                .Width = (FLOAT)windowWidth,
+                .Height = (FLOAT)windowHeight,
+                .MinDepth = 0.0f,
+                .MaxDepth = 1.0f,
+            }));
+        state.commandList->RSSetScissorRects(
+            1,
+            as_lvalue(D3D12_RECT{
+                .left = 0,
+                .top = 0,
+                .right = (LONG)windowWidth,
+                .bottom = (LONG)windowHeight,
+            }));
+
+        state.commandList->ResourceBarrier(
+            1,
+            as_lvalue(D3D12_RESOURCE_BARRIER{
+                .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+                .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+                .Transition =
+                    {
+                        .pResource = state.resources.swapChainBuffers[currentFrame].Get(),
+                        .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                        .StateBefore = D3D12_RESOURCE_STATE_COMMON,
+                        .StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET,
+                    },
+            }));
+
+        time += 1 / 60.0f; // vsync is on, so this should be fine
+
+        auto backBufferHandle = state.heaps.rtv->GetCPUDescriptorHandleForHeapStart();
+        backBufferHandle.ptr += state.descriptorSizes.rtv * currentFrame;
+        auto depthBufferHandle = state.heaps.dsv->GetCPUDescriptorHandleForHeapStart();
+
+        float clearColor[4] = {69.0f / 255.0f, 133.0f / 255.0f, 136.0f / 255.0f, 1.0f};
+        state.commandList->ClearRenderTargetView(backBufferHandle, clearColor, 0, nullptr);
+        state.commandList->ClearDepthStencilView(depthBufferHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
+        state.commandList->OMSetRenderTargets(1, &backBufferHandle, true, &depthBufferHandle);
+        state.commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+        std::array bufferViews{
+            D3D12_VERTEX_BUFFER_VIEW{
+                .BufferLocation = state.resources.vertexPositionBuffer->GetGPUVirtualAddress(),
+                .SizeInBytes = state.upload.vertexPosition.size(),
+                .StrideInBytes = state.upload.vertexPosition.STRIDE,
+            },
+            D3D12_VERTEX_BUFFER_VIEW{
+                .BufferLocation = state.resources.vertexUvBuffer->GetGPUVirtualAddress(),
+                .SizeInBytes = state.upload.vertexUv.size(),
+                .StrideInBytes = state.upload.vertexUv.STRIDE,
+            },
+            D3D12_VERTEX_BUFFER_VIEW{
+                .BufferLocation = state.resources.vertexNormalBuffer->GetGPUVirtualAddress(),
+                .SizeInBytes = state.upload.vertexNormal.size(),
+                .StrideInBytes = state.upload.vertexNormal.STRIDE,
+            },
+            D3D12_VERTEX_BUFFER_VIEW{
+                .BufferLocation = state.resources.vertexTangentBuffer->GetGPUVirtualAddress(),
+                .SizeInBytes = state.upload.vertexTangent.size(),
+                .StrideInBytes = state.upload.vertexTangent.STRIDE,
+            },
+        };
+        state.commandList->IASetVertexBuffers(0, bufferViews.size(), bufferViews.data());
+        state.commandList->IASetIndexBuffer(as_lvalue(D3D12_INDEX_BUFFER_VIEW{
+            .BufferLocation = state.resources.indexBuffer->GetGPUVirtualAddress(),
+            .SizeInBytes = state.upload.index.size(),
+            .Format = state.indexFormat,
+        }));
+
+        state.commandList->SetDescriptorHeaps(1, state.heaps.srv.GetAddressOf());
+        state.commandList->SetGraphicsRootDescriptorTable(2, state.heaps.srv->GetGPUDescriptorHandleForHeapStart());
+
+        // Every constant buffer is a fresh allocation out of this frame's part of the ring, so nothing the GPU may
+        // still be reading for the previous frames is written over. Note the transpose!
+        const SimpleMath::Matrix viewProjectionMatrix =
+            (SimpleMath::Matrix::CreateLookAt(CAMERA_POSITION, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f})
+             * SimpleMath::Matrix::CreatePerspectiveFieldOfView(
+                 DirectX::XMConvertToRadians(59.0f), // 59.0f = 90 deg horizontal FoV at 16:9
+                 windowWidth / (float)windowHeight,
+                 1.0f,
+                 10.0f))
+                .Transpose();
+        state.commandList->SetGraphicsRootConstantBufferView(
+            1, state.uploadRing.push(viewProjectionMatrix).value().gpuAddress);
+
+        // Bind and draw first object
+        SimpleMath::Matrix transform =
+            (SimpleMath::Matrix::CreateRotationX(std::sinf(time) * 0.2f)
+             * SimpleMath::Matrix::CreateRotationY(time * 0.5f) * SimpleMath::Matrix::CreateTranslation(1, 0, 0))
+                .Transpose();
+        state.commandList->SetGraphicsRootConstantBufferView(0, state.uploadRing.push(transform).value().gpuAddress);
+        for(const IndexFormat::Batch& batch : state.indexBatches)
+            state.commandList->DrawIndexedInstanced(batch.indexCount, 1, batch.firstIndex, batch.baseVertex, 0);
+
+        // Bind and draw second object
+        transform = (SimpleMath::Matrix::CreateRotationX(std::sinf(time) * 0.2f)
+                     * SimpleMath::Matrix::CreateRotationY(time * -0.5f)
+                     * SimpleMath::Matrix::CreateTranslation(-1, 0, std::sinf(time * 0.66f) + 0.5f))
+                        .Transpose();
+        state.commandList->SetGraphicsRootConstantBufferView(0, state.uploadRing.push(transform).value().gpuAddress);
+        for(const IndexFormat::Batch& batch : state.indexBatches)
+            state.commandList->DrawIndexedInstanced(batch.indexCount, 1, batch.firstIndex, batch.baseVertex, 0);
+
+        state.commandList->ResourceBarrier(
+            1,
+            as_lvalue(D3D12_RESOURCE_BARRIER{
+                .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+                .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+                .Transition =
+                    {
+                        .pResource = state.resources.swapChainBuffers[currentFrame].Get(),
+                        .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                        .StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET,
+                        .StateAfter = D3D12_RESOURCE_STATE_COMMON,
+                    },
+            }));
+        state.commandList->Close();
+
+        ID3D12CommandList* commandList = state.commandList.Get();
+        state.commandQueue->ExecuteCommandLists(1, &commandList);
+        state.swapChain->Present(1, 0);
+
+        // No wait here, the next frame starts recording while the GPU is still on this one
+        const UINT64 fence = ++state.sync.fenceCounter;
+        state.commandQueue->Signal(state.sync.flushFence.Get(), fence);
+        state.uploadRing.endFrame(fence);
+    }
+
+    void shutdown()
+    {
+        // render() returns with up to FRAMES_IN_FLIGHT frames still on the GPU, which use the resources and the
+        // mapped ring that are released along with `state`
+        const UINT64 fence = ++state.sync.fenceCounter;
+        state.commandQueue->Signal(state.sync.flushFence.Get(), fence);
+
+        if(state.sync.flushFence->GetCompletedValue() < fence)
+        {
+            state.sync.flushFence->SetEventOnCompletion(fence, state.sync.fenceEventHandle);
+            WaitForSingleObject(state.sync.fenceEventHandle, INFINITE);
+        }
+    }
+}
+}
\ No newline at end of file
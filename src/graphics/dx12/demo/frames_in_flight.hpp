@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include <asset/index_format.hpp>
+#include <graphics/dx12/versioning.hpp>
+#include <util/align.hpp>
+#include <util/upload_layout.hpp>
+#include <util/upload_ring.hpp>
+
+#include <DirectXMath.h>
+#include <SimpleMath.h>
+#include <d3d12.h>
+
+namespace dx12_demo
+{
+namespace DEMO_NAME
+{
+    constexpr uint32_t BACKBUFFER_COUNT = 3;
+    // Frames the CPU can record ahead of the GPU
+    constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+    // Constant buffers for all frames in flight, each frame gets an even share
+    constexpr uint32_t UPLOAD_RING_SIZE = 64 * 1024 * FRAMES_IN_FLIGHT;
+    constexpr DXGI_FORMAT BACKBUFFER_FORMAT = DXGI_FORMAT_R8G8B8A8_UNORM;
+    constexpr DXGI_FORMAT DEPTH_STENCIL_FORMAT = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    constexpr uint32_t MSAA_COUNT = 1;
+    constexpr uint32_t MSAA_QUALITY = 0;
+
+    constexpr uint32_t TEXTURE_WIDTH = 512;
+    constexpr uint32_t TEXTURE_HEIGHT = 512;
+    constexpr uint32_t TEXTURE_CHANNELS = 4;
+
+    constexpr DirectX::SimpleMath::Vector3 CAMERA_POSITION{0.0f, 0.0f, -3.0f};
+
+    // Everything with a size that's known up front, laid out at compile time at the start of the upload buffer
+    struct StaticUpload
+    {
+        UploadRegion<char> textureAlbedo;
+        UploadRegion<char> textureAmbient;
+        UploadRegion<char> textureNormal;
+        uint32_t size;
+    };
+    constexpr StaticUpload STATIC_UPLOAD = []
+    {
+        UploadLayout layout;
+        // clang-format off
+        return StaticUpload{
+            .textureAlbedo = layout.add<char>(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT),
+            .textureAmbient = layout.add<char>(AlignTo(TEXTURE_WIDTH, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT),
+            .textureNormal = layout.add<char>(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT),
+            .size = layout.getSize(),
+        };
+        // clang-format on
+    }();
+
+    struct State
+    {
+        ID3D12DeviceS device;
+        IDXGISwapChainS swapChain;
+        ID3D12CommandQueueS commandQueue;
+        std::array<ID3D12CommandAllocatorS, FRAMES_IN_FLIGHT> commandAllocators;
+        ID3D12GraphicsCommandListS commandList;
+        ID3D12RootSignatureS rootSignature;
+        ID3D12PipelineStateS pipelineState;
+
+        struct
+        {
+            ID3D12FenceS flushFence;
+            uint64_t fenceCounter;
+            HANDLE fenceEventHandle;
+        } sync;
+
+        struct
+        {
+            uint32_t rtv;
+            uint32_t dsv;
+            union
+            {
+                uint32_t cbvSrvUav;
+                uint32_t cbv;
+                uint32_t srv;
+                uint32_t uav;
+            };
+        } descriptorSizes;
+
+        struct
+        {
+            ID3D12DescriptorHeapS rtv;
+            ID3D12DescriptorHeapS srv;
+            ID3D12DescriptorHeapS dsv;
+        } heaps;
+
+        struct
+        {
+            std::array<ID3D12ResourceS, BACKBUFFER_COUNT> swapChainBuffers;
+            ID3D12ResourceS renderTargetBuffer;
+            ID3D12ResourceS depthStencilBuffer;
+            ID3D12ResourceS uploadBuffer;
+            ID3D12ResourceS uploadRingBuffer;
+            ID3D12ResourceS vertexPositionBuffer;
+            ID3D12ResourceS vertexUvBuffer;
+            ID3D12ResourceS vertexNormalBuffer;
+            ID3D12ResourceS vertexTangentBuffer;
+            ID3D12ResourceS indexBuffer;
+            ID3D12ResourceS textureAlbedo;
+            ID3D12ResourceS textureAmbient;
+            ID3D12ResourceS textureNormal;
+        } resources;
+
+        struct
+        {
+            ID3DBlobS vertexBlob;
+            ID3DBlobS pixelBlob;
+        } shaders;
+
+        // After STATIC_UPLOAD
+        struct
+        {
+            UploadRegion<DirectX::XMFLOAT3> vertexPosition;
+            UploadRegion<DirectX::XMFLOAT2> vertexUv;
+            UploadRegion<DirectX::XMFLOAT3> vertexNormal;
+            UploadRegion<DirectX::XMFLOAT3> vertexTangent;
+            UploadRegion<char> index;
+            uint32_t size;
+        } upload;
+
+        // Every frame's constant buffers, persistently mapped
+        UploadRing uploadRing;
+
+        DXGI_FORMAT indexFormat;
+        std::vector<IndexFormat::Batch> indexBatches;
+    };
+
+    void init(HWND hWnd, uint32_t windowWidth, uint32_t windowHeight);
+    void render(uint32_t windowWidth, uint32_t windowHeight);
+    // Waits for the frames still in flight, must be called before exiting
+    void shutdown();
+}
+}
\ No newline at end of file
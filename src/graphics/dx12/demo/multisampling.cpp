@@ -22,13 +22,13 @@
 #include <graphics/dx12/rasterizer_state.hpp>
 #include <graphics/dx12/versioning.hpp>
 
+#include <util/blit.hpp>
 #include <util/file_util.hpp>
 #include <util/path.hpp>
-#include <util/stbi.hpp>
 
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
+#include <asset/texture_load.hpp>
+
+#include <asset/mesh_cache.hpp>
 
 static dx12_demo::DEMO_NAME::State state;
 
@@ -42,54 +42,23 @@ namespace DEMO_NAME
     {
         State state{};
 
+        // Cooks cube.glb on the first run, after that it's just a mapped file
+        MeshCache::CookedMesh mesh = MeshCache::loadOrCook(Path::getAssetPath("cube.glb")).value();
         {
-            auto& indexData = state.indexData;
-            auto& vertexData = state.vertexData;
-
-            Assimp::Importer importer;
-            const aiScene* scene = importer.ReadFile(
-                Path::getAssetPath("cube.glb").string().c_str(), // This works with non-ANSII paths on Win11 22H2 ???
-                aiPostProcessSteps::aiProcess_PreTransformVertices);
-            assert(scene);
-
-            aiMesh* mesh = scene->mMeshes[0];
-            for(aiFace* face = mesh->mFaces; face < mesh->mFaces + mesh->mNumFaces; ++face)
-            {
-                assert(face->mNumIndices == 3);
-                indexData.push_back(face->mIndices[0]);
-                indexData.push_back(face->mIndices[1]);
-                indexData.push_back(face->mIndices[2]);
-            }
-
-            for(auto [position, texCoords, normal, tangent] =
-                    std::make_tuple(mesh->mVertices, mesh->mTextureCoords[0], mesh->mNormals, mesh->mTangents);
-                position != mesh->mVertices + mesh->mNumVertices;
-                ++position, ++texCoords, ++normal, ++tangent)
-            {
-                vertexData.push_back({
-                    .position = {position->x, position->y, position->z},
-                    .uv = {texCoords->x, texCoords->y},
-                    .normal = {normal->x, normal->y, normal->z},
-                    .tangent = {tangent->x, tangent->y, tangent->z},
-                });
-            }
-
-            OffsetCounter counter;
+            const MeshCache::Header& meshHeader = mesh.header();
+            state.indexFormat = meshHeader.indexStride == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+            state.indexBatches = mesh.fullDetailBatches();
 
+            UploadLayout layout{STATIC_UPLOAD.size};
             // clang-format off
-            auto& c = state.constants;
-            std::tie(c.VERTEX_POSITION_OFFSET, c.VERTEX_POSITION_SIZE)   = counter.append<DirectX::XMFLOAT3>(vertexData.size());
-            std::tie(c.VERTEX_UV_OFFSET, c.VERTEX_UV_SIZE)               = counter.append<DirectX::XMFLOAT2>(vertexData.size());
-            std::tie(c.VERTEX_NORMAL_OFFSET, c.VERTEX_NORMAL_SIZE)       = counter.append<DirectX::XMFLOAT3>(vertexData.size());
-            std::tie(c.VERTEX_TANGENT_OFFSET, c.VERTEX_TANGENT_SIZE)     = counter.append<DirectX::XMFLOAT3>(vertexData.size());
-            std::tie(c.INDEX_OFFSET, c.INDEX_SIZE)                       = counter.append<DirectX::XMFLOAT2>(indexData.size());
-            std::tie(c.CBV_TRANSFORM_0_OFFSET, c.CBV_TRANSFORM_0_SIZE)   = counter.appendAligned<DirectX::XMFLOAT4X4>(1, 256);
-            std::tie(c.CBV_TRANSFORM_1_OFFSET, c.CBV_TRANSFORM_1_SIZE)   = counter.appendAligned<DirectX::XMFLOAT4X4>(1, 256);
-            std::tie(c.CBV_VIEWPROJ_OFFSET, c.CBV_VIEWPROJ_SIZE)         = counter.appendAligned<DirectX::XMFLOAT4X4>(1, 256);
-            std::tie(c.TEXTURE_ALBEDO_OFFSET, c.TEXTURE_ALBEDO_SIZE)   = counter.appendAligned(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
-            std::tie(c.TEXTURE_AMBIENT_OFFSET, c.TEXTURE_AMBIENT_SIZE)   = counter.appendAligned(AlignTo(TEXTURE_WIDTH, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
-            std::tie(c.TEXTURE_NORMAL_OFFSET, c.TEXTURE_NORMAL_SIZE)     = counter.appendAligned(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
-            std::tie(c.UPLOAD_BUFFER_SIZE, std::ignore) = counter.append(0);
+            state.upload = {
+                .vertexPosition = layout.add<DirectX::XMFLOAT3>(meshHeader.vertexCount),
+                .vertexUv = layout.add<DirectX::XMFLOAT2>(meshHeader.vertexCount),
+                .vertexNormal = layout.add<DirectX::XMFLOAT3>(meshHeader.vertexCount),
+                .vertexTangent = layout.add<DirectX::XMFLOAT3>(meshHeader.vertexCount),
+                .index = layout.add<char>(meshHeader.indexSize),
+                .size = layout.getSize(),
+            };
             // clang-format on
         }
 
@@ -337,41 +306,18 @@ namespace DEMO_NAME
         {
             auto albedoPath = Path::getAssetPath() / "texture" / "jagged-cliff1-albedo_low.png";
 
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), albedoPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_rgb_alpha), // everything will break if this is
-                                                                                    // changed from STBI_rgb_alpha :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                return stbiData;
-            }();
+            const TextureLoad::Image image = TextureLoad::load(albedoPath, 4).value();
+            assert(image.width == TEXTURE_WIDTH);
+            assert(image.height == TEXTURE_HEIGHT);
 
             textureRowPitch = AlignTo(TEXTURE_WIDTH * 4, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
 
             textureAlbedoData.resize(textureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureAlbedoData.data() + textureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 4 * i,
-                    TEXTURE_WIDTH * 4);
+            Blit::blit(
+                {image.pixels.get(), TEXTURE_WIDTH * 4, Blit::Format::RGBA8},
+                {textureAlbedoData.data(), textureRowPitch, Blit::Format::RGBA8},
+                TEXTURE_WIDTH,
+                TEXTURE_HEIGHT);
         }
 
         uint32_t ambientTextureRowPitch;
@@ -379,80 +325,34 @@ namespace DEMO_NAME
         {
             auto normalPath = Path::getAssetPath() / "texture" / "jagged-cliff1-ao_low.png";
 
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), normalPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_grey), // everything will break if this is
-                                                                               // changed from STBI_grey :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                ambientTextureRowPitch = AlignTo(TEXTURE_WIDTH * 1, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+            const TextureLoad::Image image = TextureLoad::load(normalPath, 1).value();
+            assert(image.width == TEXTURE_WIDTH);
+            assert(image.height == TEXTURE_HEIGHT);
 
-                return stbiData;
-            }();
+            ambientTextureRowPitch = AlignTo(TEXTURE_WIDTH * 1, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
 
             textureAmbientData.resize(ambientTextureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureAmbientData.data() + ambientTextureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 1 * i,
-                    TEXTURE_WIDTH * 1);
+            Blit::blit(
+                {image.pixels.get(), TEXTURE_WIDTH * 1, Blit::Format::R8},
+                {textureAmbientData.data(), ambientTextureRowPitch, Blit::Format::R8},
+                TEXTURE_WIDTH,
+                TEXTURE_HEIGHT);
         }
 
         std::vector<char> textureNormalData;
         {
             auto normalPath = Path::getAssetPath() / "texture" / "jagged-cliff1-normal-ogl_low.png";
 
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), normalPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_rgb_alpha), // everything will break if this is
-                                                                                    // changed from STBI_rgb_alpha :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                return stbiData;
-            }();
+            const TextureLoad::Image image = TextureLoad::load(normalPath, 4).value();
+            assert(image.width == TEXTURE_WIDTH);
+            assert(image.height == TEXTURE_HEIGHT);
 
             textureNormalData.resize(textureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureNormalData.data() + textureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 4 * i,
-                    TEXTURE_WIDTH * 4);
+            Blit::blit(
+                {image.pixels.get(), TEXTURE_WIDTH * 4, Blit::Format::RGBA8},
+                {textureNormalData.data(), textureRowPitch, Blit::Format::RGBA8},
+                TEXTURE_WIDTH,
+                TEXTURE_HEIGHT);
         }
 
         {
@@ -469,7 +369,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.UPLOAD_BUFFER_SIZE,
+                    .Width = state.upload.size,
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -501,7 +401,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_POSITION_SIZE,
+                    .Width = state.upload.vertexPosition.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -530,7 +430,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_NORMAL_SIZE,
+                    .Width = state.upload.vertexNormal.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -559,7 +459,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_TANGENT_SIZE,
+                    .Width = state.upload.vertexTangent.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -588,7 +488,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_UV_SIZE,
+                    .Width = state.upload.vertexUv.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -618,7 +518,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.INDEX_SIZE,
+                    .Width = state.upload.index.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -738,47 +638,19 @@ namespace DEMO_NAME
         {
             void* uploadBufferDataPointer;
             state.resources.uploadBuffer->Map(0, nullptr, &uploadBufferDataPointer);
+            std::span uploadData{(char*)uploadBufferDataPointer, state.upload.size};
 
-            uint32_t i = 0;
-            for(const auto [position, uv, normal, tangent] : state.vertexData)
-            {
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_POSITION_OFFSET
-                        + sizeof(DirectX::XMFLOAT3) * i,
-                    &position,
-                    sizeof(DirectX::XMFLOAT3));
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_UV_OFFSET + sizeof(DirectX::XMFLOAT2) * i,
-                    &uv,
-                    sizeof(DirectX::XMFLOAT2));
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_NORMAL_OFFSET
-                        + sizeof(DirectX::XMFLOAT3) * i,
-                    &normal,
-                    sizeof(DirectX::XMFLOAT3));
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_TANGENT_OFFSET
-                        + sizeof(DirectX::XMFLOAT3) * i,
-                    &tangent,
-                    sizeof(DirectX::XMFLOAT3));
-
-                ++i;
-            }
-
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.INDEX_OFFSET,
-                state.indexData.data(),
-                state.constants.INDEX_SIZE);
+            // The cooked streams are already in their final format, so each one is a single copy
+            const MeshCache::Header& meshHeader = mesh.header();
+            state.upload.vertexPosition.write(uploadData, mesh.positions());
+            state.upload.vertexUv.write(uploadData, mesh.uvs());
+            state.upload.vertexNormal.write(uploadData, mesh.normals());
+            state.upload.vertexTangent.write(uploadData, mesh.tangents());
+            std::memcpy(state.upload.index.data(uploadData), mesh.indices(), state.upload.index.size());
 
             SimpleMath::Matrix transformMatrix = SimpleMath::Matrix::CreateRotationZ(0.0f).Transpose();
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.CBV_TRANSFORM_0_OFFSET,
-                &transformMatrix,
-                state.constants.CBV_TRANSFORM_0_SIZE);
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.CBV_TRANSFORM_1_OFFSET,
-                &transformMatrix,
-                state.constants.CBV_TRANSFORM_1_SIZE);
+            STATIC_UPLOAD.cbvTransform0.write(uploadData, transformMatrix);
+            STATIC_UPLOAD.cbvTransform1.write(uploadData, transformMatrix);
             // Note the transpose!
             SimpleMath::Matrix viewProjectionMatrix =
                 (SimpleMath::Matrix::CreateLookAt(CAMERA_POSITION, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f})
@@ -788,23 +660,11 @@ namespace DEMO_NAME
                      1.0f,
                      10.0f))
                     .Transpose();
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.CBV_VIEWPROJ_OFFSET,
-                &viewProjectionMatrix,
-                state.constants.CBV_VIEWPROJ_SIZE);
-
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.TEXTURE_ALBEDO_OFFSET,
-                textureAlbedoData.data(),
-                state.constants.TEXTURE_ALBEDO_SIZE);
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.TEXTURE_AMBIENT_OFFSET,
-                textureAmbientData.data(),
-                state.constants.TEXTURE_AMBIENT_SIZE);
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.TEXTURE_NORMAL_OFFSET,
-                textureNormalData.data(),
-                state.constants.TEXTURE_NORMAL_SIZE);
+            STATIC_UPLOAD.cbvViewProjection.write(uploadData, viewProjectionMatrix);
+
+            STATIC_UPLOAD.textureAlbedo.write(uploadData, textureAlbedoData);
+            STATIC_UPLOAD.textureAmbient.write(uploadData, textureAmbientData);
+            STATIC_UPLOAD.textureNormal.write(uploadData, textureNormalData);
             state.resources.uploadBuffer->Unmap(0, nullptr);
 
             // TODO: Implicit transition?
@@ -826,32 +686,32 @@ namespace DEMO_NAME
                 state.resources.vertexPositionBuffer.Get(),
                 0,
                 state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_POSITION_OFFSET,
-                state.constants.VERTEX_POSITION_SIZE);
+                state.upload.vertexPosition.offset,
+                state.upload.vertexPosition.size());
             state.commandList->CopyBufferRegion(
                 state.resources.vertexNormalBuffer.Get(),
                 0,
                 state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_NORMAL_OFFSET,
-                state.constants.VERTEX_NORMAL_SIZE);
+                state.upload.vertexNormal.offset,
+                state.upload.vertexNormal.size());
             state.commandList->CopyBufferRegion(
                 state.resources.vertexTangentBuffer.Get(),
                 0,
                 state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_TANGENT_OFFSET,
-                state.constants.VERTEX_TANGENT_SIZE);
+                state.upload.vertexTangent.offset,
+                state.upload.vertexTangent.size());
             state.commandList->CopyBufferRegion(
                 state.resources.vertexUvBuffer.Get(),
                 0,
                 state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_UV_OFFSET,
-                state.constants.VERTEX_UV_SIZE);
+                state.upload.vertexUv.offset,
+                state.upload.vertexUv.size());
             state.commandList->CopyBufferRegion(
                 state.resources.indexBuffer.Get(),
                 0,
                 state.resources.uploadBuffer.Get(),
-                state.constants.INDEX_OFFSET,
-                state.constants.INDEX_SIZE);
+                state.upload.index.offset,
+                state.upload.index.size());
             state.commandList->CopyTextureRegion(
                 as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
                     .pResource = state.resources.textureAlbedo.Get(),
@@ -866,7 +726,7 @@ namespace DEMO_NAME
                     .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
                     .PlacedFootprint =
                         D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
-                            .Offset = state.constants.TEXTURE_ALBEDO_OFFSET,
+                            .Offset = STATIC_UPLOAD.textureAlbedo.offset,
                             .Footprint =
                                 D3D12_SUBRESOURCE_FOOTPRINT{
                                     .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
@@ -891,7 +751,7 @@ namespace DEMO_NAME
                     .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
                     .PlacedFootprint =
                         D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
-                            .Offset = state.constants.TEXTURE_AMBIENT_OFFSET,
+                            .Offset = STATIC_UPLOAD.textureAmbient.offset,
                             .Footprint =
                                 D3D12_SUBRESOURCE_FOOTPRINT{
                                     .Format = DXGI_FORMAT_R8_UNORM,
@@ -916,7 +776,7 @@ namespace DEMO_NAME
                     .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
                     .PlacedFootprint =
                         D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
-                            .Offset = state.constants.TEXTURE_NORMAL_OFFSET,
+                            .Offset = STATIC_UPLOAD.textureNormal.offset,
                             .Footprint =
                                 D3D12_SUBRESOURCE_FOOTPRINT{
                                     .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
@@ -1229,70 +1089,67 @@ namespace DEMO_NAME
         std::array bufferViews{
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexPositionBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_POSITION_SIZE,
-                .StrideInBytes = sizeof(float) * 3,
+                .SizeInBytes = state.upload.vertexPosition.size(),
+                .StrideInBytes = state.upload.vertexPosition.STRIDE,
             },
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexUvBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_UV_SIZE,
-                .StrideInBytes = sizeof(float) * 2,
+                .SizeInBytes = state.upload.vertexUv.size(),
+                .StrideInBytes = state.upload.vertexUv.STRIDE,
             },
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexNormalBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_NORMAL_SIZE,
-                .StrideInBytes = sizeof(float) * 3,
+                .SizeInBytes = state.upload.vertexNormal.size(),
+                .StrideInBytes = state.upload.vertexNormal.STRIDE,
             },
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexTangentBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_TANGENT_SIZE,
-                .StrideInBytes = sizeof(float) * 3,
+                .SizeInBytes = state.upload.vertexTangent.size(),
+                .StrideInBytes = state.upload.vertexTangent.STRIDE,
             },
         };
         state.commandList->IASetVertexBuffers(0, bufferViews.size(), bufferViews.data());
         state.commandList->IASetIndexBuffer(as_lvalue(D3D12_INDEX_BUFFER_VIEW{
             .BufferLocation = state.resources.indexBuffer->GetGPUVirtualAddress(),
-            .SizeInBytes = state.constants.INDEX_SIZE,
-            .Format = DXGI_FORMAT_R32_UINT,
+            .SizeInBytes = state.upload.index.size(),
+            .Format = state.indexFormat,
         }));
 
         state.commandList->SetDescriptorHeaps(1, state.heaps.srv.GetAddressOf());
         state.commandList->SetGraphicsRootDescriptorTable(2, state.heaps.srv->GetGPUDescriptorHandleForHeapStart());
         state.commandList->SetGraphicsRootConstantBufferView(
             1,
-            state.resources.uploadBuffer->GetGPUVirtualAddress() + state.constants.CBV_VIEWPROJ_OFFSET);
+            STATIC_UPLOAD.cbvViewProjection.gpuAddress(state.resources.uploadBuffer->GetGPUVirtualAddress()));
 
         // Upload buffer data for both objects
         void* uploadBufferDataPointer;
         state.resources.uploadBuffer->Map(0, nullptr, &uploadBufferDataPointer);
+        std::span uploadData{(char*)uploadBufferDataPointer, state.upload.size};
         SimpleMath::Matrix transform =
             (SimpleMath::Matrix::CreateRotationX(std::sinf(time) * 0.2f)
              * SimpleMath::Matrix::CreateRotationY(time * 0.5f) * SimpleMath::Matrix::CreateTranslation(1, 0, 0))
                 .Transpose();
-        std::memcpy(
-            (char*)uploadBufferDataPointer + state.constants.CBV_TRANSFORM_0_OFFSET,
-            &transform,
-            state.constants.CBV_TRANSFORM_0_SIZE);
+        STATIC_UPLOAD.cbvTransform0.write(uploadData, transform);
         transform = (SimpleMath::Matrix::CreateRotationX(std::sinf(time) * 0.2f)
                      * SimpleMath::Matrix::CreateRotationY(time * -0.5f)
                      * SimpleMath::Matrix::CreateTranslation(-1, 0, std::sinf(time * 0.66f) + 0.5f))
                         .Transpose();
-        std::memcpy(
-            (char*)uploadBufferDataPointer + state.constants.CBV_TRANSFORM_1_OFFSET,
-            &transform,
-            state.constants.CBV_TRANSFORM_1_SIZE);
+        STATIC_UPLOAD.cbvTransform1.write(uploadData, transform);
         state.resources.uploadBuffer->Unmap(0, nullptr);
 
         // Bind and draw first object
         state.commandList->SetGraphicsRootConstantBufferView(
             0,
-            state.resources.uploadBuffer->GetGPUVirtualAddress() + state.constants.CBV_TRANSFORM_0_OFFSET);
-        state.commandList->DrawIndexedInstanced(state.indexData.size(), 1, 0, 0, 0);
+            STATIC_UPLOAD.cbvTransform0.gpuAddress(state.resources.uploadBuffer->GetGPUVirtualAddress()));
+        for(const IndexFormat::Batch& batch : state.indexBatches)
+            state.commandList->DrawIndexedInstanced(batch.indexCount, 1, batch.firstIndex, batch.baseVertex, 0);
 
         // Bind and draw second object
         state.commandList->SetGraphicsRootConstantBufferView(
             0,
-            state.resources.uploadBuffer->GetGPUVirtualAddress() + state.constants.CBV_TRANSFORM_1_OFFSET);
-        state.commandList->DrawIndexedInstanced(state.indexData.size(), 1, 0, 0, 0);
+            STATIC_UPLOAD.cbvTransform1.gpuAddress(state.resources.uploadBuffer->GetGPUVirtualAddress()));
+        for(const IndexFormat::Batch& batch : state.indexBatches)
+            state.commandList->DrawIndexedInstanced(batch.indexCount, 1, batch.firstIndex, batch.baseVertex, 0);
 
         state.commandList->ResourceBarrier(
             1,
@@ -6,7 +6,9 @@
 #include <cstring>
 #include <dxgiformat.h>
 #include <iostream>
+#include <span>
 #include <tuple>
+#include <utility>
 
 #include <DirectXMath.h>
 #include <SimpleMath.h>
@@ -18,17 +20,17 @@
 #include <dxgi1_2.h>
 
 #include <graphics/dx12/blend_state.hpp>
+#include <graphics/dx12/copy_batcher.hpp>
 #include <graphics/dx12/depth_stencil_state.hpp>
 #include <graphics/dx12/rasterizer_state.hpp>
 #include <graphics/dx12/versioning.hpp>
 
 #include <util/file_util.hpp>
 #include <util/path.hpp>
-#include <util/stbi.hpp>
 
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
+#include <asset/mesh_cache.hpp>
+#include <asset/mesh_lod.hpp>
+#include <asset/texture_cache.hpp>
 
 static dx12_demo::DEMO_NAME::State state;
 
@@ -42,53 +44,52 @@ namespace DEMO_NAME
     {
         State state{};
 
+        // Cooks cube.glb on the first run, after that it's just a mapped file
+        MeshCache::CookedMesh mesh = MeshCache::loadOrCook(Path::getAssetPath("cube.glb"), VERTEX_FORMAT).value();
+        // Cooked on the first run as well, full mip chains block compressed to BC7 for albedo with AO packed
+        // into its alpha, and BC5 for normals, the shaders rebuild the normals' Z. That's two fetches per pixel
+        // instead of three, and one texture less to upload. Each payload is already laid out the way
+        // CopyTextureRegion wants it, so it's copied into the upload buffer as is
+        TextureCache::CookedTexture albedoTexture =
+            TextureCache::loadOrCook(
+                Path::getAssetPath() / "texture" / "jagged-cliff1-albedo_low.png",
+                {
+                    .channels = TEXTURE_CHANNELS,
+                    .content = MipGenerate::Content::COLOR,
+                    .filter = MipGenerate::Filter::KAISER,
+                    .compression = TextureCompress::Format::BC7,
+                    .alphaSource = Path::getAssetPath() / "texture" / "jagged-cliff1-ao_low.png",
+                })
+                .value();
+        TextureCache::CookedTexture normalTexture =
+            TextureCache::loadOrCook(
+                Path::getAssetPath() / "texture" / "jagged-cliff1-normal-ogl_low.png",
+                {
+                    .channels = TEXTURE_CHANNELS,
+                    .content = MipGenerate::Content::NORMAL,
+                    .filter = MipGenerate::Filter::BOX,
+                    .compression = TextureCompress::Format::BC5,
+                })
+                .value();
         {
-            auto& indexData = state.indexData;
-            auto& vertexData = state.vertexData;
-
-            Assimp::Importer importer;
-            const aiScene* scene = importer.ReadFile(
-                Path::getAssetPath("cube.glb").string().c_str(), // This works with non-ANSII paths on Win11 22H2 ???
-                aiPostProcessSteps::aiProcess_PreTransformVertices);
-            assert(scene);
-
-            aiMesh* mesh = scene->mMeshes[0];
-            for(aiFace* face = mesh->mFaces; face < mesh->mFaces + mesh->mNumFaces; ++face)
-            {
-                assert(face->mNumIndices == 3);
-                indexData.push_back(face->mIndices[0]);
-                indexData.push_back(face->mIndices[1]);
-                indexData.push_back(face->mIndices[2]);
-            }
-
-            for(auto [position, texCoords, normal, tangent] =
-                    std::make_tuple(mesh->mVertices, mesh->mTextureCoords[0], mesh->mNormals, mesh->mTangents);
-                position != mesh->mVertices + mesh->mNumVertices;
-                ++position, ++texCoords, ++normal, ++tangent)
-            {
-                vertexData.push_back({
-                    .position = {position->x, position->y, position->z},
-                    .uv = {texCoords->x, texCoords->y},
-                    .normal = {normal->x, normal->y, normal->z},
-                    .tangent = {tangent->x, tangent->y, tangent->z},
-                });
-            }
-
-            OffsetCounter counter;
+            const MeshCache::Header& meshHeader = mesh.header();
+            state.indexFormat = meshHeader.indexStride == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+            state.indexBatches.assign(mesh.batches().begin(), mesh.batches().end());
+            state.lods.assign(mesh.lods().begin(), mesh.lods().end());
+            state.parts.assign(mesh.parts().begin(), mesh.parts().end());
 
+            UploadLayout layout{STATIC_UPLOAD.size};
             // clang-format off
-            auto& c = state.constants;
-            std::tie(c.VERTEX_POSITION_OFFSET, c.VERTEX_POSITION_SIZE)   = counter.append<DirectX::XMFLOAT3>(vertexData.size());
-            std::tie(c.VERTEX_UV_OFFSET, c.VERTEX_UV_SIZE)               = counter.append<DirectX::XMFLOAT2>(vertexData.size());
-            std::tie(c.VERTEX_NORMAL_OFFSET, c.VERTEX_NORMAL_SIZE)       = counter.append<DirectX::XMFLOAT3>(vertexData.size());
-            std::tie(c.VERTEX_TANGENT_OFFSET, c.VERTEX_TANGENT_SIZE)     = counter.append<DirectX::XMFLOAT3>(vertexData.size());
-            std::tie(c.INDEX_OFFSET, c.INDEX_SIZE)                       = counter.append<DirectX::XMFLOAT2>(indexData.size());
-            std::tie(c.CBV_TRANSFORM_OFFSET, c.CBV_TRANSFORM_SIZE)       = counter.appendAligned<DirectX::XMFLOAT4X4>(1, 256);
-            std::tie(c.CBV_VIEWPROJ_OFFSET, c.CBV_VIEWPROJ_SIZE)         = counter.appendAligned<DirectX::XMFLOAT4X4>(1, 256);
-            std::tie(c.TEXTURE_ALBEDO_OFFSET, c.TEXTURE_ALBEDO_SIZE)   = counter.appendAligned(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
-            std::tie(c.TEXTURE_AMBIENT_OFFSET, c.TEXTURE_AMBIENT_SIZE)   = counter.appendAligned(AlignTo(TEXTURE_WIDTH, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
-            std::tie(c.TEXTURE_NORMAL_OFFSET, c.TEXTURE_NORMAL_SIZE)     = counter.appendAligned(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
-            std::tie(c.UPLOAD_BUFFER_SIZE, std::ignore) = counter.append(0);
+            state.upload = {
+                .vertexPosition = layout.add<char>(meshHeader.positionSize),
+                .vertexUv = layout.add<char>(meshHeader.uvSize),
+                .vertexNormal = layout.add<char>(meshHeader.normalSize),
+                .vertexTangent = layout.add<char>(meshHeader.tangentSize),
+                .index = layout.add<char>(meshHeader.indexSize),
+                .textureAlbedo = layout.add<char>(albedoTexture.header().payloadSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT),
+                .textureNormal = layout.add<char>(normalTexture.header().payloadSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT),
+                .size = layout.getSize(),
+            };
             // clang-format on
         }
 
@@ -182,7 +183,7 @@ namespace DEMO_NAME
             Die(device->CreateDescriptorHeap(
                 as_lvalue(D3D12_DESCRIPTOR_HEAP_DESC{
                     .Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
-                    .NumDescriptors = 3,
+                    .NumDescriptors = 2,
                     .Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
                     .NodeMask = 0,
                 }),
@@ -210,129 +211,6 @@ namespace DEMO_NAME
                 Out(state.commandList)));
         }
 
-        uint32_t textureRowPitch;
-        std::vector<char> textureAlbedoData;
-        {
-            auto albedoPath = Path::getAssetPath() / "texture" / "jagged-cliff1-albedo_low.png";
-
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), albedoPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_rgb_alpha), // everything will break if this is
-                                                                                    // changed from STBI_rgb_alpha :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                return stbiData;
-            }();
-
-            textureRowPitch = AlignTo(TEXTURE_WIDTH * 4, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
-
-            textureAlbedoData.resize(textureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureAlbedoData.data() + textureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 4 * i,
-                    TEXTURE_WIDTH * 4);
-        }
-
-        uint32_t ambientTextureRowPitch;
-        std::vector<char> textureAmbientData;
-        {
-            auto normalPath = Path::getAssetPath() / "texture" / "jagged-cliff1-ao_low.png";
-
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), normalPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_grey), // everything will break if this is
-                                                                               // changed from STBI_grey :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                ambientTextureRowPitch = AlignTo(TEXTURE_WIDTH * 1, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
-
-                return stbiData;
-            }();
-
-            textureAmbientData.resize(ambientTextureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureAmbientData.data() + ambientTextureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 1 * i,
-                    TEXTURE_WIDTH * 1);
-        }
-
-        std::vector<char> textureNormalData;
-        {
-            auto normalPath = Path::getAssetPath() / "texture" / "jagged-cliff1-normal-ogl_low.png";
-
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), normalPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_rgb_alpha), // everything will break if this is
-                                                                                    // changed from STBI_rgb_alpha :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                return stbiData;
-            }();
-
-            textureNormalData.resize(textureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureNormalData.data() + textureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 4 * i,
-                    TEXTURE_WIDTH * 4);
-        }
-
         {
             device->CreateCommittedResource(
                 as_lvalue(D3D12_HEAP_PROPERTIES{
@@ -347,7 +225,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.UPLOAD_BUFFER_SIZE,
+                    .Width = state.upload.size,
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -379,7 +257,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_POSITION_SIZE,
+                    .Width = state.upload.vertexPosition.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -408,7 +286,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_NORMAL_SIZE,
+                    .Width = state.upload.vertexNormal.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -437,7 +315,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_TANGENT_SIZE,
+                    .Width = state.upload.vertexTangent.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -466,7 +344,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_UV_SIZE,
+                    .Width = state.upload.vertexUv.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -496,7 +374,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.INDEX_SIZE,
+                    .Width = state.upload.index.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -526,11 +404,11 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = TEXTURE_WIDTH,
-                    .Height = TEXTURE_HEIGHT,
+                    .Width = albedoTexture.header().width,
+                    .Height = albedoTexture.header().height,
                     .DepthOrArraySize = 1, // Mandatory
-                    .MipLevels = 1,
-                    .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+                    .MipLevels = (UINT16)albedoTexture.header().levelCount,
+                    .Format = DXGI_FORMAT_BC7_UNORM,
                     .SampleDesc =
                         {
                             .Count = 1, // Mandatory
@@ -555,40 +433,11 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = TEXTURE_WIDTH,
-                    .Height = TEXTURE_HEIGHT,
+                    .Width = normalTexture.header().width,
+                    .Height = normalTexture.header().height,
                     .DepthOrArraySize = 1, // Mandatory
-                    .MipLevels = 1,
-                    .Format = DXGI_FORMAT_R8_UNORM,
-                    .SampleDesc =
-                        {
-                            .Count = 1, // Mandatory
-                            .Quality = 0, // Mandatory
-                        },
-                    .Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN, // Mandatory
-                    .Flags = D3D12_RESOURCE_FLAG_NONE,
-                }),
-                D3D12_RESOURCE_STATE_COMMON,
-                nullptr,
-                Out(state.resources.textureAmbient));
-            device->CreateCommittedResource(
-                as_lvalue(D3D12_HEAP_PROPERTIES{
-                    .Type = D3D12_HEAP_TYPE_DEFAULT,
-                    .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN, // Mandatory
-                    .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN, // Mandatory
-                    .CreationNodeMask = 0,
-                    .VisibleNodeMask = 0,
-                }),
-                D3D12_HEAP_FLAG_NONE,
-                as_lvalue(D3D12_RESOURCE_DESC{
-                    .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
-                    .Alignment =
-                        0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = TEXTURE_WIDTH,
-                    .Height = TEXTURE_HEIGHT,
-                    .DepthOrArraySize = 1, // Mandatory
-                    .MipLevels = 1,
-                    .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+                    .MipLevels = (UINT16)normalTexture.header().levelCount,
+                    .Format = DXGI_FORMAT_BC5_UNORM,
                     .SampleDesc =
                         {
                             .Count = 1, // Mandatory
@@ -606,9 +455,6 @@ namespace DEMO_NAME
             auto handle = state.heaps.srv->GetCPUDescriptorHandleForHeapStart();
             device->CreateShaderResourceView(state.resources.textureAlbedo.Get(), nullptr, handle);
 
-            handle.ptr += state.descriptorSizes.srv;
-            device->CreateShaderResourceView(state.resources.textureAmbient.Get(), nullptr, handle);
-
             handle.ptr += state.descriptorSizes.srv;
             device->CreateShaderResourceView(state.resources.textureNormal.Get(), nullptr, handle);
         }
@@ -616,43 +462,38 @@ namespace DEMO_NAME
         {
             void* uploadBufferDataPointer;
             state.resources.uploadBuffer->Map(0, nullptr, &uploadBufferDataPointer);
+            std::span uploadData{(char*)uploadBufferDataPointer, state.upload.size};
 
-            uint32_t i = 0;
-            for(const auto [position, uv, normal, tangent] : state.vertexData)
-            {
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_POSITION_OFFSET
-                        + sizeof(DirectX::XMFLOAT3) * i,
-                    &position,
-                    sizeof(DirectX::XMFLOAT3));
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_UV_OFFSET + sizeof(DirectX::XMFLOAT2) * i,
-                    &uv,
-                    sizeof(DirectX::XMFLOAT2));
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_NORMAL_OFFSET
-                        + sizeof(DirectX::XMFLOAT3) * i,
-                    &normal,
-                    sizeof(DirectX::XMFLOAT3));
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_TANGENT_OFFSET
-                        + sizeof(DirectX::XMFLOAT3) * i,
-                    &tangent,
-                    sizeof(DirectX::XMFLOAT3));
-
-                ++i;
-            }
-
+            // The cooked streams are already in their final format, so each one is a single copy
+            const MeshCache::Header& meshHeader = mesh.header();
+            std::memcpy(
+                state.upload.vertexPosition.data(uploadData),
+                mesh.payload() + meshHeader.positionOffset,
+                state.upload.vertexPosition.size());
+            std::memcpy(
+                state.upload.vertexUv.data(uploadData),
+                mesh.payload() + meshHeader.uvOffset,
+                state.upload.vertexUv.size());
+            std::memcpy(
+                state.upload.vertexNormal.data(uploadData),
+                mesh.payload() + meshHeader.normalOffset,
+                state.upload.vertexNormal.size());
             std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.INDEX_OFFSET,
-                state.indexData.data(),
-                state.constants.INDEX_SIZE);
+                state.upload.vertexTangent.data(uploadData),
+                mesh.payload() + meshHeader.tangentOffset,
+                state.upload.vertexTangent.size());
+            std::memcpy(state.upload.index.data(uploadData), mesh.indices(), state.upload.index.size());
+            std::memcpy(
+                state.upload.textureAlbedo.data(uploadData),
+                albedoTexture.payload(),
+                state.upload.textureAlbedo.size());
+            std::memcpy(
+                state.upload.textureNormal.data(uploadData),
+                normalTexture.payload(),
+                state.upload.textureNormal.size());
 
             SimpleMath::Matrix transformMatrix = SimpleMath::Matrix::CreateRotationZ(0.0f).Transpose();
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.CBV_TRANSFORM_OFFSET,
-                &transformMatrix,
-                state.constants.CBV_TRANSFORM_SIZE);
+            STATIC_UPLOAD.cbvTransform.write(uploadData, transformMatrix);
             // Note the transpose!
             SimpleMath::Matrix viewProjectionMatrix =
                 (SimpleMath::Matrix::CreateLookAt(CAMERA_POSITION, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f})
@@ -662,23 +503,20 @@ namespace DEMO_NAME
                      0.5f,
                      5.0f))
                     .Transpose();
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.CBV_VIEWPROJ_OFFSET,
-                &viewProjectionMatrix,
-                state.constants.CBV_VIEWPROJ_SIZE);
+            STATIC_UPLOAD.cbvViewProjection.write(uploadData, viewProjectionMatrix);
+#ifdef DEMO_VARIANT_QUANTIZED
+            // float3s are padded to 16 bytes in a cbuffer
+            std::array quantization = std::to_array({
+                DirectX::XMFLOAT4{meshHeader.positionMin.x, meshHeader.positionMin.y, meshHeader.positionMin.z, 0.0f},
+                DirectX::XMFLOAT4{
+                    meshHeader.positionExtent.x,
+                    meshHeader.positionExtent.y,
+                    meshHeader.positionExtent.z,
+                    0.0f},
+            });
+            STATIC_UPLOAD.cbvQuantization.write(uploadData, quantization);
+#endif
 
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.TEXTURE_ALBEDO_OFFSET,
-                textureAlbedoData.data(),
-                state.constants.TEXTURE_ALBEDO_SIZE);
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.TEXTURE_AMBIENT_OFFSET,
-                textureAmbientData.data(),
-                state.constants.TEXTURE_AMBIENT_SIZE);
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.TEXTURE_NORMAL_OFFSET,
-                textureNormalData.data(),
-                state.constants.TEXTURE_NORMAL_SIZE);
             state.resources.uploadBuffer->Unmap(0, nullptr);
 
             // TODO: Implicit transition?
@@ -696,155 +534,69 @@ namespace DEMO_NAME
             //             },
             //     }));
 
-            state.commandList->CopyBufferRegion(
-                state.resources.vertexPositionBuffer.Get(),
-                0,
-                state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_POSITION_OFFSET,
-                state.constants.VERTEX_POSITION_SIZE);
-            state.commandList->CopyBufferRegion(
-                state.resources.vertexNormalBuffer.Get(),
-                0,
-                state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_NORMAL_OFFSET,
-                state.constants.VERTEX_NORMAL_SIZE);
-            state.commandList->CopyBufferRegion(
-                state.resources.vertexTangentBuffer.Get(),
-                0,
-                state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_TANGENT_OFFSET,
-                state.constants.VERTEX_TANGENT_SIZE);
-            state.commandList->CopyBufferRegion(
-                state.resources.vertexUvBuffer.Get(),
-                0,
-                state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_UV_OFFSET,
-                state.constants.VERTEX_UV_SIZE);
-            state.commandList->CopyBufferRegion(
-                state.resources.indexBuffer.Get(),
-                0,
-                state.resources.uploadBuffer.Get(),
-                state.constants.INDEX_OFFSET,
-                state.constants.INDEX_SIZE);
-            state.commandList->CopyTextureRegion(
-                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
-                    .pResource = state.resources.textureAlbedo.Get(),
-                    .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
-                    .SubresourceIndex = 0,
-                }),
-                0,
-                0,
-                0,
-                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
-                    .pResource = state.resources.uploadBuffer.Get(),
-                    .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
-                    .PlacedFootprint =
-                        D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
-                            .Offset = state.constants.TEXTURE_ALBEDO_OFFSET,
-                            .Footprint =
-                                D3D12_SUBRESOURCE_FOOTPRINT{
-                                    .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
-                                    .Width = TEXTURE_WIDTH,
-                                    .Height = TEXTURE_HEIGHT,
-                                    .Depth = 1,
-                                    .RowPitch = textureRowPitch,
-                                },
-                        }}),
-                nullptr);
-            state.commandList->CopyTextureRegion(
-                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
-                    .pResource = state.resources.textureAmbient.Get(),
-                    .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
-                    .SubresourceIndex = 0,
-                }),
-                0,
-                0,
-                0,
-                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
-                    .pResource = state.resources.uploadBuffer.Get(),
-                    .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
-                    .PlacedFootprint =
-                        D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
-                            .Offset = state.constants.TEXTURE_AMBIENT_OFFSET,
-                            .Footprint =
-                                D3D12_SUBRESOURCE_FOOTPRINT{
-                                    .Format = DXGI_FORMAT_R8_UNORM,
-                                    .Width = TEXTURE_WIDTH,
-                                    .Height = TEXTURE_HEIGHT,
-                                    .Depth = 1,
-                                    .RowPitch = ambientTextureRowPitch,
-                                },
-                        }}),
-                nullptr);
-            state.commandList->CopyTextureRegion(
-                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
-                    .pResource = state.resources.textureNormal.Get(),
-                    .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
-                    .SubresourceIndex = 0,
-                }),
-                0,
-                0,
-                0,
-                as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
-                    .pResource = state.resources.uploadBuffer.Get(),
-                    .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
-                    .PlacedFootprint =
+            CopyBatcher copies;
+            auto bufferUploads = std::to_array<std::pair<ID3D12Resource*, UploadRegion<char>>>({
+                {state.resources.vertexPositionBuffer.Get(), state.upload.vertexPosition},
+                {state.resources.vertexNormalBuffer.Get(), state.upload.vertexNormal},
+                {state.resources.vertexTangentBuffer.Get(), state.upload.vertexTangent},
+                {state.resources.vertexUvBuffer.Get(), state.upload.vertexUv},
+                {state.resources.indexBuffer.Get(), state.upload.index},
+            });
+            for(const auto& [buffer, region] : bufferUploads)
+                copies.copyBuffer(buffer, 0, state.resources.uploadBuffer.Get(), region.offset, region.size());
+
+            struct TextureUpload
+            {
+                ID3D12Resource* texture;
+                DXGI_FORMAT format;
+                uint32_t offset;
+                std::span<const MipGenerate::Level> levels;
+            };
+            auto textureUploads = std::to_array({
+                TextureUpload{
+                    state.resources.textureAlbedo.Get(),
+                    DXGI_FORMAT_BC7_UNORM,
+                    state.upload.textureAlbedo.offset,
+                    albedoTexture.levels()},
+                TextureUpload{
+                    state.resources.textureNormal.Get(),
+                    DXGI_FORMAT_BC5_UNORM,
+                    state.upload.textureNormal.offset,
+                    normalTexture.levels()},
+            });
+            // One copy per mip, the layout already has every level where GetCopyableFootprints would put it.
+            // The small levels are padded to whole blocks, which is the size the copy wants
+            for(const TextureUpload& upload : textureUploads)
+            {
+                for(uint32_t level = 0; level < upload.levels.size(); ++level)
+                {
+                    const MipGenerate::Level& mip = upload.levels[level];
+                    copies.copyTexture(
+                        upload.texture,
+                        level,
+                        state.resources.uploadBuffer.Get(),
                         D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
-                            .Offset = state.constants.TEXTURE_NORMAL_OFFSET,
+                            .Offset = upload.offset + mip.offset,
                             .Footprint =
                                 D3D12_SUBRESOURCE_FOOTPRINT{
-                                    .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
-                                    .Width = TEXTURE_WIDTH,
-                                    .Height = TEXTURE_HEIGHT,
+                                    .Format = upload.format,
+                                    .Width = mip.width,
+                                    .Height = mip.height,
                                     .Depth = 1,
-                                    .RowPitch = textureRowPitch,
+                                    .RowPitch = mip.rowPitch,
                                 },
-                        }}),
-                nullptr);
-
-            // Note: resource has been promoted into COPY_DEST
-            auto barriers = std::to_array({
-                D3D12_RESOURCE_BARRIER{
-                    .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-                    .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-                    .Transition =
-                        {
-                            .pResource = state.resources.textureAlbedo.Get(),
-                            .Subresource = 0,
-                            .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
-                            .StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-                        },
-                },
-                D3D12_RESOURCE_BARRIER{
-                    .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-                    .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-                    .Transition =
-                        {
-                            .pResource = state.resources.textureAmbient.Get(),
-                            .Subresource = 0,
-                            .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
-                            .StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-                        },
-                },
-                D3D12_RESOURCE_BARRIER{
-                    .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-                    .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-                    .Transition =
-                        {
-                            .pResource = state.resources.textureNormal.Get(),
-                            .Subresource = 0,
-                            .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
-                            .StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-                        },
-                },
-            });
-            state.commandList->ResourceBarrier(barriers.size(), barriers.data());
+                        });
+                }
+                // Note: resource has been promoted into COPY_DEST
+                copies.transition(upload.texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+            }
+            copies.flush(state.commandList.Get());
         }
 
         {
             std::array descriptorTableRanges = std::to_array({D3D12_DESCRIPTOR_RANGE{
                 .RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
-                .NumDescriptors = 3,
+                .NumDescriptors = 2,
                 .BaseShaderRegister = 0,
                 .RegisterSpace = 0,
                 .OffsetInDescriptorsFromTableStart = 0,
@@ -877,6 +629,18 @@ namespace DEMO_NAME
                         },
                     .ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL,
                 },
+#ifdef DEMO_VARIANT_QUANTIZED
+                // After the table so the parameters every variant shares keep their indices
+                D3D12_ROOT_PARAMETER{
+                    .ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV,
+                    .Descriptor =
+                        D3D12_ROOT_DESCRIPTOR{
+                            .ShaderRegister = 2,
+                            .RegisterSpace = 0,
+                        },
+                    .ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX,
+                },
+#endif
             });
 
             std::array samplers = std::to_array({D3D12_STATIC_SAMPLER_DESC{
@@ -889,7 +653,7 @@ namespace DEMO_NAME
                 .ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER,
                 .BorderColor = D3D12_STATIC_BORDER_COLOR_OPAQUE_BLACK,
                 .MinLOD = 0.0f,
-                .MaxLOD = 0.0,
+                .MaxLOD = D3D12_FLOAT32_MAX,
                 .ShaderRegister = 0,
                 .RegisterSpace = 0,
                 .ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL,
@@ -925,8 +689,11 @@ namespace DEMO_NAME
 #elif DEMO_VARIANT_WORLD_SPACE
             std::vector vertexShaderCode =
                 FileUtil::readFile(Path::getShaderPath("vs/normal_mapping_world.bin")).value();
+#elif DEMO_VARIANT_QUANTIZED
+            std::vector vertexShaderCode =
+                FileUtil::readFile(Path::getShaderPath("vs/normal_mapping_quantized.bin")).value();
 #else
-    #error Must be compiled with either -DDEMO_VARIANT_TANGENT_SPACE or -DDEMO_VARIANT_WORLD_SPACE
+    #error Must be compiled with one of -DDEMO_VARIANT_TANGENT_SPACE, -DDEMO_VARIANT_WORLD_SPACE or -DDEMO_VARIANT_QUANTIZED
 #endif
             Die(D3DCreateBlob(vertexShaderCode.size(), state.shaders.vertexBlob.GetAddressOf()));
             std::memcpy(state.shaders.vertexBlob->GetBufferPointer(), vertexShaderCode.data(), vertexShaderCode.size());
@@ -935,23 +702,27 @@ namespace DEMO_NAME
         {
 #ifdef DEMO_VARIANT_TANGENT_SPACE
             std::vector pixelShaderCode =
-                FileUtil::readFile(Path::getShaderPath("ps/normal_mapping_tangent.bin")).value();
+                FileUtil::readFile(Path::getShaderPath("ps/normal_mapping_tangent_packed.bin")).value();
 #elif DEMO_VARIANT_WORLD_SPACE
             std::vector pixelShaderCode =
                 FileUtil::readFile(Path::getShaderPath("ps/normal_mapping_world.bin")).value();
+#elif DEMO_VARIANT_QUANTIZED
+            std::vector pixelShaderCode =
+                FileUtil::readFile(Path::getShaderPath("ps/normal_mapping_tangent_packed.bin")).value();
 #else
-    #error Must be compiled with either -DDEMO_VARIANT_TANGENT_SPACE or -DDEMO_VARIANT_WORLD_SPACE
+    #error Must be compiled with one of -DDEMO_VARIANT_TANGENT_SPACE, -DDEMO_VARIANT_WORLD_SPACE or -DDEMO_VARIANT_QUANTIZED
 #endif
             Die(D3DCreateBlob(pixelShaderCode.size(), state.shaders.pixelBlob.GetAddressOf()));
             std::memcpy(state.shaders.pixelBlob->GetBufferPointer(), pixelShaderCode.data(), pixelShaderCode.size());
         }
 
         {
+            constexpr bool quantized = VERTEX_FORMAT == MeshCache::VertexFormat::QUANTIZED;
             std::array inputLayout = std::to_array({
                 D3D12_INPUT_ELEMENT_DESC{
                     .SemanticName = "POSITION",
                     .SemanticIndex = 0,
-                    .Format = DXGI_FORMAT_R32G32B32_FLOAT,
+                    .Format = quantized ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R32G32B32_FLOAT,
                     .InputSlot = 0,
                     .AlignedByteOffset = 0,
                     .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
@@ -960,7 +731,7 @@ namespace DEMO_NAME
                 D3D12_INPUT_ELEMENT_DESC{
                     .SemanticName = "UV",
                     .SemanticIndex = 0,
-                    .Format = DXGI_FORMAT_R32G32_FLOAT,
+                    .Format = quantized ? DXGI_FORMAT_R16G16_FLOAT : DXGI_FORMAT_R32G32_FLOAT,
                     .InputSlot = 1,
                     .AlignedByteOffset = 0,
                     .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
@@ -969,7 +740,7 @@ namespace DEMO_NAME
                 D3D12_INPUT_ELEMENT_DESC{
                     .SemanticName = "NORMAL",
                     .SemanticIndex = 0,
-                    .Format = DXGI_FORMAT_R32G32B32_FLOAT,
+                    .Format = quantized ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R32G32B32_FLOAT,
                     .InputSlot = 2,
                     .AlignedByteOffset = 0,
                     .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
@@ -978,7 +749,7 @@ namespace DEMO_NAME
                 D3D12_INPUT_ELEMENT_DESC{
                     .SemanticName = "TANGENT",
                     .SemanticIndex = 0,
-                    .Format = DXGI_FORMAT_R32G32B32_FLOAT,
+                    .Format = quantized ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R32G32B32_FLOAT,
                     .InputSlot = 3,
                     .AlignedByteOffset = 0,
                     .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
@@ -1095,13 +866,11 @@ namespace DEMO_NAME
 
         void* uploadBufferDataPointer;
         state.resources.uploadBuffer->Map(0, nullptr, &uploadBufferDataPointer);
+        std::span uploadData{(char*)uploadBufferDataPointer, state.upload.size};
         SimpleMath::Matrix transform = (SimpleMath::Matrix::CreateRotationX(std::sinf(time) * 0.2f)
                                         * SimpleMath::Matrix::CreateRotationY(time * 0.5f))
                                            .Transpose();
-        std::memcpy(
-            (char*)uploadBufferDataPointer + state.constants.CBV_TRANSFORM_OFFSET,
-            &transform,
-            state.constants.CBV_TRANSFORM_SIZE);
+        STATIC_UPLOAD.cbvTransform.write(uploadData, transform);
         state.resources.uploadBuffer->Unmap(0, nullptr);
 
         auto backBufferHandle = state.heaps.rtv->GetCPUDescriptorHandleForHeapStart();
@@ -1115,42 +884,59 @@ namespace DEMO_NAME
         std::array bufferViews{
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexPositionBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_POSITION_SIZE,
-                .StrideInBytes = sizeof(float) * 3,
+                .SizeInBytes = state.upload.vertexPosition.size(),
+                .StrideInBytes = VERTEX_STRIDES.position,
             },
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexUvBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_UV_SIZE,
-                .StrideInBytes = sizeof(float) * 2,
+                .SizeInBytes = state.upload.vertexUv.size(),
+                .StrideInBytes = VERTEX_STRIDES.uv,
             },
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexNormalBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_NORMAL_SIZE,
-                .StrideInBytes = sizeof(float) * 3,
+                .SizeInBytes = state.upload.vertexNormal.size(),
+                .StrideInBytes = VERTEX_STRIDES.normal,
             },
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexTangentBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_TANGENT_SIZE,
-                .StrideInBytes = sizeof(float) * 3,
+                .SizeInBytes = state.upload.vertexTangent.size(),
+                .StrideInBytes = VERTEX_STRIDES.tangent,
             },
         };
         state.commandList->IASetVertexBuffers(0, bufferViews.size(), bufferViews.data());
         state.commandList->IASetIndexBuffer(as_lvalue(D3D12_INDEX_BUFFER_VIEW{
             .BufferLocation = state.resources.indexBuffer->GetGPUVirtualAddress(),
-            .SizeInBytes = state.constants.INDEX_SIZE,
-            .Format = DXGI_FORMAT_R32_UINT,
+            .SizeInBytes = state.upload.index.size(),
+            .Format = state.indexFormat,
         }));
         state.commandList->SetGraphicsRootConstantBufferView(
             0,
-            state.resources.uploadBuffer->GetGPUVirtualAddress() + state.constants.CBV_TRANSFORM_OFFSET);
+            STATIC_UPLOAD.cbvTransform.gpuAddress(state.resources.uploadBuffer->GetGPUVirtualAddress()));
 
         state.commandList->SetGraphicsRootConstantBufferView(
             1,
-            state.resources.uploadBuffer->GetGPUVirtualAddress() + state.constants.CBV_VIEWPROJ_OFFSET);
+            STATIC_UPLOAD.cbvViewProjection.gpuAddress(state.resources.uploadBuffer->GetGPUVirtualAddress()));
 
         state.commandList->SetDescriptorHeaps(1, state.heaps.srv.GetAddressOf());
         state.commandList->SetGraphicsRootDescriptorTable(2, state.heaps.srv->GetGPUDescriptorHandleForHeapStart());
-        state.commandList->DrawIndexedInstanced(state.indexData.size(), 1, 0, 0, 0);
+#ifdef DEMO_VARIANT_QUANTIZED
+        state.commandList->SetGraphicsRootConstantBufferView(
+            3,
+            STATIC_UPLOAD.cbvQuantization.gpuAddress(state.resources.uploadBuffer->GetGPUVirtualAddress()));
+#endif
+
+        // The transform is identity and node transforms are baked into the vertices, so the part bounds are
+        // already in world space
+        float projectionScale = MeshLod::getProjectionScale(DirectX::XMConvertToRadians(59.0f), windowHeight);
+        for(const MeshCache::Part& part : state.parts)
+        {
+            float distance = (CAMERA_POSITION - SimpleMath::Vector3(part.boundsCenter)).Length() - part.boundsRadius;
+            std::span lods = std::span(state.lods).subspan(part.firstLod, part.lodCount);
+            const MeshCache::Lod& lod = lods[MeshLod::select(lods, distance, projectionScale)];
+            std::span batches = std::span(state.indexBatches).subspan(lod.firstBatch, lod.batchCount);
+            for(const IndexFormat::Batch& batch : batches)
+                state.commandList->DrawIndexedInstanced(batch.indexCount, 1, batch.firstIndex, batch.baseVertex, 0);
+        }
 
         state.commandList->ResourceBarrier(
             1,
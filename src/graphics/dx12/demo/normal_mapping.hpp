@@ -3,10 +3,13 @@
 #include <array>
 #include <cstdint>
 #include <numeric>
+#include <vector>
 
+#include <asset/index_format.hpp>
+#include <asset/mesh_cache.hpp>
 #include <graphics/dx12/versioning.hpp>
 #include <util/align.hpp>
-#include <util/offset_counter.hpp>
+#include <util/upload_layout.hpp>
 
 #include <DirectXMath.h>
 #include <SimpleMath.h>
@@ -21,19 +24,41 @@ namespace DEMO_NAME
     constexpr uint32_t MSAA_COUNT = 1;
     constexpr uint32_t MSAA_QUALITY = 0;
 
-    constexpr uint32_t TEXTURE_WIDTH = 512;
-    constexpr uint32_t TEXTURE_HEIGHT = 512;
     constexpr uint32_t TEXTURE_CHANNELS = 4;
 
     constexpr DirectX::SimpleMath::Vector3 CAMERA_POSITION{0.0f, 0.0f, -3.0f};
 
-    struct Vertex
+#ifdef DEMO_VARIANT_QUANTIZED
+    constexpr MeshCache::VertexFormat VERTEX_FORMAT = MeshCache::VertexFormat::QUANTIZED;
+#else
+    constexpr MeshCache::VertexFormat VERTEX_FORMAT = MeshCache::VertexFormat::FULL;
+#endif
+    constexpr MeshCache::VertexStrides VERTEX_STRIDES = MeshCache::getVertexStrides(VERTEX_FORMAT);
+
+    // Everything with a size that's known up front, laid out at compile time at the start of the upload buffer
+    struct StaticUpload
     {
-        DirectX::SimpleMath::Vector3 position;
-        DirectX::SimpleMath::Vector2 uv;
-        DirectX::SimpleMath::Vector3 normal;
-        DirectX::SimpleMath::Vector3 tangent;
+        UploadRegion<DirectX::XMFLOAT4X4> cbvTransform;
+        UploadRegion<DirectX::XMFLOAT4X4> cbvViewProjection;
+#ifdef DEMO_VARIANT_QUANTIZED
+        UploadRegion<DirectX::XMFLOAT4> cbvQuantization;
+#endif
+        uint32_t size;
     };
+    constexpr StaticUpload STATIC_UPLOAD = []
+    {
+        UploadLayout layout;
+        // clang-format off
+        return StaticUpload{
+            .cbvTransform = layout.add<DirectX::XMFLOAT4X4>(1, 256),
+            .cbvViewProjection = layout.add<DirectX::XMFLOAT4X4>(1, 256),
+#ifdef DEMO_VARIANT_QUANTIZED
+            .cbvQuantization = layout.add<DirectX::XMFLOAT4>(2, 256),
+#endif
+            .size = layout.getSize(),
+        };
+        // clang-format on
+    }();
 
     struct State
     {
@@ -81,7 +106,6 @@ namespace DEMO_NAME
             ID3D12ResourceS vertexTangentBuffer;
             ID3D12ResourceS indexBuffer;
             ID3D12ResourceS textureAlbedo;
-            ID3D12ResourceS textureAmbient;
             ID3D12ResourceS textureNormal;
         } resources;
 
@@ -91,33 +115,24 @@ namespace DEMO_NAME
             ID3DBlobS pixelBlob;
         } shaders;
 
+        // After STATIC_UPLOAD
         struct
         {
-            uint32_t VERTEX_POSITION_OFFSET = -1;
-            uint32_t VERTEX_POSITION_SIZE = -1;
-            uint32_t VERTEX_UV_OFFSET = -1;
-            uint32_t VERTEX_UV_SIZE = -1;
-            uint32_t VERTEX_NORMAL_OFFSET = -1;
-            uint32_t VERTEX_NORMAL_SIZE = -1;
-            uint32_t VERTEX_TANGENT_OFFSET = -1;
-            uint32_t VERTEX_TANGENT_SIZE = -1;
-            uint32_t INDEX_OFFSET = -1;
-            uint32_t INDEX_SIZE = -1;
-            uint32_t CBV_TRANSFORM_OFFSET = -1;
-            uint32_t CBV_TRANSFORM_SIZE = -1;
-            uint32_t CBV_VIEWPROJ_OFFSET = -1;
-            uint32_t CBV_VIEWPROJ_SIZE = -1;
-            uint32_t TEXTURE_ALBEDO_OFFSET = -1;
-            uint32_t TEXTURE_ALBEDO_SIZE = -1;
-            uint32_t TEXTURE_AMBIENT_OFFSET = -1;
-            uint32_t TEXTURE_AMBIENT_SIZE = -1;
-            uint32_t TEXTURE_NORMAL_OFFSET = -1;
-            uint32_t TEXTURE_NORMAL_SIZE = -1;
-            uint32_t UPLOAD_BUFFER_SIZE = -1;
-        } constants;
-
-        std::vector<uint32_t> indexData;
-        std::vector<Vertex> vertexData;
+            UploadRegion<char> vertexPosition;
+            UploadRegion<char> vertexUv;
+            UploadRegion<char> vertexNormal;
+            UploadRegion<char> vertexTangent;
+            UploadRegion<char> index;
+            UploadRegion<char> textureAlbedo;
+            UploadRegion<char> textureNormal;
+            uint32_t size;
+        } upload;
+
+        DXGI_FORMAT indexFormat;
+        // Batches of every level of detail, see MeshCache::Lod
+        std::vector<IndexFormat::Batch> indexBatches;
+        std::vector<MeshCache::Lod> lods;
+        std::vector<MeshCache::Part> parts;
     };
 
     void init(HWND hWnd, uint32_t windowWidth, uint32_t windowHeight);
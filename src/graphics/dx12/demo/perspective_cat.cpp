@@ -21,9 +21,11 @@
 #include <graphics/dx12/rasterizer_state.hpp>
 #include <graphics/dx12/versioning.hpp>
 
+#include <util/blit.hpp>
 #include <util/file_util.hpp>
 #include <util/path.hpp>
-#include <util/stbi.hpp>
+
+#include <asset/texture_load.hpp>
 
 static dx12_demo::DEMO_NAME::State state;
 
@@ -160,41 +162,18 @@ namespace DEMO_NAME
         {
             auto catPath = Path::getRandomCat();
 
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), catPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_rgb_alpha), // everything will break if this is
-                                                                                    // changed from STBI_rgb_alpha :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                return stbiData;
-            }();
+            const TextureLoad::Image image = TextureLoad::load(catPath, 4).value();
+            assert(image.width == TEXTURE_WIDTH);
+            assert(image.height == TEXTURE_HEIGHT);
 
             textureRowPitch = AlignTo(TEXTURE_WIDTH * 4, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
 
             textureData.resize(textureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureData.data() + textureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 4 * i,
-                    TEXTURE_WIDTH * 4);
+            Blit::blit(
+                {image.pixels.get(), TEXTURE_WIDTH * 4, Blit::Format::RGBA8},
+                {textureData.data(), textureRowPitch, Blit::Format::RGBA8},
+                TEXTURE_WIDTH,
+                TEXTURE_HEIGHT);
         }
 
         {
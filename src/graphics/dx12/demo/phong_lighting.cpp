@@ -22,9 +22,11 @@
 #include <graphics/dx12/rasterizer_state.hpp>
 #include <graphics/dx12/versioning.hpp>
 
+#include <util/blit.hpp>
 #include <util/file_util.hpp>
 #include <util/path.hpp>
-#include <util/stbi.hpp>
+
+#include <asset/texture_load.hpp>
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
@@ -73,19 +75,15 @@ namespace DEMO_NAME
                 });
             }
 
-            OffsetCounter counter;
-
+            UploadLayout layout{STATIC_UPLOAD.size};
             // clang-format off
-            auto& c = state.constants;
-            std::tie(c.VERTEX_POSITION_OFFSET, c.VERTEX_POSITION_SIZE)   = counter.append<DirectX::XMFLOAT3>(vertexData.size());
-            std::tie(c.VERTEX_UV_OFFSET, c.VERTEX_UV_SIZE)               = counter.append<DirectX::XMFLOAT2>(vertexData.size());
-            std::tie(c.VERTEX_NORMAL_OFFSET, c.VERTEX_NORMAL_SIZE)       = counter.append<DirectX::XMFLOAT3>(vertexData.size());
-            std::tie(c.INDEX_OFFSET, c.INDEX_SIZE)                       = counter.append<DirectX::XMFLOAT2>(indexData.size());
-            std::tie(c.CBV_TRANSFORM_OFFSET, c.CBV_TRANSFORM_SIZE)       = counter.appendAligned<DirectX::XMFLOAT4X4>(1, 256);
-            std::tie(c.CBV_VIEWPROJ_OFFSET, c.CBV_VIEWPROJ_SIZE)         = counter.appendAligned<DirectX::XMFLOAT4X4>(1, 256);
-            std::tie(c.TEXTURE_ALBEDO_OFFSET, c.TEXTURE_ALBEDO_SIZE)   = counter.appendAligned(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
-            std::tie(c.TEXTURE_AMBIENT_OFFSET, c.TEXTURE_AMBIENT_SIZE)   = counter.appendAligned(AlignTo(TEXTURE_WIDTH, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
-            std::tie(c.UPLOAD_BUFFER_SIZE, std::ignore) = counter.append(0);
+            state.upload = {
+                .vertexPosition = layout.add<DirectX::XMFLOAT3>(vertexData.size()),
+                .vertexUv = layout.add<DirectX::XMFLOAT2>(vertexData.size()),
+                .vertexNormal = layout.add<DirectX::XMFLOAT3>(vertexData.size()),
+                .index = layout.add<uint32_t>(indexData.size()),
+                .size = layout.getSize(),
+            };
             // clang-format on
         }
 
@@ -212,41 +210,18 @@ namespace DEMO_NAME
         {
             auto albedoPath = Path::getAssetPath() / "texture" / "jagged-cliff1-albedo_low.png";
 
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), albedoPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_rgb_alpha), // everything will break if this is
-                                                                                    // changed from STBI_rgb_alpha :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                return stbiData;
-            }();
+            const TextureLoad::Image image = TextureLoad::load(albedoPath, 4).value();
+            assert(image.width == TEXTURE_WIDTH);
+            assert(image.height == TEXTURE_HEIGHT);
 
             textureRowPitch = AlignTo(TEXTURE_WIDTH * 4, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
 
             textureAlbedoData.resize(textureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureAlbedoData.data() + textureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 4 * i,
-                    TEXTURE_WIDTH * 4);
+            Blit::blit(
+                {image.pixels.get(), TEXTURE_WIDTH * 4, Blit::Format::RGBA8},
+                {textureAlbedoData.data(), textureRowPitch, Blit::Format::RGBA8},
+                TEXTURE_WIDTH,
+                TEXTURE_HEIGHT);
         }
 
         uint32_t ambientTextureRowPitch;
@@ -254,41 +229,18 @@ namespace DEMO_NAME
         {
             auto normalPath = Path::getAssetPath() / "texture" / "jagged-cliff1-ao_low.png";
 
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), normalPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_grey), // everything will break if this is
-                                                                               // changed from STBI_grey :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                ambientTextureRowPitch = AlignTo(TEXTURE_WIDTH * 1, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+            const TextureLoad::Image image = TextureLoad::load(normalPath, 1).value();
+            assert(image.width == TEXTURE_WIDTH);
+            assert(image.height == TEXTURE_HEIGHT);
 
-                return stbiData;
-            }();
+            ambientTextureRowPitch = AlignTo(TEXTURE_WIDTH * 1, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
 
             textureAmbientData.resize(ambientTextureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureAmbientData.data() + ambientTextureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 1 * i,
-                    TEXTURE_WIDTH * 1);
+            Blit::blit(
+                {image.pixels.get(), TEXTURE_WIDTH * 1, Blit::Format::R8},
+                {textureAmbientData.data(), ambientTextureRowPitch, Blit::Format::R8},
+                TEXTURE_WIDTH,
+                TEXTURE_HEIGHT);
         }
 
         {
@@ -305,7 +257,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.UPLOAD_BUFFER_SIZE,
+                    .Width = state.upload.size,
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -337,7 +289,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_POSITION_SIZE,
+                    .Width = state.upload.vertexPosition.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -366,7 +318,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_NORMAL_SIZE,
+                    .Width = state.upload.vertexNormal.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -395,7 +347,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.VERTEX_UV_SIZE,
+                    .Width = state.upload.vertexUv.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -425,7 +377,7 @@ namespace DEMO_NAME
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
-                    .Width = state.constants.INDEX_SIZE,
+                    .Width = state.upload.index.size(),
                     .Height = 1, // Mandatory
                     .DepthOrArraySize = 1, // Mandatory
                     .MipLevels = 1, // Mandatory
@@ -513,38 +465,26 @@ namespace DEMO_NAME
         {
             void* uploadBufferDataPointer;
             state.resources.uploadBuffer->Map(0, nullptr, &uploadBufferDataPointer);
+            std::span uploadData{(char*)uploadBufferDataPointer, state.upload.size};
 
+            // The vertices are interleaved on the CPU and split into a stream per attribute here
+            DirectX::XMFLOAT3* positions = state.upload.vertexPosition.data(uploadData);
+            DirectX::XMFLOAT2* uvs = state.upload.vertexUv.data(uploadData);
+            DirectX::XMFLOAT3* normals = state.upload.vertexNormal.data(uploadData);
             uint32_t i = 0;
             for(const auto [position, uv, normal] : state.vertexData)
             {
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_POSITION_OFFSET
-                        + sizeof(DirectX::XMFLOAT3) * i,
-                    &position,
-                    sizeof(DirectX::XMFLOAT3));
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_UV_OFFSET + sizeof(DirectX::XMFLOAT2) * i,
-                    &uv,
-                    sizeof(DirectX::XMFLOAT2));
-                std::memcpy(
-                    (char*)uploadBufferDataPointer + state.constants.VERTEX_NORMAL_OFFSET
-                        + sizeof(DirectX::XMFLOAT3) * i,
-                    &normal,
-                    sizeof(DirectX::XMFLOAT3));
+                positions[i] = position;
+                uvs[i] = uv;
+                normals[i] = normal;
 
                 ++i;
             }
 
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.INDEX_OFFSET,
-                state.indexData.data(),
-                state.constants.INDEX_SIZE);
+            state.upload.index.write(uploadData, state.indexData);
 
             SimpleMath::Matrix transformMatrix = SimpleMath::Matrix::CreateRotationZ(0.0f).Transpose();
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.CBV_TRANSFORM_OFFSET,
-                &transformMatrix,
-                state.constants.CBV_TRANSFORM_SIZE);
+            STATIC_UPLOAD.cbvTransform.write(uploadData, transformMatrix);
             // Note the transpose!
             SimpleMath::Matrix viewProjectionMatrix =
                 (SimpleMath::Matrix::CreateLookAt(CAMERA_POSITION, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f})
@@ -554,19 +494,10 @@ namespace DEMO_NAME
                      0.5f,
                      5.0f))
                     .Transpose();
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.CBV_VIEWPROJ_OFFSET,
-                &viewProjectionMatrix,
-                state.constants.CBV_VIEWPROJ_SIZE);
-
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.TEXTURE_ALBEDO_OFFSET,
-                textureAlbedoData.data(),
-                state.constants.TEXTURE_ALBEDO_SIZE);
-            std::memcpy(
-                (char*)uploadBufferDataPointer + state.constants.TEXTURE_AMBIENT_OFFSET,
-                textureAmbientData.data(),
-                state.constants.TEXTURE_AMBIENT_SIZE);
+            STATIC_UPLOAD.cbvViewProjection.write(uploadData, viewProjectionMatrix);
+
+            STATIC_UPLOAD.textureAlbedo.write(uploadData, textureAlbedoData);
+            STATIC_UPLOAD.textureAmbient.write(uploadData, textureAmbientData);
             state.resources.uploadBuffer->Unmap(0, nullptr);
 
             // TODO: Implicit transition?
@@ -588,26 +519,26 @@ namespace DEMO_NAME
                 state.resources.vertexPositionBuffer.Get(),
                 0,
                 state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_POSITION_OFFSET,
-                state.constants.VERTEX_POSITION_SIZE);
+                state.upload.vertexPosition.offset,
+                state.upload.vertexPosition.size());
             state.commandList->CopyBufferRegion(
                 state.resources.vertexNormalBuffer.Get(),
                 0,
                 state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_NORMAL_OFFSET,
-                state.constants.VERTEX_NORMAL_SIZE);
+                state.upload.vertexNormal.offset,
+                state.upload.vertexNormal.size());
             state.commandList->CopyBufferRegion(
                 state.resources.vertexUvBuffer.Get(),
                 0,
                 state.resources.uploadBuffer.Get(),
-                state.constants.VERTEX_UV_OFFSET,
-                state.constants.VERTEX_UV_SIZE);
+                state.upload.vertexUv.offset,
+                state.upload.vertexUv.size());
             state.commandList->CopyBufferRegion(
                 state.resources.indexBuffer.Get(),
                 0,
                 state.resources.uploadBuffer.Get(),
-                state.constants.INDEX_OFFSET,
-                state.constants.INDEX_SIZE);
+                state.upload.index.offset,
+                state.upload.index.size());
             state.commandList->CopyTextureRegion(
                 as_lvalue(D3D12_TEXTURE_COPY_LOCATION{
                     .pResource = state.resources.textureAlbedo.Get(),
@@ -622,7 +553,7 @@ namespace DEMO_NAME
                     .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
                     .PlacedFootprint =
                         D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
-                            .Offset = state.constants.TEXTURE_ALBEDO_OFFSET,
+                            .Offset = STATIC_UPLOAD.textureAlbedo.offset,
                             .Footprint =
                                 D3D12_SUBRESOURCE_FOOTPRINT{
                                     .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
@@ -647,7 +578,7 @@ namespace DEMO_NAME
                     .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
                     .PlacedFootprint =
                         D3D12_PLACED_SUBRESOURCE_FOOTPRINT{
-                            .Offset = state.constants.TEXTURE_AMBIENT_OFFSET,
+                            .Offset = STATIC_UPLOAD.textureAmbient.offset,
                             .Footprint =
                                 D3D12_SUBRESOURCE_FOOTPRINT{
                                     .Format = DXGI_FORMAT_R8_UNORM,
@@ -916,13 +847,11 @@ namespace DEMO_NAME
 
         void* uploadBufferDataPointer;
         state.resources.uploadBuffer->Map(0, nullptr, &uploadBufferDataPointer);
+        std::span uploadData{(char*)uploadBufferDataPointer, state.upload.size};
         SimpleMath::Matrix transform = (SimpleMath::Matrix::CreateRotationX(std::sinf(time) * 0.2f)
                                         * SimpleMath::Matrix::CreateRotationY(time * 0.5f))
                                            .Transpose();
-        std::memcpy(
-            (char*)uploadBufferDataPointer + state.constants.CBV_TRANSFORM_OFFSET,
-            &transform,
-            state.constants.CBV_TRANSFORM_SIZE);
+        STATIC_UPLOAD.cbvTransform.write(uploadData, transform);
         state.resources.uploadBuffer->Unmap(0, nullptr);
 
         auto backBufferHandle = state.heaps.rtv->GetCPUDescriptorHandleForHeapStart();
@@ -936,33 +865,33 @@ namespace DEMO_NAME
         std::array bufferViews{
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexPositionBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_POSITION_SIZE,
-                .StrideInBytes = sizeof(float) * 3,
+                .SizeInBytes = state.upload.vertexPosition.size(),
+                .StrideInBytes = state.upload.vertexPosition.STRIDE,
             },
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexUvBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_UV_SIZE,
-                .StrideInBytes = sizeof(float) * 2,
+                .SizeInBytes = state.upload.vertexUv.size(),
+                .StrideInBytes = state.upload.vertexUv.STRIDE,
             },
             D3D12_VERTEX_BUFFER_VIEW{
                 .BufferLocation = state.resources.vertexNormalBuffer->GetGPUVirtualAddress(),
-                .SizeInBytes = state.constants.VERTEX_NORMAL_SIZE,
-                .StrideInBytes = sizeof(float) * 3,
+                .SizeInBytes = state.upload.vertexNormal.size(),
+                .StrideInBytes = state.upload.vertexNormal.STRIDE,
             },
         };
         state.commandList->IASetVertexBuffers(0, bufferViews.size(), bufferViews.data());
         state.commandList->IASetIndexBuffer(as_lvalue(D3D12_INDEX_BUFFER_VIEW{
             .BufferLocation = state.resources.indexBuffer->GetGPUVirtualAddress(),
-            .SizeInBytes = state.constants.INDEX_SIZE,
+            .SizeInBytes = state.upload.index.size(),
             .Format = DXGI_FORMAT_R32_UINT,
         }));
         state.commandList->SetGraphicsRootConstantBufferView(
             0,
-            state.resources.uploadBuffer->GetGPUVirtualAddress() + state.constants.CBV_TRANSFORM_OFFSET);
+            STATIC_UPLOAD.cbvTransform.gpuAddress(state.resources.uploadBuffer->GetGPUVirtualAddress()));
 
         state.commandList->SetGraphicsRootConstantBufferView(
             1,
-            state.resources.uploadBuffer->GetGPUVirtualAddress() + state.constants.CBV_VIEWPROJ_OFFSET);
+            STATIC_UPLOAD.cbvViewProjection.gpuAddress(state.resources.uploadBuffer->GetGPUVirtualAddress()));
 
         state.commandList->SetDescriptorHeaps(1, state.heaps.srv.GetAddressOf());
         state.commandList->SetGraphicsRootDescriptorTable(2, state.heaps.srv->GetGPUDescriptorHandleForHeapStart());
@@ -6,7 +6,7 @@
 
 #include <graphics/dx12/versioning.hpp>
 #include <util/align.hpp>
-#include <util/offset_counter.hpp>
+#include <util/upload_layout.hpp>
 
 #include <DirectXMath.h>
 #include <SimpleMath.h>
@@ -34,6 +34,29 @@ namespace DEMO_NAME
         DirectX::SimpleMath::Vector3 normal;
     };
 
+    // Everything with a size that's known up front, laid out at compile time at the start of the upload buffer
+    struct StaticUpload
+    {
+        UploadRegion<DirectX::XMFLOAT4X4> cbvTransform;
+        UploadRegion<DirectX::XMFLOAT4X4> cbvViewProjection;
+        UploadRegion<char> textureAlbedo;
+        UploadRegion<char> textureAmbient;
+        uint32_t size;
+    };
+    constexpr StaticUpload STATIC_UPLOAD = []
+    {
+        UploadLayout layout;
+        // clang-format off
+        return StaticUpload{
+            .cbvTransform = layout.add<DirectX::XMFLOAT4X4>(1, 256),
+            .cbvViewProjection = layout.add<DirectX::XMFLOAT4X4>(1, 256),
+            .textureAlbedo = layout.add<char>(AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT),
+            .textureAmbient = layout.add<char>(AlignTo(TEXTURE_WIDTH, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT),
+            .size = layout.getSize(),
+        };
+        // clang-format on
+    }();
+
     struct State
     {
         ID3D12DeviceS device;
@@ -88,26 +111,15 @@ namespace DEMO_NAME
             ID3DBlobS pixelBlob;
         } shaders;
 
+        // After STATIC_UPLOAD
         struct
         {
-            uint32_t VERTEX_POSITION_OFFSET = -1;
-            uint32_t VERTEX_POSITION_SIZE = -1;
-            uint32_t VERTEX_UV_OFFSET = -1;
-            uint32_t VERTEX_UV_SIZE = -1;
-            uint32_t VERTEX_NORMAL_OFFSET = -1;
-            uint32_t VERTEX_NORMAL_SIZE = -1;
-            uint32_t INDEX_OFFSET = -1;
-            uint32_t INDEX_SIZE = -1;
-            uint32_t CBV_TRANSFORM_OFFSET = -1;
-            uint32_t CBV_TRANSFORM_SIZE = -1;
-            uint32_t CBV_VIEWPROJ_OFFSET = -1;
-            uint32_t CBV_VIEWPROJ_SIZE = -1;
-            uint32_t TEXTURE_ALBEDO_OFFSET = -1;
-            uint32_t TEXTURE_ALBEDO_SIZE = -1;
-            uint32_t TEXTURE_AMBIENT_OFFSET = -1;
-            uint32_t TEXTURE_AMBIENT_SIZE = -1;
-            uint32_t UPLOAD_BUFFER_SIZE = -1;
-        } constants;
+            UploadRegion<DirectX::XMFLOAT3> vertexPosition;
+            UploadRegion<DirectX::XMFLOAT2> vertexUv;
+            UploadRegion<DirectX::XMFLOAT3> vertexNormal;
+            UploadRegion<uint32_t> index;
+            uint32_t size;
+        } upload;
 
         std::vector<uint32_t> indexData;
         std::vector<Vertex> vertexData;
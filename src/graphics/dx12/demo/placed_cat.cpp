@@ -21,9 +21,11 @@
 #include <graphics/dx12/rasterizer_state.hpp>
 #include <graphics/dx12/versioning.hpp>
 
+#include <util/blit.hpp>
 #include <util/file_util.hpp>
 #include <util/path.hpp>
-#include <util/stbi.hpp>
+
+#include <asset/texture_load.hpp>
 
 static dx12_demo::DEMO_NAME::State state;
 
@@ -85,23 +87,8 @@ namespace DEMO_NAME
         }
         auto& commandQueue = state.commandQueue;
 
-        {
-            Die(device->CreateHeap(
-                as_lvalue(D3D12_HEAP_DESC{
-                    .SizeInBytes = state.constants.HEAP_SIZE,
-                    .Properties =
-                        {
-                            .Type = D3D12_HEAP_TYPE_DEFAULT,
-                            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-                            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-                            .CreationNodeMask = 0,
-                            .VisibleNodeMask = 0,
-                        },
-                    .Alignment = 0,
-                    .Flags = D3D12_HEAP_FLAG_NONE,
-                }),
-                Out(state.heap)));
-        }
+        // Every resource that isn't uploaded to gets placed in a default heap, which the allocator creates as needed
+        state.heapAllocator = HeapAllocator(device, D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_NONE, HEAP_SIZE);
 
         {
             DXGI_SWAP_CHAIN_DESC1 desc;
@@ -178,41 +165,18 @@ namespace DEMO_NAME
         {
             auto catPath = Path::getRandomCat();
 
-            // Immediately invoked function expressions (IIFE)
-            const auto stbiData = [&]() {
-                // This scope prevents usage of `width`, `height`, and `channels`
-                int width;
-                int height;
-                int channels;
-
-                // Windows uses wchar in std::filesystem::path >:(
-#ifdef _WIN32
-                char stbiBuf[512];
-                stbi_convert_wchar_to_utf8(stbiBuf, sizeof(stbiBuf), catPath.c_str());
-
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(stbiBuf, &width, &height, &channels, STBI_rgb_alpha), // everything will break if this is
-                                                                                    // changed from STBI_rgb_alpha :)
-                    stbi_image_free);
-#else
-                auto stbiData = std::unique_ptr<stbi_uc, void (*)(void*)>(
-                    stbi_load(catPath.c_str(), &width, &textureHeight, &channels, STBI_rgb_alpha),
-                    stbi_image_free);
-#endif
-                assert(width == TEXTURE_WIDTH);
-                assert(height == TEXTURE_HEIGHT);
-
-                return stbiData;
-            }();
+            const TextureLoad::Image image = TextureLoad::load(catPath, 4).value();
+            assert(image.width == TEXTURE_WIDTH);
+            assert(image.height == TEXTURE_HEIGHT);
 
             textureRowPitch = AlignTo(TEXTURE_WIDTH * 4, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
 
             textureData.resize(textureRowPitch * TEXTURE_HEIGHT);
-            for(uint32_t i = 0; i < TEXTURE_HEIGHT; ++i)
-                std::memcpy(
-                    textureData.data() + textureRowPitch * i,
-                    stbiData.get() + TEXTURE_WIDTH * 4 * i,
-                    TEXTURE_WIDTH * 4);
+            Blit::blit(
+                {image.pixels.get(), TEXTURE_WIDTH * 4, Blit::Format::RGBA8},
+                {textureData.data(), textureRowPitch, Blit::Format::RGBA8},
+                TEXTURE_WIDTH,
+                TEXTURE_HEIGHT);
         }
 
         {
@@ -248,10 +212,8 @@ namespace DEMO_NAME
         }
 
         {
-            device->CreatePlacedResource(
-                state.heap.Get(),
-                state.constants.HEAP_VERTEX_POSITION_OFFSET,
-                as_lvalue(D3D12_RESOURCE_DESC{
+            Die(state.heapAllocator.createResource(
+                D3D12_RESOURCE_DESC{
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
@@ -267,15 +229,14 @@ namespace DEMO_NAME
                         },
                     .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR, // Mandatory
                     .Flags = D3D12_RESOURCE_FLAG_NONE,
-                }),
+                },
                 D3D12_RESOURCE_STATE_COMMON,
                 nullptr,
-                Out(state.resources.vertexPositionBuffer));
+                state.resources.vertexPositionBuffer,
+                state.heapAllocations.vertexPositionBuffer));
 
-            device->CreatePlacedResource(
-                state.heap.Get(),
-                state.constants.HEAP_VERTEX_UV_OFFSET,
-                as_lvalue(D3D12_RESOURCE_DESC{
+            Die(state.heapAllocator.createResource(
+                D3D12_RESOURCE_DESC{
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
@@ -291,15 +252,14 @@ namespace DEMO_NAME
                         },
                     .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR, // Mandatory
                     .Flags = D3D12_RESOURCE_FLAG_NONE,
-                }),
+                },
                 D3D12_RESOURCE_STATE_COMMON,
                 nullptr,
-                Out(state.resources.vertexUvBuffer));
+                state.resources.vertexUvBuffer,
+                state.heapAllocations.vertexUvBuffer));
 
-            device->CreatePlacedResource(
-                state.heap.Get(),
-                state.constants.HEAP_VERTEX_INDEX_OFFSET,
-                as_lvalue(D3D12_RESOURCE_DESC{
+            Die(state.heapAllocator.createResource(
+                D3D12_RESOURCE_DESC{
                     .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
@@ -315,15 +275,14 @@ namespace DEMO_NAME
                         },
                     .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR, // Mandatory
                     .Flags = D3D12_RESOURCE_FLAG_NONE,
-                }),
+                },
                 D3D12_RESOURCE_STATE_COMMON,
                 nullptr,
-                Out(state.resources.indexBuffer));
+                state.resources.indexBuffer,
+                state.heapAllocations.indexBuffer));
 
-            device->CreatePlacedResource(
-                state.heap.Get(),
-                state.constants.HEAP_TEXTURE_OFFSET,
-                as_lvalue(D3D12_RESOURCE_DESC{
+            Die(state.heapAllocator.createResource(
+                D3D12_RESOURCE_DESC{
                     .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
                     .Alignment =
                         0, // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_resource_desc#alignment
@@ -339,10 +298,11 @@ namespace DEMO_NAME
                         },
                     .Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN, // Mandatory
                     .Flags = D3D12_RESOURCE_FLAG_NONE,
-                }),
+                },
                 D3D12_RESOURCE_STATE_COMMON,
                 nullptr,
-                Out(state.resources.texture));
+                state.resources.texture,
+                state.heapAllocations.texture));
         }
 
         {
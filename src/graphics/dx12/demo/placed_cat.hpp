@@ -3,6 +3,7 @@
 #include <array>
 #include <cstdint>
 
+#include <graphics/dx12/heap_allocator.hpp>
 #include <graphics/dx12/versioning.hpp>
 #include <util/align.hpp>
 
@@ -23,6 +24,9 @@ namespace DEMO_NAME
     constexpr uint32_t TEXTURE_HEIGHT = 512;
     constexpr uint32_t TEXTURE_CHANNELS = 4;
 
+    // Everything fits in the first heap several times over
+    constexpr uint64_t HEAP_SIZE = 4 * 1024 * 1024;
+
     constexpr DirectX::SimpleMath::Vector3 CAMERA_POSITION{0.0f, 0.0f, -5.0f};
 
     struct Vertex
@@ -84,7 +88,7 @@ namespace DEMO_NAME
         ID3D12GraphicsCommandListS commandList;
         ID3D12RootSignatureS rootSignature;
         ID3D12PipelineStateS pipelineState;
-        ID3D12HeapS heap;
+        HeapAllocator heapAllocator;
 
         struct
         {
@@ -122,6 +126,14 @@ namespace DEMO_NAME
             ID3D12ResourceS texture;
         } resources;
 
+        struct
+        {
+            HeapAllocator::Allocation vertexPositionBuffer;
+            HeapAllocator::Allocation vertexUvBuffer;
+            HeapAllocator::Allocation indexBuffer;
+            HeapAllocator::Allocation texture;
+        } heapAllocations;
+
         struct
         {
             ID3DBlobS vertexBlob;
@@ -140,13 +152,6 @@ namespace DEMO_NAME
             uint32_t UPLOAD_CBV_VIEWPROJ_OFFSET =   AlignTo256(UPLOAD_TEXTURE_OFFSET         + AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT);
             uint32_t UPLOAD_BUFFER_SIZE =           AlignTo256(UPLOAD_CBV_VIEWPROJ_OFFSET    + sizeof(DirectX::XMFLOAT4X4));
             // clang-format on
-            // clang-format off
-            uint32_t HEAP_VERTEX_POSITION_OFFSET = 0;
-            uint32_t HEAP_VERTEX_UV_OFFSET =                HEAP_VERTEX_POSITION_OFFSET      + sizeof(DirectX::XMFLOAT3) * vertices.size();
-            uint32_t HEAP_VERTEX_INDEX_OFFSET =             HEAP_VERTEX_UV_OFFSET            + sizeof(indexData);
-            uint32_t HEAP_TEXTURE_OFFSET  =         AlignTo(HEAP_VERTEX_INDEX_OFFSET         + sizeof(DirectX::XMFLOAT2) * vertices.size(), D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
-            uint32_t HEAP_SIZE =                            HEAP_TEXTURE_OFFSET              + AlignTo(TEXTURE_WIDTH * TEXTURE_CHANNELS, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * TEXTURE_HEIGHT;
-            // clang-format on
         } constants;
     };
 
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <graphics/dx12/versioning.hpp>
+#include <util/tlsf_allocator.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <d3d12.h>
+
+// Places resources in ID3D12Heaps of one heap type instead of giving each its own committed allocation. The heaps
+// are suballocated with a TlsfAllocator at the size and alignment GetResourceAllocationInfo asks for, freed ranges
+// are reused, and another heap is added whenever nothing fits
+class HeapAllocator
+{
+    ID3D12DeviceS device;
+    D3D12_HEAP_TYPE type = D3D12_HEAP_TYPE_DEFAULT;
+    D3D12_HEAP_FLAGS flags = D3D12_HEAP_FLAG_NONE;
+    uint64_t heapSize = 0;
+    TlsfAllocator allocator;
+    std::vector<ID3D12HeapS> heaps;
+
+    bool addHeap(uint64_t size)
+    {
+        ID3D12HeapS heap;
+        const HRESULT result = device->CreateHeap(
+            as_lvalue(D3D12_HEAP_DESC{
+                .SizeInBytes = size,
+                .Properties =
+                    {
+                        .Type = type,
+                        .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+                        .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
+                        .CreationNodeMask = 0,
+                        .VisibleNodeMask = 0,
+                    },
+                // Every heap can hold multisampled textures as well
+                .Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT,
+                .Flags = flags,
+            }),
+            Out(heap));
+        if(FAILED(result))
+            return false;
+
+        heaps.push_back(heap);
+        allocator.addPool(size);
+        return true;
+    }
+
+  public:
+    static constexpr uint64_t DEFAULT_HEAP_SIZE = 64 * 1024 * 1024;
+
+    struct Allocation
+    {
+        ID3D12Heap* heap;
+        uint64_t offset;
+        TlsfAllocator::Allocation block;
+    };
+
+    HeapAllocator() = default;
+    // D3D12_HEAP_FLAG_NONE lets buffers, textures and render targets share a heap, which needs resource heap tier 2.
+    // On tier 1 there has to be an allocator per kind of resource, with the matching D3D12_HEAP_FLAG_ALLOW_ONLY_*
+    HeapAllocator(
+        ID3D12DeviceS device,
+        D3D12_HEAP_TYPE type,
+        D3D12_HEAP_FLAGS flags = D3D12_HEAP_FLAG_NONE,
+        uint64_t heapSize = DEFAULT_HEAP_SIZE)
+        : device(std::move(device)), type(type), flags(flags), heapSize(heapSize)
+    {
+    }
+
+    // Returns std::nullopt if the resource can't be created or another heap can't be
+    std::optional<Allocation> allocate(const D3D12_RESOURCE_DESC& desc)
+    {
+        const D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &desc);
+        if(info.SizeInBytes == UINT64_MAX)
+            return std::nullopt;
+
+        std::optional<TlsfAllocator::Allocation> block = allocator.allocate(info.SizeInBytes, info.Alignment);
+        if(!block)
+        {
+            // Resources larger than a heap get a heap of their own size
+            constexpr uint64_t HEAP_ALIGNMENT = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+            const uint64_t size =
+                std::max(heapSize, (info.SizeInBytes + HEAP_ALIGNMENT - 1) / HEAP_ALIGNMENT * HEAP_ALIGNMENT);
+            if(!addHeap(size))
+                return std::nullopt;
+            block = allocator.allocate(info.SizeInBytes, info.Alignment);
+        }
+        return Allocation{heaps[block->pool].Get(), block->offset, block.value()};
+    }
+
+    // Allocates and creates the resource at once. The allocation has to be freed after the resource is released
+    // and the GPU is done with it
+    HRESULT createResource(
+        const D3D12_RESOURCE_DESC& desc,
+        D3D12_RESOURCE_STATES initialState,
+        const D3D12_CLEAR_VALUE* clearValue,
+        ID3D12ResourceS& resource,
+        Allocation& allocation)
+    {
+        std::optional<Allocation> placed = allocate(desc);
+        if(!placed)
+            return E_OUTOFMEMORY;
+
+        const HRESULT result = device->CreatePlacedResource(
+            placed->heap, placed->offset, &desc, initialState, clearValue, Out(resource));
+        if(FAILED(result))
+        {
+            free(placed.value());
+            return result;
+        }
+
+        allocation = placed.value();
+        return S_OK;
+    }
+
+    void free(const Allocation& allocation)
+    {
+        allocator.free(allocation.block);
+    }
+
+    TlsfAllocator::Stats stats() const
+    {
+        return allocator.stats();
+    }
+};
@@ -0,0 +1,8 @@
+Texture2DArray cats : register(t0);
+SamplerState samp : register(s0);
+
+float4 main(float2 uv : UV, nointerpolation uint slice : SLICE) : SV_Target {
+    float3 textureColor = cats.Sample(samp, float3(uv, slice)).rgb;
+
+    return float4(textureColor, 1.0f);
+}
@@ -0,0 +1,32 @@
+// AO is packed into the albedo's alpha
+Texture2D albedo : register(t0);
+Texture2D normal : register(t1);
+
+SamplerState samp : register(s0);
+
+struct Input {
+    float2 uv : UV;
+    float3 pixelPosTangent : PIXEL_POS;
+    float3 lightPosTangent : LIGHT_POS;
+    float3 viewPosTangent : VIEW_POS;
+};
+
+const static float ambientFactor = 0.7f;
+
+float4 main(Input input) : SV_Target {
+    // Only X and Y are stored, Z of a unit normal facing out of the surface follows from them
+    float2 normalXY = 2.0f * normal.Sample(samp, input.uv).rg - 1.0f;
+    float3 normalTangent = float3(normalXY, sqrt(saturate(1.0f - dot(normalXY, normalXY))));
+
+    // Pixel-to-light position since that matches normal map
+    float3 lightDir = normalize(input.lightPosTangent - input.pixelPosTangent);
+    float3 viewDir = normalize(input.viewPosTangent - input.pixelPosTangent);
+
+    float4 albedoSample = albedo.Sample(samp, input.uv);
+    float ambientStrength = ambientFactor * albedoSample.a;
+    float albedoStrength = max(dot(normalTangent, lightDir), 0.0f);
+    float3 reflected = reflect(-lightDir, normalTangent); // `reflect` wants an incident ray
+    float specularStrength = pow(max(dot(viewDir, reflected), 0.0f), 32.0f) * 0.1f;
+
+    return float4(albedoSample.rgb * (ambientStrength + albedoStrength) + specularStrength, 0.0f);
+}
\ No newline at end of file
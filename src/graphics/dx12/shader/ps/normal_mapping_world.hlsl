@@ -1,6 +1,6 @@
+// AO is packed into the albedo's alpha
 Texture2D albedo : register(t0);
-Texture2D ambient : register(t1);
-Texture2D normal : register(t2);
+Texture2D normal : register(t1);
 
 SamplerState samp : register(s0);
 
@@ -20,18 +20,20 @@ float4 main(Input input) : SV_Target {
     float3 bitangent = cross(input.normal, input.tangent);
     float3x3 tbnMatrix = float3x3(input.tangent, bitangent, input.normal);
 
-    float3 normalTangent = normalize(2.0f * normal.Sample(samp, input.uv).rgb - 1.0f);
+    // Only X and Y are stored, Z of a unit normal facing out of the surface follows from them
+    float2 normalXY = 2.0f * normal.Sample(samp, input.uv).rg - 1.0f;
+    float3 normalTangent = float3(normalXY, sqrt(saturate(1.0f - dot(normalXY, normalXY))));
     float3 normalWorld = mul(normalTangent, tbnMatrix);
 
     // Pixel-to-light position since that matches normal map
     float3 lightDir = normalize(lightPos - input.pixelPos);
     float3 viewDir = normalize(viewPos - input.pixelPos);
 
-    float ambientStrength = ambientFactor * ambient.Sample(samp, input.uv).r;
+    float4 albedoSample = albedo.Sample(samp, input.uv);
+    float ambientStrength = ambientFactor * albedoSample.a;
     float albedoStrength = max(dot(normalWorld, lightDir), 0.0f);
     float3 reflected = reflect(-lightDir, normalWorld); // `reflect` wants an incident ray
     float specularStrength = pow(max(dot(viewDir, reflected), 0.0f), 32.0f) * 0.1f;
 
-    float3 albedoColour = albedo.Sample(samp, input.uv).rgb;
-    return float4(albedoColour * (ambientStrength + albedoStrength) + specularStrength, 0.0f);
+    return float4(albedoSample.rgb * (ambientStrength + albedoStrength) + specularStrength, 0.0f);
 }
\ No newline at end of file
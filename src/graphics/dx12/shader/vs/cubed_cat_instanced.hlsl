@@ -0,0 +1,31 @@
+cbuffer Transform : register(b0) { matrix transform; }
+cbuffer Transform : register(b1) { matrix viewProjection; }
+
+static const float CUBE_SCALE = 0.5f;
+static const float CUBE_SPACING = 2.4f;
+
+struct Input {
+    float3 position : POSITION;
+    float2 uv : UV;
+    uint instance : SV_InstanceID;
+};
+
+struct Output {
+    float2 uv : UV;
+    nointerpolation uint slice : SLICE;
+    // Must be last or the UV slot will be mismatched in the pixel shader
+    float4 finalPosition : SV_POSITION;
+};
+
+Output main(Input input) {
+    Output output;
+    output.uv = input.uv;
+    // Each instance shows its own cat, on a 2x2 grid
+    output.slice = input.instance;
+
+    float4 position = mul(float4(input.position * CUBE_SCALE, 1.0f), transform);
+    position.xy += (float2(input.instance % 2, input.instance / 2) - 0.5f) * CUBE_SPACING;
+    output.finalPosition = mul(position, viewProjection);
+
+    return output;
+}
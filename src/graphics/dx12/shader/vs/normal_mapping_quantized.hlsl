@@ -0,0 +1,62 @@
+cbuffer Transform : register(b0) { matrix transform; }
+cbuffer Transform : register(b1) { matrix viewProjection; }
+// float3s are padded to 16 bytes, upload these as two float4s
+cbuffer Quantization : register(b2) {
+    float3 positionMin;
+    float3 positionExtent;
+}
+
+// Same as vs/normal_mapping_tangent.hlsl but with the inputs from VertexQuantize.
+// The input assembler already turns UNORM/SNORM/FLOAT16 into floats
+struct Input {
+    float4 position : POSITION;
+    float2 uv : UV;
+    float2 normal : NORMAL;
+    float2 tangent : TANGENT;
+};
+
+struct Output {
+    float2 uv : UV;
+    float3 pixelPosTangent : PIXEL_POS;
+    float3 lightPosTangent : LIGHT_POS;
+    float3 viewPosTangent : VIEW_POS;
+    // Must be last or the UV slot will be mismatched in the pixel shader
+    float4 finalPosition : SV_POSITION;
+};
+
+const static float3 lightPos = float3(0.0f, 0.0f, -1.75f);
+const static float3 viewPos = float3(0.0f, 0.0f, -3.0f);
+
+float3 octahedralDecode(float2 encoded) {
+    float3 n = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-n.z);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+Output main(Input input) {
+    Output output;
+    output.uv = input.uv;
+
+    float3 position = positionMin + input.position.xyz * positionExtent;
+    float3 normal = octahedralDecode(input.normal);
+    float3 tangent = octahedralDecode(input.tangent);
+
+    float3 normalWorld =    mul(float4(normal, 0.0f), transform).xyz;
+    float3 tangentWorld =   mul(float4(tangent, 0.0f), transform).xyz;
+    // Gram–Schmidt process to make sure the vector really is orthogonal, optional but correct step
+    tangentWorld =          normalize(tangentWorld - dot(tangentWorld, normalWorld) * normalWorld);
+    float3 bitangentWorld = cross(normalWorld, tangentWorld);
+    float3x3 tbnMatrix = transpose(float3x3(tangentWorld, bitangentWorld, normalWorld));
+
+    float4 finalPositionWorld = mul(float4(position, 1.0f), transform);
+
+    output.lightPosTangent = mul(lightPos, tbnMatrix);
+    output.viewPosTangent = mul(viewPos, tbnMatrix);
+    output.pixelPosTangent = mul(finalPositionWorld.xyz, tbnMatrix);
+
+    output.finalPosition = mul(finalPositionWorld, viewProjection);
+
+    return output;
+}
@@ -131,5 +131,9 @@ int main(int argc, char** argv)
 #endif
     }
 
+#ifdef DEMO_NAME_FRAMES_IN_FLIGHT
+    dx12_demo::DEMO_NAME::shutdown();
+#endif
+
     return 0;
 }
\ No newline at end of file
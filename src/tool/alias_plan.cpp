@@ -0,0 +1,180 @@
+#include <util/transient_alias.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Plans the transient render targets of two frames and prints where everything ends up. The first is the frame
+// multisampling and resizing render, the second a deferred frame with SSAO and a bloom chain, which has enough
+// passes for aliasing to pay off. Sizes approximate what GetResourceAllocationInfo returns: 64KB aligned, and
+// multisampled textures placed at 4MB. Random frames are then planned and validated to fuzz the planner
+namespace
+{
+constexpr uint64_t KB = 1024;
+constexpr uint64_t MB = 1024 * KB;
+
+struct Target
+{
+    const char* name;
+    uint32_t bytesPerPixel;
+    // Of the frame's resolution
+    uint32_t divisor;
+    uint32_t firstPass;
+    uint32_t lastPass;
+};
+
+std::vector<TransientAlias::Resource> getResources(
+    std::span<const Target> targets, uint32_t width, uint32_t height, uint32_t sampleCount)
+{
+    std::vector<TransientAlias::Resource> resources;
+    for(const Target& target : targets)
+    {
+        const uint64_t pixelCount = (uint64_t)(width / target.divisor) * (height / target.divisor);
+        const uint64_t size = pixelCount * target.bytesPerPixel * sampleCount;
+        resources.push_back({
+            .size = (size + 64 * KB - 1) / (64 * KB) * (64 * KB),
+            .alignment = sampleCount > 1 ? 4 * MB : 64 * KB,
+            .firstPass = target.firstPass,
+            .lastPass = target.lastPass,
+        });
+    }
+    return resources;
+}
+
+bool print(const char* frameName, std::span<const Target> targets, std::span<const TransientAlias::Resource> resources)
+{
+    const TransientAlias::Plan plan = TransientAlias::plan(resources);
+    if(!TransientAlias::validate(resources, plan))
+    {
+        std::cerr << frameName << ": plan is invalid" << std::endl;
+        return false;
+    }
+
+    std::cout << frameName << ":" << std::endl;
+    for(uint32_t i = 0; i < resources.size(); ++i)
+    {
+        std::cout << "  " << std::left << std::setw(16) << targets[i].name << std::right << " passes "
+                  << resources[i].firstPass << "-" << resources[i].lastPass << ", " << std::setw(6)
+                  << resources[i].size / KB << " KB at " << plan.offsets[i] / KB << " KB" << std::endl;
+    }
+    for(const TransientAlias::Barrier& barrier : plan.barriers)
+    {
+        std::cout << "  aliasing barrier before pass " << barrier.pass << ": "
+                  << (barrier.before == TransientAlias::NONE ? "any" : targets[barrier.before].name) << " -> "
+                  << targets[barrier.after].name << std::endl;
+    }
+    std::cout << "  heap " << plan.heapSize / KB << " KB, unaliased " << plan.unaliasedSize / KB << " KB, saved "
+              << 100.0 * (plan.unaliasedSize - std::min(plan.heapSize, plan.unaliasedSize)) / plan.unaliasedSize
+              << "%, lower bound " << plan.lowerBound / KB << " KB" << std::endl;
+    return true;
+}
+
+bool fuzz(uint32_t frameCount, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    double totalRatio = 0.0;
+    double worstRatio = 1.0;
+    double totalSaved = 0.0;
+    for(uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        const uint32_t resourceCount = std::uniform_int_distribution<uint32_t>{1, 64}(random);
+        const uint32_t passCount = std::uniform_int_distribution<uint32_t>{1, 32}(random);
+        std::vector<TransientAlias::Resource> resources;
+        for(uint32_t i = 0; i < resourceCount; ++i)
+        {
+            const uint32_t firstPass = std::uniform_int_distribution<uint32_t>{0, passCount - 1}(random);
+            const uint32_t lastPass = std::uniform_int_distribution<uint32_t>{firstPass, passCount - 1}(random);
+            const uint64_t alignment = (random() & 3) == 0 ? 4 * MB : 64 * KB;
+            resources.push_back({
+                .size = std::uniform_int_distribution<uint64_t>{1, 256}(random) * 64 * KB,
+                .alignment = alignment,
+                .firstPass = firstPass,
+                .lastPass = lastPass,
+            });
+        }
+
+        const TransientAlias::Plan plan = TransientAlias::plan(resources);
+        if(!TransientAlias::validate(resources, plan))
+        {
+            std::cerr << "Random frame " << frame << " has an invalid plan" << std::endl;
+            return false;
+        }
+        const double ratio = (double)plan.heapSize / plan.lowerBound;
+        totalRatio += ratio;
+        worstRatio = std::max(worstRatio, ratio);
+        totalSaved += 1.0 - (double)std::min(plan.heapSize, plan.unaliasedSize) / plan.unaliasedSize;
+    }
+
+    std::cout << "Fuzz: " << frameCount << " random frames valid, heap " << totalRatio / frameCount
+              << "x the lower bound on average and " << worstRatio << "x at worst, " << 100.0 * totalSaved / frameCount
+              << "% saved on average" << std::endl;
+    return true;
+}
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t sampleCount = 4;
+    uint32_t fuzzCount = 10000;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view argument = argv[i];
+        if(argument == "--width" && i + 1 < argc)
+            width = std::max(std::stoi(argv[++i]), 8);
+        else if(argument == "--height" && i + 1 < argc)
+            height = std::max(std::stoi(argv[++i]), 8);
+        else if(argument == "--msaa" && i + 1 < argc)
+            sampleCount = std::max(std::stoi(argv[++i]), 1);
+        else if(argument == "--fuzz" && i + 1 < argc)
+            fuzzCount = std::max(std::stoi(argv[++i]), 0);
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--width <pixels>] [--height <pixels>] [--msaa <samples>]"
+                      << " [--fuzz <frames>]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Draw into the multisampled targets, then resolve into the back buffer, which isn't transient. Both are
+    // alive for the whole frame, there's nothing to alias until there's a second pass
+    // clang-format off
+    const Target multisampling[] = {
+        {"render target", 4, 1, 0, 1},
+        {"depth", 4, 1, 0, 0},
+    };
+    // clang-format on
+    if(!print("multisampling", multisampling, getResources(multisampling, width, height, sampleCount)))
+        return 1;
+
+    // G-buffer, SSAO and its blur, lighting, a bloom chain down to an eighth and back up, then tone mapping into
+    // a target that's anti-aliased into the back buffer
+    // clang-format off
+    const Target deferred[] = {
+        {"albedo",           4, 1, 0, 3},
+        {"normal",           8, 1, 0, 3},
+        {"depth",            4, 1, 0, 3},
+        {"ao",               1, 1, 1, 2},
+        {"ao blurred",       1, 1, 2, 3},
+        {"hdr",              8, 1, 3, 9},
+        {"bloom half",       8, 2, 4, 5},
+        {"bloom quarter",    8, 4, 5, 6},
+        {"bloom eighth",     8, 8, 6, 7},
+        {"bloom up quarter", 8, 4, 7, 8},
+        {"bloom up half",    8, 2, 8, 9},
+        {"tone mapped",      4, 1, 9, 10},
+    };
+    // clang-format on
+    if(!print("deferred", deferred, getResources(deferred, width, height, 1)))
+        return 1;
+
+    if(fuzzCount > 0 && !fuzz(fuzzCount, 1))
+        return 1;
+
+    return 0;
+}
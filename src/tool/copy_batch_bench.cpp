@@ -0,0 +1,255 @@
+#include <util/copy_batch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Counts what batching saves on a scene load: every mesh uploads four vertex streams and its indices, every texture
+// each of its mips, and every mesh and texture transitions what it copied into once its copies are in. The meshes
+// go either into buffers of their own, like the demos do, where nothing can be merged, or into one shared buffer per
+// stream with the upload buffer laid out the same way, where each stream becomes a single copy and the meshes ask
+// for the same few transitions over and over. The merging is fuzzed against a copy of the buffers in memory
+namespace
+{
+using Resource = uint32_t;
+using State = uint32_t;
+constexpr uint32_t STREAM_COUNT = 5;
+constexpr State SHADER_RESOURCE = 1;
+constexpr State VERTEX_BUFFER = 2;
+constexpr State INDEX_BUFFER = 3;
+
+struct Scene
+{
+    std::vector<CopyBatch::BufferCopy<Resource>> bufferCopies;
+    uint32_t textureCopyCount;
+    // One per request, which is one barrier each without batching
+    std::vector<CopyBatch::Transition<Resource, State>> transitions;
+};
+
+Scene generateScene(uint32_t meshCount, uint32_t textureCount, uint32_t mipCount, bool sharedBuffers, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<uint64_t> vertexCount{100, 20000};
+
+    std::vector<uint64_t> sizes;
+    for(uint32_t mesh = 0; mesh < meshCount; ++mesh)
+    {
+        const uint64_t vertices = vertexCount(random);
+        // Position, UV, normal, tangent, indices
+        for(uint64_t stride : {12, 8, 12, 12})
+            sizes.push_back(vertices * stride);
+        sizes.push_back(vertices * 3 * 2);
+    }
+
+    // The upload buffer is resource 0, laid out stream major. With shared buffers every stream's meshes are then in
+    // the same order in the upload buffer as in the stream's buffer
+    Scene scene = {};
+    uint64_t sourceOffset = 0;
+    std::vector<uint64_t> streamOffsets(STREAM_COUNT);
+    for(uint32_t stream = 0; stream < STREAM_COUNT; ++stream)
+    {
+        for(uint32_t mesh = 0; mesh < meshCount; ++mesh)
+        {
+            const uint64_t size = sizes[mesh * STREAM_COUNT + stream];
+            const Resource destination = sharedBuffers ? 1 + stream : 1 + mesh * STREAM_COUNT + stream;
+            const uint64_t destinationOffset = sharedBuffers ? streamOffsets[stream] : 0;
+            scene.bufferCopies.push_back({destination, destinationOffset, 0, sourceOffset, size});
+            streamOffsets[stream] += size;
+            sourceOffset += size;
+        }
+    }
+    // Recorded in the order the meshes are loaded, not the order they're laid out
+    std::shuffle(scene.bufferCopies.begin(), scene.bufferCopies.end(), random);
+
+    // Every mesh's loader asks for its own streams to be transitioned, not knowing whether they're shared
+    for(uint32_t mesh = 0; mesh < meshCount; ++mesh)
+    {
+        for(uint32_t stream = 0; stream < STREAM_COUNT; ++stream)
+        {
+            const Resource buffer = sharedBuffers ? 1 + stream : 1 + mesh * STREAM_COUNT + stream;
+            scene.transitions.push_back({buffer, stream == STREAM_COUNT - 1 ? INDEX_BUFFER : VERTEX_BUFFER});
+        }
+    }
+    const Resource firstTexture = 1 + meshCount * STREAM_COUNT;
+    for(uint32_t texture = 0; texture < textureCount; ++texture)
+        scene.transitions.push_back({firstTexture + texture, SHADER_RESOURCE});
+    scene.textureCopyCount = textureCount * mipCount;
+    return scene;
+}
+
+void bench(uint32_t meshCount, uint32_t textureCount, uint32_t mipCount, bool sharedBuffers, uint64_t seed)
+{
+    Scene scene = generateScene(meshCount, textureCount, mipCount, sharedBuffers, seed);
+    const uint32_t requestedCopyCount = (uint32_t)scene.bufferCopies.size() + scene.textureCopyCount;
+    const uint32_t requestedBarrierCount = (uint32_t)scene.transitions.size();
+
+    const auto start = std::chrono::steady_clock::now();
+    CopyBatch::coalesce(scene.bufferCopies);
+    CopyBatch::dedupe(scene.transitions);
+    const auto end = std::chrono::steady_clock::now();
+
+    const uint32_t copyCount = (uint32_t)scene.bufferCopies.size() + scene.textureCopyCount;
+    std::cout << (sharedBuffers ? "shared buffers:   " : "separate buffers: ") << requestedCopyCount << " -> "
+              << copyCount << " copies, " << requestedBarrierCount << " -> " << scene.transitions.size()
+              << " barriers in 1 call, batched in "
+              << std::chrono::duration<double, std::micro>(end - start).count() << " us" << std::endl;
+}
+
+bool fuzz(uint32_t batchCount, uint64_t seed)
+{
+    constexpr uint32_t DESTINATION_COUNT = 8;
+    constexpr uint32_t DESTINATION_SIZE = 4096;
+    constexpr uint32_t SOURCE_COUNT = 2;
+    constexpr uint32_t SOURCE_SIZE = 64 * 1024;
+
+    std::mt19937_64 random(seed);
+    std::vector<char> sources(SOURCE_COUNT * SOURCE_SIZE);
+    for(char& byte : sources)
+        byte = (char)random();
+
+    uint64_t requestedCopyCount = 0;
+    uint64_t copyCount = 0;
+    for(uint32_t batch = 0; batch < batchCount; ++batch)
+    {
+        // Every destination is cut into chunks that are copied or skipped. A chunk often continues in the source
+        // where the one before it ended, which is what can be merged
+        std::vector<CopyBatch::BufferCopy<Resource>> copies;
+        for(Resource destination = 0; destination < DESTINATION_COUNT; ++destination)
+        {
+            uint64_t offset = 0;
+            while(offset < DESTINATION_SIZE)
+            {
+                const uint64_t size = std::min<uint64_t>(
+                    std::uniform_int_distribution<uint64_t>{1, 512}(random), DESTINATION_SIZE - offset);
+                if(random() % 4 != 0)
+                {
+                    const bool continues = !copies.empty() && copies.back().destination == destination
+                                           && copies.back().destinationOffset + copies.back().size == offset
+                                           && random() % 2 == 0;
+                    Resource source = (Resource)(random() % SOURCE_COUNT);
+                    uint64_t sourceOffset = std::uniform_int_distribution<uint64_t>{0, SOURCE_SIZE - size}(random);
+                    if(continues && copies.back().sourceOffset + copies.back().size + size <= SOURCE_SIZE)
+                    {
+                        source = copies.back().source;
+                        sourceOffset = copies.back().sourceOffset + copies.back().size;
+                    }
+                    copies.push_back({destination, offset, source, sourceOffset, size});
+                }
+                offset += size;
+            }
+        }
+        std::shuffle(copies.begin(), copies.end(), random);
+
+        std::vector<CopyBatch::BufferCopy<Resource>> merged = copies;
+        CopyBatch::coalesce(merged);
+        requestedCopyCount += copies.size();
+        copyCount += merged.size();
+
+        std::vector<char> expected(DESTINATION_COUNT * DESTINATION_SIZE);
+        std::vector<char> actual(DESTINATION_COUNT * DESTINATION_SIZE);
+        auto apply = [&](std::vector<char>& destinations, const CopyBatch::BufferCopy<Resource>& copy)
+        {
+            std::memcpy(
+                destinations.data() + copy.destination * DESTINATION_SIZE + copy.destinationOffset,
+                sources.data() + copy.source * SOURCE_SIZE + copy.sourceOffset,
+                copy.size);
+        };
+        for(const auto& copy : copies)
+            apply(expected, copy);
+        for(const auto& copy : merged)
+            apply(actual, copy);
+        if(expected != actual)
+        {
+            std::cerr << "Batch " << batch << ": merged copies write different bytes" << std::endl;
+            return false;
+        }
+        for(size_t i = 1; i < merged.size(); ++i)
+        {
+            const auto& previous = merged[i - 1];
+            const auto& copy = merged[i];
+            if(copy.destination == previous.destination && copy.source == previous.source
+               && copy.destinationOffset == previous.destinationOffset + previous.size
+               && copy.sourceOffset == previous.sourceOffset + previous.size)
+            {
+                std::cerr << "Batch " << batch << ": copy " << i << " wasn't merged" << std::endl;
+                return false;
+            }
+        }
+
+        // One transition per resource, in the order they were first asked for, to the last state
+        std::vector<CopyBatch::Transition<Resource, State>> transitions;
+        for(uint32_t i = std::uniform_int_distribution<uint32_t>{0, 64}(random); i > 0; --i)
+            transitions.push_back({(Resource)(random() % 16), (State)(random() % 4)});
+        std::vector<CopyBatch::Transition<Resource, State>> unique = transitions;
+        CopyBatch::dedupe(unique);
+        std::vector<CopyBatch::Transition<Resource, State>> reference;
+        for(const auto& transition : transitions)
+        {
+            auto found = std::find_if(
+                reference.begin(),
+                reference.end(),
+                [&](const auto& other) { return other.resource == transition.resource; });
+            if(found != reference.end())
+                found->after = transition.after;
+            else
+                reference.push_back(transition);
+        }
+        if(!std::equal(
+               unique.begin(),
+               unique.end(),
+               reference.begin(),
+               reference.end(),
+               [](const auto& a, const auto& b) { return a.resource == b.resource && a.after == b.after; }))
+        {
+            std::cerr << "Batch " << batch << ": transitions weren't deduplicated" << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "Fuzz: " << batchCount << " random batches, " << requestedCopyCount << " -> " << copyCount
+              << " copies, same bytes written" << std::endl;
+    return true;
+}
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t meshCount = 2000;
+    uint32_t textureCount = 500;
+    uint32_t mipCount = 10;
+    uint32_t fuzzCount = 2000;
+    uint64_t seed = 1;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view argument = argv[i];
+        if(argument == "--meshes" && i + 1 < argc)
+            meshCount = std::max(std::stoi(argv[++i]), 1);
+        else if(argument == "--textures" && i + 1 < argc)
+            textureCount = std::max(std::stoi(argv[++i]), 0);
+        else if(argument == "--mips" && i + 1 < argc)
+            mipCount = std::max(std::stoi(argv[++i]), 1);
+        else if(argument == "--fuzz" && i + 1 < argc)
+            fuzzCount = std::max(std::stoi(argv[++i]), 0);
+        else if(argument == "--seed" && i + 1 < argc)
+            seed = std::stoull(argv[++i]);
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--meshes <count>] [--textures <count>] [--mips <count>] [--fuzz <batches>]"
+                      << " [--seed <seed>]" << std::endl;
+            return 1;
+        }
+    }
+
+    if(fuzzCount > 0 && !fuzz(fuzzCount, seed))
+        return 1;
+    bench(meshCount, textureCount, mipCount, false, seed);
+    bench(meshCount, textureCount, mipCount, true, seed);
+
+    return 0;
+}
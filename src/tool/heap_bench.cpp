@@ -0,0 +1,220 @@
+#include <util/tlsf_allocator.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Fuzzes the TLSF allocator the GPU heaps are suballocated with against a plain map of what's allocated, and
+// times allocating and freeing once it's warmed up. Sizes and alignments follow what GetResourceAllocationInfo
+// returns for the demos' resources: buffers and small textures of a few KB up to textures of several MB, at 4KB,
+// 64KB and 4MB placement alignments. Pools grow the way the heap allocator grows, by adding a heap when nothing
+// fits
+namespace
+{
+constexpr uint64_t KB = 1024;
+constexpr uint64_t MB = 1024 * KB;
+constexpr uint64_t ALIGNMENTS[] = {4 * KB, 64 * KB, 64 * KB, 64 * KB, 4 * MB};
+
+struct Request
+{
+    uint64_t size;
+    uint64_t alignment;
+};
+
+class Generator
+{
+    std::mt19937_64 random;
+    std::uniform_real_distribution<double> logSize{std::log2(256.0), std::log2(16.0 * MB)};
+    std::uniform_int_distribution<size_t> alignment{0, std::size(ALIGNMENTS) - 1};
+
+  public:
+    explicit Generator(uint64_t seed): random(seed) {}
+
+    Request next()
+    {
+        return {(uint64_t)std::exp2(logSize(random)), ALIGNMENTS[alignment(random)]};
+    }
+
+    size_t pick(size_t count)
+    {
+        return std::uniform_int_distribution<size_t>{0, count - 1}(random);
+    }
+
+    bool coin()
+    {
+        return random() & 1;
+    }
+};
+
+TlsfAllocator::Allocation allocateOrGrow(TlsfAllocator& allocator, const Request& request, uint64_t poolSize)
+{
+    std::optional<TlsfAllocator::Allocation> allocation = allocator.allocate(request.size, request.alignment);
+    if(!allocation)
+    {
+        allocator.addPool(std::max(poolSize, request.size + request.alignment));
+        allocation = allocator.allocate(request.size, request.alignment);
+    }
+    return allocation.value();
+}
+
+// Returns false on the first allocation that overlaps another one, isn't aligned or is too small
+bool fuzz(uint32_t operationCount, uint64_t poolSize, uint64_t seed)
+{
+    TlsfAllocator allocator;
+    Generator generator(seed);
+    std::vector<TlsfAllocator::Allocation> live;
+    // Start of every allocation per pool, to find its neighbours
+    std::map<std::pair<uint32_t, uint64_t>, uint64_t> shadow;
+    uint32_t validations = 0;
+
+    for(uint32_t operation = 0; operation < operationCount; ++operation)
+    {
+        // Grows for the first half, then shrinks, so both merging and reuse of freed blocks get exercised
+        const bool growing = operation < operationCount / 2;
+        if(live.empty() || generator.coin() || (growing && generator.coin()))
+        {
+            const Request request = generator.next();
+            const TlsfAllocator::Allocation allocation = allocateOrGrow(allocator, request, poolSize);
+            if(allocation.offset % request.alignment != 0 || allocation.size < request.size)
+            {
+                std::cerr << "Allocation " << operation << " isn't aligned or is too small" << std::endl;
+                return false;
+            }
+
+            auto next = shadow.lower_bound({allocation.pool, allocation.offset});
+            if(next != shadow.end() && next->first.first == allocation.pool
+               && next->first.second < allocation.offset + allocation.size)
+            {
+                std::cerr << "Allocation " << operation << " overlaps the one after it" << std::endl;
+                return false;
+            }
+            if(next != shadow.begin())
+            {
+                auto previous = std::prev(next);
+                if(previous->first.first == allocation.pool
+                   && previous->first.second + previous->second > allocation.offset)
+                {
+                    std::cerr << "Allocation " << operation << " overlaps the one before it" << std::endl;
+                    return false;
+                }
+            }
+            shadow[{allocation.pool, allocation.offset}] = allocation.size;
+            live.push_back(allocation);
+        }
+        else
+        {
+            const size_t index = generator.pick(live.size());
+            allocator.free(live[index]);
+            shadow.erase({live[index].pool, live[index].offset});
+            live[index] = live.back();
+            live.pop_back();
+        }
+
+        // Every operation at first, when the layouts are still small and most of the edge cases happen
+        if(operation < 4096 || operation % 256 == 0)
+        {
+            ++validations;
+            if(!allocator.validate())
+            {
+                std::cerr << "Allocator is inconsistent after operation " << operation << std::endl;
+                return false;
+            }
+        }
+    }
+
+    for(const TlsfAllocator::Allocation& allocation : live)
+        allocator.free(allocation);
+    const TlsfAllocator::Stats stats = allocator.stats();
+    bool empty = allocator.validate() && stats.allocationCount == 0 && stats.freeBlockCount == stats.poolCount;
+    for(uint32_t pool = 0; pool < stats.poolCount; ++pool)
+        empty &= allocator.isPoolEmpty(pool);
+    if(!empty)
+    {
+        std::cerr << "Freeing everything didn't merge every pool back into one block" << std::endl;
+        return false;
+    }
+
+    std::cout << "Fuzz: " << operationCount << " operations, " << validations << " validations, " << stats.poolCount
+              << " pools of " << poolSize / MB << " MB, all merged back after freeing everything" << std::endl;
+    return true;
+}
+
+void bench(uint32_t liveCount, uint32_t operationCount, uint64_t poolSize, uint64_t seed)
+{
+    TlsfAllocator allocator;
+    Generator generator(seed);
+    std::vector<TlsfAllocator::Allocation> live;
+    for(uint32_t i = 0; i < liveCount; ++i)
+        live.push_back(allocateOrGrow(allocator, generator.next(), poolSize));
+
+    // Requests and victims are drawn up front so only the allocator is timed
+    std::vector<Request> requests(operationCount);
+    std::vector<size_t> victims(operationCount);
+    for(uint32_t i = 0; i < operationCount; ++i)
+    {
+        requests[i] = generator.next();
+        victims[i] = generator.pick(liveCount);
+    }
+
+    // Timed as a whole, the clock costs about as much as a single operation
+    uint32_t grownPools = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < operationCount; ++i)
+    {
+        allocator.free(live[victims[i]]);
+        std::optional<TlsfAllocator::Allocation> allocation =
+            allocator.allocate(requests[i].size, requests[i].alignment);
+        if(!allocation)
+        {
+            ++grownPools;
+            allocation = allocateOrGrow(allocator, requests[i], poolSize);
+        }
+        live[victims[i]] = allocation.value();
+    }
+    std::chrono::duration<double, std::nano> duration = std::chrono::high_resolution_clock::now() - start;
+
+    const TlsfAllocator::Stats stats = allocator.stats();
+    const uint64_t freeSize = stats.poolSize - stats.allocatedSize;
+    std::cout << "Bench: " << liveCount << " live allocations, free and allocate " << duration.count() / operationCount
+              << " ns, " << operationCount * 2 / (duration.count() / 1000.0) << " M operations/s, " << stats.poolCount
+              << " pools (" << grownPools << " added while timing), " << 100.0 * stats.allocatedSize / stats.poolSize
+              << "% used, largest free block " << 100.0 * stats.largestFreeBlock / std::max<uint64_t>(freeSize, 1)
+              << "% of the free space in " << stats.freeBlockCount << " blocks" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t operationCount = 200000;
+    uint64_t poolSize = 256 * MB;
+    uint64_t seed = 1;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view argument = argv[i];
+        if(argument == "--operations" && i + 1 < argc)
+            operationCount = std::max(std::stoi(argv[++i]), 1);
+        else if(argument == "--pool-mb" && i + 1 < argc)
+            poolSize = std::max(std::stoi(argv[++i]), 1) * MB;
+        else if(argument == "--seed" && i + 1 < argc)
+            seed = std::stoull(argv[++i]);
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--operations <count>] [--pool-mb <size>] [--seed <seed>]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    if(!fuzz(operationCount, poolSize, seed))
+        return 1;
+    for(uint32_t liveCount : {64u, 1024u, 16384u})
+        bench(liveCount, operationCount, poolSize, seed);
+
+    return 0;
+}
@@ -0,0 +1,880 @@
+#include <asset/mesh.hpp>
+#include <asset/mesh_lod.hpp>
+#include <asset/mesh_optimize.hpp>
+#include <asset/meshlet_build.hpp>
+#include <asset/tangent_generate.hpp>
+#include <asset/vector_math.hpp>
+#include <asset/vertex_quantize.hpp>
+#include <asset/vertex_weld.hpp>
+#include <util/thread_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Runs the cook passes on generated meshes of 10k to 10M triangles: a flat grid, and a UV sphere which has a seam
+// and poles like most real meshes. Triangles are shuffled first, the order an exporter that doesn't care would
+// leave them in, so the optimizer starts from the worst case. Every pass is checked against what it promises
+namespace
+{
+float timeMS(auto func)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+    return duration.count();
+}
+
+// `n` by `n` quads in the XY plane facing -Z, the way the demos' camera looks at them
+Mesh generateGrid(uint32_t n)
+{
+    Mesh mesh;
+    for(uint32_t y = 0; y <= n; ++y)
+    {
+        for(uint32_t x = 0; x <= n; ++x)
+        {
+            const float u = (float)x / n;
+            const float v = (float)y / n;
+            mesh.positions.push_back({u - 0.5f, 0.5f - v, 0.0f});
+            mesh.uvs.push_back({u, v});
+            mesh.normals.push_back({0.0f, 0.0f, -1.0f});
+            mesh.tangents.push_back({1.0f, 0.0f, 0.0f});
+        }
+    }
+
+    for(uint32_t y = 0; y < n; ++y)
+    {
+        for(uint32_t x = 0; x < n; ++x)
+        {
+            const uint32_t corner = y * (n + 1) + x;
+            mesh.indices.insert(mesh.indices.end(), {corner, corner + 1, corner + n + 1});
+            mesh.indices.insert(mesh.indices.end(), {corner + 1, corner + n + 2, corner + n + 1});
+        }
+    }
+    return mesh;
+}
+
+// `rings` from pole to pole and twice as many segments around. The first and last column are the same positions
+// with different UVs, and every pole vertex is repeated per segment, so only one triangle of the quads that touch
+// a pole is kept
+Mesh generateSphere(uint32_t rings)
+{
+    const uint32_t segments = rings * 2;
+    Mesh mesh;
+    for(uint32_t ring = 0; ring <= rings; ++ring)
+    {
+        const float theta = std::numbers::pi_v<float> * ring / rings;
+        for(uint32_t segment = 0; segment <= segments; ++segment)
+        {
+            // The last column wraps around to exactly the first
+            const float phi = segment == segments ? 0.0f : 2.0f * std::numbers::pi_v<float> * segment / segments;
+            const DirectX::XMFLOAT3 normal{
+                std::sin(theta) * std::cos(phi),
+                std::cos(theta),
+                std::sin(theta) * std::sin(phi),
+            };
+            mesh.positions.push_back(normal);
+            mesh.uvs.push_back({(float)segment / segments, (float)ring / rings});
+            mesh.normals.push_back(normal);
+            mesh.tangents.push_back({-std::sin(phi), 0.0f, std::cos(phi)});
+        }
+    }
+
+    for(uint32_t ring = 0; ring < rings; ++ring)
+    {
+        for(uint32_t segment = 0; segment < segments; ++segment)
+        {
+            const uint32_t corner = ring * (segments + 1) + segment;
+            const uint32_t below = corner + segments + 1;
+            if(ring != 0)
+                mesh.indices.insert(mesh.indices.end(), {corner, corner + 1, below});
+            if(ring != rings - 1)
+                mesh.indices.insert(mesh.indices.end(), {corner + 1, below + 1, below});
+        }
+    }
+    return mesh;
+}
+
+// Sizes are only hit roughly, the meshes have to stay regular
+Mesh generate(std::string_view shape, uint32_t triangleCount)
+{
+    if(shape == "grid")
+        return generateGrid(std::max((uint32_t)std::lround(std::sqrt(triangleCount / 2.0)), 1u));
+    return generateSphere(std::max((uint32_t)std::lround(std::sqrt(triangleCount / 4.0)), 2u));
+}
+
+void shuffleTriangles(Mesh& mesh, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    const uint32_t triangleCount = mesh.indexCount() / 3;
+    for(uint32_t triangle = triangleCount - 1; triangle > 0; --triangle)
+    {
+        const uint32_t other = std::uniform_int_distribution<uint32_t>{0, triangle}(random);
+        std::swap_ranges(&mesh.indices[triangle * 3], &mesh.indices[triangle * 3 + 3], &mesh.indices[other * 3]);
+    }
+}
+
+uint64_t mix(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    return hash ^ (hash >> 33);
+}
+
+uint64_t hashVertex(const Mesh& mesh, uint32_t vertex)
+{
+    const DirectX::XMFLOAT3& position = mesh.positions[vertex];
+    const DirectX::XMFLOAT2& uv = mesh.uvs[vertex];
+    uint64_t hash = 0;
+    for(float component : {position.x, position.y, position.z, uv.x, uv.y})
+        hash = mix(hash ^ std::bit_cast<uint32_t>(component));
+    return hash;
+}
+
+// Sums up a hash per triangle over what its vertices hold, so it doesn't change when the triangles or the vertices
+// are reordered. Each triangle starts at its smallest vertex hash, which keeps the winding part of the hash
+uint64_t hashTriangles(const Mesh& mesh)
+{
+    uint64_t sum = 0;
+    for(uint32_t i = 0; i < mesh.indexCount(); i += 3)
+    {
+        uint64_t corners[3] = {
+            hashVertex(mesh, mesh.indices[i]),
+            hashVertex(mesh, mesh.indices[i + 1]),
+            hashVertex(mesh, mesh.indices[i + 2]),
+        };
+        std::rotate(corners, std::min_element(corners, corners + 3), corners + 3);
+        sum += mix(mix(mix(corners[0]) ^ corners[1]) ^ corners[2]);
+    }
+    return sum;
+}
+
+bool benchOptimize(std::string_view shape, uint32_t triangleCount, uint64_t seed)
+{
+    Mesh mesh = generate(shape, triangleCount);
+    shuffleTriangles(mesh, seed);
+    const uint32_t triangles = mesh.indexCount() / 3;
+    const uint64_t hash = hashTriangles(mesh);
+
+    MeshOptimize::Stats stats;
+    const float time = timeMS([&]() { stats = MeshOptimize::optimize(mesh); });
+    if(mesh.indexCount() / 3 != triangles || hashTriangles(mesh) != hash)
+    {
+        std::cerr << shape << " " << triangles << ": optimizing changed the triangles" << std::endl;
+        return false;
+    }
+
+    std::cout << shape << " " << triangles << " triangles: ACMR " << stats.before.acmr << " -> " << stats.after.acmr
+              << ", ATVR " << stats.before.atvr << " -> " << stats.after.atvr << ", " << time << " ms, "
+              << triangles / (time * 1000.0f) << " million triangles per second" << std::endl;
+    return true;
+}
+
+DirectX::XMFLOAT3 randomDirection(std::mt19937_64& random)
+{
+    std::normal_distribution<float> normal;
+    while(true)
+    {
+        const DirectX::XMFLOAT3 direction{normal(random), normal(random), normal(random)};
+        if(VectorMath::length(direction) > 0.0f)
+            return VectorMath::normalize(direction);
+    }
+}
+
+// In double and through atan2, so angles of 1e-5 radians still come out right
+double angleBetween(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+{
+    const double x = (double)a.y * b.z - (double)a.z * b.y;
+    const double y = (double)a.z * b.x - (double)a.x * b.z;
+    const double z = (double)a.x * b.y - (double)a.y * b.x;
+    return std::atan2(std::sqrt(x * x + y * y + z * z), (double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z);
+}
+
+// Round trips every stream and holds the result to the bounds vertex_quantize.hpp documents. Besides the generated
+// meshes, random vertices cover bounds away from the origin, UVs that tile and go into half denormals, and the
+// directions the octahedral fold treats specially
+bool checkQuantize(uint32_t vertexCount, uint64_t seed)
+{
+    // Every half that isn't a NaN comes back as the same bits
+    for(uint32_t bits = 0; bits <= 0xFFFF; ++bits)
+    {
+        const bool nan = (bits & 0x7C00) == 0x7C00 && (bits & 0x3FF) != 0;
+        if(!nan && VertexQuantize::encodeHalf(VertexQuantize::decodeHalf((uint16_t)bits)) != bits)
+        {
+            std::cerr << "Half " << bits << " doesn't round trip" << std::endl;
+            return false;
+        }
+    }
+
+    std::mt19937_64 random(seed);
+    std::vector<Mesh> meshes{generate("grid", 10'000), generate("sphere", 10'000), Mesh{}};
+    Mesh& randomMesh = meshes.back();
+    const DirectX::XMFLOAT3 min{
+        std::uniform_real_distribution<float>{-100.0f, 100.0f}(random),
+        std::uniform_real_distribution<float>{-100.0f, 100.0f}(random),
+        std::uniform_real_distribution<float>{-100.0f, 100.0f}(random),
+    };
+    std::uniform_real_distribution<float> extent{0.001f, 100.0f};
+    const DirectX::XMFLOAT3 max{min.x + extent(random), min.y + extent(random), min.z + extent(random)};
+    for(uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        randomMesh.positions.push_back({
+            std::uniform_real_distribution<float>{min.x, max.x}(random),
+            std::uniform_real_distribution<float>{min.y, max.y}(random),
+            std::uniform_real_distribution<float>{min.z, max.z}(random),
+        });
+        const float uvRange = vertex % 4 == 0 ? 1e-6f : 8.0f;
+        std::uniform_real_distribution<float> uv{-uvRange, uvRange};
+        randomMesh.uvs.push_back({uv(random), uv(random)});
+
+        DirectX::XMFLOAT3 normal = randomDirection(random);
+        // On the fold, and on the diagonals of the octahedron
+        if(vertex % 8 == 1)
+            normal = VectorMath::normalize({normal.x, normal.y, 0.0f});
+        else if(vertex % 8 == 2)
+            normal = VectorMath::normalize({normal.x, std::copysign(normal.x, normal.y), normal.z});
+        else if(vertex % 8 == 3)
+            normal = {0.0f, 0.0f, vertex % 16 < 8 ? 1.0f : -1.0f};
+        randomMesh.normals.push_back(normal);
+        randomMesh.tangents.push_back(randomDirection(random));
+    }
+
+    double worstPosition = 0.0;
+    double worstUv = 0.0;
+    double worstNormal = 0.0;
+    double worstTangent = 0.0;
+    for(const Mesh& mesh : meshes)
+    {
+        const VertexQuantize::QuantizedStreams streams = VertexQuantize::quantize(mesh);
+        const Mesh decoded = VertexQuantize::dequantize(streams);
+        const float minimum[3] = {streams.positionMin.x, streams.positionMin.y, streams.positionMin.z};
+        const float extents[3] = {streams.positionExtent.x, streams.positionExtent.y, streams.positionExtent.z};
+        for(uint32_t vertex = 0; vertex < mesh.vertexCount(); ++vertex)
+        {
+            const float source[3] = {mesh.positions[vertex].x, mesh.positions[vertex].y, mesh.positions[vertex].z};
+            const float result[3] = {
+                decoded.positions[vertex].x,
+                decoded.positions[vertex].y,
+                decoded.positions[vertex].z,
+            };
+            for(uint32_t axis = 0; axis < 3; ++axis)
+            {
+                // Half a step, plus the few ulps min + unorm * extent loses in float
+                const double step = extents[axis] / 65535.0;
+                const double slack =
+                    4.0 * std::numeric_limits<float>::epsilon() * (std::abs(minimum[axis]) + extents[axis]);
+                const double error = std::abs((double)source[axis] - result[axis]);
+                if(error > 0.5 * step + slack)
+                {
+                    std::cerr << "Position " << vertex << " is off by " << error << " with a step of " << step
+                              << std::endl;
+                    return false;
+                }
+                if(step > 0.0)
+                    worstPosition = std::max(worstPosition, error / step);
+            }
+
+            for(auto [source, result] : {
+                    std::pair{mesh.uvs[vertex].x, decoded.uvs[vertex].x},
+                    std::pair{mesh.uvs[vertex].y, decoded.uvs[vertex].y},
+                })
+            {
+                // 2^-25 is half the smallest half denormal
+                const double bound = std::max(std::abs(source) * std::ldexp(1.0, -11), std::ldexp(1.0, -25));
+                const double error = std::abs((double)source - result);
+                if(error > bound)
+                {
+                    std::cerr << "UV " << source << " of vertex " << vertex << " is off by " << error << std::endl;
+                    return false;
+                }
+                worstUv = std::max(worstUv, error / bound);
+            }
+
+            const double normal = angleBetween(mesh.normals[vertex], decoded.normals[vertex]);
+            const double tangent = angleBetween(mesh.tangents[vertex], decoded.tangents[vertex]);
+            if(normal > VertexQuantize::MAX_DIRECTION_ERROR || tangent > VertexQuantize::MAX_DIRECTION_ERROR)
+            {
+                std::cerr << "Direction of vertex " << vertex << " is off by " << std::max(normal, tangent)
+                          << " rad" << std::endl;
+                return false;
+            }
+            worstNormal = std::max(worstNormal, normal);
+            worstTangent = std::max(worstTangent, tangent);
+        }
+    }
+
+    std::cout << "Quantize: every half round trips, " << vertexCount << " random vertices and both shapes within "
+              << "bounds, worst position " << worstPosition << " steps, UV " << worstUv
+              << " of the bound, normal " << worstNormal << " rad, tangent " << worstTangent << " rad" << std::endl;
+    return true;
+}
+
+using VertexBits = std::array<uint32_t, 3 + 2 + 3 + 3>;
+
+// What weld compares, -0 and 0 are the same
+VertexBits getVertexBits(const Mesh& mesh, uint32_t vertex)
+{
+    const DirectX::XMFLOAT3& position = mesh.positions[vertex];
+    const DirectX::XMFLOAT2& uv = mesh.uvs[vertex];
+    const DirectX::XMFLOAT3& normal = mesh.normals[vertex];
+    const DirectX::XMFLOAT3& tangent = mesh.tangents[vertex];
+    VertexBits bits;
+    uint32_t i = 0;
+    for(float component : {
+            position.x,
+            position.y,
+            position.z,
+            uv.x,
+            uv.y,
+            normal.x,
+            normal.y,
+            normal.z,
+            tangent.x,
+            tangent.y,
+            tangent.z,
+        })
+        bits[i++] = component == 0.0f ? 0 : std::bit_cast<uint32_t>(component);
+    return bits;
+}
+
+// Every triangle gets vertices of its own, the way exporters write them out, in a random order and with some zeros
+// turned into -0. Some tangents are moved by one ulp, so there are vertices that differ in nothing else
+Mesh splitVertices(const Mesh& mesh, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    std::vector<uint32_t> order(mesh.indexCount());
+    for(uint32_t i = 0; i < mesh.indexCount(); ++i)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), random);
+
+    Mesh split;
+    split.indices.resize(mesh.indexCount());
+    for(uint32_t i : order)
+    {
+        const uint32_t vertex = mesh.indices[i];
+        split.indices[i] = split.vertexCount();
+        split.positions.push_back(mesh.positions[vertex]);
+        split.uvs.push_back(mesh.uvs[vertex]);
+        split.normals.push_back(mesh.normals[vertex]);
+        split.tangents.push_back(mesh.tangents[vertex]);
+        if(random() % 16 == 0)
+        {
+            DirectX::XMFLOAT3& tangent = split.tangents.back();
+            tangent.z = std::nextafter(tangent.z, 2.0f);
+        }
+        if(random() % 2 == 0)
+        {
+            DirectX::XMFLOAT3& position = split.positions.back();
+            for(float* component : {&position.x, &position.y, &position.z})
+                *component = *component == 0.0f ? -0.0f : *component;
+        }
+    }
+    return split;
+}
+
+// Welding has to leave exactly one vertex per distinct attribute tuple, and every corner of every triangle has to
+// read the same attributes as before, in the same order. The result has to be the same with one thread and many
+bool checkWeld(uint32_t triangleCount, uint64_t seed)
+{
+    ThreadPool singleThread(0);
+    ThreadPool multiThread(std::max(std::thread::hardware_concurrency(), 4u) - 1);
+
+    for(std::string_view shape : {"grid", "sphere"})
+    {
+        const Mesh source = splitVertices(generate(shape, triangleCount), seed);
+        std::vector<VertexBits> distinct;
+        for(uint32_t vertex = 0; vertex < source.vertexCount(); ++vertex)
+            distinct.push_back(getVertexBits(source, vertex));
+        std::sort(distinct.begin(), distinct.end());
+        const uint32_t distinctCount = (uint32_t)(std::unique(distinct.begin(), distinct.end()) - distinct.begin());
+
+        std::vector<Mesh> welded;
+        for(ThreadPool* pool : {&singleThread, &multiThread})
+        {
+            Mesh& mesh = welded.emplace_back(source);
+            float time = timeMS([&]() { VertexWeld::weld(mesh, 0.0f, *pool); });
+            if(mesh.vertexCount() != distinctCount || mesh.indexCount() != source.indexCount())
+            {
+                std::cerr << shape << ": welded into " << mesh.vertexCount() << " vertices and "
+                          << mesh.indexCount() << " indices instead of " << distinctCount << " and "
+                          << source.indexCount() << std::endl;
+                return false;
+            }
+            for(uint32_t i = 0; i < source.indexCount(); ++i)
+            {
+                if(getVertexBits(mesh, mesh.indices[i]) != getVertexBits(source, source.indices[i]))
+                {
+                    std::cerr << shape << ": index " << i << " reads a different vertex after welding" << std::endl;
+                    return false;
+                }
+            }
+            const uint32_t threadCount = pool->workerCount() + 1;
+            std::cout << "Weld " << shape << " on " << threadCount << (threadCount == 1 ? " thread: " : " threads: ")
+                      << source.vertexCount() << " -> " << mesh.vertexCount() << " vertices, " << time
+                      << " ms, same triangles" << std::endl;
+        }
+
+        const Mesh& a = welded[0];
+        const Mesh& b = welded[1];
+        for(uint32_t vertex = 0; vertex < a.vertexCount(); ++vertex)
+        {
+            if(getVertexBits(a, vertex) != getVertexBits(b, vertex))
+            {
+                std::cerr << shape << ": vertex " << vertex << " depends on the thread count" << std::endl;
+                return false;
+            }
+        }
+        if(a.indices != b.indices)
+        {
+            std::cerr << shape << ": the indices depend on the thread count" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// The generated shapes come with their tangents worked out analytically. A vertex's generated tangent is an average
+// over the triangles around it, so it may be off from the analytic one by as much as the analytic tangent turns
+// across one of those triangles, plus float rounding. Vertices no triangle uses get any tangent. Every tangent has to
+// be unit length, perpendicular to the normal, and the same whatever the number of threads
+bool checkTangents(uint32_t triangleCount, uint64_t seed)
+{
+    constexpr double ROUNDING = 1e-5;
+
+    ThreadPool singleThread(0);
+    ThreadPool multiThread(std::max(std::thread::hardware_concurrency(), 4u) - 1);
+
+    for(std::string_view shape : {"grid", "sphere"})
+    {
+        Mesh source = generate(shape, triangleCount);
+        shuffleTriangles(source, seed);
+
+        std::vector<double> bounds(source.vertexCount(), std::numbers::pi);
+        for(uint32_t vertex : source.indices)
+            bounds[vertex] = 0.0;
+        for(uint32_t i = 0; i < source.indexCount(); i += 3)
+        {
+            const uint32_t* triangle = &source.indices[i];
+            double turn = 0.0;
+            for(uint32_t corner = 0; corner < 3; ++corner)
+            {
+                turn = std::max(
+                    turn,
+                    angleBetween(source.tangents[triangle[corner]], source.tangents[triangle[(corner + 1) % 3]]));
+            }
+            for(uint32_t corner = 0; corner < 3; ++corner)
+                bounds[triangle[corner]] = std::max(bounds[triangle[corner]], turn);
+        }
+
+        std::vector<Mesh> generated;
+        for(ThreadPool* pool : {&singleThread, &multiThread})
+        {
+            Mesh& mesh = generated.emplace_back(source);
+            float time = timeMS([&]() { TangentGenerate::generate(mesh, *pool); });
+
+            double worstError = 0.0;
+            double errorSum = 0.0;
+            uint32_t usedCount = 0;
+            for(uint32_t vertex = 0; vertex < mesh.vertexCount(); ++vertex)
+            {
+                const DirectX::XMFLOAT3& tangent = mesh.tangents[vertex];
+                const double error = angleBetween(tangent, source.tangents[vertex]);
+                if(error > bounds[vertex] + ROUNDING
+                   || std::abs(VectorMath::length(tangent) - 1.0f) > ROUNDING
+                   || std::abs(VectorMath::dot(tangent, mesh.normals[vertex])) > ROUNDING)
+                {
+                    std::cerr << shape << ": vertex " << vertex << " got a tangent " << error << " rad from the "
+                              << "analytic one, which turns " << bounds[vertex] << " rad across its triangles, "
+                              << "with length " << VectorMath::length(tangent) << " and "
+                              << VectorMath::dot(tangent, mesh.normals[vertex]) << " along the normal" << std::endl;
+                    return false;
+                }
+                if(bounds[vertex] < std::numbers::pi)
+                {
+                    worstError = std::max(worstError, error);
+                    errorSum += error;
+                    ++usedCount;
+                }
+            }
+
+            const uint32_t threadCount = pool->workerCount() + 1;
+            std::cout << "Tangents " << shape << " on " << threadCount
+                      << (threadCount == 1 ? " thread: " : " threads: ") << source.indexCount() / 3
+                      << " triangles, " << time << " ms, worst " << worstError << " rad, mean " << errorSum / usedCount
+                      << " rad from the analytic tangents" << std::endl;
+        }
+
+        if(std::memcmp(
+               generated[0].tangents.data(),
+               generated[1].tangents.data(),
+               generated[0].tangents.size() * sizeof(DirectX::XMFLOAT3))
+           != 0)
+        {
+            std::cerr << shape << ": the tangents depend on the thread count" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Random triangles between groups of 32 vertices, far more triangles per vertex than any real mesh has, so meshlets
+// fill up on triangles before they run out of vertices
+Mesh generateDense(uint32_t triangleCount, uint64_t seed)
+{
+    constexpr uint32_t GROUP_SIZE = 32;
+    constexpr uint32_t TRIANGLES_PER_GROUP = 256;
+    std::mt19937_64 random(seed);
+    std::uniform_real_distribution<float> coordinate{-1.0f, 1.0f};
+    std::uniform_int_distribution<uint32_t> corner{0, GROUP_SIZE - 1};
+
+    Mesh mesh;
+    while(mesh.indexCount() / 3 < triangleCount)
+    {
+        const uint32_t first = mesh.vertexCount();
+        for(uint32_t vertex = 0; vertex < GROUP_SIZE; ++vertex)
+        {
+            mesh.positions.push_back({coordinate(random), coordinate(random), coordinate(random)});
+            mesh.uvs.push_back({0.0f, 0.0f});
+            mesh.normals.push_back({0.0f, 0.0f, -1.0f});
+            mesh.tangents.push_back({1.0f, 0.0f, 0.0f});
+        }
+        for(uint32_t triangle = 0; triangle < TRIANGLES_PER_GROUP; ++triangle)
+        {
+            const uint32_t a = corner(random);
+            uint32_t b = corner(random);
+            uint32_t c = corner(random);
+            while(b == a)
+                b = corner(random);
+            while(c == a || c == b)
+                c = corner(random);
+            mesh.indices.insert(mesh.indices.end(), {first + a, first + b, first + c});
+        }
+    }
+    return mesh;
+}
+
+// Rotated so the smallest index comes first, which keeps the winding
+std::array<uint32_t, 3> getCanonicalTriangle(uint32_t a, uint32_t b, uint32_t c)
+{
+    if(b < a && b < c)
+        return {b, c, a};
+    if(c < a && c < b)
+        return {c, a, b};
+    return {a, b, c};
+}
+
+bool isSame(const MeshletBuild::MeshletData& a, const MeshletBuild::MeshletData& b)
+{
+    auto same = [](const auto& x, const auto& y)
+    {
+        return x.size() == y.size()
+               && (x.empty() || std::memcmp(x.data(), y.data(), x.size() * sizeof(x[0])) == 0);
+    };
+    return same(a.meshlets, b.meshlets) && same(a.bounds, b.bounds) && same(a.vertices, b.vertices)
+           && same(a.triangles, b.triangles);
+}
+
+// Every triangle of the mesh has to be in exactly one meshlet with its winding, no meshlet may go past the limits,
+// every sphere has to contain its vertices and every cone the normals of its triangles. The output has to be the
+// same with one thread and many
+bool checkMeshlets(uint32_t triangleCount, uint64_t seed)
+{
+    ThreadPool singleThread(0);
+    ThreadPool multiThread(std::max(std::thread::hardware_concurrency(), 4u) - 1);
+
+    for(std::string_view shape : {"grid", "sphere", "dense"})
+    {
+        Mesh mesh = shape == "dense" ? generateDense(triangleCount, seed) : generate(shape, triangleCount);
+        shuffleTriangles(mesh, seed);
+        MeshOptimize::optimize(mesh);
+
+        MeshletBuild::MeshletData data;
+        const float time = timeMS([&]() { data = MeshletBuild::build(mesh, singleThread); });
+        if(!isSame(data, MeshletBuild::build(mesh, multiThread)))
+        {
+            std::cerr << shape << ": the meshlets depend on the thread count" << std::endl;
+            return false;
+        }
+        if(data.bounds.size() != data.meshlets.size())
+        {
+            std::cerr << shape << ": " << data.bounds.size() << " bounds for " << data.meshlets.size() << " meshlets"
+                      << std::endl;
+            return false;
+        }
+
+        std::vector<std::array<uint32_t, 3>> expected;
+        for(uint32_t i = 0; i < mesh.indexCount(); i += 3)
+            expected.push_back(getCanonicalTriangle(mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]));
+        std::vector<std::array<uint32_t, 3>> found;
+
+        for(uint32_t meshletIndex = 0; meshletIndex < data.meshlets.size(); ++meshletIndex)
+        {
+            const MeshletBuild::Meshlet& meshlet = data.meshlets[meshletIndex];
+            const MeshletBuild::Bounds& bounds = data.bounds[meshletIndex];
+            if(meshlet.vertexCount == 0 || meshlet.vertexCount > MeshletBuild::MAX_VERTICES
+               || meshlet.triangleCount == 0 || meshlet.triangleCount > MeshletBuild::MAX_TRIANGLES
+               || meshlet.vertexOffset + meshlet.vertexCount > data.vertices.size()
+               || meshlet.triangleOffset + meshlet.triangleCount > data.triangles.size())
+            {
+                std::cerr << shape << ": meshlet " << meshletIndex << " has " << meshlet.vertexCount
+                          << " vertices and " << meshlet.triangleCount << " triangles" << std::endl;
+                return false;
+            }
+
+            for(uint32_t i = 0; i < meshlet.vertexCount; ++i)
+            {
+                const DirectX::XMFLOAT3& position = mesh.positions[data.vertices[meshlet.vertexOffset + i]];
+                const float distance = VectorMath::length(VectorMath::sub(position, bounds.center));
+                if(distance > bounds.radius * (1.0f + 1e-5f) + 1e-6f)
+                {
+                    std::cerr << shape << ": vertex " << i << " is outside the sphere of meshlet " << meshletIndex
+                              << std::endl;
+                    return false;
+                }
+            }
+
+            // A cutoff of 1 is a cone that's never rejected, anything else has to hold every normal
+            const float minDot = std::sqrt(std::max(1.0f - bounds.coneCutoff * bounds.coneCutoff, 0.0f));
+            for(uint32_t triangle = 0; triangle < meshlet.triangleCount; ++triangle)
+            {
+                const uint32_t packed = data.triangles[meshlet.triangleOffset + triangle];
+                std::array<uint32_t, 3> local{packed & 0xFF, (packed >> 8) & 0xFF, (packed >> 16) & 0xFF};
+                if(packed >> 24 != 0 || local[0] >= meshlet.vertexCount || local[1] >= meshlet.vertexCount
+                   || local[2] >= meshlet.vertexCount)
+                {
+                    std::cerr << shape << ": triangle " << triangle << " of meshlet " << meshletIndex
+                              << " indexes past its vertices" << std::endl;
+                    return false;
+                }
+                std::array<uint32_t, 3> vertices;
+                for(uint32_t corner = 0; corner < 3; ++corner)
+                    vertices[corner] = data.vertices[meshlet.vertexOffset + local[corner]];
+                found.push_back(getCanonicalTriangle(vertices[0], vertices[1], vertices[2]));
+
+                const DirectX::XMFLOAT3 normal = VectorMath::normalize(VectorMath::cross(
+                    VectorMath::sub(mesh.positions[vertices[1]], mesh.positions[vertices[0]]),
+                    VectorMath::sub(mesh.positions[vertices[2]], mesh.positions[vertices[0]])));
+                if(bounds.coneCutoff < 1.0f && VectorMath::dot(normal, bounds.coneAxis) < minDot - 1e-4f)
+                {
+                    std::cerr << shape << ": triangle " << triangle << " is outside the cone of meshlet "
+                              << meshletIndex << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        if(found != expected)
+        {
+            std::cerr << shape << ": the meshlets hold " << found.size() << " triangles that don't match the mesh's "
+                      << expected.size() << std::endl;
+            return false;
+        }
+
+        const MeshletBuild::Stats stats = MeshletBuild::analyze(data);
+        std::cout << "Meshlets " << shape << " " << expected.size() << " triangles: " << stats.meshletCount
+                  << " meshlets, " << stats.vertexFill * 100.0f << "% vertex fill, " << stats.triangleFill * 100.0f
+                  << "% triangle fill, " << time << " ms, every triangle once, same on 1 and "
+                  << multiThread.workerCount() + 1 << " threads" << std::endl;
+    }
+    return true;
+}
+
+// -0 and 0 are the same place, the poles have both
+uint64_t hashPosition(const DirectX::XMFLOAT3& position)
+{
+    auto bits = [](float value) { return value == 0.0f ? 0u : std::bit_cast<uint32_t>(value); };
+    return mix(mix(mix(bits(position.x)) ^ bits(position.y)) ^ bits(position.z));
+}
+
+// Positions simplification may never move: ones shared by vertices with different attributes, which is a UV or
+// normal seam, and ones on an edge only one triangle uses. Only the position has to survive, a seam's copies can
+// each lose their triangles to collapses next to them
+std::unordered_set<uint64_t> getLockedPositions(const Mesh& mesh)
+{
+    std::unordered_set<uint64_t> locked;
+
+    std::unordered_map<uint64_t, uint32_t> positions;
+    for(uint32_t vertex = 0; vertex < mesh.vertexCount(); ++vertex)
+    {
+        const uint64_t position = hashPosition(mesh.positions[vertex]);
+        if(++positions[position] == 2)
+            locked.insert(position);
+    }
+
+    std::unordered_map<uint64_t, uint32_t> edgeUses;
+    for(uint32_t i = 0; i < mesh.lods[0].indexCount; i += 3)
+    {
+        for(uint32_t corner = 0; corner < 3; ++corner)
+        {
+            const uint64_t a = hashPosition(mesh.positions[mesh.indices[i + corner]]);
+            const uint64_t b = hashPosition(mesh.positions[mesh.indices[i + (corner + 1) % 3]]);
+            ++edgeUses[mix(std::min(a, b)) ^ std::max(a, b)];
+        }
+    }
+    for(uint32_t i = 0; i < mesh.lods[0].indexCount; i += 3)
+    {
+        for(uint32_t corner = 0; corner < 3; ++corner)
+        {
+            const uint64_t a = hashPosition(mesh.positions[mesh.indices[i + corner]]);
+            const uint64_t b = hashPosition(mesh.positions[mesh.indices[i + (corner + 1) % 3]]);
+            if(edgeUses[mix(std::min(a, b)) ^ std::max(a, b)] == 1)
+                locked.insert({a, b});
+        }
+    }
+    return locked;
+}
+
+// Every level has to be smaller than the one before it with at least as much error, index only vertices the full
+// mesh uses, keep every seam and border position, and keep every triangle facing the way its vertex normals do
+bool checkLods(uint32_t triangleCount)
+{
+    // Sine of the smallest corner angle a triangle may have before it counts as collinear
+    constexpr double MIN_SINE = 1e-9;
+
+    for(std::string_view shape : {"grid", "sphere"})
+    {
+        Mesh mesh = generate(shape, triangleCount);
+        MeshOptimize::optimize(mesh);
+        const std::vector<MeshLod::LevelStats> levels = MeshLod::build(mesh);
+        const std::unordered_set<uint64_t> locked = getLockedPositions(mesh);
+        if(levels.size() != mesh.lods.size() || mesh.lods.size() < 2)
+        {
+            std::cerr << shape << ": " << mesh.lods.size() << " levels of detail" << std::endl;
+            return false;
+        }
+
+        std::unordered_set<uint32_t> fullVertices(
+            mesh.indices.begin(), mesh.indices.begin() + mesh.lods[0].indexCount);
+        std::cout << "LODs " << shape << " " << mesh.lods[0].indexCount / 3 << " triangles:";
+        for(uint32_t lod = 0; lod < mesh.lods.size(); ++lod)
+        {
+            const Mesh::Lod& level = mesh.lods[lod];
+            if(lod > 0
+               && (level.indexCount >= mesh.lods[lod - 1].indexCount || level.error < mesh.lods[lod - 1].error))
+            {
+                std::cerr << std::endl
+                          << shape << ": LOD " << lod << " has " << level.indexCount << " indices and error "
+                          << level.error << " after " << mesh.lods[lod - 1].indexCount << " and "
+                          << mesh.lods[lod - 1].error << std::endl;
+                return false;
+            }
+
+            std::unordered_set<uint64_t> used;
+            for(uint32_t i = level.firstIndex; i < level.firstIndex + level.indexCount; i += 3)
+            {
+                const uint32_t a = mesh.indices[i];
+                const uint32_t b = mesh.indices[i + 1];
+                const uint32_t c = mesh.indices[i + 2];
+                for(uint32_t vertex : {a, b, c})
+                    used.insert(hashPosition(mesh.positions[vertex]));
+                // In double, float can give collinear corners a tiny normal facing either way depending on FMA
+                auto edge = [&](uint32_t to)
+                {
+                    return std::array{
+                        (double)mesh.positions[to].x - mesh.positions[a].x,
+                        (double)mesh.positions[to].y - mesh.positions[a].y,
+                        (double)mesh.positions[to].z - mesh.positions[a].z,
+                    };
+                };
+                const std::array<double, 3> edge1 = edge(b);
+                const std::array<double, 3> edge2 = edge(c);
+                const std::array<double, 3> faceNormal{
+                    edge1[1] * edge2[2] - edge1[2] * edge2[1],
+                    edge1[2] * edge2[0] - edge1[0] * edge2[2],
+                    edge1[0] * edge2[1] - edge1[1] * edge2[0],
+                };
+                const DirectX::XMFLOAT3 vertexNormal =
+                    VectorMath::add(VectorMath::add(mesh.normals[a], mesh.normals[b]), mesh.normals[c]);
+                const bool collinear = std::hypot(faceNormal[0], faceNormal[1], faceNormal[2])
+                                       <= MIN_SINE * std::hypot(edge1[0], edge1[1], edge1[2])
+                                              * std::hypot(edge2[0], edge2[1], edge2[2]);
+                const bool flipped =
+                    faceNormal[0] * vertexNormal.x + faceNormal[1] * vertexNormal.y + faceNormal[2] * vertexNormal.z
+                    <= 0.0;
+                if(a == b || b == c || c == a || collinear || flipped || !fullVertices.contains(a)
+                   || !fullVertices.contains(b) || !fullVertices.contains(c))
+                {
+                    std::cerr << std::endl
+                              << shape << ": triangle " << (i - level.firstIndex) / 3 << " of LOD " << lod
+                              << " is degenerate, collinear, flipped or uses a vertex the full mesh doesn't"
+                              << std::endl;
+                    return false;
+                }
+            }
+            const size_t lostCount = std::count_if(
+                locked.begin(), locked.end(), [&](uint64_t position) { return !used.contains(position); });
+            if(lostCount > 0)
+            {
+                std::cerr << std::endl
+                          << shape << ": LOD " << lod << " lost " << lostCount << " seam or border positions"
+                          << std::endl;
+                return false;
+            }
+
+            std::cout << (lod == 0 ? " " : ", ") << level.indexCount * 100.0f / mesh.lods[0].indexCount
+                      << "% error " << level.error << " in " << levels[lod].buildTimeMS << " ms";
+        }
+        std::cout << std::endl;
+    }
+    return true;
+}
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t maxTriangleCount = 10'000'000;
+    uint64_t seed = 1;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view argument = argv[i];
+        if(argument == "--max-triangles" && i + 1 < argc)
+            maxTriangleCount = (uint32_t)std::max(std::stoll(argv[++i]), 10'000ll);
+        else if(argument == "--seed" && i + 1 < argc)
+            seed = std::stoull(argv[++i]);
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--max-triangles <count>] [--seed <seed>]" << std::endl;
+            return 1;
+        }
+    }
+
+    if(!checkQuantize(1'000'000, seed))
+        return 1;
+    if(!checkWeld(100'000, seed))
+        return 1;
+    if(!checkTangents(100'000, seed))
+        return 1;
+    if(!checkMeshlets(100'000, seed))
+        return 1;
+    if(!checkLods(100'000))
+        return 1;
+
+    std::cout << "Optimize, vertex cache then overdraw then vertex fetch:" << std::endl;
+    for(uint32_t triangleCount = 10'000; triangleCount <= maxTriangleCount; triangleCount *= 10)
+    {
+        for(std::string_view shape : {"grid", "sphere"})
+        {
+            if(!benchOptimize(shape, triangleCount, seed))
+                return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include <asset/mesh_cache.hpp>
+#include <asset/mesh_import.hpp>
+#include <asset/mesh_lod.hpp>
+#include <asset/mesh_optimize.hpp>
+#include <asset/meshlet_build.hpp>
+#include <asset/tangent_generate.hpp>
+#include <asset/vertex_quantize.hpp>
+#include <asset/vertex_weld.hpp>
+#include <util/thread_pool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+    #include <Windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+// Offline cook step. Demos will cook on demand as well, but this gives a way
+// of doing it ahead of time and comparing the cooked load against Assimp
+namespace
+{
+float timeMS(auto func)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+    return duration.count();
+}
+
+// High water mark of the whole process so far
+float getPeakMemoryMB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / (1024.0f * 1024.0f);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // Kilobytes on Linux
+    return usage.ru_maxrss / 1024.0f;
+#endif
+}
+
+// Copy the whole payload like the demos do, which is what actually faults the pages in
+void copyPayload(const MeshCache::CookedMesh& mesh, std::vector<char>& destination)
+{
+    destination.resize(mesh.header().payloadSize);
+    std::memcpy(destination.data(), mesh.payload(), mesh.header().payloadSize);
+}
+}
+
+int main(int argc, char** argv)
+{
+    MeshCache::VertexFormat vertexFormat = MeshCache::VertexFormat::FULL;
+    float weldEpsilon = 0.0f;
+    std::vector<std::filesystem::path> paths;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::string_view(argv[i]) == "--quantized")
+            vertexFormat = MeshCache::VertexFormat::QUANTIZED;
+        else if(std::string_view(argv[i]) == "--weld-epsilon" && i + 1 < argc)
+            weldEpsilon = std::stof(argv[++i]);
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if(paths.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " [--quantized] [--weld-epsilon <epsilon>] <source> [cooked]" << std::endl;
+        return 1;
+    }
+
+    std::filesystem::path sourcePath = paths[0];
+    std::filesystem::path cookedPath =
+        paths.size() > 1 ? paths[1] : MeshCache::getCookedPath(sourcePath, vertexFormat);
+
+    std::optional<std::vector<Mesh>> meshes;
+    float importTime = timeMS([&]() { meshes = MeshImport::import(sourcePath); });
+    if(!meshes)
+    {
+        std::cerr << "Failed to import " << sourcePath << std::endl;
+        return 1;
+    }
+    uint32_t meshCount = (uint32_t)meshes->size();
+    float importPeakMemory = getPeakMemoryMB();
+
+    // Only the tangents change, the imported ones stay as the reference. Sources that come without
+    // tangents were already run through the generator on import and compare as identical
+    uint64_t tangentTriangleCount = 0;
+    uint64_t tangentVertexCount = 0;
+    float tangentTime = 0.0f;
+    TangentGenerate::Error tangentError{0.0f, 0.0f};
+    for(const Mesh& mesh : meshes.value())
+    {
+        Mesh regenerated = mesh;
+        tangentTime += timeMS([&]() { TangentGenerate::generate(regenerated); });
+        TangentGenerate::Error error = TangentGenerate::measureError(regenerated.tangents, mesh.tangents);
+        tangentError.max = std::max(tangentError.max, error.max);
+        tangentError.mean += error.mean * mesh.vertexCount();
+        tangentTriangleCount += mesh.indexCount() / 3;
+        tangentVertexCount += mesh.vertexCount();
+    }
+    if(tangentVertexCount > 0)
+        tangentError.mean /= (float)tangentVertexCount;
+
+    // Every stage runs one task per mesh, like MeshCache::cook does, and the stats are summed over
+    // all of them
+    ThreadPool& pool = ThreadPool::shared();
+    std::vector<VertexWeld::Stats> weldStats(meshCount);
+    float weldTime = timeMS(
+        [&]()
+        {
+            pool.parallelFor(
+                meshCount,
+                1,
+                [&](uint32_t mesh, uint32_t) { weldStats[mesh] = VertexWeld::weld((*meshes)[mesh], weldEpsilon); });
+        });
+    uint64_t verticesBefore = 0;
+    uint64_t verticesAfter = 0;
+    for(const VertexWeld::Stats& stats : weldStats)
+    {
+        verticesBefore += stats.verticesBefore;
+        verticesAfter += stats.verticesAfter;
+    }
+
+    std::vector<MeshOptimize::Stats> optimizeStats(meshCount);
+    float optimizeTime = timeMS(
+        [&]()
+        {
+            pool.parallelFor(
+                meshCount,
+                1,
+                [&](uint32_t mesh, uint32_t) { optimizeStats[mesh] = MeshOptimize::optimize((*meshes)[mesh]); });
+        });
+    // Weighted by triangles and vertices so the totals match what one big mesh would report
+    MeshOptimize::Stats optimizeTotal{{0.0f, 0.0f}, {0.0f, 0.0f}};
+    uint64_t triangleCount = 0;
+    uint64_t vertexCount = 0;
+    for(uint32_t mesh = 0; mesh < meshCount; ++mesh)
+    {
+        float triangles = (float)((*meshes)[mesh].indexCount() / 3);
+        float vertices = (float)(*meshes)[mesh].vertexCount();
+        optimizeTotal.before.acmr += optimizeStats[mesh].before.acmr * triangles;
+        optimizeTotal.after.acmr += optimizeStats[mesh].after.acmr * triangles;
+        optimizeTotal.before.atvr += optimizeStats[mesh].before.atvr * vertices;
+        optimizeTotal.after.atvr += optimizeStats[mesh].after.atvr * vertices;
+        triangleCount += (*meshes)[mesh].indexCount() / 3;
+        vertexCount += (*meshes)[mesh].vertexCount();
+    }
+    if(triangleCount > 0)
+    {
+        optimizeTotal.before.acmr /= (float)triangleCount;
+        optimizeTotal.after.acmr /= (float)triangleCount;
+    }
+    if(vertexCount > 0)
+    {
+        optimizeTotal.before.atvr /= (float)vertexCount;
+        optimizeTotal.after.atvr /= (float)vertexCount;
+    }
+
+    // Nothing consumes meshlets yet, they're only built to report on them
+    std::vector<MeshletBuild::MeshletData> meshlets(meshCount);
+    float meshletTime = timeMS(
+        [&]()
+        {
+            pool.parallelFor(
+                meshCount,
+                1,
+                [&](uint32_t mesh, uint32_t) { meshlets[mesh] = MeshletBuild::build((*meshes)[mesh]); });
+        });
+    uint64_t meshletCount = 0;
+    float vertexFill = 0.0f;
+    float triangleFill = 0.0f;
+    for(const MeshletBuild::MeshletData& data : meshlets)
+    {
+        MeshletBuild::Stats stats = MeshletBuild::analyze(data);
+        meshletCount += stats.meshletCount;
+        vertexFill += stats.vertexFill * stats.meshletCount;
+        triangleFill += stats.triangleFill * stats.meshletCount;
+    }
+    if(meshletCount > 0)
+    {
+        vertexFill /= (float)meshletCount;
+        triangleFill /= (float)meshletCount;
+    }
+
+    std::vector<std::vector<MeshLod::LevelStats>> lodStats(meshCount);
+    float lodTime = timeMS(
+        [&]()
+        {
+            pool.parallelFor(
+                meshCount,
+                1,
+                [&](uint32_t mesh, uint32_t) { lodStats[mesh] = MeshLod::build((*meshes)[mesh]); });
+        });
+    // Meshes stop simplifying at different levels, so a level only counts the meshes that reached it
+    std::vector<MeshLod::LevelStats> lodTotal;
+    std::vector<uint64_t> lodBaseIndices;
+    for(const std::vector<MeshLod::LevelStats>& levels : lodStats)
+    {
+        for(uint32_t lod = 0; lod < levels.size(); ++lod)
+        {
+            if(lod == lodTotal.size())
+            {
+                lodTotal.push_back({0, 0.0f, 0.0f});
+                lodBaseIndices.push_back(0);
+            }
+            lodTotal[lod].indexCount += levels[lod].indexCount;
+            lodTotal[lod].error = std::max(lodTotal[lod].error, levels[lod].error);
+            lodTotal[lod].buildTimeMS += levels[lod].buildTimeMS;
+            lodBaseIndices[lod] += levels[0].indexCount;
+        }
+    }
+
+    bool written = false;
+    float writeTime =
+        timeMS([&]() { written = MeshCache::write(meshes.value(), sourcePath, cookedPath, vertexFormat); });
+    if(!written)
+    {
+        std::cerr << "Failed to write " << cookedPath << std::endl;
+        return 1;
+    }
+    float writePeakMemory = getPeakMemoryMB();
+
+    // The file was just written so it's most likely in the OS file cache. "Cold" here means a fresh
+    // mapping, not a cold disk
+    std::vector<char> destination;
+    float coldTime = timeMS([&]() { copyPayload(MeshCache::load(cookedPath).value(), destination); });
+
+    std::optional<MeshCache::CookedMesh> cooked = MeshCache::load(cookedPath);
+    copyPayload(cooked.value(), destination);
+    float warmTime = timeMS([&]() { copyPayload(cooked.value(), destination); });
+
+    std::cout << cookedPath.string() << ": " << meshCount << " meshes, " << vertexCount << " vertices, "
+              << triangleCount * 3 << " indices" << std::endl;
+    std::cout << "Assimp import: " << importTime << " ms" << std::endl;
+    std::cout << "Tangents:      " << tangentTime << " ms, " << tangentTriangleCount / (tangentTime * 1000.0f)
+              << " million triangles per second" << std::endl;
+    std::cout << "  max " << tangentError.max << " rad, mean " << tangentError.mean << " rad from the imported tangents"
+              << std::endl;
+    std::cout << "Weld:          " << weldTime << " ms, " << weldTime * 1'000'000.0f / verticesBefore
+              << " ms per million vertices" << std::endl;
+    std::cout << "  " << verticesBefore << " -> " << verticesAfter << " vertices, " << verticesBefore - verticesAfter
+              << " removed" << std::endl;
+    std::cout << "Optimize:      " << optimizeTime << " ms" << std::endl;
+    std::cout << "  ACMR " << optimizeTotal.before.acmr << " -> " << optimizeTotal.after.acmr << ", ATVR "
+              << optimizeTotal.before.atvr << " -> " << optimizeTotal.after.atvr << std::endl;
+    std::cout << "Meshlets:      " << meshletTime << " ms, " << triangleCount / (meshletTime * 1000.0f)
+              << " million triangles per second" << std::endl;
+    std::cout << "  " << meshletCount << " meshlets, " << vertexFill * 100.0f << "% vertex fill, "
+              << triangleFill * 100.0f << "% triangle fill" << std::endl;
+    std::cout << "LODs:          " << lodTime << " ms" << std::endl;
+    for(uint32_t lod = 1; lod < lodTotal.size(); ++lod)
+    {
+        std::cout << "  LOD " << lod << ": " << lodTotal[lod].indexCount / 3 << " triangles ("
+                  << lodTotal[lod].indexCount * 100.0f / lodBaseIndices[lod] << "%), error " << lodTotal[lod].error
+                  << ", " << lodTotal[lod].buildTimeMS << " ms" << std::endl;
+    }
+    if(vertexFormat == MeshCache::VertexFormat::QUANTIZED)
+    {
+        // Measured against the same combined bounds the cooked file quantizes to
+        Mesh combined;
+        for(const Mesh& mesh : meshes.value())
+        {
+            combined.positions.insert(combined.positions.end(), mesh.positions.begin(), mesh.positions.end());
+            combined.uvs.insert(combined.uvs.end(), mesh.uvs.begin(), mesh.uvs.end());
+            combined.normals.insert(combined.normals.end(), mesh.normals.begin(), mesh.normals.end());
+            combined.tangents.insert(combined.tangents.end(), mesh.tangents.begin(), mesh.tangents.end());
+        }
+        VertexQuantize::Error error = VertexQuantize::measureError(combined, VertexQuantize::quantize(combined));
+        std::cout << "Quantization:  max position error " << error.position << ", uv " << error.uv << ", normal "
+                  << error.normal << " rad, tangent " << error.tangent << " rad" << std::endl;
+    }
+    std::cout << "Cook write:    " << writeTime << " ms" << std::endl;
+    std::cout << "Peak memory:   " << importPeakMemory << " MB after import, " << writePeakMemory
+              << " MB after the write" << std::endl;
+    std::cout << "Cooked (cold): " << coldTime << " ms" << std::endl;
+    std::cout << "Cooked (warm): " << warmTime << " ms" << std::endl;
+
+    return 0;
+}
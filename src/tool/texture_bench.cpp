@@ -0,0 +1,487 @@
+#include <asset/mip_generate.hpp>
+#include <asset/texture_atlas.hpp>
+#include <asset/texture_cache.hpp>
+#include <asset/texture_compress.hpp>
+#include <asset/texture_load.hpp>
+#include <util/align.hpp>
+#include <util/blit.hpp>
+#include <util/file_util.hpp>
+#include <util/stbi.hpp>
+#include <util/thread_pool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Timings for the CPU side texture work the demos do at load time, on a single image. Any other images given
+// only have their decode timed
+namespace
+{
+constexpr uint32_t RUN_COUNT = 5;
+
+float timeMS(auto func)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+    return duration.count();
+}
+
+const char* getName(MipGenerate::Content content)
+{
+    switch(content)
+    {
+    case MipGenerate::Content::COLOR: return "color";
+    case MipGenerate::Content::LINEAR: return "linear";
+    case MipGenerate::Content::NORMAL: return "normal";
+    }
+    return "";
+}
+
+const char* getName(MipGenerate::Filter filter)
+{
+    return filter == MipGenerate::Filter::BOX ? "box" : "kaiser";
+}
+
+const char* getName(Blit::Isa isa)
+{
+    switch(isa)
+    {
+    case Blit::Isa::SCALAR: return "scalar";
+    case Blit::Isa::SSSE3: return "SSSE3";
+    case Blit::Isa::AVX2: return "AVX2";
+    }
+    return "";
+}
+
+const char* getName(Blit::Format format)
+{
+    switch(format)
+    {
+    case Blit::Format::R8: return "R8";
+    case Blit::Format::RG8: return "RG8";
+    case Blit::Format::RGB8: return "RGB8";
+    case Blit::Format::RGBA8: return "RGBA8";
+    case Blit::Format::BGRA8: return "BGRA8";
+    }
+    return "";
+}
+
+const char* getName(Blit::Transfer transfer)
+{
+    switch(transfer)
+    {
+    case Blit::Transfer::NONE: return "no transfer";
+    case Blit::Transfer::SRGB_TO_LINEAR: return "sRGB to linear";
+    case Blit::Transfer::LINEAR_TO_SRGB: return "linear to sRGB";
+    }
+    return "";
+}
+
+const char* getName(TextureCompress::Format format)
+{
+    switch(format)
+    {
+    case TextureCompress::Format::BC1: return "BC1";
+    case TextureCompress::Format::BC4: return "BC4";
+    case TextureCompress::Format::BC5: return "BC5";
+    case TextureCompress::Format::BC7: return "BC7";
+    }
+    return "";
+}
+
+// Best of RUN_COUNT runs for every thread count. The calling thread works too, so the pools get one worker
+// less than the count
+void printThroughput(std::string_view name, float megabytes, std::span<const uint32_t> threadCounts, auto func)
+{
+    std::cout << name << ":";
+    for(uint32_t threadCount : threadCounts)
+    {
+        ThreadPool pool(threadCount - 1);
+        float best = std::numeric_limits<float>::max();
+        for(uint32_t run = 0; run < RUN_COUNT; ++run)
+            best = std::min(best, timeMS([&]() { func(pool); }));
+        std::cout << " " << threadCount << "T " << megabytes / (best / 1000.0f) << " MB/s";
+    }
+    std::cout << std::endl;
+}
+
+// Every vectorized path against the scalar one for every pair of formats and every transfer, at widths from 1 up
+// so each vector loop also runs with every tail length after it. The rows have padding on both sides, which is
+// compared too, so a path that reads or writes past the end of a row fails as well
+bool checkBlit()
+{
+    constexpr uint32_t MAX_WIDTH = 99;
+    constexpr uint32_t HEIGHT = 3;
+    constexpr uint32_t PADDING = 5;
+    constexpr Blit::Format FORMATS[] = {
+        Blit::Format::R8, Blit::Format::RG8, Blit::Format::RGB8, Blit::Format::RGBA8, Blit::Format::BGRA8};
+    constexpr Blit::Transfer TRANSFERS[] = {
+        Blit::Transfer::NONE, Blit::Transfer::SRGB_TO_LINEAR, Blit::Transfer::LINEAR_TO_SRGB};
+
+    std::mt19937 random(1);
+    std::vector<char> source((MAX_WIDTH * 4 + PADDING) * HEIGHT);
+    for(char& byte : source)
+        byte = (char)random();
+
+    uint32_t caseCount = 0;
+    for(uint32_t width = 1; width <= MAX_WIDTH; ++width)
+    {
+        for(Blit::Format sourceFormat : FORMATS)
+        {
+            for(Blit::Format destinationFormat : FORMATS)
+            {
+                for(Blit::Transfer transfer : TRANSFERS)
+                {
+                    const Blit::Image image = {
+                        source.data(), width * Blit::getPixelSize(sourceFormat) + PADDING, sourceFormat};
+                    const uint32_t destinationPitch = width * Blit::getPixelSize(destinationFormat) + PADDING;
+                    std::vector<char> reference(destinationPitch * HEIGHT, (char)0xCD);
+                    Blit::blit(
+                        image,
+                        {reference.data(), destinationPitch, destinationFormat},
+                        width,
+                        HEIGHT,
+                        transfer,
+                        Blit::Isa::SCALAR);
+
+                    for(uint32_t isa = (uint32_t)Blit::Isa::SCALAR + 1; isa <= (uint32_t)Blit::getIsa(); ++isa)
+                    {
+                        std::vector<char> result(destinationPitch * HEIGHT, (char)0xCD);
+                        Blit::blit(
+                            image,
+                            {result.data(), destinationPitch, destinationFormat},
+                            width,
+                            HEIGHT,
+                            transfer,
+                            (Blit::Isa)isa);
+                        if(result != reference)
+                        {
+                            std::cerr << "Blit " << getName(sourceFormat) << " to " << getName(destinationFormat)
+                                      << ", " << getName(transfer) << ", at width " << width << ": "
+                                      << getName((Blit::Isa)isa) << " doesn't match scalar" << std::endl;
+                            return false;
+                        }
+                    }
+                    ++caseCount;
+                }
+            }
+        }
+    }
+
+    std::cout << "Blit: " << getName(Blit::getIsa()) << " and below match scalar on " << caseCount
+              << " format, transfer and width combinations" << std::endl;
+    return true;
+}
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t channels = 4;
+    // The first one is the image for everything, the rest only have their decode timed
+    std::vector<std::string> paths;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::string_view(argv[i]) == "--channels" && i + 1 < argc)
+            channels = std::clamp(std::stoi(argv[++i]), 1, 4);
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if(paths.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " [--channels <1-4>] <image> [images to time decoding of]" << std::endl;
+        return 1;
+    }
+
+    if(!checkBlit())
+        return 1;
+
+    const std::string& path = paths[0];
+    std::optional<TextureLoad::Image> image = TextureLoad::load(path, channels);
+    if(!image)
+    {
+        std::cerr << "Can't decode " << path << ": " << stbi_failure_reason() << std::endl;
+        return 1;
+    }
+    const uint32_t width = image->width;
+    const uint32_t height = image->height;
+
+    const MipGenerate::Layout layout = MipGenerate::getLayout(width, height, channels);
+    // Touched once up front so page faults don't end up in the first timing
+    std::vector<char> destination(layout.size);
+    const float sourceMB = width * height * channels / (1024.0f * 1024.0f);
+    std::cout << path << ": " << width << "x" << height << ", " << channels << " channels, " << layout.levels.size()
+              << " levels, " << layout.size / 1024 << " KB pitched chain" << std::endl;
+
+    std::vector<uint32_t> threadCounts;
+    for(uint32_t threadCount = 1; threadCount < std::thread::hardware_concurrency(); threadCount *= 2)
+        threadCounts.push_back(threadCount);
+    threadCounts.push_back(std::max(std::thread::hardware_concurrency(), 1u));
+
+    std::vector<MipGenerate::Content> contents = {MipGenerate::Content::LINEAR};
+    if(channels >= 3)
+        contents = {MipGenerate::Content::COLOR, MipGenerate::Content::LINEAR, MipGenerate::Content::NORMAL};
+
+    for(MipGenerate::Content content : contents)
+    {
+        for(MipGenerate::Filter filter : {MipGenerate::Filter::BOX, MipGenerate::Filter::KAISER})
+        {
+            printThroughput(
+                std::string("Mips, ") + getName(content) + " " + getName(filter),
+                sourceMB,
+                threadCounts,
+                [&](ThreadPool& pool)
+                { MipGenerate::generate(image->pixels.get(), layout, content, filter, destination.data(), pool); });
+        }
+    }
+
+    // Every format gets the box filtered chain of the content it's meant for. Throughput is in uncompressed
+    // texels of the whole chain
+    struct Compression
+    {
+        TextureCompress::Format format;
+        MipGenerate::Content content;
+    };
+    std::vector<Compression> compressions = {{TextureCompress::Format::BC4, MipGenerate::Content::LINEAR}};
+    if(channels >= 2)
+        compressions.push_back({TextureCompress::Format::BC5, MipGenerate::Content::NORMAL});
+    if(channels >= 3)
+    {
+        compressions.push_back({TextureCompress::Format::BC1, MipGenerate::Content::COLOR});
+        compressions.push_back({TextureCompress::Format::BC7, MipGenerate::Content::COLOR});
+    }
+
+    float chainMB = 0.0f;
+    for(const MipGenerate::Level& level : layout.levels)
+        chainMB += level.width * level.height * channels / (1024.0f * 1024.0f);
+
+    for(const Compression& compression : compressions)
+    {
+        MipGenerate::generate(
+            image->pixels.get(), layout, compression.content, MipGenerate::Filter::BOX, destination.data());
+        const TextureCompress::Layout compressedLayout =
+            TextureCompress::getLayout(width, height, compression.format);
+        std::vector<char> compressed(compressedLayout.size);
+        printThroughput(
+            std::string("Compress, ") + getName(compression.format),
+            chainMB,
+            threadCounts,
+            [&](ThreadPool& pool)
+            { TextureCompress::compress(destination.data(), layout, compressedLayout, compressed.data(), pool); });
+
+        std::cout << "  PSNR "
+                  << TextureCompress::measurePsnr(destination.data(), layout, compressedLayout, compressed.data())
+                  << " dB, " << compressedLayout.size / 1024 << " KB, "
+                  << float(layout.size) / compressedLayout.size << "x smaller" << std::endl;
+    }
+
+    // Blits of the source into the upload buffer pitch, every path checked against the scalar one again on a real
+    // image. Throughput is in source bytes
+    struct BlitCase
+    {
+        const char* name;
+        Blit::Format source;
+        Blit::Format destination;
+        Blit::Transfer transfer;
+    };
+    const BlitCase blitCases[] = {
+        {"copy RGBA8", Blit::Format::RGBA8, Blit::Format::RGBA8, Blit::Transfer::NONE},
+        {"RGB8 to RGBA8", Blit::Format::RGB8, Blit::Format::RGBA8, Blit::Transfer::NONE},
+        {"RGBA8 to BGRA8", Blit::Format::RGBA8, Blit::Format::BGRA8, Blit::Transfer::NONE},
+        {"RGBA8 to R8", Blit::Format::RGBA8, Blit::Format::R8, Blit::Transfer::NONE},
+        {"sRGB to linear RGBA8", Blit::Format::RGBA8, Blit::Format::RGBA8, Blit::Transfer::SRGB_TO_LINEAR},
+    };
+    constexpr Blit::Format IMAGE_FORMATS[] = {
+        Blit::Format::R8, Blit::Format::RG8, Blit::Format::RGB8, Blit::Format::RGBA8};
+    const Blit::Image imageSource = {image->pixels.get(), width * channels, IMAGE_FORMATS[channels - 1]};
+    const uint32_t maxRowPitch = AlignTo(width * 4, MipGenerate::ROW_PITCH_ALIGNMENT);
+    std::vector<char> blitSource(width * height * 4);
+    std::vector<char> blitDestination(maxRowPitch * height);
+    std::vector<char> blitReference(maxRowPitch * height);
+    for(const BlitCase& blitCase : blitCases)
+    {
+        const uint32_t sourcePitch = width * Blit::getPixelSize(blitCase.source);
+        const uint32_t destinationPitch =
+            AlignTo(width * Blit::getPixelSize(blitCase.destination), MipGenerate::ROW_PITCH_ALIGNMENT);
+        const Blit::Image source = {blitSource.data(), sourcePitch, blitCase.source};
+        Blit::blit(imageSource, {blitSource.data(), sourcePitch, blitCase.source}, width, height);
+        Blit::blit(
+            source,
+            {blitReference.data(), destinationPitch, blitCase.destination},
+            width,
+            height,
+            blitCase.transfer,
+            Blit::Isa::SCALAR);
+
+        std::cout << "Blit, " << blitCase.name << ":";
+        for(uint32_t isa = 0; isa <= (uint32_t)Blit::getIsa(); ++isa)
+        {
+            const Blit::MutableImage target = {blitDestination.data(), destinationPitch, blitCase.destination};
+            float best = std::numeric_limits<float>::max();
+            for(uint32_t run = 0; run < RUN_COUNT; ++run)
+            {
+                best = std::min(
+                    best,
+                    timeMS([&]() { Blit::blit(source, target, width, height, blitCase.transfer, (Blit::Isa)isa); }));
+            }
+            const bool matches =
+                std::memcmp(blitDestination.data(), blitReference.data(), (size_t)destinationPitch * height) == 0;
+            std::cout << " " << getName((Blit::Isa)isa) << " "
+                      << sourcePitch * height / (1024.0f * 1024.0f) / (best / 1000.0f) << " MB/s";
+            if(!matches)
+            {
+                std::cout << std::endl;
+                std::cerr << "Blit, " << blitCase.name << ": " << getName((Blit::Isa)isa) << " doesn't match scalar"
+                          << std::endl;
+                return 1;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    // Atlases of crops of the source at random sizes, padded and aligned for the first 4 mips. Seeded, so the
+    // sets are the same from run to run
+    struct AtlasSet
+    {
+        const char* name;
+        uint32_t count;
+        uint32_t minSize;
+        uint32_t maxSize;
+    };
+    const AtlasSet atlasSets[] = {
+        {"64 icons", 64, 16, 64},
+        {"256 mixed", 256, 8, 256},
+        {"32 large", 32, 128, 512},
+    };
+    const Blit::Format atlasFormat = IMAGE_FORMATS[channels - 1];
+    std::mt19937 random(1);
+    for(const AtlasSet& atlasSet : atlasSets)
+    {
+        std::uniform_int_distribution<uint32_t> sizeDistribution(
+            std::min(atlasSet.minSize, width), std::min(atlasSet.maxSize, std::min(width, height)));
+        std::vector<TextureLoad::Size> sizes(atlasSet.count);
+        for(TextureLoad::Size& size : sizes)
+            size = {sizeDistribution(random), sizeDistribution(random)};
+
+        std::optional<TextureAtlas::Packing> packing;
+        float packMS = std::numeric_limits<float>::max();
+        for(uint32_t run = 0; run < RUN_COUNT; ++run)
+            packMS = std::min(packMS, timeMS([&]() { packing = TextureAtlas::pack(sizes, 16384, 8, 8); }));
+        if(!packing)
+        {
+            std::cout << "Atlas, " << atlasSet.name << ": doesn't fit" << std::endl;
+            continue;
+        }
+
+        const std::vector<Blit::Image> crops(atlasSet.count, imageSource);
+        const uint32_t atlasPitch = AlignTo(packing->width * channels, MipGenerate::ROW_PITCH_ALIGNMENT);
+        std::vector<char> atlas((size_t)atlasPitch * packing->height);
+        float buildMS = std::numeric_limits<float>::max();
+        for(uint32_t run = 0; run < RUN_COUNT; ++run)
+        {
+            buildMS = std::min(
+                buildMS,
+                timeMS([&]() { TextureAtlas::build(*packing, crops, {atlas.data(), atlasPitch, atlasFormat}); }));
+        }
+        std::cout << "Atlas, " << atlasSet.name << ": " << packing->width << "x" << packing->height << ", "
+                  << TextureAtlas::getEfficiency(*packing) * 100.0f << "% used, pack " << packMS << " ms, build "
+                  << buildMS << " ms" << std::endl;
+    }
+
+    // What the demos pay per texture once it's cooked, against cooking it from the source image
+    const TextureCache::Settings settings = {
+        .channels = channels,
+        .content = channels >= 3 ? MipGenerate::Content::COLOR : MipGenerate::Content::LINEAR,
+        .filter = MipGenerate::Filter::BOX,
+        .compression = channels >= 3 ? TextureCompress::Format::BC7 : TextureCompress::Format::BC4,
+    };
+    const std::filesystem::path cookedPath = TextureCache::getCookedPath(path, settings);
+    bool cooked = false;
+    const float cookMS = timeMS([&]() { cooked = TextureCache::cook(path, cookedPath, settings); });
+    if(!cooked)
+    {
+        std::cerr << "Can't cook " << path << " to " << cookedPath << std::endl;
+        return 1;
+    }
+
+    float best = std::numeric_limits<float>::max();
+    uint32_t payloadSize = 0;
+    for(uint32_t run = 0; run < RUN_COUNT; ++run)
+    {
+        best = std::min(
+            best,
+            timeMS(
+                [&]()
+                {
+                    std::optional<TextureCache::CookedTexture> texture = TextureCache::load(cookedPath);
+                    payloadSize = texture->header().payloadSize;
+                    std::memcpy(destination.data(), texture->payload(), payloadSize);
+                }));
+    }
+    std::cout << "Cooked " << getName(settings.compression.value()) << ", " << payloadSize / 1024 << " KB: cook "
+              << cookMS << " ms, load and copy " << best << " ms" << std::endl;
+
+    // Decoding straight from the mapped file, the way everything loads images, against reading the file into
+    // memory first. Throughput is in encoded bytes, so formats compare by what they cost per byte on disk
+    for(const std::string& decodePath : paths)
+    {
+        std::optional<std::vector<char>> encoded = FileUtil::readFile(decodePath);
+        if(!encoded)
+        {
+            std::cerr << "Can't read " << decodePath << std::endl;
+            continue;
+        }
+
+        float mappedBest = std::numeric_limits<float>::max();
+        float readBest = std::numeric_limits<float>::max();
+        float sharedBest = std::numeric_limits<float>::max();
+        bool decoded = true;
+        for(uint32_t run = 0; run < RUN_COUNT; ++run)
+        {
+            mappedBest = std::min(
+                mappedBest, timeMS([&]() { decoded &= TextureLoad::load(decodePath, channels).has_value(); }));
+            readBest = std::min(
+                readBest,
+                timeMS(
+                    [&]()
+                    {
+                        std::optional<std::vector<char>> file = FileUtil::readFile(decodePath);
+                        decoded &= file && TextureLoad::loadFromMemory(file.value(), channels).has_value();
+                    }));
+        }
+
+        // Loading an image that's already alive somewhere else only costs the registry lookup
+        const TextureLoad::SharedImage held = TextureLoad::loadShared(decodePath, channels);
+        decoded &= held != nullptr;
+        for(uint32_t run = 0; run < RUN_COUNT; ++run)
+        {
+            sharedBest = std::min(
+                sharedBest, timeMS([&]() { decoded &= TextureLoad::loadShared(decodePath, channels) == held; }));
+        }
+        if(!decoded)
+        {
+            std::cerr << "Can't decode " << decodePath << ": " << stbi_failure_reason() << std::endl;
+            continue;
+        }
+
+        const float encodedMB = encoded->size() / (1024.0f * 1024.0f);
+        std::cout << "Decode " << std::filesystem::path(decodePath).extension().string().substr(1) << ", "
+                  << encoded->size() / 1024 << " KB: mapped " << encodedMB / (mappedBest / 1000.0f)
+                  << " MB/s, read first " << encodedMB / (readBest / 1000.0f) << " MB/s, shared "
+                  << sharedBest * 1000.0f << " us" << std::endl;
+    }
+
+    return 0;
+}
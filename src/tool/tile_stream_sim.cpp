@@ -0,0 +1,221 @@
+#include <asset/texture_cache.hpp>
+#include <asset/tile_residency.hpp>
+#include <asset/tile_stream.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <numbers>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Flies a camera over a field of quads that each have their own streamed texture, many more than the tile pool
+// can hold at once, and reports how well the residency keeps up. Every quad is split into patches that request
+// the level their distance calls for, loads take a few frames to complete like they would behind a GPU copy,
+// and the residency is validated after every frame
+namespace
+{
+constexpr uint32_t QUADS_PER_ROW = 16;
+constexpr float QUAD_SPACING = 1.5f;
+constexpr uint32_t PATCHES_PER_SIDE = 4;
+constexpr float CAMERA_HEIGHT = 1.0f;
+constexpr float VIEW_DISTANCE = 16.0f;
+// cos of half the field of view, with some margin for the patches' size
+constexpr float VIEW_COS = 0.5f;
+// Screen pixels a unit of world covers at a distance of one unit, about 1080p at 60 degrees
+constexpr float PIXELS_PER_UNIT = 1000.0f;
+
+struct Totals
+{
+    uint64_t patches = 0;
+    uint64_t hits = 0;
+    uint64_t fallbackLevels = 0;
+    uint64_t loads = 0;
+    uint64_t evictions = 0;
+    uint64_t starvedLoads = 0;
+    double updateMS = 0.0;
+    double readMS = 0.0;
+};
+
+void print(const Totals& totals, uint32_t frameCount, uint32_t residentTiles)
+{
+    std::cout << "hit rate " << 100.0 * totals.hits / std::max<uint64_t>(totals.patches, 1) << "%, fallback "
+              << (double)totals.fallbackLevels / std::max<uint64_t>(totals.patches, 1) << " levels, "
+              << (double)totals.loads / frameCount << " loads and " << (double)totals.evictions / frameCount
+              << " evictions per frame, " << (double)totals.starvedLoads / frameCount << " starved, "
+              << residentTiles * (TileResidency::TILE_SIZE / 1024) / 1024 << " MB resident, update "
+              << totals.updateMS * 1000.0 / frameCount << " us, wait for reads " << totals.readMS / frameCount
+              << " ms" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t textureCount = 256;
+    uint32_t poolMB = 256;
+    uint32_t maxLoads = 64;
+    uint32_t latency = 3;
+    uint32_t frameCount = 1200;
+    std::string path;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view argument = argv[i];
+        if(argument == "--textures" && i + 1 < argc)
+            textureCount = std::max(std::stoi(argv[++i]), 1);
+        else if(argument == "--pool-mb" && i + 1 < argc)
+            poolMB = std::max(std::stoi(argv[++i]), 1);
+        else if(argument == "--max-loads" && i + 1 < argc)
+            maxLoads = std::max(std::stoi(argv[++i]), 1);
+        else if(argument == "--latency" && i + 1 < argc)
+            latency = std::max(std::stoi(argv[++i]), 0);
+        else if(argument == "--frames" && i + 1 < argc)
+            frameCount = std::max(std::stoi(argv[++i]), 1);
+        else
+            path = argument;
+    }
+
+    if(path.empty())
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--textures <count>] [--pool-mb <size>] [--max-loads <per frame>] [--latency <frames>]"
+                     " [--frames <count>] <image>"
+                  << std::endl;
+        return 1;
+    }
+
+    const TextureCache::Settings settings = {
+        .channels = 4,
+        .content = MipGenerate::Content::COLOR,
+        .filter = MipGenerate::Filter::BOX,
+        .compression = TextureCompress::Format::BC7,
+    };
+    std::optional<TextureCache::CookedTexture> cooked = TextureCache::loadOrCook(path, settings);
+    if(!cooked)
+    {
+        std::cerr << "Can't cook " << path << std::endl;
+        return 1;
+    }
+
+    // Every quad streams from the same file, which is all the residency needs to treat them as different
+    // textures. The page cache does make reads cheaper than they would be for distinct files
+    const TextureCache::Header& header = cooked->header();
+    const uint32_t slotCount = poolMB * 1024 / (TileResidency::TILE_SIZE / 1024);
+    TileResidency::Residency residency(slotCount, maxLoads);
+    std::vector<char> slotMemory((size_t)slotCount * TileResidency::TILE_SIZE);
+    TileStream::Streamer streamer(residency, slotMemory);
+    for(uint32_t i = 0; i < textureCount; ++i)
+        streamer.addTexture(*cooked);
+
+    const uint64_t textureSize = header.payloadSize;
+    std::cout << path << ": " << header.width << "x" << header.height << " BC7, " << textureCount << " textures, "
+              << textureSize * textureCount / (1024 * 1024) << " MB in total, " << poolMB << " MB pool of " << slotCount
+              << " tiles, " << latency << " frames latency" << std::endl;
+
+    const uint32_t rowCount = (textureCount + QUADS_PER_ROW - 1) / QUADS_PER_ROW;
+    const float fieldWidth = QUADS_PER_ROW * QUAD_SPACING;
+    const float fieldHeight = rowCount * QUAD_SPACING;
+    const uint32_t levelCount = header.levelCount;
+
+    // Loads that are in their staging slot, waiting on the frame their copy would have finished by
+    std::deque<std::pair<uint32_t, TileResidency::Load>> copies;
+    Totals totals;
+    Totals window;
+    const uint32_t windowSize = std::max(frameCount / 6, 1u);
+    for(uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        const float time = 2.0f * std::numbers::pi_v<float> * frame / frameCount;
+        const float cameraX = fieldWidth * (0.5f + 0.4f * std::cos(time));
+        const float cameraY = fieldHeight * (0.5f + 0.4f * std::sin(2.0f * time));
+        float forwardX = -0.4f * fieldWidth * std::sin(time);
+        float forwardY = 0.8f * fieldHeight * std::cos(2.0f * time);
+        const float forwardLength = std::sqrt(forwardX * forwardX + forwardY * forwardY);
+        forwardX /= forwardLength;
+        forwardY /= forwardLength;
+
+        // The levels are looked up against the residency as it stood when the frame started, like a shader
+        // clamping to it would
+        auto start = std::chrono::high_resolution_clock::now();
+        for(uint32_t texture = 0; texture < textureCount; ++texture)
+        {
+            const float quadX = (texture % QUADS_PER_ROW) * QUAD_SPACING;
+            const float quadY = (texture / QUADS_PER_ROW) * QUAD_SPACING;
+            for(uint32_t patchY = 0; patchY < PATCHES_PER_SIDE; ++patchY)
+            {
+                for(uint32_t patchX = 0; patchX < PATCHES_PER_SIDE; ++patchX)
+                {
+                    const float u = (patchX + 0.5f) / PATCHES_PER_SIDE;
+                    const float v = (patchY + 0.5f) / PATCHES_PER_SIDE;
+                    const float toX = quadX + u - cameraX;
+                    const float toY = quadY + v - cameraY;
+                    const float groundDistance = std::sqrt(toX * toX + toY * toY);
+                    const float distance = std::sqrt(groundDistance * groundDistance + CAMERA_HEIGHT * CAMERA_HEIGHT);
+                    if(distance > VIEW_DISTANCE)
+                        continue;
+                    if(groundDistance > 1.0f && (toX * forwardX + toY * forwardY) / groundDistance < VIEW_COS)
+                        continue;
+
+                    const float texelsPerPixel = header.width * distance / PIXELS_PER_UNIT;
+                    const uint32_t level =
+                        std::min((uint32_t)std::max(std::log2(texelsPerPixel), 0.0f), levelCount - 1);
+                    const float halfPatch = 0.5f / PATCHES_PER_SIDE;
+                    residency.request(texture, level, u - halfPatch, v - halfPatch, u + halfPatch, v + halfPatch);
+
+                    const uint32_t resident = residency.getResidentLevel(texture, level, u, v);
+                    ++window.patches;
+                    window.hits += resident == level;
+                    window.fallbackLevels += resident - level;
+                }
+            }
+        }
+
+        // Evictions would be unmapped here, the streamer has already dropped them from the page table
+        TileResidency::Update update = streamer.update();
+        std::chrono::duration<double, std::milli> updateDuration = std::chrono::high_resolution_clock::now() - start;
+        window.updateMS += updateDuration.count();
+
+        start = std::chrono::high_resolution_clock::now();
+        streamer.wait();
+        std::chrono::duration<double, std::milli> readDuration = std::chrono::high_resolution_clock::now() - start;
+        window.readMS += readDuration.count();
+        for(const TileResidency::Load& load : streamer.collect())
+            copies.push_back({frame + latency, load});
+        while(!copies.empty() && copies.front().first <= frame)
+        {
+            residency.complete(copies.front().second);
+            copies.pop_front();
+        }
+
+        const TileResidency::Stats& stats = residency.stats();
+        window.loads += stats.loads;
+        window.evictions += stats.evictions;
+        window.starvedLoads += stats.starvedLoads;
+        if(!residency.validate())
+        {
+            std::cerr << "Residency is inconsistent after frame " << frame << std::endl;
+            return 1;
+        }
+
+        if((frame + 1) % windowSize == 0 || frame + 1 == frameCount)
+        {
+            std::cout << "  frames " << frame - frame % windowSize << "-" << frame << ": ";
+            print(window, frame % windowSize + 1, stats.residentTiles);
+            totals.patches += window.patches;
+            totals.hits += window.hits;
+            totals.fallbackLevels += window.fallbackLevels;
+            totals.loads += window.loads;
+            totals.evictions += window.evictions;
+            totals.starvedLoads += window.starvedLoads;
+            totals.updateMS += window.updateMS;
+            totals.readMS += window.readMS;
+            window = {};
+        }
+    }
+
+    std::cout << "total: ";
+    print(totals, frameCount, residency.stats().residentTiles);
+
+    return 0;
+}
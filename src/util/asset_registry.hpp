@@ -0,0 +1,161 @@
+#pragma once
+
+#include <util/concurrent_data.hpp>
+#include <util/file_util.hpp>
+#include <util/hash.hpp>
+#include <util/mapped_file.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+// Shares whatever gets made from a file, a decoded image or the mapping of a cooked file, between everything that
+// loads it. Entries are keyed by a hash of the file's contents, so two paths to the same bytes share one as
+// well, and live for as long as someone holds a handle to them. Loading something that's already alive
+// costs a lookup instead of a decode and a GPU allocation
+template<typename T>
+class AssetRegistry
+{
+    struct Stamp
+    {
+        uint64_t size;
+        int64_t writeTime;
+        uint64_t hash;
+    };
+
+    struct State
+    {
+        std::unordered_map<uint64_t, std::weak_ptr<const T>> assets;
+        // Contents hash of every path and seed read so far, as long as the file hasn't changed since, so a
+        // repeated load doesn't read the file again either
+        std::unordered_map<uint64_t, Stamp> stamps;
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+    };
+
+    ConcurrentData<State> state;
+
+    std::shared_ptr<const T> find(uint64_t hash)
+    {
+        std::shared_ptr<const T> asset;
+        state.modify(
+            [&](State& current)
+            {
+                auto it = current.assets.find(hash);
+                if(it == current.assets.end())
+                    return;
+
+                asset = it->second.lock();
+                if(asset)
+                    ++current.hits;
+                else
+                    current.assets.erase(it);
+            });
+        return asset;
+    }
+
+    // Two threads can race to create the same asset, the first one in keeps its copy
+    std::shared_ptr<const T> insert(uint64_t hash, std::shared_ptr<const T> created)
+    {
+        state.modify(
+            [&](State& current)
+            {
+                ++current.misses;
+                std::weak_ptr<const T>& entry = current.assets[hash];
+                if(std::shared_ptr<const T> existing = entry.lock())
+                    created = std::move(existing);
+                else
+                    entry = created;
+            });
+        return created;
+    }
+
+  public:
+    using Handle = std::shared_ptr<const T>;
+
+    struct Stats
+    {
+        uint32_t hits;
+        uint32_t misses;
+        // Entries with at least one handle left
+        uint32_t alive;
+    };
+
+    // `create()` returns a std::optional<T>, and is only called when nothing with `hash` is alive
+    template<typename F>
+    Handle getOrCreate(uint64_t hash, F&& create)
+    {
+        if(Handle asset = find(hash))
+            return asset;
+
+        std::optional<T> created = create();
+        if(!created)
+            return nullptr;
+        return insert(hash, std::make_shared<const T>(std::move(created.value())));
+    }
+
+    // Maps the file and keys it by a hash of the mapped view, so nothing is copied on the way. On a miss
+    // `create(std::move(file))` makes the asset from the MappedFile, and can keep the mapping for assets that are
+    // used in place. `seed` keeps assets made differently from the same file apart, e.g. an image decoded to a
+    // different channel count
+    template<typename F>
+    Handle load(const std::filesystem::path& path, F&& create, uint64_t seed = 0)
+    {
+        auto [size, writeTime] = FileUtil::getStamp(path);
+        const std::filesystem::path::string_type& name = path.native();
+        const uint64_t key = Hash::xxh64(name.data(), name.size() * sizeof(name[0]), seed);
+
+        std::optional<uint64_t> knownHash;
+        state.view(
+            [&](const State& current)
+            {
+                auto it = current.stamps.find(key);
+                if(it != current.stamps.end() && it->second.size == size && it->second.writeTime == writeTime)
+                    knownHash = it->second.hash;
+            });
+        if(knownHash)
+        {
+            if(Handle asset = find(knownHash.value()))
+                return asset;
+        }
+
+        std::optional<MappedFile> file = MappedFile::open(path);
+        if(!file)
+            return nullptr;
+
+        const uint64_t hash = Hash::xxh64(file->data(), file->size(), seed);
+        state.modify([&](State& current) { current.stamps[key] = {size, writeTime, hash}; });
+        return getOrCreate(hash, [&]() { return create(std::move(file.value())); });
+    }
+
+    // Handles out for the asset with `hash`, 0 if it's gone
+    uint32_t getUseCount(uint64_t hash) const
+    {
+        uint32_t count = 0;
+        state.view(
+            [&](const State& current)
+            {
+                auto it = current.assets.find(hash);
+                if(it != current.assets.end())
+                    count = (uint32_t)it->second.use_count();
+            });
+        return count;
+    }
+
+    Stats stats() const
+    {
+        Stats result = {};
+        state.view(
+            [&](const State& current)
+            {
+                result.hits = current.hits;
+                result.misses = current.misses;
+                for(const auto& [hash, asset] : current.assets)
+                    result.alive += !asset.expired();
+            });
+        return result;
+    }
+};
@@ -0,0 +1,363 @@
+#include "blit.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#define BLIT_SIMD
+#endif
+
+// MSVC takes the intrinsics anywhere, GCC and Clang only in functions built for the instruction set
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_SSSE3
+#define TARGET_AVX2
+#else
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace Blit
+{
+namespace
+{
+    // Byte offset of red, green, blue and alpha within a pixel, -1 for the ones the format doesn't have
+    constexpr int8_t CHANNEL_OFFSETS[][4] = {
+        {0, -1, -1, -1}, // R8
+        {0, 1, -1, -1},  // RG8
+        {0, 1, 2, -1},   // RGB8
+        {0, 1, 2, 3},    // RGBA8
+        {2, 1, 0, 3},    // BGRA8
+    };
+
+    enum class Kind
+    {
+        COPY,
+        // RGB8 to RGBA8 or BGRA8
+        EXPAND,
+        // RGBA8 to BGRA8 and back
+        SWIZZLE,
+        // RGBA8 or BGRA8 to R8
+        EXTRACT,
+        // Everything else, a pixel at a time
+        GENERIC,
+    };
+
+    Kind getKind(Format source, Format destination)
+    {
+        const bool fourChannels = source == Format::RGBA8 || source == Format::BGRA8;
+        if(source == destination)
+            return Kind::COPY;
+        if(source == Format::RGB8 && (destination == Format::RGBA8 || destination == Format::BGRA8))
+            return Kind::EXPAND;
+        if(fourChannels && (destination == Format::RGBA8 || destination == Format::BGRA8))
+            return Kind::SWIZZLE;
+        if(fourChannels && destination == Format::R8)
+            return Kind::EXTRACT;
+        return Kind::GENERIC;
+    }
+
+    void convertPixels(const uint8_t* source, Format sourceFormat, uint8_t* destination, Format destinationFormat,
+                       uint32_t count)
+    {
+        const int8_t* sourceOffsets = CHANNEL_OFFSETS[(int)sourceFormat];
+        const int8_t* destinationOffsets = CHANNEL_OFFSETS[(int)destinationFormat];
+        const uint32_t sourceSize = getPixelSize(sourceFormat);
+        const uint32_t destinationSize = getPixelSize(destinationFormat);
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            uint8_t rgba[4] = {0, 0, 0, 255};
+            for(uint32_t c = 0; c < 4; ++c)
+            {
+                if(sourceOffsets[c] >= 0)
+                    rgba[c] = source[i * sourceSize + sourceOffsets[c]];
+            }
+            for(uint32_t c = 0; c < 4; ++c)
+            {
+                if(destinationOffsets[c] >= 0)
+                    destination[i * destinationSize + destinationOffsets[c]] = rgba[c];
+            }
+        }
+    }
+
+    using Table = std::array<uint8_t, 256>;
+
+    const Table& getTable(Transfer transfer)
+    {
+        static const Table toLinear = []()
+        {
+            Table table;
+            for(uint32_t i = 0; i < 256; ++i)
+            {
+                float value = i / 255.0f;
+                value = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+                table[i] = (uint8_t)std::lround(value * 255.0f);
+            }
+            return table;
+        }();
+        static const Table toSrgb = []()
+        {
+            Table table;
+            for(uint32_t i = 0; i < 256; ++i)
+            {
+                float value = i / 255.0f;
+                value = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+                table[i] = (uint8_t)std::lround(value * 255.0f);
+            }
+            return table;
+        }();
+        return transfer == Transfer::SRGB_TO_LINEAR ? toLinear : toSrgb;
+    }
+
+    // In place over a converted row, which is still in L1 by then. A table lookup per byte is already as fast
+    // as this goes, gathers don't beat it
+    void applyTransfer(uint8_t* row, Format format, uint32_t width, const Table& table)
+    {
+        if(format == Format::RGBA8 || format == Format::BGRA8)
+        {
+            for(uint32_t x = 0; x < width; ++x)
+            {
+                row[x * 4 + 0] = table[row[x * 4 + 0]];
+                row[x * 4 + 1] = table[row[x * 4 + 1]];
+                row[x * 4 + 2] = table[row[x * 4 + 2]];
+            }
+            return;
+        }
+
+        const uint32_t size = width * getPixelSize(format);
+        for(uint32_t i = 0; i < size; ++i)
+            row[i] = table[row[i]];
+    }
+
+#ifdef BLIT_SIMD
+    Isa detectIsa()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+        __cpuid(info, 1);
+        const bool ssse3 = (info[2] & (1 << 9)) != 0;
+        // AVX state has to be enabled by the OS as well
+        const bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        bool avx2 = false;
+        if(maxLeaf >= 7 && osAvx)
+        {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+#else
+        __builtin_cpu_init();
+        const bool ssse3 = __builtin_cpu_supports("ssse3");
+        const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        if(avx2)
+            return Isa::AVX2;
+        return ssse3 ? Isa::SSSE3 : Isa::SCALAR;
+    }
+
+    // Each of these does as many whole vectors as the row has without reading past its end, and returns how
+    // many pixels that was
+
+    TARGET_SSSE3 uint32_t expandSsse3(const uint8_t* source, uint8_t* destination, uint32_t width, bool bgra)
+    {
+        const __m128i shuffle = bgra ? _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+                                     : _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+        uint32_t x = 0;
+        // 4 pixels per 16 byte load, of which the last 4 bytes are unused
+        for(; x + 6 <= width; x += 4)
+        {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(source + x * 3));
+            pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha);
+            _mm_storeu_si128((__m128i*)(destination + x * 4), pixels);
+        }
+        return x;
+    }
+
+    TARGET_SSSE3 uint32_t swizzleSsse3(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        uint32_t x = 0;
+        for(; x + 4 <= width; x += 4)
+        {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(source + x * 4));
+            _mm_storeu_si128((__m128i*)(destination + x * 4), _mm_shuffle_epi8(pixels, shuffle));
+        }
+        return x;
+    }
+
+    TARGET_SSSE3 uint32_t extractSsse3(const uint8_t* source, uint8_t* destination, uint32_t width, int8_t offset)
+    {
+        const __m128i shuffle =
+            _mm_setr_epi8(offset, offset + 4, offset + 8, offset + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        uint32_t x = 0;
+        for(; x + 16 <= width; x += 16)
+        {
+            const __m128i* pixels = (const __m128i*)(source + x * 4);
+            __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(pixels + 0), shuffle);
+            __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(pixels + 1), shuffle);
+            __m128i c = _mm_shuffle_epi8(_mm_loadu_si128(pixels + 2), shuffle);
+            __m128i d = _mm_shuffle_epi8(_mm_loadu_si128(pixels + 3), shuffle);
+            __m128i result = _mm_unpacklo_epi64(_mm_unpacklo_epi32(a, b), _mm_unpacklo_epi32(c, d));
+            _mm_storeu_si128((__m128i*)(destination + x), result);
+        }
+        return x;
+    }
+
+    TARGET_AVX2 uint32_t expandAvx2(const uint8_t* source, uint8_t* destination, uint32_t width, bool bgra)
+    {
+        const __m256i shuffle = bgra ? _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                                                        2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+                                     : _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+        uint32_t x = 0;
+        // 4 pixels per lane, the second lane loaded 12 bytes after the first
+        for(; x + 10 <= width; x += 8)
+        {
+            __m128i low = _mm_loadu_si128((const __m128i*)(source + x * 3));
+            __m128i high = _mm_loadu_si128((const __m128i*)(source + x * 3 + 12));
+            __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+            pixels = _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alpha);
+            _mm256_storeu_si256((__m256i*)(destination + x * 4), pixels);
+        }
+        return x;
+    }
+
+    TARGET_AVX2 uint32_t swizzleAvx2(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                                 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        uint32_t x = 0;
+        for(; x + 8 <= width; x += 8)
+        {
+            __m256i pixels = _mm256_loadu_si256((const __m256i*)(source + x * 4));
+            _mm256_storeu_si256((__m256i*)(destination + x * 4), _mm256_shuffle_epi8(pixels, shuffle));
+        }
+        return x;
+    }
+
+    TARGET_AVX2 uint32_t extractAvx2(const uint8_t* source, uint8_t* destination, uint32_t width, int8_t offset)
+    {
+        const __m128i laneShuffle =
+            _mm_setr_epi8(offset, offset + 4, offset + 8, offset + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m256i shuffle = _mm256_broadcastsi128_si256(laneShuffle);
+        // The unpacks leave the lanes interleaved, 4 pixels at a time
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        uint32_t x = 0;
+        for(; x + 32 <= width; x += 32)
+        {
+            const __m256i* pixels = (const __m256i*)(source + x * 4);
+            __m256i a = _mm256_shuffle_epi8(_mm256_loadu_si256(pixels + 0), shuffle);
+            __m256i b = _mm256_shuffle_epi8(_mm256_loadu_si256(pixels + 1), shuffle);
+            __m256i c = _mm256_shuffle_epi8(_mm256_loadu_si256(pixels + 2), shuffle);
+            __m256i d = _mm256_shuffle_epi8(_mm256_loadu_si256(pixels + 3), shuffle);
+            __m256i result = _mm256_unpacklo_epi64(_mm256_unpacklo_epi32(a, b), _mm256_unpacklo_epi32(c, d));
+            _mm256_storeu_si256((__m256i*)(destination + x), _mm256_permutevar8x32_epi32(result, order));
+        }
+        return x;
+    }
+#endif
+
+    // Pixels of the row done with vectors, the caller finishes the rest one at a time
+    uint32_t convertRowSimd(const uint8_t* source, Format sourceFormat, uint8_t* destination,
+                            Format destinationFormat, uint32_t width, Kind kind, Isa isa)
+    {
+#ifdef BLIT_SIMD
+        const bool bgra = destinationFormat == Format::BGRA8;
+        const int8_t offset = CHANNEL_OFFSETS[(int)sourceFormat][0];
+        if(isa == Isa::AVX2)
+        {
+            switch(kind)
+            {
+            case Kind::EXPAND: return expandAvx2(source, destination, width, bgra);
+            case Kind::SWIZZLE: return swizzleAvx2(source, destination, width);
+            case Kind::EXTRACT: return extractAvx2(source, destination, width, offset);
+            default: return 0;
+            }
+        }
+        if(isa == Isa::SSSE3)
+        {
+            switch(kind)
+            {
+            case Kind::EXPAND: return expandSsse3(source, destination, width, bgra);
+            case Kind::SWIZZLE: return swizzleSsse3(source, destination, width);
+            case Kind::EXTRACT: return extractSsse3(source, destination, width, offset);
+            default: return 0;
+            }
+        }
+#endif
+        return 0;
+    }
+}
+
+uint32_t getPixelSize(Format format)
+{
+    switch(format)
+    {
+    case Format::R8: return 1;
+    case Format::RG8: return 2;
+    case Format::RGB8: return 3;
+    case Format::RGBA8: return 4;
+    case Format::BGRA8: return 4;
+    }
+    return 0;
+}
+
+Isa getIsa()
+{
+#ifdef BLIT_SIMD
+    static const Isa isa = detectIsa();
+    return isa;
+#else
+    return Isa::SCALAR;
+#endif
+}
+
+void blit(
+    const Image& source,
+    const MutableImage& destination,
+    uint32_t width,
+    uint32_t height,
+    Transfer transfer,
+    Isa isa)
+{
+    const uint32_t sourceSize = getPixelSize(source.format);
+    const uint32_t destinationSize = getPixelSize(destination.format);
+    assert(source.rowPitch >= width * sourceSize && destination.rowPitch >= width * destinationSize);
+
+    isa = std::min(isa, getIsa());
+    const Kind kind = getKind(source.format, destination.format);
+    const Table* table = transfer == Transfer::NONE ? nullptr : &getTable(transfer);
+    for(uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* sourceRow = (const uint8_t*)source.data + (size_t)y * source.rowPitch;
+        uint8_t* destinationRow = (uint8_t*)destination.data + (size_t)y * destination.rowPitch;
+        if(kind == Kind::COPY)
+        {
+            std::memcpy(destinationRow, sourceRow, width * sourceSize);
+        }
+        else
+        {
+            const uint32_t done =
+                convertRowSimd(sourceRow, source.format, destinationRow, destination.format, width, kind, isa);
+            convertPixels(
+                sourceRow + done * sourceSize,
+                source.format,
+                destinationRow + done * destinationSize,
+                destination.format,
+                width - done);
+        }
+
+        if(table)
+            applyTransfer(destinationRow, destination.format, width, *table);
+    }
+}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+// Copies 8 bit images between buffers with different row pitches, converting the pixel format and transfer
+// function on the way. This is what goes between a tightly packed decoded image and an upload buffer row
+// pitched for CopyTextureRegion. The common conversions have SSSE3 and AVX2 paths picked at runtime, the rest
+// go through a per pixel path
+namespace Blit
+{
+enum class Format
+{
+    R8,
+    RG8,
+    RGB8,
+    RGBA8,
+    BGRA8,
+};
+
+enum class Transfer
+{
+    NONE,
+    // Color channels only, alpha always stays as it is
+    SRGB_TO_LINEAR,
+    LINEAR_TO_SRGB,
+};
+
+enum class Isa
+{
+    SCALAR,
+    SSSE3,
+    AVX2,
+};
+
+struct Image
+{
+    const void* data;
+    uint32_t rowPitch;
+    Format format;
+};
+
+struct MutableImage
+{
+    void* data;
+    uint32_t rowPitch;
+    Format format;
+};
+
+uint32_t getPixelSize(Format format);
+
+// The best one the CPU supports, checked once
+Isa getIsa();
+
+// Channels missing from the source are 0, alpha 255. Going to fewer channels keeps the first ones, so RGBA8 and
+// BGRA8 to R8 both keep red. `isa` is only there to compare paths, anything above getIsa() is clamped to it
+void blit(
+    const Image& source,
+    const MutableImage& destination,
+    uint32_t width,
+    uint32_t height,
+    Transfer transfer = Transfer::NONE,
+    Isa isa = getIsa());
+}
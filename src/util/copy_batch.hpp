@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// The device independent half of batching the copies of a load, see graphics/dx12/copy_batcher.hpp. Resource is
+// whatever identifies a resource, an ID3D12Resource* there, State whatever a barrier transitions it to
+namespace CopyBatch
+{
+template<typename Resource>
+struct BufferCopy
+{
+    Resource destination;
+    uint64_t destinationOffset;
+    Resource source;
+    uint64_t sourceOffset;
+    uint64_t size;
+};
+
+template<typename Resource, typename State>
+struct Transition
+{
+    Resource resource;
+    State after;
+};
+
+// Sorts by destination and merges every copy that continues where the one before it ended, in the destination and
+// the source. Copies in one batch run without barriers between them, so their order doesn't matter as long as no
+// two of them write the same bytes, which isn't allowed
+template<typename Resource>
+void coalesce(std::vector<BufferCopy<Resource>>& copies)
+{
+    const std::less<Resource> less;
+    std::sort(
+        copies.begin(),
+        copies.end(),
+        [&](const BufferCopy<Resource>& a, const BufferCopy<Resource>& b)
+        {
+            if(a.destination != b.destination)
+                return less(a.destination, b.destination);
+            return a.destinationOffset < b.destinationOffset;
+        });
+
+    size_t last = 0;
+    for(size_t i = 1; i < copies.size(); ++i)
+    {
+        BufferCopy<Resource>& previous = copies[last];
+        const BufferCopy<Resource>& copy = copies[i];
+        const bool sameDestination = copy.destination == previous.destination;
+        assert(!sameDestination || copy.destinationOffset >= previous.destinationOffset + previous.size);
+        if(sameDestination && copy.source == previous.source
+           && copy.destinationOffset == previous.destinationOffset + previous.size
+           && copy.sourceOffset == previous.sourceOffset + previous.size)
+            previous.size += copy.size;
+        else
+            copies[++last] = copy;
+    }
+    if(!copies.empty())
+        copies.resize(last + 1);
+}
+
+// Keeps one transition per resource, where it was first asked for, with the last state it was asked to go to
+template<typename Resource, typename State>
+void dedupe(std::vector<Transition<Resource, State>>& transitions)
+{
+    std::unordered_map<Resource, size_t> indices;
+    size_t count = 0;
+    for(const Transition<Resource, State>& transition : transitions)
+    {
+        auto [found, inserted] = indices.try_emplace(transition.resource, count);
+        if(inserted)
+            transitions[count++] = transition;
+        else
+            transitions[found->second].after = transition.after;
+    }
+    transitions.resize(count);
+}
+}
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <fstream>
 #include <limits>
+#include <system_error>
 
 namespace FileUtil
 {
@@ -22,4 +23,42 @@ std::optional<std::vector<char>> readFile(const std::filesystem::path& path)
 
     return outData;
 }
+
+bool replaceFile(const std::filesystem::path& path, std::span<const char> data)
+{
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if(!out.is_open())
+        return false;
+
+    out.write(data.data(), (std::streamsize)data.size());
+    out.close();
+
+    std::error_code error;
+    if(out.good())
+    {
+        std::filesystem::rename(tempPath, path, error);
+        if(!error)
+            return true;
+    }
+
+    std::filesystem::remove(tempPath, error);
+    return false;
+}
+
+std::pair<uint64_t, int64_t> getStamp(const std::filesystem::path& path)
+{
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(path, error);
+    if(error)
+        return {0, 0};
+
+    auto writeTime = std::filesystem::last_write_time(path, error);
+    if(error)
+        return {0, 0};
+
+    return {size, (int64_t)writeTime.time_since_epoch().count()};
+}
 }
@@ -1,10 +1,21 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <optional>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace FileUtil
 {
 std::optional<std::vector<char>> readFile(const std::filesystem::path& path);
+
+// Writes `<path>.tmp` and renames it over `path`, so anything that still has the old file mapped keeps its
+// inode and bytes on POSIX. Windows refuses the rename while the old file is mapped, which fails this
+bool replaceFile(const std::filesystem::path& path, std::span<const char> data);
+
+// Size and last write time, what the caches store to tell when their source has changed. Both are 0 if
+// the file can't be found
+std::pair<uint64_t, int64_t> getStamp(const std::filesystem::path& path);
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "hash.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace Hash
+{
+namespace
+{
+    constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ull;
+    constexpr uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ull;
+    constexpr uint64_t PRIME_5 = 0x27D4EB2F165667C5ull;
+
+    // Little endian reads, which is every platform the demos run on
+    uint64_t read64(const unsigned char* data)
+    {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint32_t read32(const unsigned char* data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint64_t round(uint64_t accumulator, uint64_t input)
+    {
+        accumulator += input * PRIME_2;
+        accumulator = std::rotl(accumulator, 31);
+        return accumulator * PRIME_1;
+    }
+
+    uint64_t mergeRound(uint64_t accumulator, uint64_t value)
+    {
+        accumulator ^= round(0, value);
+        return accumulator * PRIME_1 + PRIME_4;
+    }
+}
+
+uint64_t xxh64(const void* data, size_t size, uint64_t seed)
+{
+    const unsigned char* input = (const unsigned char*)data;
+    const unsigned char* end = input + size;
+
+    uint64_t hash;
+    if(size >= 32)
+    {
+        // Four independent lanes over 32 byte stripes
+        uint64_t lanes[4] = {seed + PRIME_1 + PRIME_2, seed + PRIME_2, seed, seed - PRIME_1};
+        for(; end - input >= 32; input += 32)
+        {
+            for(uint32_t i = 0; i < 4; ++i)
+                lanes[i] = round(lanes[i], read64(input + i * 8));
+        }
+
+        hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        for(uint64_t lane : lanes)
+            hash = mergeRound(hash, lane);
+    }
+    else
+    {
+        hash = seed + PRIME_5;
+    }
+    hash += size;
+
+    for(; end - input >= 8; input += 8)
+        hash = std::rotl(hash ^ round(0, read64(input)), 27) * PRIME_1 + PRIME_4;
+    if(end - input >= 4)
+    {
+        hash = std::rotl(hash ^ (read32(input) * PRIME_1), 23) * PRIME_2 + PRIME_3;
+        input += 4;
+    }
+    for(; input < end; ++input)
+        hash = std::rotl(hash ^ (*input * PRIME_5), 11) * PRIME_1;
+
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Hash
+{
+// XXH64, fast enough to hash whole files on load (several GB/s) and with a low enough collision rate to key
+// assets by their contents
+uint64_t xxh64(const void* data, size_t size, uint64_t seed = 0);
+
+inline uint64_t xxh64(std::span<const char> data, uint64_t seed = 0)
+{
+    return xxh64(data.data(), data.size(), seed);
+}
+}
@@ -0,0 +1,126 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+std::optional<MappedFile> MappedFile::open(const std::filesystem::path& path)
+{
+    MappedFile file;
+
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if(fileHandle == INVALID_HANDLE_VALUE)
+        return std::nullopt;
+    file.fileHandle = fileHandle;
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(fileHandle, &fileSize))
+        return std::nullopt;
+    file.mappingSize = (size_t)fileSize.QuadPart;
+
+    // Zero-sized files can't be mapped, but they are still valid files
+    if(file.mappingSize == 0)
+        return file;
+
+    file.mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!file.mappingHandle)
+        return std::nullopt;
+
+    file.mapping = (const char*)MapViewOfFile(file.mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if(!file.mapping)
+        return std::nullopt;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd == -1)
+        return std::nullopt;
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) == -1)
+    {
+        close(fd);
+        return std::nullopt;
+    }
+    file.mappingSize = (size_t)fileStat.st_size;
+
+    if(file.mappingSize == 0)
+    {
+        close(fd);
+        return file;
+    }
+
+    void* mapping = mmap(nullptr, file.mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if(mapping == MAP_FAILED)
+        return std::nullopt;
+
+    file.mapping = (const char*)mapping;
+#endif
+
+    return file;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mapping(std::exchange(other.mapping, nullptr))
+    , mappingSize(std::exchange(other.mappingSize, 0))
+#ifdef _WIN32
+    , fileHandle(std::exchange(other.fileHandle, nullptr))
+    , mappingHandle(std::exchange(other.mappingHandle, nullptr))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if(this != &other)
+    {
+        release();
+        mapping = std::exchange(other.mapping, nullptr);
+        mappingSize = std::exchange(other.mappingSize, 0);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+void MappedFile::release()
+{
+#ifdef _WIN32
+    if(mapping)
+        UnmapViewOfFile(mapping);
+    if(mappingHandle)
+        CloseHandle(mappingHandle);
+    if(fileHandle)
+        CloseHandle(fileHandle);
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    if(mapping)
+        munmap((void*)mapping, mappingSize);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+
+// Read-only view of a whole file. Pages are faulted in on first access, so
+// opening is cheap and the data is only copied once it's actually read
+class MappedFile
+{
+    const char* mapping = nullptr;
+    size_t mappingSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+    MappedFile() = default;
+    void release();
+
+  public:
+    static std::optional<MappedFile> open(const std::filesystem::path& path);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    const char* data() const
+    {
+        return mapping;
+    }
+
+    size_t size() const
+    {
+        return mappingSize;
+    }
+};
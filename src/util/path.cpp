@@ -22,11 +22,26 @@ std::filesystem::path getShaderPath(const std::filesystem::path& name)
     return getShaderPath() / name;
 }
 
-std::filesystem::path getRandomCat()
+std::filesystem::path getCachePath()
+{
+    return std::filesystem::path(ROOT_DIR_CACHE);
+}
+
+std::filesystem::path getCachePath(const std::filesystem::path& name)
+{
+    return getCachePath() / name;
+}
+
+std::filesystem::path getCat(uint32_t index)
 {
     char path[] = "catX.jpg";
-    path[3] = '0' + (char)(rand() % 4);
+    path[3] = '0' + (char)(index % CAT_COUNT);
 
     return getAssetPath(path);
 }
+
+std::filesystem::path getRandomCat()
+{
+    return getCat((uint32_t)rand());
+}
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 
 namespace Path
@@ -10,5 +11,11 @@ std::filesystem::path getAssetPath(const std::filesystem::path& name);
 std::filesystem::path getShaderPath();
 std::filesystem::path getShaderPath(const std::filesystem::path& name);
 
+std::filesystem::path getCachePath();
+std::filesystem::path getCachePath(const std::filesystem::path& name);
+
+constexpr uint32_t CAT_COUNT = 4;
+
+std::filesystem::path getCat(uint32_t index);
 std::filesystem::path getRandomCat();
 }
@@ -1,5 +1,2 @@
 #define STB_IMAGE_IMPLEMENTATION
-#ifdef _WIN32
-    #define STBI_WINDOWS_UTF8
-#endif
-#include <stb_image.h>
\ No newline at end of file
+#include "stbi.hpp"
\ No newline at end of file
@@ -1,4 +1,3 @@
-#ifdef _WIN32
-    #define STBI_WINDOWS_UTF8
-#endif
+// Images are only ever decoded from memory, see TextureLoad::load
+#define STBI_NO_STDIO
 #include <stb_image.h>
@@ -0,0 +1,60 @@
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(uint32_t workerCount)
+{
+    workers.reserve(workerCount);
+    for(uint32_t i = 0; i < workerCount; ++i)
+        workers.emplace_back([this]() { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for(std::thread& worker : workers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return pool;
+}
+
+void ThreadPool::push(std::function<void()> task)
+{
+    if(workers.empty())
+    {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    condition.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    while(true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            // Finish what's queued before stopping, somebody might be waiting on it
+            if(tasks.empty())
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads for the CPU side asset work. parallelFor is the main entry point,
+// submit is there for independent tasks that should run next to each other
+class ThreadPool
+{
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+
+    void workerLoop();
+    void push(std::function<void()> task);
+
+  public:
+    explicit ThreadPool(uint32_t workerCount);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    // One worker per hardware thread except the calling one, which takes part in parallelFor
+    static ThreadPool& shared();
+
+    uint32_t workerCount() const
+    {
+        return (uint32_t)workers.size();
+    }
+
+    // Runs `func` right away on the calling thread if the pool has no workers
+    template<typename F>
+    std::future<std::invoke_result_t<F>> submit(F func)
+    {
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::move(func));
+        std::future<std::invoke_result_t<F>> future = task->get_future();
+        push([task]() { (*task)(); });
+        return future;
+    }
+
+    // Calls func(begin, end) over [0, count) in chunks of `grain` elements. The chunk boundaries only
+    // depend on `grain`, so per chunk results are the same no matter how many threads there are.
+    // The calling thread works through the chunks as well and never waits on a queued task, which
+    // makes this safe to call from inside a submitted task
+    template<typename F>
+    void parallelFor(uint32_t count, uint32_t grain, F&& func)
+    {
+        uint32_t chunkCount = (count + grain - 1) / grain;
+        if(chunkCount <= 1 || workers.empty())
+        {
+            for(uint32_t begin = 0; begin < count; begin += grain)
+                func(begin, std::min(begin + grain, count));
+            return;
+        }
+
+        struct Progress
+        {
+            std::atomic<uint32_t> next = 0;
+            std::atomic<uint32_t> done = 0;
+        };
+        auto progress = std::make_shared<Progress>();
+
+        // Helpers that only start after every chunk has been claimed return without touching func,
+        // which is gone by then
+        auto work = [progress, count, grain, chunkCount, &func]()
+        {
+            for(uint32_t chunk = progress->next++; chunk < chunkCount; chunk = progress->next++)
+            {
+                uint32_t begin = chunk * grain;
+                func(begin, std::min(begin + grain, count));
+                if(++progress->done == chunkCount)
+                    progress->done.notify_all();
+            }
+        };
+
+        uint32_t helperCount = std::min(workerCount(), chunkCount - 1);
+        for(uint32_t i = 0; i < helperCount; ++i)
+            push(work);
+        work();
+
+        for(uint32_t done = progress->done; done != chunkCount; done = progress->done)
+            progress->done.wait(done);
+    }
+};
@@ -0,0 +1,370 @@
+#include "tlsf_allocator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace
+{
+uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    assert(std::popcount(alignment) == 1);
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+}
+
+TlsfAllocator::TlsfAllocator()
+{
+    for(std::array<uint32_t, SECOND_LEVEL_COUNT>& lists : freeLists)
+        lists.fill(NONE);
+}
+
+std::pair<uint32_t, uint32_t> TlsfAllocator::getLevels(uint64_t size)
+{
+    // Sizes below SECOND_LEVEL_COUNT would all land in the first level's linear steps, they can't happen with
+    // GRANULARITY above it
+    static_assert(GRANULARITY >= SECOND_LEVEL_COUNT);
+    const uint32_t firstLevel = 63 - std::countl_zero(size);
+    const uint32_t secondLevel = (uint32_t)(size >> (firstLevel - SECOND_LEVEL_BITS)) ^ SECOND_LEVEL_COUNT;
+    return {firstLevel, secondLevel};
+}
+
+uint32_t TlsfAllocator::createBlock(const Block& block)
+{
+    if(unusedBlocks.empty())
+    {
+        blocks.push_back(block);
+        return (uint32_t)blocks.size() - 1;
+    }
+
+    const uint32_t index = unusedBlocks.back();
+    unusedBlocks.pop_back();
+    blocks[index] = block;
+    return index;
+}
+
+void TlsfAllocator::destroyBlock(uint32_t index)
+{
+    blocks[index].unused = true;
+    unusedBlocks.push_back(index);
+}
+
+void TlsfAllocator::insertFree(uint32_t index)
+{
+    auto [firstLevel, secondLevel] = getLevels(blocks[index].size);
+    uint32_t& head = freeLists[firstLevel][secondLevel];
+
+    Block& block = blocks[index];
+    block.free = true;
+    block.previousFree = NONE;
+    block.nextFree = head;
+    if(head != NONE)
+        blocks[head].previousFree = index;
+    head = index;
+
+    firstLevelBitmap |= 1ull << firstLevel;
+    secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+void TlsfAllocator::removeFree(uint32_t index)
+{
+    Block& block = blocks[index];
+    auto [firstLevel, secondLevel] = getLevels(block.size);
+
+    if(block.previousFree != NONE)
+        blocks[block.previousFree].nextFree = block.nextFree;
+    else
+        freeLists[firstLevel][secondLevel] = block.nextFree;
+    if(block.nextFree != NONE)
+        blocks[block.nextFree].previousFree = block.previousFree;
+    block.free = false;
+
+    if(freeLists[firstLevel][secondLevel] == NONE)
+    {
+        secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+        if(secondLevelBitmaps[firstLevel] == 0)
+            firstLevelBitmap &= ~(1ull << firstLevel);
+    }
+}
+
+uint32_t TlsfAllocator::findFree(uint64_t size) const
+{
+    // Rounds up to the next size class, so every block in the list that's found is large enough and the head
+    // can be taken without looking further
+    const uint32_t sizeLevel = 63 - std::countl_zero(size);
+    const uint64_t rounded = size + (1ull << (sizeLevel - SECOND_LEVEL_BITS)) - 1;
+    if(rounded < size)
+        return NONE;
+    auto [firstLevel, secondLevel] = getLevels(rounded);
+
+    uint32_t secondLevelMap = secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if(secondLevelMap == 0)
+    {
+        const uint64_t firstLevelMap =
+            firstLevel + 1 < FIRST_LEVEL_COUNT ? firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+        if(firstLevelMap == 0)
+            return NONE;
+
+        firstLevel = std::countr_zero(firstLevelMap);
+        secondLevelMap = secondLevelBitmaps[firstLevel];
+    }
+    return freeLists[firstLevel][std::countr_zero(secondLevelMap)];
+}
+
+uint32_t TlsfAllocator::splitFront(uint32_t index, uint64_t size)
+{
+    const Block& block = blocks[index];
+    assert(size < block.size);
+    const uint32_t front = createBlock({
+        .offset = block.offset,
+        .size = size,
+        .pool = block.pool,
+        .previousPhysical = block.previousPhysical,
+        .nextPhysical = index,
+        .previousFree = NONE,
+        .nextFree = NONE,
+        .free = false,
+        .unused = false,
+    });
+
+    // createBlock() can grow `blocks`
+    Block& rest = blocks[index];
+    if(rest.previousPhysical != NONE)
+        blocks[rest.previousPhysical].nextPhysical = front;
+    rest.previousPhysical = front;
+    rest.offset += size;
+    rest.size -= size;
+    return front;
+}
+
+void TlsfAllocator::splitBack(uint32_t index, uint64_t size)
+{
+    const Block& block = blocks[index];
+    if(block.size - size < GRANULARITY)
+        return;
+
+    const uint32_t back = createBlock({
+        .offset = block.offset + size,
+        .size = block.size - size,
+        .pool = block.pool,
+        .previousPhysical = index,
+        .nextPhysical = block.nextPhysical,
+        .previousFree = NONE,
+        .nextFree = NONE,
+        .free = false,
+        .unused = false,
+    });
+
+    Block& front = blocks[index];
+    if(front.nextPhysical != NONE)
+        blocks[front.nextPhysical].previousPhysical = back;
+    front.nextPhysical = back;
+    front.size = size;
+    insertFree(back);
+}
+
+uint32_t TlsfAllocator::mergeIntoPrevious(uint32_t index)
+{
+    const Block& block = blocks[index];
+    const uint32_t previous = block.previousPhysical;
+    assert(previous != NONE && blocks[previous].pool == block.pool);
+
+    blocks[previous].size += block.size;
+    blocks[previous].nextPhysical = block.nextPhysical;
+    if(block.nextPhysical != NONE)
+        blocks[block.nextPhysical].previousPhysical = previous;
+    destroyBlock(index);
+    return previous;
+}
+
+uint32_t TlsfAllocator::addPool(uint64_t size)
+{
+    size = size / GRANULARITY * GRANULARITY;
+    assert(size > 0);
+
+    const uint32_t pool = (uint32_t)pools.size();
+    pools.push_back({size, 0});
+    const uint32_t index = createBlock({
+        .offset = 0,
+        .size = size,
+        .pool = pool,
+        .previousPhysical = NONE,
+        .nextPhysical = NONE,
+        .previousFree = NONE,
+        .nextFree = NONE,
+        .free = false,
+        .unused = false,
+    });
+    insertFree(index);
+    return pool;
+}
+
+std::optional<TlsfAllocator::Allocation> TlsfAllocator::allocate(uint64_t size, uint64_t alignment)
+{
+    size = alignUp(std::max<uint64_t>(size, 1), GRANULARITY);
+    alignment = std::max(alignment, GRANULARITY);
+
+    // The first block that's large enough usually is aligned enough as well, since D3D12 sizes are multiples of
+    // their alignment. If it isn't, look for one that fits the worst case padding
+    uint32_t index = findFree(size);
+    if(index != NONE)
+    {
+        const Block& block = blocks[index];
+        if(alignUp(block.offset, alignment) + size > block.offset + block.size)
+            index = NONE;
+    }
+    if(index == NONE && alignment > GRANULARITY)
+        index = findFree(size + alignment - GRANULARITY);
+    if(index == NONE)
+        return std::nullopt;
+
+    removeFree(index);
+    const uint64_t padding = alignUp(blocks[index].offset, alignment) - blocks[index].offset;
+    if(padding > 0)
+    {
+        // The block before a free block is never free, so the padding doesn't have to be merged with anything
+        insertFree(splitFront(index, padding));
+    }
+    splitBack(index, size);
+
+    const Block& block = blocks[index];
+    ++allocationCount;
+    ++pools[block.pool].allocationCount;
+    allocatedSize += block.size;
+    return Allocation{block.pool, block.offset, block.size, index};
+}
+
+void TlsfAllocator::free(const Allocation& allocation)
+{
+    uint32_t index = allocation.block;
+    assert(index < blocks.size() && !blocks[index].unused && !blocks[index].free);
+    assert(blocks[index].offset == allocation.offset && blocks[index].pool == allocation.pool);
+
+    --allocationCount;
+    --pools[blocks[index].pool].allocationCount;
+    allocatedSize -= blocks[index].size;
+
+    const uint32_t next = blocks[index].nextPhysical;
+    if(next != NONE && blocks[next].free)
+    {
+        removeFree(next);
+        mergeIntoPrevious(next);
+    }
+    const uint32_t previous = blocks[index].previousPhysical;
+    if(previous != NONE && blocks[previous].free)
+    {
+        removeFree(previous);
+        index = mergeIntoPrevious(index);
+    }
+    insertFree(index);
+}
+
+bool TlsfAllocator::isPoolEmpty(uint32_t pool) const
+{
+    return pools[pool].allocationCount == 0;
+}
+
+TlsfAllocator::Stats TlsfAllocator::stats() const
+{
+    Stats result = {};
+    result.poolCount = (uint32_t)pools.size();
+    result.allocationCount = allocationCount;
+    result.allocatedSize = allocatedSize;
+    for(const Pool& pool : pools)
+        result.poolSize += pool.size;
+    for(const Block& block : blocks)
+    {
+        if(block.unused || !block.free)
+            continue;
+        ++result.freeBlockCount;
+        result.largestFreeBlock = std::max(result.largestFreeBlock, block.size);
+    }
+    return result;
+}
+
+bool TlsfAllocator::validate() const
+{
+    // Every pool is tiled by its blocks, starting at 0, without two free ones in a row
+    std::vector<uint32_t> poolStarts(pools.size(), NONE);
+    uint32_t usedBlockCount = 0;
+    for(uint32_t i = 0; i < blocks.size(); ++i)
+    {
+        const Block& block = blocks[i];
+        if(block.unused)
+            continue;
+        ++usedBlockCount;
+        if(block.pool >= pools.size() || block.size == 0 || block.size % GRANULARITY != 0)
+            return false;
+        if(block.previousPhysical == NONE)
+        {
+            if(poolStarts[block.pool] != NONE)
+                return false;
+            poolStarts[block.pool] = i;
+        }
+    }
+
+    uint32_t walkedBlockCount = 0;
+    uint32_t freeBlockCount = 0;
+    uint32_t walkedAllocationCount = 0;
+    uint64_t walkedAllocatedSize = 0;
+    for(uint32_t pool = 0; pool < pools.size(); ++pool)
+    {
+        uint64_t offset = 0;
+        uint32_t poolAllocationCount = 0;
+        uint32_t previous = NONE;
+        for(uint32_t index = poolStarts[pool]; index != NONE; index = blocks[index].nextPhysical)
+        {
+            const Block& block = blocks[index];
+            if(block.unused || block.pool != pool || block.offset != offset || block.previousPhysical != previous)
+                return false;
+            if(block.free && previous != NONE && blocks[previous].free)
+                return false;
+            if(++walkedBlockCount > usedBlockCount)
+                return false;
+
+            freeBlockCount += block.free;
+            if(!block.free)
+            {
+                ++poolAllocationCount;
+                walkedAllocatedSize += block.size;
+            }
+            offset += block.size;
+            previous = index;
+        }
+        if(offset != pools[pool].size || poolAllocationCount != pools[pool].allocationCount)
+            return false;
+        walkedAllocationCount += poolAllocationCount;
+    }
+    if(walkedBlockCount != usedBlockCount || walkedAllocationCount != allocationCount
+       || walkedAllocatedSize != allocatedSize)
+        return false;
+
+    // Every free block is in the list of its size class, and the bitmaps match which lists aren't empty
+    uint32_t listedBlockCount = 0;
+    for(uint32_t firstLevel = 0; firstLevel < FIRST_LEVEL_COUNT; ++firstLevel)
+    {
+        for(uint32_t secondLevel = 0; secondLevel < SECOND_LEVEL_COUNT; ++secondLevel)
+        {
+            const uint32_t head = freeLists[firstLevel][secondLevel];
+            const bool bit = (secondLevelBitmaps[firstLevel] >> secondLevel) & 1;
+            if(bit != (head != NONE))
+                return false;
+
+            uint32_t previous = NONE;
+            for(uint32_t index = head; index != NONE; index = blocks[index].nextFree)
+            {
+                const Block& block = blocks[index];
+                if(block.unused || !block.free || block.previousFree != previous)
+                    return false;
+                if(getLevels(block.size) != std::pair{firstLevel, secondLevel})
+                    return false;
+                if(++listedBlockCount > freeBlockCount)
+                    return false;
+                previous = index;
+            }
+        }
+        if(((firstLevelBitmap >> firstLevel) & 1) != (secondLevelBitmaps[firstLevel] != 0))
+            return false;
+    }
+    return listedBlockCount == freeBlockCount;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Two-level segregated fit allocator over any number of pools, e.g. GPU heaps of one type. It never touches the
+// memory it manages, it only hands out offsets into the pools, so it works the same for anything that's placed
+// at an offset. Free blocks are kept in lists by size class: the first level is the power of two below the
+// size and the second splits that range into SECOND_LEVEL_COUNT linear steps, with a bitmap per level so
+// finding a list with a block that fits, allocating and freeing are all constant time. Freed blocks are merged
+// with their free neighbours right away, blocks of different pools never are
+class TlsfAllocator
+{
+  public:
+    static constexpr uint32_t SECOND_LEVEL_BITS = 5;
+    static constexpr uint32_t SECOND_LEVEL_COUNT = 1 << SECOND_LEVEL_BITS;
+    // Every size is rounded up to this, and no block is split into anything smaller
+    static constexpr uint64_t GRANULARITY = 256;
+
+    struct Allocation
+    {
+        uint32_t pool;
+        uint64_t offset;
+        uint64_t size;
+        // Handle for free()
+        uint32_t block;
+    };
+
+    struct Stats
+    {
+        uint32_t poolCount;
+        uint32_t allocationCount;
+        uint32_t freeBlockCount;
+        uint64_t poolSize;
+        // Allocated bytes, with their rounding but not the alignment padding in front of them
+        uint64_t allocatedSize;
+        uint64_t largestFreeBlock;
+    };
+
+  private:
+    static constexpr uint32_t FIRST_LEVEL_COUNT = 64;
+    static constexpr uint32_t NONE = ~0u;
+
+    struct Block
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t pool;
+        // Neighbours in the pool, by offset
+        uint32_t previousPhysical;
+        uint32_t nextPhysical;
+        // Neighbours in the free list of the block's size class, only while it's free
+        uint32_t previousFree;
+        uint32_t nextFree;
+        bool free;
+        // Whether the block slot itself is unused and in `unusedBlocks`
+        bool unused;
+    };
+
+    struct Pool
+    {
+        uint64_t size;
+        uint32_t allocationCount;
+    };
+
+    std::vector<Block> blocks;
+    std::vector<uint32_t> unusedBlocks;
+    std::vector<Pool> pools;
+    uint64_t firstLevelBitmap = 0;
+    std::array<uint32_t, FIRST_LEVEL_COUNT> secondLevelBitmaps = {};
+    std::array<std::array<uint32_t, SECOND_LEVEL_COUNT>, FIRST_LEVEL_COUNT> freeLists;
+    uint32_t allocationCount = 0;
+    uint64_t allocatedSize = 0;
+
+    static std::pair<uint32_t, uint32_t> getLevels(uint64_t size);
+
+    uint32_t createBlock(const Block& block);
+    void destroyBlock(uint32_t index);
+    void insertFree(uint32_t index);
+    void removeFree(uint32_t index);
+    // First free block of at least `size`, or NONE
+    uint32_t findFree(uint64_t size) const;
+    // Splits the start of a block off into a new one of `size`, which is returned. The block keeps the rest
+    uint32_t splitFront(uint32_t index, uint64_t size);
+    // Splits everything after `size` off into a new free block
+    void splitBack(uint32_t index, uint64_t size);
+    // Merges a block into the one physically before it, returns the merged block
+    uint32_t mergeIntoPrevious(uint32_t index);
+
+  public:
+    TlsfAllocator();
+
+    // Adds a pool of `size` bytes and returns its index, which allocations from it carry. Pools start at
+    // offset 0 and are never removed
+    uint32_t addPool(uint64_t size);
+
+    // `alignment` is a power of two. Returns std::nullopt if no pool has a large enough free block, which is when
+    // another pool would be added
+    std::optional<Allocation> allocate(uint64_t size, uint64_t alignment = GRANULARITY);
+    void free(const Allocation& allocation);
+
+    // Whether nothing in `pool` is allocated
+    bool isPoolEmpty(uint32_t pool) const;
+
+    Stats stats() const;
+    // Walks every pool and free list and checks they agree, blocks tile each pool and no two free blocks are
+    // next to each other. For tests, it's linear in the block count
+    bool validate() const;
+};
@@ -0,0 +1,162 @@
+#include "transient_alias.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+namespace TransientAlias
+{
+namespace
+{
+    uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        assert(std::popcount(alignment) == 1);
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    bool overlapsInTime(const Resource& a, const Resource& b)
+    {
+        return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+    }
+
+    bool overlapsInMemory(uint64_t offsetA, uint64_t sizeA, uint64_t offsetB, uint64_t sizeB)
+    {
+        return offsetA < offsetB + sizeB && offsetB < offsetA + sizeA;
+    }
+
+    // Resources that used some of `index`'s memory before it
+    std::vector<uint32_t> getPredecessors(
+        std::span<const Resource> resources, std::span<const uint64_t> offsets, uint32_t index)
+    {
+        std::vector<uint32_t> predecessors;
+        const Resource& resource = resources[index];
+        for(uint32_t i = 0; i < resources.size(); ++i)
+        {
+            if(resources[i].lastPass < resource.firstPass
+               && overlapsInMemory(offsets[i], resources[i].size, offsets[index], resource.size))
+                predecessors.push_back(i);
+        }
+        return predecessors;
+    }
+}
+
+Plan plan(std::span<const Resource> resources)
+{
+    Plan result = {};
+    result.offsets.resize(resources.size());
+
+    std::vector<uint32_t> order(resources.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(),
+        order.end(),
+        [&](uint32_t a, uint32_t b)
+        {
+            if(resources[a].size != resources[b].size)
+                return resources[a].size > resources[b].size;
+            return resources[a].firstPass < resources[b].firstPass;
+        });
+
+    // Placed so far, as (offset, end, resource)
+    std::vector<std::tuple<uint64_t, uint64_t, uint32_t>> placed;
+    std::vector<std::pair<uint64_t, uint64_t>> conflicts;
+    for(uint32_t index : order)
+    {
+        const Resource& resource = resources[index];
+        assert(resource.firstPass <= resource.lastPass);
+
+        conflicts.clear();
+        for(const auto& [offset, end, other] : placed)
+        {
+            if(overlapsInTime(resource, resources[other]))
+                conflicts.push_back({offset, end});
+        }
+        std::sort(conflicts.begin(), conflicts.end());
+
+        // First gap between the ranges of everything alive at the same time that's large enough
+        uint64_t offset = 0;
+        for(const auto& [conflictOffset, conflictEnd] : conflicts)
+        {
+            if(alignUp(offset, resource.alignment) + resource.size <= conflictOffset)
+                break;
+            offset = std::max(offset, conflictEnd);
+        }
+        offset = alignUp(offset, resource.alignment);
+
+        result.offsets[index] = offset;
+        result.heapSize = std::max(result.heapSize, offset + resource.size);
+        placed.push_back({offset, offset + resource.size, index});
+    }
+
+    // One barrier per resource that takes over memory, in pass order
+    for(uint32_t index = 0; index < resources.size(); ++index)
+    {
+        result.unaliasedSize = alignUp(result.unaliasedSize, resources[index].alignment) + resources[index].size;
+
+        const std::vector<uint32_t> predecessors = getPredecessors(resources, result.offsets, index);
+        if(!predecessors.empty())
+        {
+            result.barriers.push_back(
+                {resources[index].firstPass, predecessors.size() == 1 ? predecessors[0] : NONE, index});
+        }
+    }
+    std::stable_sort(
+        result.barriers.begin(),
+        result.barriers.end(),
+        [](const Barrier& a, const Barrier& b) { return a.pass < b.pass; });
+
+    // Memory alive per pass only changes where a resource starts
+    for(const Resource& resource : resources)
+    {
+        uint64_t alive = 0;
+        for(const Resource& other : resources)
+        {
+            if(other.firstPass <= resource.firstPass && resource.firstPass <= other.lastPass)
+                alive += other.size;
+        }
+        result.lowerBound = std::max(result.lowerBound, alive);
+    }
+
+    return result;
+}
+
+bool validate(std::span<const Resource> resources, const Plan& plan)
+{
+    if(plan.offsets.size() != resources.size())
+        return false;
+
+    for(uint32_t i = 0; i < resources.size(); ++i)
+    {
+        const Resource& resource = resources[i];
+        if(plan.offsets[i] % resource.alignment != 0 || plan.offsets[i] + resource.size > plan.heapSize)
+            return false;
+
+        for(uint32_t j = i + 1; j < resources.size(); ++j)
+        {
+            if(overlapsInTime(resource, resources[j])
+               && overlapsInMemory(plan.offsets[i], resource.size, plan.offsets[j], resources[j].size))
+                return false;
+        }
+
+        const std::vector<uint32_t> predecessors = getPredecessors(resources, plan.offsets, i);
+        if(predecessors.empty())
+            continue;
+
+        // A barrier naming one resource only covers it if it's the only one
+        const bool covered = std::any_of(
+            plan.barriers.begin(),
+            plan.barriers.end(),
+            [&](const Barrier& barrier)
+            {
+                return barrier.after == i && barrier.pass == resource.firstPass
+                    && (barrier.before == NONE || (predecessors.size() == 1 && barrier.before == predecessors[0]));
+            });
+        if(!covered)
+            return false;
+    }
+    return plan.heapSize >= plan.lowerBound;
+}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Places the transient resources of a frame (render targets, depth buffers, intermediate targets of post
+// effects) in one shared heap so that resources which are never alive at the same time share memory. Every
+// resource declares the first and last pass that uses it, two resources whose pass ranges overlap are never
+// placed over each other. It only plans offsets and barriers, the caller creates the heap and the placed
+// resources, so it can be planned and checked without a device
+namespace TransientAlias
+{
+constexpr uint32_t NONE = ~0u;
+
+struct Resource
+{
+    // As returned by GetResourceAllocationInfo
+    uint64_t size;
+    uint64_t alignment;
+    uint32_t firstPass;
+    // Inclusive
+    uint32_t lastPass;
+};
+
+// Goes before `pass`. `after` takes over memory that `before` used, NONE if several resources did, which is the
+// null pResourceBefore of D3D12_RESOURCE_ALIASING_BARRIER. The new resource's contents are undefined, its first
+// use has to be a clear, discard or full copy
+struct Barrier
+{
+    uint32_t pass;
+    uint32_t before;
+    uint32_t after;
+};
+
+struct Plan
+{
+    // Per resource, in the order they were declared
+    std::vector<uint64_t> offsets;
+    std::vector<Barrier> barriers;
+    uint64_t heapSize;
+    // What every resource would take on its own, with their alignment
+    uint64_t unaliasedSize;
+    // The most memory that's alive during any pass. No placement can go below it
+    uint64_t lowerBound;
+};
+
+// Greedy by size: the largest resources are placed first, each at the lowest offset that doesn't overlap anything
+// already placed that's alive at the same time. That's an interval graph coloring where the colors are address
+// ranges, it's usually within a few percent of the lower bound
+Plan plan(std::span<const Resource> resources);
+
+// Whether no two resources that are alive at the same time overlap, every offset is aligned and every resource
+// that reuses memory has a barrier that covers whatever used it last. For tests, it's quadratic
+bool validate(std::span<const Resource> resources, const Plan& plan);
+}
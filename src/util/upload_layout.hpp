@@ -0,0 +1,77 @@
+#pragma once
+
+#include <util/align.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// A range of an upload buffer that holds `count` elements of T. The type is part of the handle, so writing a
+// matrix where the layout declared indices doesn't compile, and the size can't disagree with what was declared
+template<typename T>
+struct UploadRegion
+{
+    static constexpr uint32_t STRIDE = sizeof(T);
+
+    uint32_t offset = 0;
+    uint32_t count = 0;
+
+    constexpr uint32_t size() const
+    {
+        return count * STRIDE;
+    }
+
+    constexpr uint32_t end() const
+    {
+        return offset + size();
+    }
+
+    constexpr uint64_t gpuAddress(uint64_t bufferAddress) const
+    {
+        return bufferAddress + offset;
+    }
+
+    // `mapped` is the whole mapped buffer, which the region has to be inside of
+    T* data(std::span<char> mapped) const
+    {
+        assert(end() <= mapped.size());
+        return reinterpret_cast<T*>(mapped.data() + offset);
+    }
+
+    void write(std::span<char> mapped, std::span<const T> values) const
+    {
+        assert(values.size() <= count);
+        std::memcpy(data(mapped), values.data(), values.size_bytes());
+    }
+
+    void write(std::span<char> mapped, const T& value) const
+    {
+        write(mapped, std::span{&value, 1});
+    }
+};
+
+// Lays out regions one after another, each at its alignment. Everything is constexpr, so a layout whose counts
+// are known up front can be built in a constant initializer and costs nothing at runtime. A layout that depends on
+// what's loaded can start where a constant one ends
+class UploadLayout
+{
+    uint32_t size = 0;
+
+  public:
+    constexpr UploadLayout() = default;
+    constexpr explicit UploadLayout(uint32_t offset): size(offset) {}
+
+    template<typename T>
+    constexpr UploadRegion<T> add(uint32_t count, uint32_t alignment = alignof(T))
+    {
+        const UploadRegion<T> region{AlignTo(size, alignment), count};
+        size = region.end();
+        return region;
+    }
+
+    constexpr uint32_t getSize() const
+    {
+        return size;
+    }
+};
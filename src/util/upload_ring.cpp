@@ -0,0 +1,75 @@
+#include "upload_ring.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <utility>
+
+UploadRing::UploadRing(char* data, uint64_t gpuAddress, uint32_t size, uint32_t frameCount)
+    : data(data), gpuAddress(gpuAddress), frameCount(frameCount), frame(frameCount - 1)
+{
+    assert(frameCount > 0 && frameCount <= MAX_FRAME_COUNT);
+    // Keeps every partition as aligned as the buffer is, which is 64KB for a committed resource
+    partitionSize = size / frameCount / 256 * 256;
+}
+
+UploadRing::UploadRing(UploadRing&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+UploadRing& UploadRing::operator=(UploadRing&& other) noexcept
+{
+    data = std::exchange(other.data, nullptr);
+    gpuAddress = std::exchange(other.gpuAddress, 0);
+    partitionSize = std::exchange(other.partitionSize, 0);
+    frameCount = std::exchange(other.frameCount, 0);
+    frame = std::exchange(other.frame, 0);
+    head = other.head.exchange(0);
+    failedAllocations = other.failedAllocations.exchange(0);
+    fences = std::exchange(other.fences, {});
+    frameStats = std::exchange(other.frameStats, {});
+    return *this;
+}
+
+void UploadRing::beginFrame(uint64_t completedFence)
+{
+    frame = (frame + 1) % frameCount;
+    assert(completedFence >= fences[frame]);
+    head = 0;
+}
+
+void UploadRing::endFrame(uint64_t fence)
+{
+    assert(fence > fences[frame]);
+    fences[frame] = fence;
+    frameStats.lastFrameSize = std::min(head.load(), partitionSize);
+    frameStats.peakFrameSize = std::max(frameStats.peakFrameSize, frameStats.lastFrameSize);
+}
+
+std::optional<UploadRing::Allocation> UploadRing::allocate(uint32_t size, uint32_t alignment)
+{
+    assert(std::popcount(alignment) == 1 && alignment <= 256);
+
+    uint32_t current = head.load(std::memory_order_relaxed);
+    uint32_t offset;
+    do
+    {
+        offset = AlignTo(current, alignment);
+        if(offset > partitionSize || size > partitionSize - offset)
+        {
+            ++failedAllocations;
+            return std::nullopt;
+        }
+    } while(!head.compare_exchange_weak(current, offset + size, std::memory_order_relaxed));
+
+    offset += frame * partitionSize;
+    return Allocation{data + offset, gpuAddress + offset, offset, size};
+}
+
+UploadRing::Stats UploadRing::stats() const
+{
+    Stats result = frameStats;
+    result.failedAllocations = failedAllocations;
+    return result;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <util/align.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+// Per frame allocator for data the GPU reads straight from a persistently mapped upload buffer, constant
+// buffers and other dynamic data. The buffer is split into one partition per frame in flight and every frame
+// bump allocates from its own, so nothing a previous frame handed to the GPU is written over until that
+// frame's fence has passed. The buffer itself is never mapped or unmapped again after creation
+class UploadRing
+{
+  public:
+    static constexpr uint32_t MAX_FRAME_COUNT = 4;
+
+    struct Allocation
+    {
+        char* data;
+        uint64_t gpuAddress;
+        // From the start of the buffer
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct Stats
+    {
+        // Bytes used by the last frame that ended, and the most any frame has used
+        uint32_t lastFrameSize;
+        uint32_t peakFrameSize;
+        // Allocations that didn't fit in their frame's partition
+        uint32_t failedAllocations;
+    };
+
+  private:
+    char* data = nullptr;
+    uint64_t gpuAddress = 0;
+    uint32_t partitionSize = 0;
+    uint32_t frameCount = 0;
+    uint32_t frame = 0;
+    std::atomic<uint32_t> head = 0;
+    std::atomic<uint32_t> failedAllocations = 0;
+    // Fence that has to complete before each partition can be written again, 0 if it was never used
+    std::array<uint64_t, MAX_FRAME_COUNT> fences = {};
+    Stats frameStats = {};
+
+  public:
+    UploadRing() = default;
+    // `data` and `gpuAddress` are the mapped upload buffer, whose `size` is split evenly between
+    // `frameCount` partitions. beginFrame() has to be called before the first allocation
+    UploadRing(char* data, uint64_t gpuAddress, uint32_t size, uint32_t frameCount);
+    // Only while no thread is allocating
+    UploadRing(UploadRing&& other) noexcept;
+    UploadRing& operator=(UploadRing&& other) noexcept;
+    UploadRing(const UploadRing&) = delete;
+    UploadRing& operator=(const UploadRing&) = delete;
+
+    // What `completedFence` has to reach before beginFrame() can be called
+    uint64_t getReuseFence() const
+    {
+        return fences[(frame + 1) % frameCount];
+    }
+
+    // Moves on to the next frame's partition, which the GPU has to be done with
+    void beginFrame(uint64_t completedFence);
+    // Partition the current frame allocates from, anything else kept per frame in flight (command allocators)
+    // can be indexed with it as it's reused under the same fence
+    uint32_t getFrameIndex() const
+    {
+        return frame;
+    }
+    // `fence` is what the queue signals once it's done with everything allocated this frame
+    void endFrame(uint64_t fence);
+
+    // Lock free, so any thread recording the frame can allocate. `alignment` is at most what a constant buffer
+    // view needs, which is also the default. Returns std::nullopt if the frame's partition is full
+    std::optional<Allocation> allocate(uint32_t size, uint32_t alignment = 256);
+
+    template<typename T>
+    std::optional<Allocation> push(const T& value, uint32_t alignment = 256)
+    {
+        std::optional<Allocation> allocation = allocate(sizeof(T), alignment);
+        if(allocation)
+            std::memcpy(allocation->data, &value, sizeof(T));
+        return allocation;
+    }
+
+    uint32_t getPartitionSize() const
+    {
+        return partitionSize;
+    }
+
+    Stats stats() const;
+};